@@ -236,165 +236,9 @@ struct ib_sga_state_desc {
 struct ib_state_desc {
 };
 
-/// \brief InnoDB aysnc operation awaitable
-template <typename T>
-struct ib_async {
-};
-
-/// \brief InnoDB error codes.
-/// \details Most of the error codes are internal to the engine and will not be seen by user applications.
-/// The partial error codes reflect the sub-state of an operation within InnoDB.
-/// Some of the error codes are deprecated and are no longer used.
-enum ib_err {
-	/// \brief A successult result
-	DB_SUCCESS = 10,
-
-	/// \brief This is a generic error code.
-	/// \details It is used to classify error conditions that can't be represented by other codes
-	DB_ERROR,
-
-	/// \brief An operation was interrupted by a user.
-	DB_INTERRUPTED,
-
-	/// \brief Operation caused an out of memory error.
-	/// \details Within InnoDB core code this is normally a fatal error
-	DB_OUT_OF_MEMORY,
-
-	/// \brief The operating system returned an out of file space error when trying to do an IO operation
-	DB_OUT_OF_FILE_SPACE,
-
-	/// \brief A lock request by transaction resulted in a lock wait
-	/// \details The thread is suspended internally by InnoDB and is put on a lock wait queue.
-	DB_LOCK_WAIT,
-
-	/// \brief A lock request by a transaction resulted in a deadlock.
-	/// \details The transaction was rolled back
-	DB_DEADLOCK,
-
-	/// \brief Not used
-	DB_ROLLBACK,
-
-	/// \brief A record insert or update violates a unique contraint.
-	DB_DUPLICATE_KEY,
-
-	/// \brief A query thread should be in state suspended but is trying to acquire a lock.
-	/// \details Currently this is treated as a hard error and a violation of an invariant.
-	DB_QUE_THR_SUSPENDED,
-
-	/// \brief Required history data has been deleted due to lack of space in rollback segment
-	DB_MISSING_HISTORY,
-
-	/// \brief This error is not used
-	DB_CLUSTER_NOT_FOUND = 30,
-
-	/// \brief The table could not be found
-	DB_TABLE_NOT_FOUND,
-
-	/// \brief The database has to be stopped and restarted with more file space
-	DB_MUST_GET_MORE_FILE_SPACE,
-
-	/// \brief The user is trying to create a table in the InnoDB data dictionary but a table with that name already exists
-	DB_TABLE_IS_BEING_USED,
-
-	/// \brief A record in an index would not fit on a compressed page, or it woul become bigger than 1/2 free space in an uncompressed page frame
-	DB_TOO_BIG_RECORD,
-
-	/// \brief Lock wait lasted too long
-	DB_LOCK_WAIT_TIMEOUT,
-
-	/// \brief Referenced key value not found for a foreign key in an insert or update of a row
-	DB_NO_REFERENCED_ROW,
-
-	/// \brief Cannot delete or update a row because it contains a key value which is referenced
-	DB_ROW_IS_REFERENCED,
-
-	/// \brief Adding a foreign key constraint to a table failed
-	DB_CANNOT_ADD_CONSTRAINT,
-
-	/// \brief Data structure corruption noticed
-	DB_CORRUPTION,
-
-	/// \brief InnoDB cannot handle an index where same column appears twice
-	DB_COL_APPEARS_TWICE_IN_INDEX,
-
-	/// \brief Dropping a foreign key constraint from a table failed
-	DB_CANNOT_DROP_CONSTRAINT,
+#include "xinnodb/err.hpp" // IWYU pragma: export
 
-	/// \brief No savepoint exists with the given name
-	DB_NO_SAVEPOINT,
-
-	/// \brief We cannot create a new single-table tablespace because a file of the same name already exists
-	DB_TABLESPACE_ALREADY_EXISTS,
-
-	/// \brief Tablespace does not exist or is being dropped right now
-	DB_TABLESPACE_DELETED,
-
-	/// \brief Lock structs have exhausted the buffer pool (for big transactions, InnoDB stores the lock structs in the buffer pool)
-	DB_LOCK_TABLE_FULL,
-
-	/// \brief Foreign key constraints activated but the operation would lead to a duplicate key in some table
-	DB_FOREIGN_DUPLICATE_KEY,
-
-	/// \brief When InnoDB runs out of the preconfigured undo slots, this can only happen when there are too many concurrent transactions
-	DB_TOO_MANY_CONCURRENT_TRXS,
-
-	/// \brief When InnoDB sees any artefact or a feature that it can't recoginize or work with e.g., FT indexes created by a later version of the engine.
-	DB_UNSUPPORTED,
-
-	/// \brief A column in the PRIMARY KEY was found to be NULL
-	DB_PRIMARY_KEY_IS_NULL,
-
-	/// \brief The application should clean up and quite ASAP.
-	/// \details Fatal error, InnoDB cannot continue operation without risking database corruption.
-	DB_FATAL,
-
-	// The following are partial failure codes
-	// -----------------------------------------------
-
-	/// \brief Partial failure code.
-	DB_FAIL = 1000,
-
-	/// \brief If an update or insert of a record doesn't fit in a Btree page
-	DB_OVERFLOW,
-
-	/// \brief If an update or delete of a record causes a Btree page to be below a minimum threshold
-	DB_UNDERFLOW,
-
-	/// \brief Failure to insert a secondary index entry to the insert buffer
-	DB_STRONG_FAIL,
-
-	/// \brief Failure trying to compress a page
-	DB_ZIP_OVERFLOW,
-
-	// ------------------------------------------------------
-
-	/// \brief Record not found
-	DB_RECORD_NOT_FOUND = 1500,
-
-	/// \brief A cursor operation or search operation scanned to the end of the index.
-	DB_END_OF_INDEX,
-
-	// api_only_error_codes API only error codes
-	// Error codes that are only used by the API and not by the engine itself.
-
-	/// \brief Generic schema error
-	DB_SCHEMA_ERROR = 2000,
-
-	/// \brief Column update or read failed because the types mismatch
-	DB_DATA_MISMATCH,
-
-	/// \brief If an API function expects the schema to be locked in exclusive mod and if it's not then that API function will return this error code
-	DB_SCHEMA_NOT_LOCKED,
-
-	/// \brief Generic error code for "Not found" type of errors
-	DB_NOT_FOUND,
-
-	/// \brief Generic error code for "Readonly" type of errors
-	DB_READONLY,
-
-	/// \brief Generic error code for "Invalid input" type of errors
-	DB_INVALID_INPUT
-};
+#include "xinnodb/async.hpp" // IWYU pragma: export
 
 extern int ib_version;
 
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "xinnodb/err.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/// \addtogroup other
+/// @{
+
+/// \brief Allocates a coroutine frame from the current worker (implemented by the task module)
+/// \return nullptr when neither the worker allocator nor its reserve can hold the frame
+void* ib_async_frame_alloc(std::size_t size) noexcept;
+
+/// \brief Returns a frame obtained from ib_async_frame_alloc() to its owner
+void ib_async_frame_free(void* frame, std::size_t size) noexcept;
+
+/// \brief True (once) if the last frame allocated on this thread came from the emergency reserve
+bool ib_async_frame_take_pressure() noexcept;
+
+/// \brief Parks the running task until frame memory is available, then starts `callee`
+/// \return false when there is no running task to park (the caller just runs `callee`)
+bool ib_async_frame_wait(std::coroutine_handle<> callee) noexcept;
+
+/// \brief Requeues the running task to start `callee` later if it has used up its step budget
+/// \return false when the task may go on (or there is no running task)
+bool ib_async_preempt(std::coroutine_handle<> callee) noexcept;
+
+/// \brief Promise state shared by every ib_async<T>
+struct ib_async_promise_base {
+    std::coroutine_handle<> continuation;   ///< Awaiting coroutine, resumed by symmetric transfer
+    bool                    pressured;      ///< Frame came from the reserve: start only when memory is back
+
+    ib_async_promise_base() noexcept : continuation(nullptr), pressured(ib_async_frame_take_pressure()) {}
+
+    /// \brief Frames never come from the global heap
+    static void* operator new(std::size_t size) noexcept { return ib_async_frame_alloc(size); }
+    static void  operator delete(void* frame, std::size_t size) noexcept { ib_async_frame_free(frame, size); }
+
+    struct final_awaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> self) const noexcept {
+            std::coroutine_handle<> next = self.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    final_awaiter       final_suspend() const noexcept { return {}; }
+    void                unhandled_exception() const noexcept { std::terminate(); }
+};
+
+template <typename T>
+struct ib_async;
+
+/// \brief Result storage of an ib_async<T> promise
+template <typename T>
+struct ib_async_promise : ib_async_promise_base {
+    alignas(T) unsigned char storage[sizeof(T)];
+    bool has_value = false;
+
+    ~ib_async_promise() {
+        if (has_value) reinterpret_cast<T*>(storage)->~T();
+    }
+
+    template <typename U>
+    void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+        ::new (static_cast<void*>(storage)) T(std::forward<U>(value));
+        has_value = true;
+    }
+
+    T take() noexcept { return std::move(*reinterpret_cast<T*>(storage)); }
+};
+
+template <>
+struct ib_async_promise<void> : ib_async_promise_base {
+    void return_void() const noexcept {}
+    void take() const noexcept {}
+};
+
+/// \brief InnoDB async operation: a lazily started coroutine task
+/// \details Awaiting an ib_async starts it by symmetric transfer and the awaiting coroutine is
+/// resumed the same way when it completes, so call chains of any depth run without growing the
+/// stack. Frames are allocated from the worker `alloc_table` (`alloc_kind::PROMISE`).
+///
+/// Every await is a preemption point: once the task has used up the step budget of its priority
+/// class, the callee starts on a later turn of the worker loop instead of immediately.
+///
+/// When the worker allocator is exhausted the frame comes from a small per-worker reserve and the
+/// awaiting task is parked (suspend reason ALLOC) until memory is freed; the callee starts then.
+/// Only if the reserve is exhausted too does the call yield a failed ib_async: awaiting it does not
+/// run anything and produces `DB_OUT_OF_MEMORY` for `ib_async<ib_err>` and a value-initialized
+/// `T` otherwise.
+template <typename T>
+struct [[nodiscard]] ib_async {
+    struct promise_type : ib_async_promise<T> {
+        ib_async get_return_object() noexcept {
+            return ib_async(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        static ib_async get_return_object_on_allocation_failure() noexcept { return ib_async(nullptr); }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    ib_async() noexcept : handle(nullptr) {}
+    explicit ib_async(handle_type h) noexcept : handle(h) {}
+    ib_async(ib_async&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ib_async& operator=(ib_async&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ib_async(const ib_async&) = delete;
+    ib_async& operator=(const ib_async&) = delete;
+    ~ib_async() {
+        if (handle) handle.destroy();
+    }
+
+    /// \brief False when the frame could not be allocated
+    bool valid() const noexcept { return static_cast<bool>(handle); }
+
+    /// \brief Transfers ownership of the coroutine (used to spawn root tasks)
+    handle_type release() noexcept { return std::exchange(handle, nullptr); }
+
+    struct awaiter {
+        handle_type callee;
+
+        bool await_ready() const noexcept { return !callee; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) const noexcept {
+            callee.promise().continuation = caller;
+            if (callee.promise().pressured && ib_async_frame_wait(callee)) {
+                return std::noop_coroutine();
+            }
+            if (ib_async_preempt(callee)) return std::noop_coroutine();
+            return callee;
+        }
+
+        T await_resume() const noexcept {
+            if (!callee) {
+                if constexpr (std::is_same_v<T, ib_err>) {
+                    return DB_OUT_OF_MEMORY;
+                } else if constexpr (!std::is_void_v<T>) {
+                    return T{};
+                } else {
+                    return;
+                }
+            }
+            return callee.promise().take();
+        }
+    };
+
+    awaiter operator co_await() const& noexcept { return awaiter{ handle }; }
+
+    handle_type handle;
+};
+
+/// @}
@@ -32,6 +32,7 @@ enum class alloc_kind
     FREE_SEGMENT_INDEX_INNER,
     FREE_SEGMENT_INDEX_LEAF_EXTENSION
 };
+const char* to_string(alloc_kind) noexcept;
 
 /// \brief Allocator Block Description
 /// \details The allocator block description is used to track the allocator's blocks.
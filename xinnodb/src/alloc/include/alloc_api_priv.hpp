@@ -17,8 +17,11 @@ constexpr ib_u64 ALLOC_STATE_IS_SENTINEL_MASK = 4;
 // Allocator Table
 int    alloc_table_init(alloc_table* at, void* mem, ib_size size) noexcept;
 void*  alloc_table_try_malloc(alloc_table* at, ib_size size) noexcept;
+void*  alloc_table_try_malloc(alloc_table* at, ib_size size, alloc_kind kind) noexcept;
+alloc_kind alloc_table_kind_of(const void* ptr) noexcept;
 void   alloc_table_free(alloc_table* at, void* ptr, ib_u32 side_coalescing) noexcept;
 int    alloc_table_defrag(alloc_table* at, ib_u64 millis_budget) noexcept;
+void   alloc_table_reclaim(void* at, void* ptr) noexcept;
 void   alloc_table_check_invariants(alloc_table* at, std::source_location loc = std::source_location::current()) noexcept;
 ib_i64 alloc_table_coalesce_right(alloc_table* at, alloc_block_header** out_block, ib_u32 max_merges) noexcept;
 ib_i64 alloc_table_coalesce_left(alloc_table* at, alloc_block_header** out_block, ib_u32 max_merges) noexcept;
@@ -1,4 +1,5 @@
 #include "alloc.hpp" // IWYU pragma: keep
+#include "ut_acct.hpp"
 #include <cstring>
 
 constexpr ib_size MAX_SMALL_BIN_SIZE = 2048;
@@ -20,6 +21,19 @@ const char* to_string(alloc_block_state s) noexcept {
     }
 }
 
+const char* to_string(alloc_kind k) noexcept {
+    switch (k) {
+        case alloc_kind::GENERIC_MALLOC:                    return "generic";
+        case alloc_kind::PROMISE:                           return "promise";
+        case alloc_kind::FREE_SEGMENT_INDEX_LEAF:           return "fsi_leaf";
+        case alloc_kind::FREE_SEGMENT_INDEX_INNER:          return "fsi_inner";
+        case alloc_kind::FREE_SEGMENT_INDEX_LEAF_EXTENSION: return "fsi_leaf_ext";
+        default:                                            return "invalid";
+    }
+}
+
+static_assert((ib_u32)alloc_kind::FREE_SEGMENT_INDEX_LEAF_EXTENSION < UT_ACCT_ALLOC_KINDS, "task accounts count allocations per kind");
+
 int alloc_table_init(alloc_table* at, void* mem, ib_size size) noexcept {
     
     constexpr ib_u64 SENTINEL_SIZE = sizeof(alloc_pooled_free_block_header);
@@ -97,7 +111,7 @@ int alloc_table_init(alloc_table* at, void* mem, ib_size size) noexcept {
 /// 
 /// Returns nullptr if no suitable block found (heap doesn't grow).
 /// For async version that suspends on failure, use co_await AllocMem(size).
-void* alloc_table_try_malloc(alloc_table* at, ib_size size) noexcept {
+static void* alloc_table_take(alloc_table* at, ib_size size) noexcept {
     
     alloc_table_check_invariants(at);
     // Compute aligned block size
@@ -328,6 +342,35 @@ void* alloc_table_try_malloc(alloc_table* at, ib_size size) noexcept {
     }
 }
 
+/// \brief Allocates an untagged block, charged to the running task as a generic allocation
+/// \return nullptr if no suitable block is found
+void* alloc_table_try_malloc(alloc_table* at, ib_size size) noexcept {
+    void* ptr = alloc_table_take(at, size);
+    if (ptr != nullptr) ut_acct_charge_alloc((ib_u32)alloc_kind::GENERIC_MALLOC, size);
+    return ptr;
+}
+
+/// \brief Allocates memory and tags the block with its kind
+/// \details The kind is kept in the block descriptor (and mirrored in the next block's prev
+/// descriptor) until the block is freed; dumps, invariant checks and statistics use it to tell
+/// coroutine frames apart from generic allocations.
+/// \return nullptr if no suitable block is found
+void* alloc_table_try_malloc(alloc_table* at, ib_size size, alloc_kind kind) noexcept {
+    void* ptr = alloc_table_take(at, size);
+    if (ptr == nullptr) return nullptr;
+    ut_acct_charge_alloc((ib_u32)kind, size);
+    alloc_block_header* block = (alloc_block_header*)((char*)ptr - HEADER_SIZE);
+    block->this_desc.kind = (ib_u32)kind;
+    alloc_block_next(block)->prev_desc.kind = (ib_u32)kind;
+    return ptr;
+}
+
+/// \brief Returns the kind of a block returned by alloc_table_try_malloc
+alloc_kind alloc_table_kind_of(const void* ptr) noexcept {
+    const alloc_block_header* block = (const alloc_block_header*)((const char*)ptr - HEADER_SIZE);
+    return (alloc_kind)block->this_desc.kind;
+}
+
 /// \brief Frees allocated memory and coalesces with adjacent free blocks.
 /// 
 /// Algorithm:
@@ -357,6 +400,7 @@ void alloc_table_free(alloc_table* at, void* ptr, ib_u32 side_coalescing) noexce
     enum alloc_block_state block_state = (enum alloc_block_state)this_size.state;
     IB_ASSERT(block_state == ALLOC_BLOCK_STATE_USED);        
     block->this_desc.state = (ib_u32)ALLOC_BLOCK_STATE_FREE;
+    block->this_desc.kind  = (ib_u32)alloc_kind::INVALID;
     at->free_mem_size += block_size;
 
     // Update next block prevSize
@@ -389,6 +433,16 @@ void alloc_table_free(alloc_table* at, void* ptr, ib_u32 side_coalescing) noexce
 }
 
 
+/// \brief Reclaim callback for deferred frees (`ut_ebr_reclaim_fn` signature)
+/// \details Retired nodes of lockless structures are returned to the worker allocator through this
+/// function once their grace period has elapsed.
+/// \param at The owning alloc_table
+/// \param ptr Pointer returned by alloc_table_try_malloc
+void alloc_table_reclaim(void* at, void* ptr) noexcept {
+    alloc_table_free((alloc_table*)at, ptr, 0);
+}
+
+
 // Coalesce helpers: merge adjacent free or wild blocks into the provided block
 // Returns: total merged size added into '*out_block' (not including original block size), or -1 on error
 ib_i64 alloc_table_coalesce_left(alloc_table* at, alloc_block_header** out_block, ib_u32 max_merges) noexcept {
@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+#include "alloc.hpp" // IWYU pragma: keep
+
+TEST(AllocKindTest, BlocksCarryTheirKindUntilFreed) {
+	ib_u64 buffer_size = 256 * 1024;
+	void* buffer = std::malloc(buffer_size);
+	ASSERT_NE(buffer, nullptr);
+	alloc_table table{};
+	ASSERT_EQ(alloc_table_init(&table, buffer, buffer_size), 0);
+
+	void* frame   = alloc_table_try_malloc(&table, 200, alloc_kind::PROMISE);
+	void* large   = alloc_table_try_malloc(&table, 4096, alloc_kind::GENERIC_MALLOC);
+	void* untyped = alloc_table_try_malloc(&table, 64);
+	ASSERT_NE(frame, nullptr);
+	ASSERT_NE(large, nullptr);
+	ASSERT_NE(untyped, nullptr);
+	EXPECT_EQ(alloc_table_kind_of(frame), alloc_kind::PROMISE);
+	EXPECT_EQ(alloc_table_kind_of(large), alloc_kind::GENERIC_MALLOC);
+	EXPECT_EQ(alloc_table_kind_of(untyped), alloc_kind::INVALID);
+
+	alloc_table_free(&table, frame, 0);
+	void* reused = alloc_table_try_malloc(&table, 200);
+	EXPECT_EQ(reused, frame);
+	EXPECT_EQ(alloc_table_kind_of(reused), alloc_kind::INVALID);
+
+	alloc_table_free(&table, reused, 0);
+	alloc_table_free(&table, large, 0);
+	alloc_table_free(&table, untyped, 0);
+	alloc_table_check_invariants(&table);
+	std::free(buffer);
+}
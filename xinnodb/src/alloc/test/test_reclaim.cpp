@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+#include "alloc.hpp"  // IWYU pragma: keep
+#include "ut_ebr.hpp" // IWYU pragma: keep
+
+struct ReclaimNode {
+	ut_ebr_node ebr;
+	ib_u64      payload;
+};
+
+TEST(AllocReclaimTest, RetiredNodesReturnToTable) {
+	ib_u64 buffer_size = 1024 * 1024;
+	void* buffer = std::malloc(buffer_size);
+	ASSERT_NE(buffer, nullptr);
+	alloc_table table{};
+	ASSERT_EQ(alloc_table_init(&table, buffer, buffer_size), 0);
+	const ib_size free_before = table.free_mem_size;
+
+	auto* d = new ut_ebr_domain;
+	ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 8);
+	ut_ebr_participant p;
+	ASSERT_EQ(ut_ebr_participant_register(d, &p, &alloc_table_reclaim, &table), 0);
+
+	for (int i = 0; i < 32; ++i) {
+		auto* n = (ReclaimNode*)alloc_table_try_malloc(&table, sizeof(ReclaimNode));
+		ASSERT_NE(n, nullptr);
+		ut_ebr_retire(&p, &n->ebr, n);
+	}
+	ut_ebr_participant_unregister(&p);
+
+	EXPECT_EQ(table.free_mem_size, free_before);
+	delete d;
+	std::free(buffer);
+}
@@ -0,0 +1,88 @@
+#include "xinnodb.hpp"
+#include "ut_cfg.hpp"
+
+#include <cstdarg>
+#include <cstdlib>
+
+namespace {
+
+/// \brief A value read from the variadic arguments of ib_cfg_set()
+union ib_cfg_value {
+    ib_bool     b;
+    ib_ulint    n;
+    const char* text;
+    void*       cb;
+};
+
+/// \brief Stores `value`; ib_cfg_set() itself cannot be a coroutine since it is variadic
+ib_async<ib_err> ib_cfg_set_value(const char* name, ib_cfg_value value) noexcept {
+    switch (ut_cfg_set(name, &value)) {
+    case 0:  co_return DB_SUCCESS;
+    case -1: co_return DB_NOT_FOUND;
+    default: co_return DB_INVALID_INPUT;
+    }
+}
+
+ib_async<ib_err> ib_cfg_fail(ib_err err) noexcept {
+    co_return err;
+}
+
+} // namespace
+
+/// \brief Sets the configuration variable called `name`
+/// \details The value follows the name and has the type of the variable (see ib_cfg_var_get_type()):
+/// an `ib_bool` for IB_CFG_IBOOL, an `ib_ulint` for IB_CFG_ULINT and IB_CFG_ULONG, a `const char*`
+/// for IB_CFG_TEXT and a function pointer for IB_CFG_CB.
+/// \return DB_SUCCESS, DB_NOT_FOUND if no module registered it, or DB_INVALID_INPUT if the value
+/// is out of range or rejected by the module
+INNODB_API ib_async<ib_err> ib_cfg_set(ib_state_hdl, const char* name, ...) noexcept {
+    ib_cfg_type type;
+    if (name == nullptr) return ib_cfg_fail(DB_INVALID_INPUT);
+    if (ut_cfg_type_of(name, &type) != 0) return ib_cfg_fail(DB_NOT_FOUND);
+    ib_cfg_value value;
+    std::va_list ap;
+    va_start(ap, name);
+    switch (type) {
+    case IB_CFG_IBOOL: value.b    = (ib_bool)va_arg(ap, int); break;
+    case IB_CFG_ULINT:
+    case IB_CFG_ULONG: value.n    = va_arg(ap, ib_ulint); break;
+    case IB_CFG_TEXT:  value.text = va_arg(ap, const char*); break;
+    case IB_CFG_CB:    value.cb   = va_arg(ap, void*); break;
+    }
+    va_end(ap);
+    return ib_cfg_set_value(name, value);
+}
+
+/// \brief Copies the value of `name` to `value`, which points to storage of the variable's type
+/// \return DB_SUCCESS, or DB_NOT_FOUND if no module registered it
+INNODB_API ib_async<ib_err> ib_cfg_get(ib_state_hdl, const char* name, void* value) noexcept {
+    if (name == nullptr || value == nullptr) co_return DB_INVALID_INPUT;
+    co_return ut_cfg_get(name, value) == 0 ? DB_SUCCESS : DB_NOT_FOUND;
+}
+
+/// \brief Lists the configuration variables registered by the running modules
+/// \param names Out: `*names_num` names in an array allocated with `malloc()`; the caller frees the
+/// array (not the names)
+/// \return DB_SUCCESS, or DB_OUT_OF_MEMORY if the array could not be allocated
+INNODB_API ib_async<ib_err> ib_cfg_get_all(ib_state_hdl, const char*** names, ib_u32* names_num) noexcept {
+    if (names == nullptr || names_num == nullptr) co_return DB_INVALID_INPUT;
+    ib_u32 n = ut_cfg_names(nullptr, 0);
+    for (;;) {
+        const char** array = (const char**)std::malloc(sizeof(const char*) * (n != 0 ? n : 1));
+        if (array == nullptr) co_return DB_OUT_OF_MEMORY;
+        const ib_u32 registered = ut_cfg_names(array, n);
+        if (registered <= n) {
+            *names     = array;
+            *names_num = registered;
+            co_return DB_SUCCESS;
+        }
+        std::free(array);
+        n = registered;
+    }
+}
+
+/// \return DB_SUCCESS, or DB_NOT_FOUND if no module registered `name`
+INNODB_API ib_async<ib_err> ib_cfg_var_get_type(ib_state_hdl, const char* name, ib_cfg_type* type) noexcept {
+    if (name == nullptr || type == nullptr) co_return DB_INVALID_INPUT;
+    co_return ut_cfg_type_of(name, type) == 0 ? DB_SUCCESS : DB_NOT_FOUND;
+}
@@ -0,0 +1,11 @@
+#include "xinnodb.hpp"
+#include "io_sim.hpp"
+
+/// \brief Arms a one-shot fault on the simulated disks (IO_BACKEND_SIM) for the next matching request
+/// \param err `EIO` fails the next read, write or fsync; `ENOSPC` the next write or fsync;
+/// IO_SIM_FAULT_LOST_FSYNC acknowledges the next fsync without persisting anything;
+/// IO_SIM_FAULT_TORN_WRITE tears the next write if the disk crashes before it is synced
+/// \return DB_SUCCESS, or DB_INVALID_INPUT for a fault the simulator cannot produce
+INNODB_API ib_async<ib_err> ib_error_inject(ib_state_hdl, int err) noexcept {
+    co_return io_sim_inject(err) == 0 ? DB_SUCCESS : DB_INVALID_INPUT;
+}
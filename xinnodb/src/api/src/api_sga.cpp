@@ -0,0 +1,51 @@
+#include "xinnodb.hpp"
+#include "sga.hpp"
+
+namespace {
+
+ib_err ib_sga_err(int rc) noexcept {
+    switch (rc) {
+    case 0:                return DB_SUCCESS;
+    case -ENOMEM:          return DB_OUT_OF_MEMORY;
+    case -ENOENT:          return DB_NOT_FOUND;
+    case -EPROTONOSUPPORT: return DB_UNSUPPORTED;
+    case -EBADMSG:         return DB_CORRUPTION;
+    case -ESTALE:          return DB_DATA_MISMATCH;
+    case -EBUSY:           return DB_LOCK_WAIT_TIMEOUT;
+    default:               return DB_INVALID_INPUT;
+    }
+}
+
+} // namespace
+
+/// \brief The exact number of bytes of the SGA described by `desc`
+/// \return The size, or 0 if `desc` is nullptr or its sizes overflow
+INNODB_API ib_u64 ib_get_sga_state_required_size(ib_sga_state_desc* desc) noexcept {
+    if (desc == nullptr) return 0;
+    return sga_required_size(desc);
+}
+
+/// \brief Creates the SGA, or attaches to the one `buffer` already holds
+/// \details With `buffer` == nullptr the SGA is one new shared mapping, inherited by the worker
+/// processes forked afterwards. A caller-provided `buffer` (at least 64-byte aligned, 2 MiB aligned
+/// for the areas to start on huge pages, and `ib_get_sga_state_required_size()` bytes long) is
+/// attached to if a previous process formatted it, after its header was validated; `desc` may then
+/// be nullptr to accept whatever layout it has.
+/// \param out_err DB_SUCCESS; DB_INVALID_INPUT for a bad argument or a buffer too small;
+/// DB_OUT_OF_MEMORY; DB_NOT_FOUND if `desc` is nullptr and there is nothing to attach to;
+/// DB_UNSUPPORTED if the SGA has another format version; DB_CORRUPTION if its header is damaged;
+/// DB_DATA_MISMATCH if it was formatted for another descriptor; DB_LOCK_WAIT_TIMEOUT if the process
+/// formatting it did not finish
+/// \return The handle, with `hdl` == 0 on failure
+INNODB_API ib_sga_hdl ib_sga_init(void* buffer, ib_u64 buffer_size, ib_sga_state_desc* desc, ib_err* out_err) noexcept {
+    sga_header* h        = nullptr;
+    bool        attached = false;
+    const int   rc       = sga_open(buffer, buffer_size, desc, &h, &attached);
+    if (out_err != nullptr) *out_err = ib_sga_err(rc);
+    return ib_sga_hdl{ (ib_uintptr)h };
+}
+
+/// \brief Releases a handle from ib_sga_init(); the SGA stays valid for the other processes
+INNODB_API void ib_sga_fini(ib_sga_hdl sga) noexcept {
+    sga_close((sga_header*)sga.hdl);
+}
@@ -0,0 +1,33 @@
+#include "xinnodb.hpp"
+#include "ut_status.hpp"
+
+#include <cstdlib>
+
+/// \brief Lists the status variables registered by the running modules
+/// \param names Out: `*names_num` names in an array allocated with `malloc()`; the caller frees the
+/// array (not the names, which stay valid while the modules that registered them are up)
+/// \return DB_SUCCESS, or DB_OUT_OF_MEMORY if the array could not be allocated
+INNODB_API ib_async<ib_err> ib_status_get_all(ib_state_hdl, const char*** names, ib_u32* names_num) noexcept {
+    if (names == nullptr || names_num == nullptr) co_return DB_INVALID_INPUT;
+    ib_u32 n = ut_status_names(nullptr, 0);
+    for (;;) {
+        const char** array = (const char**)std::malloc(sizeof(const char*) * (n != 0 ? n : 1));
+        if (array == nullptr) co_return DB_OUT_OF_MEMORY;
+        const ib_u32 registered = ut_status_names(array, n);
+        if (registered <= n) {
+            *names     = array;
+            *names_num = registered;
+            co_return DB_SUCCESS;
+        }
+        // Variables were registered meanwhile
+        std::free(array);
+        n = registered;
+    }
+}
+
+/// \brief Reads the status variable called `name`
+/// \return DB_SUCCESS, or DB_NOT_FOUND if no module registered it
+INNODB_API ib_async<ib_err> ib_status_get_i64(ib_state_hdl, const char* name, ib_i64* dst) noexcept {
+    if (name == nullptr || dst == nullptr) co_return DB_INVALID_INPUT;
+    co_return ut_status_get_i64(name, dst) == 0 ? DB_SUCCESS : DB_NOT_FOUND;
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include "task.hpp"      // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+#include "ut_cfg.hpp"    // IWYU pragma: keep
+
+namespace {
+
+struct ApiCfgFixture : ::testing::Test, task_test_env {
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+    }
+
+    void TearDown() override {
+        task_test_env_destroy(this);
+    }
+};
+
+int apply_level(ut_cfg_var* var, const void* value) noexcept {
+    const char* level = *(const char* const*)value;
+    if (std::strcmp(level, "low") != 0 && std::strcmp(level, "high") != 0) return -1;
+    const char* canonical = level[0] == 'l' ? "low" : "high";
+    ut_cfg_store(var, &canonical);
+    return 0;
+}
+
+struct Results {
+    ib_err       set_size;
+    ib_err       set_size_too_big;
+    ib_err       set_flag;
+    ib_err       set_level;
+    ib_err       set_level_bad;
+    ib_err       set_missing;
+    ib_err       get_size;
+    ib_ulint     size;
+    ib_err       get_type;
+    ib_cfg_type  type;
+    ib_err       all;
+    const char** names;
+    ib_u32       names_num;
+};
+
+ib_async<void> configure(Results* r) {
+    const ib_state_hdl db{ 0 };
+    r->set_size         = co_await ib_cfg_set(db, "test.api.size", (ib_ulint)128);
+    r->set_size_too_big = co_await ib_cfg_set(db, "test.api.size", (ib_ulint)1 << 40);
+    r->set_flag         = co_await ib_cfg_set(db, "test.api.flag", (ib_bool) true);
+    r->set_level        = co_await ib_cfg_set(db, "test.api.level", "high");
+    r->set_level_bad    = co_await ib_cfg_set(db, "test.api.level", "medium");
+    r->set_missing      = co_await ib_cfg_set(db, "test.api.missing", (ib_ulint)1);
+    r->get_size         = co_await ib_cfg_get(db, "test.api.size", &r->size);
+    r->get_type         = co_await ib_cfg_var_get_type(db, "test.api.level", &r->type);
+    r->all              = co_await ib_cfg_get_all(db, &r->names, &r->names_num);
+}
+
+} // namespace
+
+TEST_F(ApiCfgFixture, ConfigurationVariablesAreSetThroughTheApi) {
+    ib_ulint    size  = 16;
+    ib_bool     flag  = false;
+    const char* level = "low";
+    ut_cfg_var  vsize, vflag, vlevel;
+    ASSERT_EQ(ut_cfg_register(&vsize, "test.api.size", IB_CFG_ULINT, &size, nullptr, 1, 1 << 20), 0);
+    ASSERT_EQ(ut_cfg_register(&vflag, "test.api.flag", IB_CFG_IBOOL, &flag), 0);
+    ASSERT_EQ(ut_cfg_register(&vlevel, "test.api.level", IB_CFG_TEXT, &level, apply_level), 0);
+
+    Results r{};
+    ASSERT_EQ(task_spawn(&worker, configure(&r)), 0);
+    sched_run(&worker);
+    ut_cfg_unregister(&vlevel);
+    ut_cfg_unregister(&vflag);
+    ut_cfg_unregister(&vsize);
+
+    EXPECT_EQ(r.set_size, DB_SUCCESS);
+    EXPECT_EQ(r.set_size_too_big, DB_INVALID_INPUT);
+    EXPECT_EQ(r.set_flag, DB_SUCCESS);
+    EXPECT_EQ(r.set_level, DB_SUCCESS);
+    EXPECT_EQ(r.set_level_bad, DB_INVALID_INPUT);
+    EXPECT_EQ(r.set_missing, DB_NOT_FOUND);
+    EXPECT_EQ(size, 128u);
+    EXPECT_TRUE(flag);
+    EXPECT_STREQ(level, "high");
+    EXPECT_EQ(r.get_size, DB_SUCCESS);
+    EXPECT_EQ(r.size, 128u);
+    EXPECT_EQ(r.get_type, DB_SUCCESS);
+    EXPECT_EQ(r.type, IB_CFG_TEXT);
+    ASSERT_EQ(r.all, DB_SUCCESS);
+    int found = 0;
+    for (ib_u32 i = 0; i < r.names_num; ++i) found += std::strncmp(r.names[i], "test.api.", 9) == 0;
+    EXPECT_EQ(found, 3);
+    std::free(r.names);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <cerrno>
+
+#include "io_sim.hpp"    // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+
+namespace {
+
+struct ApiErrorFixture : ::testing::Test, task_test_env {
+    io_sim_disk disk;
+    io_worker   iw;
+
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+        io_sim_options o{};
+        o.virtual_time = true;
+        ASSERT_EQ(io_sim_disk_init(&disk, &o), 0);
+        io_options opts{};
+        opts.backend = IO_BACKEND_SIM;
+        opts.sim     = &disk;
+        ASSERT_EQ(io_worker_init(&iw, &worker, &opts), 0);
+    }
+
+    void TearDown() override {
+        io_worker_detach(&iw);
+        io_sim_disk_destroy(&disk);
+        task_test_env_destroy(this);
+    }
+};
+
+struct Results {
+    ib_err inject;
+    ib_err inject_bad;
+    ib_i64 failed;
+    ib_i64 next;
+};
+
+ib_async<void> inject_and_read(int fd, Results* r) {
+    const ib_state_hdl db{ 0 };
+    char               buf[512];
+    r->inject     = co_await ib_error_inject(db, EIO);
+    r->inject_bad = co_await ib_error_inject(db, 12345);
+    r->failed     = co_await io_read(fd, buf, sizeof(buf), 0);
+    r->next       = co_await io_read(fd, buf, sizeof(buf), 0);
+}
+
+} // namespace
+
+TEST_F(ApiErrorFixture, InjectedErrorFailsTheNextSimulatedRequestOnly) {
+    const int fd = io_sim_open(&disk, "ibdata1", true);
+    Results   r{};
+    ASSERT_EQ(task_spawn(&worker, inject_and_read(fd, &r)), 0);
+    sched_run(&worker);
+
+    EXPECT_EQ(r.inject, DB_SUCCESS);
+    EXPECT_EQ(r.inject_bad, DB_INVALID_INPUT);
+    EXPECT_EQ(r.failed, -EIO);
+    EXPECT_EQ(r.next, 0);
+}
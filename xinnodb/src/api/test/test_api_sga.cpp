@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "sga.hpp" // IWYU pragma: keep
+
+namespace {
+
+TEST(ApiSga, RequiredSizeIsExact) {
+    ib_sga_state_desc d{};
+    d.frame_count         = 1024;
+    d.log_buffer_size     = 1024 * 1024;
+    d.file_table_capacity = 16;
+    const ib_u64 size     = ib_get_sga_state_required_size(&d);
+    EXPECT_EQ(size, sga_required_size(&d));
+    EXPECT_EQ(ib_get_sga_state_required_size(nullptr), 0u);
+
+    void*  mem = std::aligned_alloc(SGA_ALIGN, size);
+    ib_err err = DB_ERROR;
+    EXPECT_EQ(ib_sga_init(mem, size - 1, &d, &err).hdl, 0u);
+    EXPECT_EQ(err, DB_INVALID_INPUT);
+    const ib_sga_hdl sga = ib_sga_init(mem, size, &d, &err);
+    EXPECT_EQ(err, DB_SUCCESS);
+    EXPECT_EQ(sga.hdl, (ib_uintptr)mem);
+
+    ib_sga_state_desc other = d;
+    other.file_table_capacity = 17;
+    EXPECT_EQ(ib_sga_init(mem, size, &other, &err).hdl, 0u);
+    EXPECT_EQ(err, DB_DATA_MISMATCH);
+    ib_sga_fini(sga);
+    std::free(mem);
+}
+
+TEST(ApiSga, InitMapsTheSgaAndFiniUnmapsIt) {
+    ib_sga_state_desc d{};
+    d.frame_count        = 16;
+    d.worker_buffer_size = 4096;
+    ib_err           err = DB_ERROR;
+    const ib_sga_hdl sga = ib_sga_init(nullptr, 0, &d, &err);
+    ASSERT_EQ(err, DB_SUCCESS);
+    ASSERT_NE(sga.hdl, 0u);
+    EXPECT_EQ(((sga_header*)sga.hdl)->total_size, ib_get_sga_state_required_size(&d));
+    ib_sga_fini(sga);
+
+    EXPECT_EQ(ib_sga_init(nullptr, 0, nullptr, &err).hdl, 0u);
+    EXPECT_EQ(err, DB_INVALID_INPUT);
+}
+
+} // namespace
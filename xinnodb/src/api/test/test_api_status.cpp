@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include "task.hpp"      // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+#include "ut_status.hpp" // IWYU pragma: keep
+
+namespace {
+
+struct ApiFixture : ::testing::Test, task_test_env {
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+    }
+
+    void TearDown() override {
+        task_test_env_destroy(this);
+    }
+};
+
+ib_i64 read_value(const ut_status_var* var) noexcept {
+    return (ib_i64)var->arg;
+}
+
+struct Results {
+    ib_err       get_err;
+    ib_i64       value;
+    ib_err       missing_err;
+    ib_err       all_err;
+    const char** names;
+    ib_u32       names_num;
+};
+
+ib_async<void> query_status(Results* r) {
+    const ib_state_hdl db{ 0 };
+    r->get_err     = co_await ib_status_get_i64(db, "test.api.answer", &r->value);
+    r->missing_err = co_await ib_status_get_i64(db, "test.api.missing", &r->value);
+    r->all_err     = co_await ib_status_get_all(db, &r->names, &r->names_num);
+}
+
+} // namespace
+
+TEST_F(ApiFixture, StatusVariablesAreReadableThroughTheApi) {
+    ut_status_var var;
+    ASSERT_EQ(ut_status_register(&var, "test.api.answer", read_value, nullptr, 42), 0);
+
+    Results r{};
+    ASSERT_EQ(task_spawn(&worker, query_status(&r)), 0);
+    sched_run(&worker);
+    ut_status_unregister(&var);
+
+    EXPECT_EQ(r.get_err, DB_SUCCESS);
+    EXPECT_EQ(r.missing_err, DB_NOT_FOUND);
+    EXPECT_EQ(r.value, 42);
+    ASSERT_EQ(r.all_err, DB_SUCCESS);
+    bool found = false;
+    for (ib_u32 i = 0; i < r.names_num; ++i) found |= std::strcmp(r.names[i], "test.api.answer") == 0;
+    EXPECT_TRUE(found);
+    std::free(r.names);
+}
@@ -0,0 +1,123 @@
+// Page read IOPS per core through io_uring, with and without registered buffers and files, and
+// with each submission policy.
+// One worker runs BENCH_QD tasks; each owns one 16 KiB frame of an io_buf_pool and reads random
+// pages of a BENCH_FILE_PAGES file into it. The file is opened with io_file_open(), i.e. O_DIRECT
+// when the filesystem allows it (set XINNODB_BENCH_DIR to a directory on a real device), otherwise reads hit the page
+// cache, which isolates the per-request CPU cost that registration removes. IOPS per core divides
+// the reads by the CPU time of the whole process, kernel worker threads included. SQPOLL needs a
+// core of its own for the polling thread: on a single CPU it time-slices with the worker.
+
+#include <fmt/format.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#include "io.hpp"
+#include "task_test.hpp"
+
+constexpr ib_u64 BENCH_PAGE       = 16 * 1024;
+constexpr ib_u64 BENCH_FILE_PAGES = 4096;
+constexpr ib_u32 BENCH_QD         = 32;
+constexpr ib_u64 BENCH_READS      = 400'000;
+
+using bench_clock = std::chrono::steady_clock;
+
+struct bench_state {
+    int    fd;
+    ib_u64 issued;
+    ib_u64 errors;
+    ut_rnd rnd;
+};
+
+static double bench_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static ib_async<void> bench_reader(bench_state* b, char* frame) {
+    while (b->issued < BENCH_READS) {
+        ++b->issued;
+        const ib_u64 page = ut_rnd_bounded(&b->rnd, BENCH_FILE_PAGES);
+        if (co_await io_read(b->fd, frame, BENCH_PAGE, page * BENCH_PAGE) != (ib_i64)BENCH_PAGE) ++b->errors;
+    }
+}
+
+static void bench_run(const char* name, int fd, char* pool, bool fixed_buffers, bool fixed_files,
+                      io_submit_mode submit = IO_SUBMIT_IMMEDIATE) {
+    task_test_env env;
+    io_worker     iw;
+    if (int rc = task_test_env_init(&env, 0, 1 << 20); rc != 0) {
+        fmt::print("{:<16} no task worker ({})\n", name, std::strerror(-rc));
+        std::exit(1);
+    }
+    sched_worker* w = &env.worker;
+    io_options opts{};
+    opts.backend = IO_BACKEND_URING;
+    opts.entries = 2 * BENCH_QD;
+    opts.submit  = submit;
+    if (int rc = io_worker_init(&iw, w, &opts); rc != 0) {
+        fmt::print("{:<16} io_uring unavailable ({})\n", name, std::strerror(-rc));
+        std::exit(1);
+    }
+    if (fixed_buffers) {
+        const io_fixed_buffer region = { pool, BENCH_QD * BENCH_PAGE };
+        if (int rc = io_register_buffers(&iw, &region, 1); rc != 0) fmt::print("register buffers: {}\n", std::strerror(-rc));
+    }
+    if (fixed_files) {
+        if (int rc = io_register_files(&iw, &fd, 1); rc != 0) fmt::print("register files: {}\n", std::strerror(-rc));
+    }
+
+    bench_state b = { fd, 0, 0, {} };
+    ut_rnd_init(&b.rnd, 42);
+    for (ib_u32 i = 0; i < BENCH_QD; ++i) task_spawn(w, bench_reader(&b, pool + i * BENCH_PAGE));
+    const double cpu0  = bench_cpu_seconds();
+    const auto   begin = bench_clock::now();
+    sched_run(w);
+    const double wall = std::chrono::duration<double>(bench_clock::now() - begin).count();
+    const double cpu  = bench_cpu_seconds() - cpu0;
+
+    fmt::print("{:<16} {:>10.0f} IOPS {:>10.0f} IOPS/core {:>7.2f} us/read {:>8.3f} enters/read  fixed ops {}/{}  errors {}\n",
+               name, (double)BENCH_READS / wall, (double)BENCH_READS / cpu, cpu * 1e6 / (double)BENCH_READS,
+               (double)iw.enter_calls / (double)BENCH_READS, iw.fixed_buffer_ops, iw.fixed_file_ops, b.errors);
+    io_worker_detach(&iw);
+    task_test_env_destroy(&env);
+}
+
+int main() {
+    const char* dir = std::getenv("XINNODB_BENCH_DIR");
+    std::string path = std::string(dir != nullptr ? dir : "/tmp") + "/xinnodb_bench_io_XXXXXX";
+    int fd = mkstemp(path.data());
+    if (fd < 0) {
+        fmt::print("cannot create {}\n", path);
+        return 1;
+    }
+    io_buf_pool frames;
+    if (io_buf_pool_init(&frames, BENCH_QD, BENCH_PAGE) != 0) return 1;
+    char* pool = frames.base;
+    std::memset(pool, 0x5a, BENCH_QD * BENCH_PAGE);
+    for (ib_u64 p = 0; p < BENCH_FILE_PAGES; p += BENCH_QD) {
+        if (pwrite(fd, pool, BENCH_QD * BENCH_PAGE, (off_t)(p * BENCH_PAGE)) != (ssize_t)(BENCH_QD * BENCH_PAGE)) return 1;
+    }
+    fsync(fd);
+    close(fd);
+    fd = io_file_open(path.c_str(), O_RDONLY);
+    unlink(path.c_str());
+    if (fd < 0) return 1;
+    fmt::print("{} reads of {} KiB, queue depth {}, {}, {}\n", BENCH_READS, BENCH_PAGE / 1024, BENCH_QD,
+               io_fd_is_direct(fd) ? "O_DIRECT" : "page cache", frames.huge_pages ? "hugetlb frames" : "THP frames");
+
+    bench_run("plain", fd, pool, false, false);
+    bench_run("fixed buffers", fd, pool, true, false);
+    bench_run("fixed files", fd, pool, false, true);
+    bench_run("fixed both", fd, pool, true, true);
+    bench_run("fixed batch", fd, pool, true, true, IO_SUBMIT_BATCH);
+    bench_run("fixed sqpoll", fd, pool, true, true, IO_SUBMIT_SQPOLL);
+    io_file_close(fd);
+    io_buf_pool_destroy(&frames);
+    return 0;
+}
@@ -1,14 +1,397 @@
 #pragma once
 
 #include "defs.hpp"
+#include "xinnodb.hpp"               // IWYU pragma: keep
+#include "ut_assert.hpp"             // IWYU pragma: keep
+#include "ut_dlink.hpp"              // IWYU pragma: keep
+#include "sched.hpp"                 // IWYU pragma: keep
+#include "task.hpp"                  // IWYU pragma: keep
+
+#include <pthread.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
 
 
 /// \defgroup IO io
 /// \ingroup components
 /// \brief I/O routines
+/// \details File I/O for tasks. Each worker owns an `io_worker`: an io_uring instance set up with
+/// raw syscalls (one submission and one completion ring per worker, nothing shared, no locks). A
+/// task that awaits io_read(), io_write() or io_fsync() fills an `io_request` that lives in its
+/// coroutine frame, parks with SCHED_SUSPEND_IO and returns to the run loop; the worker poller
+/// reaps the completion queue and resumes it with the result.
+///
+/// When io_uring is not available (old kernel, seccomp, `kernel.io_uring_disabled`), an
+/// `io_worker` falls back to an `io_pool`: a few threads that run `pread`/`pwrite`/`fsync` and push
+/// the finished requests onto the owner's lock-free completion stack, which the same poller drains.
+/// Tasks see the same API and the same results in both cases. Tests can also plug in a simulated
+/// disk (IO_BACKEND_SIM, see io_sim.hpp) with scripted latencies, faults and crashes.
+/// Request latencies can be recorded per file and operation (see io_stats.hpp).
+///
+/// Results follow the syscalls: bytes transferred (short transfers are not retried) or `-errno`.
+/// Bytes are charged to the resource account of the task that issued the request.
+///
+/// The buffer pool region and the open tablespaces can be registered with the ring
+/// (io_register_buffers(), io_register_files()). Registration is transparent to callers: a read or
+/// write whose buffer lies inside a registered region becomes READ_FIXED / WRITE_FIXED, and a
+/// registered fd is replaced by its slot with IOSQE_FIXED_FILE, so the kernel neither pins the
+/// pages nor looks up the file on every page I/O. The threads backend ignores registrations.
+///
+/// The submission policy (configuration variable `io_submit_policy`) decides when SQEs reach the
+/// kernel:
+///
+/// - `immediate`: one io_uring_enter per request;
+/// - `batch`: the SQEs of every task that suspended during a loop iteration are submitted by one
+///   io_uring_enter when the poller runs at the end of the iteration;
+/// - `sqpoll`: a kernel thread polls the submission ring (IORING_SETUP_SQPOLL) and submission
+///   costs no syscall until the thread has been idle for `io_sqpoll_idle_ms` and must be woken.
+///
+/// Workers follow changes between `immediate` and `batch` on their next request; `sqpoll` takes
+/// effect for rings created afterwards. The settings of the module are registered by io_cfg_init(),
+/// which the first io_worker_init() calls.
+///
+/// io_readv() and io_writev() transfer a run of file pages to or from scattered frames with one
+/// request. Under `batch` and `sqpoll` the worker also coalesces on its own (`io_coalesce`): reads,
+/// and writes, staged during a loop iteration that target adjacent ranges of the same file are
+/// merged into one READV/WRITEV SQE of up to IO_MERGE_MAX_IOVS frames, so 64 page cleaner tasks
+/// flushing neighbouring pages cost one I/O. Each merged request still gets its own result.
+///
+/// Data files are opened with io_file_open(), which asks for O_DIRECT: pages then move between the
+/// device and buffer pool frames by DMA, with no copy into or out of the kernel page cache and no
+/// second cached copy of each page. O_DIRECT requires buffer addresses, lengths and offsets aligned
+/// to IO_DIRECT_ALIGN. Frames come from an `io_buf_pool`, which carves page-sized, aligned frames
+/// out of one huge-page mapping (that is also the region to register with io_register_buffers()),
+/// and every request on a direct fd is checked before it is issued: a misaligned one fails with
+/// -EINVAL without reaching the kernel, instead of the kernel silently falling back or failing deep
+/// inside a merged request.
 /// @{
 
 inline static constexpr int diff(int a, int b) noexcept { return a - b; }
 inline static constexpr int sum2(int a, int b) noexcept { return sum(a, b); }
 
+inline static constexpr ib_u32 IO_RING_DEFAULT_ENTRIES = 256;
+inline static constexpr ib_u32 IO_POOL_MAX_THREADS     = 64;
+inline static constexpr ib_u32 IO_MAX_FIXED_BUFFERS    = 16;
+inline static constexpr ib_u32 IO_MAX_FIXED_FDS        = 1024;  ///< Registered files must have fds below this
+inline static constexpr ib_u32 IO_MERGE_MAX_IOVS       = 64;    ///< Requests merged into one SQE at most
+inline static constexpr ib_u32 IO_MAX_MERGES           = 8;     ///< Merged SQEs in flight per worker
+inline static constexpr ib_u64 IO_DIRECT_ALIGN         = 4096;  ///< O_DIRECT buffer, length and offset alignment
+inline static constexpr ib_u64 IO_HUGE_PAGE_SIZE       = 2 * 1024 * 1024;
+
+/// \brief Completion mechanism of an io_worker
+enum io_backend : ib_u32 {
+    IO_BACKEND_AUTO    = 0,     ///< io_uring, or the thread pool when io_uring is unavailable
+    IO_BACKEND_URING   = 1,
+    IO_BACKEND_THREADS = 2,
+    IO_BACKEND_SIM     = 3,     ///< An in-memory io_sim_disk (see io_sim.hpp); never chosen by AUTO
+};
+
+enum io_op : ib_u8 {
+    IO_OP_READ  = 0,
+    IO_OP_WRITE = 1,
+    IO_OP_FSYNC = 2,
+    IO_OP_READV  = 3,   ///< `buf` is a `const iovec*`, `len` the number of iovecs
+    IO_OP_WRITEV = 4,
+};
+
+/// \brief io_request::flags
+enum io_flag : ib_u32 {
+    IO_FLAG_DATASYNC  = 1u << 0, ///< IO_OP_FSYNC: fdatasync() semantics
+    IO_FLAG_READAHEAD = 1u << 1, ///< IO_OP_READ: speculative, counted apart in the statistics
+};
+
+/// \brief When filled SQEs are handed to the kernel
+enum io_submit_mode : ib_u32 {
+    IO_SUBMIT_CONFIGURED = 0,   ///< Follow the `io_submit_policy` configuration variable
+    IO_SUBMIT_IMMEDIATE  = 1,
+    IO_SUBMIT_BATCH      = 2,
+    IO_SUBMIT_SQPOLL     = 3,
+};
+
+struct io_worker;
+struct io_sim_disk;
+struct io_stats;
+struct io_stats_shard;
+
+/// \brief One file operation in flight
+/// \details Owned by the issuer (usually a coroutine frame) until `task` is resumed.
+struct io_request {
+    ut_dlink    link;           ///< Pool queue or ring overflow membership
+    io_request* next;           ///< Completion stack of the threads backend
+    sched_task* task;           ///< Resumed once `result` is set
+    io_worker*  owner;
+    void*       buf;
+    ib_u64      len;
+    ib_u64      offset;
+    ib_i64      result;         ///< Bytes transferred, or -errno
+    ib_u64      start_ns;       ///< Submission time, with statistics or the simulated backend
+    ib_u64      due_ns;         ///< Simulated backend: completion time on the disk clock
+    ib_i32      fd;
+    io_op       op;
+    ib_u32      flags;
+};
+
+/// \brief Kernel rings of one io_uring instance, mapped into the process
+struct io_ring {
+    ib_i32               fd;
+    ib_u32               sq_entries;
+    ib_u32               cq_entries;
+    ib_u32               sq_mask;
+    ib_u32               cq_mask;
+    ib_u32               sq_tail;           ///< Local tail: SQEs filled so far
+    ib_u32               to_submit;         ///< Filled but not yet consumed by io_uring_enter
+    ib_u32               features;          ///< IORING_FEAT_*
+    ib_u32               setup_flags;       ///< IORING_SETUP_*
+    std::atomic<ib_u32>* sq_khead;
+    std::atomic<ib_u32>* sq_ktail;
+    std::atomic<ib_u32>* sq_kflags;
+    ib_u32*              sq_array;
+    void*                sqes;              ///< struct io_uring_sqe[sq_entries]
+    std::atomic<ib_u32>* cq_khead;
+    std::atomic<ib_u32>* cq_ktail;
+    void*                cqes;              ///< struct io_uring_cqe[cq_entries]
+    void*                sq_map;
+    void*                cq_map;            ///< == sq_map with IORING_FEAT_SINGLE_MMAP
+    ib_size              sq_map_size;
+    ib_size              cq_map_size;
+    ib_size              sqes_size;
+};
+
+/// \brief Memory region registered with IORING_REGISTER_BUFFERS
+struct io_fixed_buffer {
+    char*   base;
+    ib_size len;
+};
+
+/// \brief Adjacent requests submitted as one vectored SQE
+struct io_merge {
+    ib_u32      count;                      ///< 0 while free
+    iovec       iov[IO_MERGE_MAX_IOVS];
+    io_request* reqs[IO_MERGE_MAX_IOVS];
+};
+
+/// \brief Aligned page frames for direct I/O, carved out of one huge-page mapping
+/// \details Frames are handed out and returned from any thread through a lock-free stack of
+/// indices (tagged against ABA); the links live in the same mapping, after the frames.
+struct io_buf_pool {
+    char*   base;                       ///< First frame; IO_HUGE_PAGE_SIZE aligned
+    ib_size map_size;
+    ib_size frame_size;                 ///< A multiple of IO_DIRECT_ALIGN
+    ib_u32  frame_count;
+    bool    huge_pages;                 ///< MAP_HUGETLB; otherwise transparent huge pages were requested
+    std::atomic<ib_u32>* links;         ///< Free frame -> next free frame + 1
+    std::atomic<ib_u64>  free_top;      ///< ABA tag << 32 | top frame + 1, low half 0 when exhausted
+    std::atomic<ib_u32>  free_count;
+};
+
+/// \brief Fallback thread pool running blocking syscalls; may be shared by several io_workers
+struct io_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    ut_dlink        queue;              ///< Requests waiting for a thread
+    ib_u32          count;
+    bool            stop;
+    std::atomic<ib_u64> executed;
+    pthread_t       threads[IO_POOL_MAX_THREADS];
+};
+
+/// \brief Per-worker I/O state
+struct io_worker {
+    sched_worker* sched;
+    io_backend    backend;              ///< URING or THREADS once initialized
+    io_submit_mode submit;              ///< Never CONFIGURED once initialized
+    bool          submit_follows_cfg;   ///< Switches between IMMEDIATE and BATCH with `io_submit_policy`
+    io_ring       ring;
+    io_pool*      pool;
+    io_sim_disk*  sim;
+    ut_dlink      sim_pending;          ///< Simulated backend: requests by completion time
+    ut_dlink      overflow;             ///< Requests waiting for a free SQE or CQE
+    ut_dlink      staged;               ///< Coalescing candidates of this loop iteration, by fd, op and offset
+    ib_u32        in_flight;            ///< Submitted and not reaped
+    ib_u32        in_ring;              ///< io_uring: SQEs submitted and not reaped
+    std::atomic<io_request*> completed; ///< Threads backend: finished requests (LIFO)
+    ib_u64        submitted_total;
+    ib_u64        completed_total;
+    ib_u64        enter_calls;          ///< io_uring_enter syscalls
+    ib_u64        sqpoll_wakeups;       ///< Enters made only to wake the SQPOLL thread
+    ib_u64        vectored_sqes;        ///< READV / WRITEV SQEs built by coalescing
+    ib_u64        coalesced_requests;   ///< Requests that went into them
+    ib_u64        overflow_waits;       ///< Requests that found the ring full
+    ib_u64        fixed_buffer_ops;     ///< READ_FIXED / WRITE_FIXED submitted
+    ib_u64        fixed_file_ops;       ///< Submitted with IOSQE_FIXED_FILE
+    ib_u32        fixed_buffer_count;
+    ib_u32        fixed_file_count;
+    io_fixed_buffer fixed_buffers[IO_MAX_FIXED_BUFFERS];
+    ib_u16        fixed_file_slot[IO_MAX_FIXED_FDS];   ///< fd -> registered slot + 1, 0 if not registered
+    io_merge      merges[IO_MAX_MERGES];
+    io_stats*     stats;                ///< Latency statistics, nullptr if not attached
+    io_stats_shard* stats_shard;        ///< This worker's histograms in `stats`
+    sched_poller  poller;               ///< Reaps completions
+};
+
+/// \brief Options of io_worker_init()
+struct io_options {
+    io_backend backend;                 ///< AUTO unless forced
+    ib_u32     entries;                 ///< Submission ring size, 0 for IO_RING_DEFAULT_ENTRIES
+    io_pool*   pool;                    ///< Fallback pool, required for THREADS and for AUTO to fall back
+    io_submit_mode submit;              ///< CONFIGURED unless forced
+    ib_u32     sqpoll_idle_ms;          ///< SQPOLL thread idle timeout, 0 for `io_sqpoll_idle_ms`
+    io_sim_disk* sim;                   ///< Disk of the SIM backend
+};
+
+/// \brief Awaitable returned by io_read(), io_write() and io_fsync()
+/// \details The request lives in the awaiting coroutine frame: issuing an I/O allocates nothing.
+/// Outside of a task, or on a worker without an io_worker, the syscall runs synchronously.
+struct io_awaiter {
+    io_request req;
+
+    bool   await_ready() const noexcept { return false; }
+    bool   await_suspend(std::coroutine_handle<> h) noexcept;
+    ib_i64 await_resume() const noexcept { return req.result; }
+};
+
+int    io_cfg_init() noexcept;
+int    io_worker_init(io_worker* iw, sched_worker* w, const io_options* opts = nullptr) noexcept;
+void   io_worker_detach(io_worker* iw) noexcept;
+void   io_submit(io_worker* iw, io_request* req) noexcept;
+ib_u64 io_reap(io_worker* iw) noexcept;
+ib_i64 io_execute(io_request* req) noexcept;
+int    io_pool_start(io_pool* pool, ib_u32 threads) noexcept;
+void   io_pool_stop(io_pool* pool) noexcept;
+void   io_pool_submit(io_pool* pool, io_request* req) noexcept;
+int    io_register_buffers(io_worker* iw, const io_fixed_buffer* buffers, ib_u32 count) noexcept;
+int    io_unregister_buffers(io_worker* iw) noexcept;
+int    io_register_files(io_worker* iw, const ib_i32* fds, ib_u32 count) noexcept;
+int    io_unregister_files(io_worker* iw) noexcept;
+int    io_buf_pool_init(io_buf_pool* pool, ib_u32 frame_count, ib_size frame_size) noexcept;
+void   io_buf_pool_destroy(io_buf_pool* pool) noexcept;
+void*  io_buf_get(io_buf_pool* pool) noexcept;
+void   io_buf_put(io_buf_pool* pool, void* frame) noexcept;
+int    io_file_open(const char* path, int flags, ib_u32 mode = 0644) noexcept;
+int    io_file_close(ib_i32 fd) noexcept;
+bool   io_request_aligned(const io_request* req) noexcept;
+const char* io_backend_name(io_backend backend) noexcept;
+const char* io_submit_mode_name(io_submit_mode mode) noexcept;
+
+int    io_ring_init(io_ring* r, ib_u32 entries, ib_u32 flags = 0, ib_u32 sq_thread_idle_ms = 0) noexcept;
+void   io_ring_destroy(io_ring* r) noexcept;
+
+inline static void        io_request_init(io_request* req, io_op op, ib_i32 fd, void* buf, ib_u64 len, ib_u64 offset, ib_u32 flags = 0) noexcept;
+inline static io_worker*  io_worker_of(sched_worker* w) noexcept;
+inline static bool        io_fd_is_direct(ib_i32 fd) noexcept;
+inline static io_fixed_buffer io_buf_pool_region(const io_buf_pool* pool) noexcept;
+inline static io_awaiter  io_read(ib_i32 fd, void* buf, ib_u64 len, ib_u64 offset) noexcept;
+inline static io_awaiter  io_write(ib_i32 fd, const void* buf, ib_u64 len, ib_u64 offset) noexcept;
+inline static io_awaiter  io_readahead(ib_i32 fd, void* buf, ib_u64 len, ib_u64 offset) noexcept;
+inline static io_awaiter  io_fsync(ib_i32 fd, bool datasync = false) noexcept;
+inline static io_awaiter  io_readv(ib_i32 fd, const iovec* iov, ib_u32 iovcnt, ib_u64 offset) noexcept;
+inline static io_awaiter  io_writev(ib_i32 fd, const iovec* iov, ib_u32 iovcnt, ib_u64 offset) noexcept;
+
 /// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline void io_request_init(io_request* req, io_op op, ib_i32 fd, void* buf, ib_u64 len, ib_u64 offset, ib_u32 flags) noexcept {
+    ut_dlink_init(&req->link);
+    req->next   = nullptr;
+    req->task   = nullptr;
+    req->owner  = nullptr;
+    req->buf    = buf;
+    req->len    = len;
+    req->offset = offset;
+    req->result = 0;
+    req->start_ns = 0;
+    req->due_ns   = 0;
+    req->fd     = fd;
+    req->op     = op;
+    req->flags  = flags;
+}
+
+/// \brief I/O state attached to `w`, or nullptr
+inline io_worker* io_worker_of(sched_worker* w) noexcept {
+    return (io_worker*)w->ext[SCHED_EXT_IO];
+}
+
+/// \brief fds below IO_MAX_FIXED_FDS opened with O_DIRECT by io_file_open(), one bit each
+extern std::atomic<ib_u64> io_direct_fds[IO_MAX_FIXED_FDS / 64];
+
+/// \brief True if `fd` was opened by io_file_open() and O_DIRECT was granted
+inline bool io_fd_is_direct(ib_i32 fd) noexcept {
+    if (fd < 0 || (ib_u32)fd >= IO_MAX_FIXED_FDS) return false;
+    return (io_direct_fds[fd / 64].load(std::memory_order_relaxed) >> (fd % 64) & 1) != 0;
+}
+
+/// \brief The frames of `pool` as one region for io_register_buffers()
+inline io_fixed_buffer io_buf_pool_region(const io_buf_pool* pool) noexcept {
+    return { pool->base, (ib_size)pool->frame_count * pool->frame_size };
+}
+
+/// \brief `co_await io_read(fd, buf, len, off)` reads like pread() without blocking the worker
+inline io_awaiter io_read(ib_i32 fd, void* buf, ib_u64 len, ib_u64 offset) noexcept {
+    io_awaiter a;
+    io_request_init(&a.req, IO_OP_READ, fd, buf, len, offset);
+    return a;
+}
+
+/// \brief `co_await io_write(fd, buf, len, off)` writes like pwrite() without blocking the worker
+inline io_awaiter io_write(ib_i32 fd, const void* buf, ib_u64 len, ib_u64 offset) noexcept {
+    io_awaiter a;
+    io_request_init(&a.req, IO_OP_WRITE, fd, const_cast<void*>(buf), len, offset);
+    return a;
+}
+
+/// \brief io_read() for pages read ahead of need; only the statistics tell them apart
+inline io_awaiter io_readahead(ib_i32 fd, void* buf, ib_u64 len, ib_u64 offset) noexcept {
+    io_awaiter a;
+    io_request_init(&a.req, IO_OP_READ, fd, buf, len, offset, IO_FLAG_READAHEAD);
+    return a;
+}
+
+/// \brief `co_await io_fsync(fd)` flushes `fd` like fsync(), or fdatasync() when `datasync`
+inline io_awaiter io_fsync(ib_i32 fd, bool datasync) noexcept {
+    io_awaiter a;
+    io_request_init(&a.req, IO_OP_FSYNC, fd, nullptr, 0, 0, datasync ? (ib_u32)IO_FLAG_DATASYNC : 0u);
+    return a;
+}
+
+/// \brief `co_await io_readv(fd, iov, n, off)` fills `n` buffers from consecutive file bytes, like preadv()
+/// \details `iov` must stay valid until the await completes.
+inline io_awaiter io_readv(ib_i32 fd, const iovec* iov, ib_u32 iovcnt, ib_u64 offset) noexcept {
+    io_awaiter a;
+    io_request_init(&a.req, IO_OP_READV, fd, const_cast<iovec*>(iov), iovcnt, offset);
+    return a;
+}
+
+/// \brief `co_await io_writev(fd, iov, n, off)` gathers `n` buffers into consecutive file bytes, like pwritev()
+inline io_awaiter io_writev(ib_i32 fd, const iovec* iov, ib_u32 iovcnt, ib_u64 offset) noexcept {
+    io_awaiter a;
+    io_request_init(&a.req, IO_OP_WRITEV, fd, const_cast<iovec*>(iov), iovcnt, offset);
+    return a;
+}
+
+inline bool io_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    if (io_fd_is_direct(req.fd) && !io_request_aligned(&req)) {
+        req.result = -EINVAL;
+        return false;
+    }
+    task*      t  = task_current();
+    io_worker* iw = t != nullptr ? io_worker_of(t->sched.worker) : nullptr;
+    if (iw == nullptr) {
+        req.result = io_execute(&req);
+        if (req.result > 0) {
+            const bool read = req.op == IO_OP_READ || req.op == IO_OP_READV;
+            ut_acct_charge_io(read ? (ib_u64)req.result : 0, read ? 0 : (ib_u64)req.result);
+        }
+        return false;
+    }
+    req.task = &t->sched;
+    task_park(t, h, SCHED_SUSPEND_IO);
+    io_submit(iw, &req);
+    return true;
+}
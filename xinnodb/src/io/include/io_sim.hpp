@@ -0,0 +1,113 @@
+#pragma once
+
+#include "io.hpp"
+#include "ut_rnd.hpp" // IWYU pragma: keep
+
+#include <pthread.h>
+
+/// \defgroup IO_SIM Simulated disk
+/// \ingroup IO
+/// \brief In-memory block device behind the io_worker interface
+/// \details An `io_sim_disk` stands in for the kernel: an io_worker created with IO_BACKEND_SIM
+/// runs every request against it and completes the request after a simulated service time, so
+/// tasks awaiting io_read(), io_write(), io_fsync() and the vectored variants see no difference.
+///
+/// Each file keeps two images: what reads see, and what would survive a crash. Writes update the
+/// first one and are queued until an fsync applies them to the second. io_sim_crash() replays a
+/// power failure: every queued write is lost, persisted or torn at a sector boundary, and with
+/// `reorder` later writes may land while earlier ones are lost. Together with random and injected
+/// faults (`EIO`, `ENOSPC`, lost fsyncs, torn writes; see ib_error_inject()) this makes recovery
+/// bugs reproducible from a seed.
+///
+/// Service time is a latency drawn from a per-operation distribution, after the device is free and
+/// the bytes have gone through at `bandwidth`. With `virtual_time` the disk has its own clock,
+/// which the poller moves to the next completion instead of waiting: runs are deterministic and
+/// as fast as the CPU allows. Without it latencies are spent in real time, which is what
+/// performance tests want.
+/// @{
+
+inline static constexpr ib_u32 IO_SIM_MAX_FILES   = 64;
+inline static constexpr ib_i32 IO_SIM_FD_BASE     = 1 << 20;  ///< Simulated fds never clash with real ones
+inline static constexpr ib_u64 IO_SIM_SECTOR_SIZE = 512;      ///< Unit of torn writes
+inline static constexpr ib_u32 IO_SIM_NAME_MAX    = 64;
+
+/// \brief Faults that have no errno, for io_sim_inject() and ib_error_inject()
+enum io_sim_fault : int {
+    IO_SIM_FAULT_LOST_FSYNC = -1,   ///< The next fsync succeeds but persists nothing
+    IO_SIM_FAULT_TORN_WRITE = -2,   ///< The next write is torn if a crash comes before its fsync
+};
+
+enum io_sim_distribution : ib_u32 {
+    IO_SIM_FIXED       = 0,     ///< Always `mean_ns`
+    IO_SIM_UNIFORM     = 1,     ///< Between `min_ns` and `max_ns`
+    IO_SIM_EXPONENTIAL = 2,     ///< `min_ns` plus an exponential tail of mean `mean_ns - min_ns`, capped at `max_ns`
+};
+
+/// \brief Latency of one kind of operation, excluding the transfer time
+struct io_sim_latency {
+    io_sim_distribution distribution;
+    ib_u64              min_ns;
+    ib_u64              mean_ns;
+    ib_u64              max_ns;     ///< 0 for no cap
+};
+
+struct io_sim_options {
+    ib_u64         seed;
+    ib_u64         capacity;            ///< Bytes of all files together; 0 for unlimited
+    ib_u64         bandwidth;           ///< Bytes per second; 0 for unlimited
+    io_sim_latency read_latency;
+    io_sim_latency write_latency;
+    io_sim_latency fsync_latency;
+    ib_u32         eio_one_in;          ///< Reads and writes failing with -EIO: 1 in N, 0 for none
+    ib_u32         lost_fsync_one_in;   ///< Fsyncs that persist nothing: 1 in N, 0 for none
+    ib_u32         torn_write_one_in;   ///< Writes surviving a crash torn: 1 in N, 0 for none
+    bool           reorder;             ///< A crash keeps any subset of unsynced writes, not a prefix
+    bool           virtual_time;
+};
+
+/// \brief A write that is visible but not yet durable
+struct io_sim_write {
+    ut_dlink link;
+    ib_u64   offset;
+    ib_u64   len;
+    bool     torn;          ///< Injected: torn on crash whatever the odds
+    char     data[];
+};
+
+struct io_sim_file {
+    char     name[IO_SIM_NAME_MAX];     ///< Empty while the slot is free
+    char*    data;                      ///< What reads see
+    ib_u64   size;
+    char*    durable;                   ///< What survives a crash
+    ib_u64   durable_size;
+    ut_dlink unsynced;                  ///< io_sim_write, oldest last
+};
+
+struct io_sim_disk {
+    pthread_mutex_t lock;
+    io_sim_options  opts;
+    ut_rnd          rnd;
+    ib_u64          used;               ///< Bytes of all files (visible sizes)
+    ib_u64          clock_ns;           ///< Virtual time
+    ib_u64          busy_until_ns;      ///< End of the last transfer
+    ib_u64          reads;
+    ib_u64          writes;
+    ib_u64          fsyncs;
+    ib_u64          errors;             ///< Requests failed on purpose
+    ib_u64          lost_fsyncs;
+    ib_u64          torn_writes;
+    ib_u64          crashes;
+    io_sim_file     files[IO_SIM_MAX_FILES];
+};
+
+int    io_sim_disk_init(io_sim_disk* disk, const io_sim_options* opts) noexcept;
+void   io_sim_disk_destroy(io_sim_disk* disk) noexcept;
+int    io_sim_open(io_sim_disk* disk, const char* name, bool create) noexcept;
+ib_u64 io_sim_file_size(io_sim_disk* disk, ib_i32 fd) noexcept;
+void   io_sim_crash(io_sim_disk* disk) noexcept;
+ib_u64 io_sim_now(io_sim_disk* disk) noexcept;
+void   io_sim_advance(io_sim_disk* disk, ib_u64 ns) noexcept;
+void   io_sim_start(io_sim_disk* disk, io_request* req) noexcept;
+int    io_sim_inject(int fault) noexcept;
+
+/// @}
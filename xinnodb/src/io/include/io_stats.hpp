@@ -0,0 +1,65 @@
+#pragma once
+
+#include "io.hpp"
+#include "ut_hist.hpp"   // IWYU pragma: keep
+#include "ut_status.hpp" // IWYU pragma: keep
+
+/// \defgroup IO_STATS I/O latency statistics
+/// \ingroup IO
+/// \brief Latency histograms per file and operation, published as status variables
+/// \details An io_worker with statistics attached (io_stats_attach()) times every request from
+/// submission to completion and records it, on its own shard, in a `ut_hist` for the operation
+/// (`read`, `write`, `fsync`, and `readahead` for reads issued with io_readahead()) and the file,
+/// plus one for all files. Recording touches worker-local memory only; the status callbacks merge
+/// the shards of all workers when a value is read.
+///
+/// For every operation `<op>` of every file `<file>` (`all`, or a name given to
+/// io_stats_track_file()), the following variables are registered:
+///
+/// - `io.<file>.<op>.count`: completed requests (what `os_n_file_reads` and friends counted);
+/// - `io.<file>.<op>.p50_ns`, `.p99_ns`, `.p999_ns`, `.max_ns`: latency percentiles.
+///
+/// Times come from the TSC, or from the disk clock with the simulated backend.
+/// @{
+
+enum io_stat_op : ib_u32 {
+    IO_STAT_READ      = 0,
+    IO_STAT_WRITE     = 1,
+    IO_STAT_FSYNC     = 2,
+    IO_STAT_READAHEAD = 3,
+    IO_STAT_OPS       = 4,
+};
+
+inline static constexpr ib_u32 IO_STATS_MAX_FILES = 8;     ///< Files tracked on their own, besides `all`
+inline static constexpr ib_u32 IO_STATS_FIELDS    = 5;
+inline static constexpr ib_u32 IO_STATS_FILE_NAME_MAX = 24;
+inline static constexpr ib_u32 IO_STATS_NAME_MAX  = 64;
+inline static constexpr ib_u32 IO_STATS_VARS      = (1 + IO_STATS_MAX_FILES) * IO_STAT_OPS * IO_STATS_FIELDS;
+
+/// \brief Histograms recorded by one worker; slot 0 is all files, slot `i + 1` tracked file `i`
+struct io_stats_shard {
+    ut_hist hist[1 + IO_STATS_MAX_FILES][IO_STAT_OPS];
+};
+
+/// \brief Statistics of a set of workers
+/// \details Files are tracked before the workers issue I/O on them: the table is read without
+/// synchronization on every completion.
+struct io_stats {
+    io_stats_shard* shards;
+    ib_u32          shard_count;
+    ib_u32          file_count;
+    ib_i32          file_fd[IO_STATS_MAX_FILES];
+    char            file_name[IO_STATS_MAX_FILES][IO_STATS_FILE_NAME_MAX];
+    ib_u32          registered;
+    ut_status_var   vars[IO_STATS_VARS];
+    char            names[IO_STATS_VARS][IO_STATS_NAME_MAX];
+};
+
+int  io_stats_register(io_stats* st, io_stats_shard* shards, ib_u32 count) noexcept;
+void io_stats_unregister(io_stats* st) noexcept;
+int  io_stats_track_file(io_stats* st, ib_i32 fd, const char* name) noexcept;
+void io_stats_attach(io_worker* iw, io_stats* st, ib_u32 shard) noexcept;
+void io_stats_merge(const io_stats* st, ib_u32 slot, io_stat_op op, ut_hist* out) noexcept;
+void io_stats_record(io_worker* iw, const io_request* req, ib_u64 ns) noexcept;
+
+/// @}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "io.hpp"                    // IWYU pragma: keep
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// \defgroup io_uring_sys io_uring syscalls
+/// \ingroup IO
+/// \brief Raw io_uring syscalls and ring accessors (no liburing)
+/// \details The ring protocol: the application fills an SQE at its local tail, publishes the new
+/// tail with a release store and calls io_uring_enter(); the kernel publishes completions at the CQ
+/// tail with a release store and the application consumes them by advancing the CQ head. Each ring
+/// has a single user-space owner (its worker), so the local indices need no atomics.
+
+/// \addtogroup io_uring_sys
+/// @{
+
+inline static int                 io_uring_sys_setup(ib_u32 entries, io_uring_params* p) noexcept;
+inline static int                 io_uring_sys_enter(int fd, ib_u32 to_submit, ib_u32 min_complete, ib_u32 flags) noexcept;
+inline static int                 io_uring_sys_register(int fd, ib_u32 opcode, const void* arg, ib_u32 nr_args) noexcept;
+inline static io_uring_sqe*       io_ring_get_sqe(io_ring* r) noexcept;
+inline static void                io_ring_publish(io_ring* r) noexcept;
+inline static const io_uring_cqe* io_ring_peek_cqe(io_ring* r, ib_u32 head) noexcept;
+inline static ib_u32              io_ring_cq_ready(const io_ring* r, ib_u32* head) noexcept;
+inline static void                io_ring_cq_advance(io_ring* r, ib_u32 head) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \return The ring fd, or -1 with errno set
+inline int io_uring_sys_setup(ib_u32 entries, io_uring_params* p) noexcept {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+/// \return SQEs consumed, or -1 with errno set
+inline int io_uring_sys_enter(int fd, ib_u32 to_submit, ib_u32 min_complete, ib_u32 flags) noexcept {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+inline int io_uring_sys_register(int fd, ib_u32 opcode, const void* arg, ib_u32 nr_args) noexcept {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/// \brief Next free SQE, zeroed, or nullptr when the submission ring is full
+inline io_uring_sqe* io_ring_get_sqe(io_ring* r) noexcept {
+    const ib_u32 head = r->sq_khead->load(std::memory_order_acquire);
+    if (r->sq_tail - head >= r->sq_entries) return nullptr;
+    const ib_u32  idx = r->sq_tail & r->sq_mask;
+    io_uring_sqe* sqe = (io_uring_sqe*)r->sqes + idx;
+    __builtin_memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    ++r->sq_tail;
+    ++r->to_submit;
+    return sqe;
+}
+
+/// \brief Makes the SQEs filled so far visible to the kernel
+inline void io_ring_publish(io_ring* r) noexcept {
+    r->sq_ktail->store(r->sq_tail, std::memory_order_release);
+}
+
+inline const io_uring_cqe* io_ring_peek_cqe(io_ring* r, ib_u32 head) noexcept {
+    return (const io_uring_cqe*)r->cqes + (head & r->cq_mask);
+}
+
+/// \brief Completions available; `*head` receives the first one's index
+inline ib_u32 io_ring_cq_ready(const io_ring* r, ib_u32* head) noexcept {
+    *head = r->cq_khead->load(std::memory_order_relaxed);
+    return r->cq_ktail->load(std::memory_order_acquire) - *head;
+}
+
+/// \brief Releases the completions before `head` back to the kernel
+inline void io_ring_cq_advance(io_ring* r, ib_u32 head) noexcept {
+    r->cq_khead->store(head, std::memory_order_release);
+}
@@ -0,0 +1,131 @@
+#include "io.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+std::atomic<ib_u64> io_direct_fds[IO_MAX_FIXED_FDS / 64];
+
+static constexpr ib_u64 io_round_up(ib_u64 n, ib_u64 align) noexcept {
+    return (n + align - 1) & ~(align - 1);
+}
+
+/// \brief Maps `size` bytes (a multiple of IO_HUGE_PAGE_SIZE) aligned to IO_HUGE_PAGE_SIZE
+/// \details Tries reserved huge pages first. Otherwise maps one huge page more than needed, trims
+/// the ends to a huge page boundary and asks for transparent huge pages.
+static char* io_map_huge(ib_size size, bool* huge) noexcept {
+    void* m = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (m != MAP_FAILED) {
+        *huge = true;
+        return (char*)m;
+    }
+    *huge = false;
+    m     = mmap(nullptr, size + IO_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) return nullptr;
+    char*         raw  = (char*)m;
+    char*         base = (char*)io_round_up((ib_u64)(ib_uintptr)raw, IO_HUGE_PAGE_SIZE);
+    const ib_size head = (ib_size)(base - raw);
+    if (head != 0) munmap(raw, head);
+    if (head != IO_HUGE_PAGE_SIZE) munmap(base + size, IO_HUGE_PAGE_SIZE - head);
+    madvise(base, size, MADV_HUGEPAGE);   // best effort: THP may be disabled
+    return base;
+}
+
+/// \brief Maps `frame_count` frames of `frame_size` bytes and puts them all on the free stack
+/// \return 0, -EINVAL if `frame_size` is not a non-zero multiple of IO_DIRECT_ALIGN, or -ENOMEM
+int io_buf_pool_init(io_buf_pool* pool, ib_u32 frame_count, ib_size frame_size) noexcept {
+    IB_ASSERT_NOT_NULL(pool);
+    pool->base = nullptr;
+    if (frame_count == 0 || frame_size == 0 || frame_size % IO_DIRECT_ALIGN != 0) return -EINVAL;
+    const ib_size frames = (ib_size)frame_count * frame_size;
+    const ib_size size   = io_round_up(frames + sizeof(std::atomic<ib_u32>) * frame_count, IO_HUGE_PAGE_SIZE);
+    bool          huge   = false;
+    char*         base   = io_map_huge(size, &huge);
+    if (base == nullptr) return -ENOMEM;
+
+    pool->base        = base;
+    pool->map_size    = size;
+    pool->frame_size  = frame_size;
+    pool->frame_count = frame_count;
+    pool->huge_pages  = huge;
+    pool->links       = (std::atomic<ib_u32>*)(base + frames);
+    for (ib_u32 i = 0; i < frame_count; ++i) pool->links[i].store(i + 1 < frame_count ? i + 2 : 0, std::memory_order_relaxed);
+    pool->free_top.store(1, std::memory_order_relaxed);
+    pool->free_count.store(frame_count, std::memory_order_release);
+    return 0;
+}
+
+void io_buf_pool_destroy(io_buf_pool* pool) noexcept {
+    if (pool->base != nullptr) munmap(pool->base, pool->map_size);
+    pool->base = nullptr;
+}
+
+/// \brief Takes a free frame
+/// \return An IO_DIRECT_ALIGN aligned frame of `frame_size` bytes, or nullptr if all are in use
+void* io_buf_get(io_buf_pool* pool) noexcept {
+    ib_u64 top = pool->free_top.load(std::memory_order_acquire);
+    for (;;) {
+        const ib_u32 index = (ib_u32)top;
+        if (index == 0) return nullptr;
+        const ib_u64 next = ((top >> 32) + 1) << 32 | pool->links[index - 1].load(std::memory_order_relaxed);
+        if (pool->free_top.compare_exchange_weak(top, next, std::memory_order_acquire, std::memory_order_acquire)) {
+            pool->free_count.fetch_sub(1, std::memory_order_relaxed);
+            return pool->base + (ib_size)(index - 1) * pool->frame_size;
+        }
+    }
+}
+
+/// \brief Returns a frame obtained from io_buf_get()
+void io_buf_put(io_buf_pool* pool, void* frame) noexcept {
+    const ib_size off = (ib_size)((char*)frame - pool->base);
+    IB_ASSERT(off < (ib_size)pool->frame_count * pool->frame_size && off % pool->frame_size == 0,
+              "not a frame of this pool");
+    const ib_u32 index = (ib_u32)(off / pool->frame_size) + 1;
+    ib_u64       top   = pool->free_top.load(std::memory_order_relaxed);
+    for (;;) {
+        pool->links[index - 1].store((ib_u32)top, std::memory_order_relaxed);
+        const ib_u64 next = ((top >> 32) + 1) << 32 | index;
+        if (pool->free_top.compare_exchange_weak(top, next, std::memory_order_release, std::memory_order_relaxed)) break;
+    }
+    pool->free_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// \brief Opens a data file for page I/O, with O_DIRECT where the filesystem supports it
+/// \details Filesystems without direct I/O (tmpfs) reject O_DIRECT with EINVAL; the file is then
+/// opened through the page cache and io_fd_is_direct() is false for it.
+/// \return The fd, or -errno
+int io_file_open(const char* path, int flags, ib_u32 mode) noexcept {
+    int fd = open(path, flags | O_DIRECT | O_CLOEXEC, (mode_t)mode);
+    if (fd < 0 && errno == EINVAL) return (fd = open(path, flags | O_CLOEXEC, (mode_t)mode)) >= 0 ? fd : -errno;
+    if (fd < 0) return -errno;
+    if ((ib_u32)fd < IO_MAX_FIXED_FDS) io_direct_fds[fd / 64].fetch_or(1ull << (fd % 64), std::memory_order_relaxed);
+    return fd;
+}
+
+/// \brief Closes an fd opened by io_file_open()
+/// \return 0, or -errno
+int io_file_close(ib_i32 fd) noexcept {
+    if (fd >= 0 && (ib_u32)fd < IO_MAX_FIXED_FDS) io_direct_fds[fd / 64].fetch_and(~(1ull << (fd % 64)), std::memory_order_relaxed);
+    return close(fd) == 0 ? 0 : -errno;
+}
+
+/// \brief True if the buffers, length and offset of `req` meet the O_DIRECT alignment
+bool io_request_aligned(const io_request* req) noexcept {
+    constexpr ib_u64 mask = IO_DIRECT_ALIGN - 1;
+    switch (req->op) {
+    case IO_OP_READ:
+    case IO_OP_WRITE:
+        return (((ib_u64)(ib_uintptr)req->buf | req->len | req->offset) & mask) == 0;
+    case IO_OP_READV:
+    case IO_OP_WRITEV: {
+        const iovec* iov = (const iovec*)req->buf;
+        ib_u64       any = req->offset;
+        for (ib_u64 i = 0; i < req->len; ++i) any |= (ib_u64)(ib_uintptr)iov[i].iov_base | iov[i].iov_len;
+        return (any & mask) == 0;
+    }
+    case IO_OP_FSYNC: return true;
+    }
+    return true;
+}
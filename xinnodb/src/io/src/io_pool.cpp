@@ -0,0 +1,78 @@
+#include "io.hpp"
+#include "sched_pool.hpp"
+
+#include <cerrno>
+
+// -----------------------------------------------------------------------------
+// Fallback thread pool
+// -----------------------------------------------------------------------------
+
+/// \brief Hands a finished request back to the worker that issued it
+/// \details The request may be resumed and freed as soon as it is on the stack: read the owner first.
+static void io_pool_complete(io_request* req) noexcept {
+    io_worker*  iw   = req->owner;
+    io_request* head = iw->completed.load(std::memory_order_relaxed);
+    do {
+        req->next = head;
+    } while (!iw->completed.compare_exchange_weak(head, req, std::memory_order_release, std::memory_order_relaxed));
+    if (iw->sched->pool != nullptr) sched_pool_wake(iw->sched);
+}
+
+static void* io_pool_thread_main(void* arg) {
+    io_pool* pool = (io_pool*)arg;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (ut_dlink_is_detached(&pool->queue) && !pool->stop) pthread_cond_wait(&pool->cond, &pool->lock);
+        if (ut_dlink_is_detached(&pool->queue)) break;
+        io_request* req = (io_request*)((char*)ut_dlink_dequeue(&pool->queue) - IB_OFFSET_OF(io_request, link));
+        pthread_mutex_unlock(&pool->lock);
+        req->result = io_execute(req);
+        pool->executed.fetch_add(1, std::memory_order_relaxed);
+        io_pool_complete(req);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return nullptr;
+}
+
+/// \brief Starts `threads` threads (at most IO_POOL_MAX_THREADS) running blocking I/O
+/// \return 0 on success, the pthread error code otherwise (already started threads are stopped)
+int io_pool_start(io_pool* pool, ib_u32 threads) noexcept {
+    IB_ASSERT_NOT_NULL(pool);
+    IB_ASSERT(threads > 0 && threads <= IO_POOL_MAX_THREADS, "invalid I/O thread count");
+    pthread_mutex_init(&pool->lock, nullptr);
+    pthread_cond_init(&pool->cond, nullptr);
+    ut_dlink_init(&pool->queue);
+    pool->stop  = false;
+    pool->count = 0;
+    pool->executed.store(0, std::memory_order_relaxed);
+    for (ib_u32 i = 0; i < threads; ++i) {
+        int rc = pthread_create(&pool->threads[i], nullptr, io_pool_thread_main, pool);
+        if (rc != 0) {
+            io_pool_stop(pool);
+            return rc;
+        }
+        ++pool->count;
+    }
+    return 0;
+}
+
+/// \brief Runs the queued requests to completion and joins the threads
+void io_pool_stop(io_pool* pool) noexcept {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (ib_u32 i = 0; i < pool->count; ++i) pthread_join(pool->threads[i], nullptr);
+    pool->count = 0;
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/// \brief Queues `req` for the pool of its owner
+void io_pool_submit(io_pool* pool, io_request* req) noexcept {
+    pthread_mutex_lock(&pool->lock);
+    ut_dlink_enqueue(&pool->queue, &req->link);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,77 @@
+#include "io.hpp"
+#include "io_uring_sys.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+/// \brief Creates an io_uring instance with `entries` submission slots and maps its rings
+/// \param flags IORING_SETUP_* flags, e.g. IORING_SETUP_SQPOLL
+/// \param sq_thread_idle_ms With IORING_SETUP_SQPOLL: idle time before the polling thread sleeps
+/// \return 0 on success, -errno otherwise (-ENOSYS on kernels without io_uring)
+int io_ring_init(io_ring* r, ib_u32 entries, ib_u32 flags, ib_u32 sq_thread_idle_ms) noexcept {
+    IB_ASSERT_NOT_NULL(r);
+    std::memset((void*)r, 0, sizeof(*r));
+    r->fd = -1;
+
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    p.flags          = flags;
+    p.sq_thread_idle = sq_thread_idle_ms;
+    const int fd = io_uring_sys_setup(entries, &p);
+    if (fd < 0) return -errno;
+
+    r->fd          = fd;
+    r->features    = p.features;
+    r->setup_flags = flags;
+    r->sq_entries  = p.sq_entries;
+    r->cq_entries  = p.cq_entries;
+    r->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(ib_u32);
+    r->cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    r->sqes_size   = p.sq_entries * sizeof(io_uring_sqe);
+    const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        if (r->cq_map_size > r->sq_map_size) r->sq_map_size = r->cq_map_size;
+        r->cq_map_size = r->sq_map_size;
+    }
+
+    r->sq_map = mmap(nullptr, r->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (r->sq_map == MAP_FAILED) goto fail;
+    r->cq_map = single ? r->sq_map
+                       : mmap(nullptr, r->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (r->cq_map == MAP_FAILED) goto fail;
+    r->sqes = mmap(nullptr, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) goto fail;
+
+    {
+        char* sq = (char*)r->sq_map;
+        char* cq = (char*)r->cq_map;
+        r->sq_khead  = (std::atomic<ib_u32>*)(sq + p.sq_off.head);
+        r->sq_ktail  = (std::atomic<ib_u32>*)(sq + p.sq_off.tail);
+        r->sq_kflags = (std::atomic<ib_u32>*)(sq + p.sq_off.flags);
+        r->sq_mask   = *(ib_u32*)(sq + p.sq_off.ring_mask);
+        r->sq_array  = (ib_u32*)(sq + p.sq_off.array);
+        r->cq_khead  = (std::atomic<ib_u32>*)(cq + p.cq_off.head);
+        r->cq_ktail  = (std::atomic<ib_u32>*)(cq + p.cq_off.tail);
+        r->cq_mask   = *(ib_u32*)(cq + p.cq_off.ring_mask);
+        r->cqes      = cq + p.cq_off.cqes;
+        r->sq_tail   = r->sq_ktail->load(std::memory_order_relaxed);
+    }
+    return 0;
+
+fail:
+    const int err = -errno;
+    io_ring_destroy(r);
+    return err;
+}
+
+void io_ring_destroy(io_ring* r) noexcept {
+    if (r->sqes != nullptr && r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_size);
+    if (r->cq_map != nullptr && r->cq_map != MAP_FAILED && r->cq_map != r->sq_map) munmap(r->cq_map, r->cq_map_size);
+    if (r->sq_map != nullptr && r->sq_map != MAP_FAILED) munmap(r->sq_map, r->sq_map_size);
+    if (r->fd >= 0) close(r->fd);
+    std::memset((void*)r, 0, sizeof(*r));
+    r->fd = -1;
+}
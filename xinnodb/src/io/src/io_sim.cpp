@@ -0,0 +1,314 @@
+#include "io_sim.hpp"
+#include "ut_clock.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+/// One-shot faults armed by io_sim_inject(), taken by the next matching request on any disk
+static std::atomic<int>  io_sim_injected_errno{ 0 };
+static std::atomic<bool> io_sim_injected_lost_fsync{ false };
+static std::atomic<bool> io_sim_injected_torn_write{ false };
+
+static io_sim_file* io_sim_file_of(io_sim_disk* disk, ib_i32 fd) noexcept {
+    const ib_i64 i = (ib_i64)fd - IO_SIM_FD_BASE;
+    if (i < 0 || i >= (ib_i64)IO_SIM_MAX_FILES || disk->files[i].name[0] == '\0') return nullptr;
+    return &disk->files[i];
+}
+
+static io_sim_write* io_sim_write_of(ut_dlink* link) noexcept {
+    return (io_sim_write*)((char*)link - IB_OFFSET_OF(io_sim_write, link));
+}
+
+/// \brief Grows `*buf` to hold `size` bytes, zero filling
+static bool io_sim_reserve(char** buf, ib_u64 old_size, ib_u64 size) noexcept {
+    if (size <= old_size) return true;
+    char* grown = (char*)std::realloc(*buf, size);
+    if (grown == nullptr) return false;
+    std::memset(grown + old_size, 0, size - old_size);
+    *buf = grown;
+    return true;
+}
+
+static void io_sim_free_writes(io_sim_file* f) noexcept {
+    while (!ut_dlink_is_detached(&f->unsynced)) {
+        ut_dlink* link = f->unsynced.next;
+        ut_dlink_detach(link);
+        std::free(io_sim_write_of(link));
+    }
+}
+
+static ib_u64 io_sim_sample(io_sim_disk* disk, const io_sim_latency* l) noexcept {
+    ib_u64 ns = l->mean_ns;
+    switch (l->distribution) {
+    case IO_SIM_FIXED: break;
+    case IO_SIM_UNIFORM: ns = l->max_ns > l->min_ns ? ut_rnd_range(&disk->rnd, l->min_ns, l->max_ns) : l->min_ns; break;
+    case IO_SIM_EXPONENTIAL: {
+        const double tail = l->mean_ns > l->min_ns ? (double)(l->mean_ns - l->min_ns) : 0.0;
+        ns = l->min_ns + (ib_u64)(-std::log(1.0 - ut_rnd_unit(&disk->rnd)) * tail);
+        break;
+    }
+    }
+    return l->max_ns != 0 && ns > l->max_ns ? l->max_ns : ns;
+}
+
+/// \brief True one time in `n` (never for 0)
+static bool io_sim_odds(io_sim_disk* disk, ib_u32 n) noexcept {
+    return n != 0 && ut_rnd_one_in(&disk->rnd, n);
+}
+
+/// \brief Takes the armed errno fault if it applies to `op`
+static int io_sim_take_errno(io_op op) noexcept {
+    int err = io_sim_injected_errno.load(std::memory_order_relaxed);
+    if (err == 0 || (err == ENOSPC && (op == IO_OP_READ || op == IO_OP_READV))) return 0;
+    return io_sim_injected_errno.compare_exchange_strong(err, 0, std::memory_order_relaxed) ? err : 0;
+}
+
+static ib_i64 io_sim_file_read(io_sim_file* f, const iovec* iov, ib_u64 count, ib_u64 offset) noexcept {
+    ib_i64 done = 0;
+    for (ib_u64 i = 0; i < count && offset < f->size; ++i) {
+        const ib_u64 n = iov[i].iov_len < f->size - offset ? iov[i].iov_len : f->size - offset;
+        std::memcpy(iov[i].iov_base, f->data + offset, n);
+        offset += n;
+        done   += (ib_i64)n;
+    }
+    return done;
+}
+
+static ib_i64 io_sim_file_write(io_sim_disk* disk, io_sim_file* f, const iovec* iov, ib_u64 count, ib_u64 offset) noexcept {
+    ib_u64 len = 0;
+    for (ib_u64 i = 0; i < count; ++i) len += iov[i].iov_len;
+    const ib_u64 end = offset + len;
+    if (end > f->size) {
+        if (disk->opts.capacity != 0 && disk->used + (end - f->size) > disk->opts.capacity) return -ENOSPC;
+        if (!io_sim_reserve(&f->data, f->size, end)) return -ENOMEM;
+        disk->used += end - f->size;
+        f->size     = end;
+    }
+    io_sim_write* w = (io_sim_write*)std::malloc(sizeof(io_sim_write) + len);
+    if (w == nullptr) return -ENOMEM;
+    w->offset = offset;
+    w->len    = len;
+    w->torn   = io_sim_injected_torn_write.exchange(false, std::memory_order_relaxed);
+    for (ib_u64 i = 0, at = 0; i < count; at += iov[i].iov_len, ++i) {
+        std::memcpy(f->data + offset + at, iov[i].iov_base, iov[i].iov_len);
+        std::memcpy(w->data + at, iov[i].iov_base, iov[i].iov_len);
+    }
+    ut_dlink_enqueue(&f->unsynced, &w->link);
+    return (ib_i64)len;
+}
+
+/// \brief Writes `len` bytes of `w` to the durable image
+static void io_sim_persist(io_sim_file* f, const io_sim_write* w, ib_u64 len) noexcept {
+    if (!io_sim_reserve(&f->durable, f->durable_size, w->offset + len)) return;
+    std::memcpy(f->durable + w->offset, w->data, len);
+    if (w->offset + len > f->durable_size) f->durable_size = w->offset + len;
+}
+
+static ib_i64 io_sim_fsync(io_sim_disk* disk, io_sim_file* f) noexcept {
+    const bool lost = io_sim_injected_lost_fsync.exchange(false, std::memory_order_relaxed) ||
+                      io_sim_odds(disk, disk->opts.lost_fsync_one_in);
+    if (lost) {
+        // Acknowledged, yet the writes will never reach the medium
+        ++disk->lost_fsyncs;
+        io_sim_free_writes(f);
+        return 0;
+    }
+    while (!ut_dlink_is_detached(&f->unsynced)) {
+        ut_dlink*     link = f->unsynced.prev;
+        io_sim_write* w    = io_sim_write_of(link);
+        io_sim_persist(f, w, w->len);
+        ut_dlink_detach(link);
+        std::free(w);
+    }
+    if (f->size > f->durable_size && io_sim_reserve(&f->durable, f->durable_size, f->size)) f->durable_size = f->size;
+    return 0;
+}
+
+/// \brief Sets up an empty disk
+/// \return 0, or -EINVAL for a distribution whose bounds are inverted
+int io_sim_disk_init(io_sim_disk* disk, const io_sim_options* opts) noexcept {
+    IB_ASSERT_NOT_NULL(disk);
+    IB_ASSERT_NOT_NULL(opts);
+    for (const io_sim_latency* l : { &opts->read_latency, &opts->write_latency, &opts->fsync_latency }) {
+        if (l->max_ns != 0 && (l->min_ns > l->max_ns || l->mean_ns > l->max_ns)) return -EINVAL;
+        if (l->min_ns > l->mean_ns && l->distribution != IO_SIM_UNIFORM) return -EINVAL;
+    }
+    std::memset((void*)disk, 0, sizeof(*disk));
+    pthread_mutex_init(&disk->lock, nullptr);
+    disk->opts = *opts;
+    ut_rnd_init(&disk->rnd, opts->seed);
+    for (io_sim_file& f : disk->files) ut_dlink_init(&f.unsynced);
+    return 0;
+}
+
+void io_sim_disk_destroy(io_sim_disk* disk) noexcept {
+    for (io_sim_file& f : disk->files) {
+        io_sim_free_writes(&f);
+        std::free(f.data);
+        std::free(f.durable);
+    }
+    pthread_mutex_destroy(&disk->lock);
+}
+
+/// \brief Opens the file called `name`, creating it if `create`
+/// \details Files live as long as the disk; opening the same name again returns the same fd, and
+/// the file survives io_sim_crash() with its durable contents.
+/// \return The fd (IO_SIM_FD_BASE and up), -ENOENT, -ENAMETOOLONG, or -EMFILE when all slots are taken
+int io_sim_open(io_sim_disk* disk, const char* name, bool create) noexcept {
+    if (name == nullptr || name[0] == '\0' || std::strlen(name) >= IO_SIM_NAME_MAX) return -ENAMETOOLONG;
+    pthread_mutex_lock(&disk->lock);
+    int free_slot = -1, fd = -ENOENT;
+    for (ib_u32 i = 0; i < IO_SIM_MAX_FILES; ++i) {
+        if (disk->files[i].name[0] == '\0') {
+            if (free_slot < 0) free_slot = (int)i;
+        } else if (std::strcmp(disk->files[i].name, name) == 0) {
+            fd = IO_SIM_FD_BASE + (int)i;
+            break;
+        }
+    }
+    if (fd == -ENOENT && create) {
+        if (free_slot < 0) {
+            fd = -EMFILE;
+        } else {
+            std::strcpy(disk->files[free_slot].name, name);
+            fd = IO_SIM_FD_BASE + free_slot;
+        }
+    }
+    pthread_mutex_unlock(&disk->lock);
+    return fd;
+}
+
+/// \return The size of the file as reads see it (0 for an unknown fd)
+ib_u64 io_sim_file_size(io_sim_disk* disk, ib_i32 fd) noexcept {
+    pthread_mutex_lock(&disk->lock);
+    const io_sim_file* f    = io_sim_file_of(disk, fd);
+    const ib_u64       size = f != nullptr ? f->size : 0;
+    pthread_mutex_unlock(&disk->lock);
+    return size;
+}
+
+/// \brief Cuts the power: only durable data remains, plus whatever unsynced writes made it
+/// \details Without `reorder` a random prefix (in issue order) of each file's unsynced writes
+/// survives; with it each one survives independently, in a random order, so an older write may
+/// overwrite a newer one. A surviving write may be torn: only its first sectors land. Must not
+/// run while requests are in flight.
+void io_sim_crash(io_sim_disk* disk) noexcept {
+    pthread_mutex_lock(&disk->lock);
+    ++disk->crashes;
+    for (io_sim_file& f : disk->files) {
+        if (f.name[0] == '\0') continue;
+        // Writes beyond the first 256 since the last fsync are simply lost
+        io_sim_write* writes[256];
+        ib_u32        n = 0;
+        for (ut_dlink* it = f.unsynced.prev; it != &f.unsynced && n < 256; it = it->prev) writes[n++] = io_sim_write_of(it);
+        ib_u32 survivors = disk->opts.reorder ? n : (ib_u32)ut_rnd_bounded(&disk->rnd, (ib_u64)n + 1);
+        if (disk->opts.reorder) {
+            for (ib_u32 i = n; i > 1; --i) {
+                const ib_u32 j = (ib_u32)ut_rnd_bounded(&disk->rnd, i);
+                io_sim_write* t = writes[i - 1];
+                writes[i - 1]   = writes[j];
+                writes[j]       = t;
+            }
+        }
+        for (ib_u32 i = 0; i < survivors; ++i) {
+            io_sim_write* w = writes[i];
+            if (disk->opts.reorder && ut_rnd_one_in(&disk->rnd, 2)) continue;
+            ib_u64 len = w->len;
+            if (w->torn || io_sim_odds(disk, disk->opts.torn_write_one_in)) {
+                const ib_u64 sectors = (len + IO_SIM_SECTOR_SIZE - 1) / IO_SIM_SECTOR_SIZE;
+                len = ut_rnd_bounded(&disk->rnd, sectors) * IO_SIM_SECTOR_SIZE;
+                ++disk->torn_writes;
+            }
+            if (len != 0) io_sim_persist(&f, w, len);
+        }
+        io_sim_free_writes(&f);
+        disk->used -= f.size;
+        if (io_sim_reserve(&f.data, 0, f.durable_size)) {
+            std::memcpy(f.data, f.durable, f.durable_size);
+            f.size = f.durable_size;
+        } else {
+            f.size = 0;
+        }
+        disk->used += f.size;
+    }
+    pthread_mutex_unlock(&disk->lock);
+}
+
+/// \brief Current time of the disk: its virtual clock, or CLOCK_MONOTONIC
+ib_u64 io_sim_now(io_sim_disk* disk) noexcept {
+    if (!disk->opts.virtual_time) return ut_clock_ns(UT_CLOCK_MONOTONIC);
+    pthread_mutex_lock(&disk->lock);
+    const ib_u64 now = disk->clock_ns;
+    pthread_mutex_unlock(&disk->lock);
+    return now;
+}
+
+/// \brief Runs `req` against the disk and sets `req->result` and `req->due_ns`, its completion time
+void io_sim_start(io_sim_disk* disk, io_request* req) noexcept {
+    iovec        one   = { req->buf, req->len };
+    const bool   vec   = req->op == IO_OP_READV || req->op == IO_OP_WRITEV;
+    const iovec* iov   = vec ? (const iovec*)req->buf : &one;
+    const ib_u64 count = vec ? req->len : 1;
+    ib_u64       bytes = 0;
+    for (ib_u64 i = 0; i < count && req->op != IO_OP_FSYNC; ++i) bytes += iov[i].iov_len;
+
+    pthread_mutex_lock(&disk->lock);
+    io_sim_file*          f       = io_sim_file_of(disk, req->fd);
+    const io_sim_latency* latency = &disk->opts.fsync_latency;
+    const int             err     = f != nullptr ? io_sim_take_errno(req->op) : 0;
+    switch (req->op) {
+    case IO_OP_READ:
+    case IO_OP_READV:
+        ++disk->reads;
+        latency     = &disk->opts.read_latency;
+        req->result = f == nullptr                                 ? -EBADF
+                      : err != 0                                   ? -err
+                      : io_sim_odds(disk, disk->opts.eio_one_in)   ? -EIO
+                                                                   : io_sim_file_read(f, iov, count, req->offset);
+        break;
+    case IO_OP_WRITE:
+    case IO_OP_WRITEV:
+        ++disk->writes;
+        latency     = &disk->opts.write_latency;
+        req->result = f == nullptr                                 ? -EBADF
+                      : err != 0                                   ? -err
+                      : io_sim_odds(disk, disk->opts.eio_one_in)   ? -EIO
+                                                                   : io_sim_file_write(disk, f, iov, count, req->offset);
+        break;
+    case IO_OP_FSYNC:
+        ++disk->fsyncs;
+        req->result = f == nullptr ? -EBADF : err != 0 ? -err : io_sim_fsync(disk, f);
+        break;
+    }
+    if (f != nullptr && req->result < 0 && req->result != -ENOMEM) ++disk->errors;
+
+    const ib_u64 now   = disk->opts.virtual_time ? disk->clock_ns : ut_clock_ns(UT_CLOCK_MONOTONIC);
+    const ib_u64 start = disk->busy_until_ns > now ? disk->busy_until_ns : now;
+    const ib_u64 xfer  = disk->opts.bandwidth != 0 ? (ib_u64)((unsigned __int128)bytes * 1'000'000'000u / disk->opts.bandwidth) : 0;
+    disk->busy_until_ns = start + xfer;
+    req->start_ns       = now;
+    req->due_ns         = disk->busy_until_ns + io_sim_sample(disk, latency);
+    pthread_mutex_unlock(&disk->lock);
+}
+
+/// \brief Moves the virtual clock of `disk` forward to `ns` (never backwards)
+void io_sim_advance(io_sim_disk* disk, ib_u64 ns) noexcept {
+    pthread_mutex_lock(&disk->lock);
+    if (ns > disk->clock_ns) disk->clock_ns = ns;
+    pthread_mutex_unlock(&disk->lock);
+}
+
+/// \brief Arms a one-shot fault for the next matching request on any simulated disk
+/// \param fault `EIO` (next request), `ENOSPC` (next write or fsync), or an io_sim_fault
+/// \return 0, or -EINVAL for a fault the simulator cannot produce
+int io_sim_inject(int fault) noexcept {
+    switch (fault) {
+    case EIO:
+    case ENOSPC:                  io_sim_injected_errno.store(fault, std::memory_order_relaxed); return 0;
+    case IO_SIM_FAULT_LOST_FSYNC: io_sim_injected_lost_fsync.store(true, std::memory_order_relaxed); return 0;
+    case IO_SIM_FAULT_TORN_WRITE: io_sim_injected_torn_write.store(true, std::memory_order_relaxed); return 0;
+    default:                      return -EINVAL;
+    }
+}
@@ -0,0 +1,128 @@
+#include "io_stats.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr const char* IO_STAT_OP_NAME[IO_STAT_OPS] = { "read", "write", "fsync", "readahead" };
+
+enum io_stats_field : ib_u32 {
+    IO_STATS_COUNT = 0,
+    IO_STATS_P50   = 1,
+    IO_STATS_P99   = 2,
+    IO_STATS_P999  = 3,
+    IO_STATS_MAX   = 4,
+};
+
+constexpr const char* IO_STATS_FIELD_NAME[IO_STATS_FIELDS] = { "count", "p50_ns", "p99_ns", "p999_ns", "max_ns" };
+
+/// \brief `arg` holds the file slot, the operation and the field, a byte each
+ib_i64 io_stats_read(const ut_status_var* var) noexcept {
+    const io_stats* st    = (const io_stats*)var->ctx;
+    const ib_u32    slot  = (ib_u32)(var->arg >> 16);
+    const ib_u32    op    = (ib_u32)(var->arg >> 8 & 0xff);
+    const ib_u32    field = (ib_u32)(var->arg & 0xff);
+    ut_hist         h;
+    io_stats_merge(st, slot, (io_stat_op)op, &h);
+    switch (field) {
+    case IO_STATS_COUNT: return (ib_i64)h.count;
+    case IO_STATS_P50:   return (ib_i64)ut_hist_percentile(&h, 50.0);
+    case IO_STATS_P99:   return (ib_i64)ut_hist_percentile(&h, 99.0);
+    case IO_STATS_P999:  return (ib_i64)ut_hist_percentile(&h, 99.9);
+    default:             return (ib_i64)h.max;
+    }
+}
+
+/// \brief Registers the variables of file `slot`
+/// \return 0, or -1 if a name is taken (the variables of the slot registered so far stay)
+int io_stats_add_slot(io_stats* st, ib_u32 slot, const char* file) noexcept {
+    for (ib_u32 op = 0; op < IO_STAT_OPS; ++op) {
+        for (ib_u32 f = 0; f < IO_STATS_FIELDS; ++f) {
+            char* buf = st->names[st->registered];
+            std::snprintf(buf, IO_STATS_NAME_MAX, "io.%s.%s.%s", file, IO_STAT_OP_NAME[op], IO_STATS_FIELD_NAME[f]);
+            const ib_u64 arg = (ib_u64)slot << 16 | (ib_u64)op << 8 | f;
+            if (ut_status_register(&st->vars[st->registered], buf, io_stats_read, st, arg) != 0) return -1;
+            ++st->registered;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+/// \brief Publishes the statistics recorded in `count` shards, one per worker
+/// \return 0 on success, -1 if the names are already registered (nothing is registered then)
+int io_stats_register(io_stats* st, io_stats_shard* shards, ib_u32 count) noexcept {
+    IB_ASSERT_NOT_NULL(st);
+    IB_ASSERT_NOT_NULL(shards);
+    st->shards      = shards;
+    st->shard_count = count;
+    st->file_count  = 0;
+    st->registered  = 0;
+    for (ib_u32 s = 0; s < count; ++s) {
+        for (auto& file : shards[s].hist) {
+            for (ut_hist& h : file) ut_hist_init(&h);
+        }
+    }
+    if (io_stats_add_slot(st, 0, "all") != 0) {
+        io_stats_unregister(st);
+        return -1;
+    }
+    return 0;
+}
+
+void io_stats_unregister(io_stats* st) noexcept {
+    for (ib_u32 i = 0; i < st->registered; ++i) ut_status_unregister(&st->vars[i]);
+    st->registered = 0;
+}
+
+/// \brief Gives `fd` histograms and status variables of its own, named after `name`
+/// \return 0, or -1 if IO_STATS_MAX_FILES files are tracked already, `name` is too long or taken
+int io_stats_track_file(io_stats* st, ib_i32 fd, const char* name) noexcept {
+    if (st->file_count == IO_STATS_MAX_FILES || std::strlen(name) >= IO_STATS_FILE_NAME_MAX) return -1;
+    const ib_u32 i          = st->file_count;
+    const ib_u32 registered = st->registered;
+    std::strcpy(st->file_name[i], name);
+    if (io_stats_add_slot(st, i + 1, st->file_name[i]) != 0) {
+        while (st->registered > registered) ut_status_unregister(&st->vars[--st->registered]);
+        return -1;
+    }
+    st->file_fd[i] = fd;
+    st->file_count = i + 1;
+    return 0;
+}
+
+/// \brief Makes `iw` record its requests in shard `shard` of `st`
+void io_stats_attach(io_worker* iw, io_stats* st, ib_u32 shard) noexcept {
+    IB_ASSERT(shard < st->shard_count, "no such shard");
+    iw->stats_shard = &st->shards[shard];
+    iw->stats       = st;
+}
+
+/// \brief Sums the histograms of file `slot` (0 for all files) and `op` over all shards
+void io_stats_merge(const io_stats* st, ib_u32 slot, io_stat_op op, ut_hist* out) noexcept {
+    ut_hist_init(out);
+    for (ib_u32 s = 0; s < st->shard_count; ++s) ut_hist_merge(out, &st->shards[s].hist[slot][op]);
+}
+
+/// \brief Records the latency of a completed request on the shard of `iw`
+void io_stats_record(io_worker* iw, const io_request* req, ib_u64 ns) noexcept {
+    io_stat_op op;
+    switch (req->op) {
+    case IO_OP_READ:
+    case IO_OP_READV:  op = (req->flags & IO_FLAG_READAHEAD) != 0 ? IO_STAT_READAHEAD : IO_STAT_READ; break;
+    case IO_OP_WRITE:
+    case IO_OP_WRITEV: op = IO_STAT_WRITE; break;
+    default:           op = IO_STAT_FSYNC; break;
+    }
+    io_stats_shard* shard = iw->stats_shard;
+    ut_hist_record(&shard->hist[0][op], ns);
+    const io_stats* st = iw->stats;
+    for (ib_u32 i = 0; i < st->file_count; ++i) {
+        if (st->file_fd[i] == req->fd) {
+            ut_hist_record(&shard->hist[i + 1][op], ns);
+            break;
+        }
+    }
+}
@@ -0,0 +1,568 @@
+#include "io.hpp"
+#include "io_uring_sys.hpp"
+#include "io_sim.hpp"
+#include "io_stats.hpp"
+#include "ut_clock.hpp"
+#include "ut_cfg.hpp"
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+/// \brief Largest transfer of a single read or write (the kernel's MAX_RW_COUNT)
+static constexpr ib_u64 IO_MAX_TRANSFER = 0x7ffff000;
+
+// -----------------------------------------------------------------------------
+// Configuration
+// -----------------------------------------------------------------------------
+
+static std::atomic<ib_u32> io_cfg_submit{ IO_SUBMIT_IMMEDIATE };
+static std::atomic<bool>   io_cfg_coalesce_on{ true };
+static const char*         io_cfg_submit_name    = "immediate";
+static ib_ulint            io_cfg_sqpoll_idle_ms = 1000;
+static ib_bool             io_cfg_coalesce       = true;
+static ut_cfg_var          io_cfg_submit_var;
+static ut_cfg_var          io_cfg_sqpoll_idle_var;
+static ut_cfg_var          io_cfg_coalesce_var;
+
+static int io_cfg_apply_submit(ut_cfg_var* var, const void* value) noexcept {
+    const char* name = *(const char* const*)value;
+    for (ib_u32 mode = IO_SUBMIT_IMMEDIATE; mode <= IO_SUBMIT_SQPOLL; ++mode) {
+        const char* canonical = io_submit_mode_name((io_submit_mode)mode);
+        if (name != nullptr && std::strcmp(name, canonical) == 0) {
+            ut_cfg_store(var, &canonical);
+            io_cfg_submit.store(mode, std::memory_order_relaxed);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int io_cfg_apply_coalesce(ut_cfg_var* var, const void* value) noexcept {
+    ut_cfg_store(var, value);
+    io_cfg_coalesce_on.store(*(const ib_bool*)value, std::memory_order_relaxed);
+    return 0;
+}
+
+/// \return 0, or -1 with nothing registered
+static int io_cfg_register() noexcept {
+    if (ut_cfg_register(&io_cfg_submit_var, "io_submit_policy", IB_CFG_TEXT, &io_cfg_submit_name, io_cfg_apply_submit) != 0) {
+        return -1;
+    }
+    if (ut_cfg_register(&io_cfg_sqpoll_idle_var, "io_sqpoll_idle_ms", IB_CFG_ULINT, &io_cfg_sqpoll_idle_ms, nullptr, 1, 3'600'000) == 0) {
+        if (ut_cfg_register(&io_cfg_coalesce_var, "io_coalesce", IB_CFG_IBOOL, &io_cfg_coalesce, io_cfg_apply_coalesce) == 0) return 0;
+        ut_cfg_unregister(&io_cfg_sqpoll_idle_var);
+    }
+    ut_cfg_unregister(&io_cfg_submit_var);
+    return -1;
+}
+
+/// \brief Registers the settings of the module; only the first call does, the others return its result
+/// \return 0 on success, -1 if one of the names was already taken (none of them is then registered)
+int io_cfg_init() noexcept {
+    static const int rc = io_cfg_register();
+    return rc;
+}
+
+/// \brief Submission policy for the next request of `iw`
+static io_submit_mode io_submit_mode_now(const io_worker* iw) noexcept {
+    if (!iw->submit_follows_cfg) return iw->submit;
+    const io_submit_mode mode = (io_submit_mode)io_cfg_submit.load(std::memory_order_relaxed);
+    return mode == IO_SUBMIT_SQPOLL ? IO_SUBMIT_BATCH : mode;   // the ring was set up without a polling thread
+}
+
+// -----------------------------------------------------------------------------
+// Completion
+// -----------------------------------------------------------------------------
+
+/// \brief Charges the bytes to the issuing task and resumes it
+static void io_complete(io_worker* iw, io_request* req) noexcept {
+    sched_task* t = req->task;
+    if (req->result > 0) {
+        if (req->op == IO_OP_READ || req->op == IO_OP_READV) t->acct.io_read_bytes += (ib_u64)req->result;
+        if (req->op == IO_OP_WRITE || req->op == IO_OP_WRITEV) t->acct.io_write_bytes += (ib_u64)req->result;
+    }
+    if (iw->stats != nullptr) {
+        const ib_u64 end = iw->backend == IO_BACKEND_SIM ? req->due_ns : ut_clock_ns(UT_CLOCK_TSC);
+        io_stats_record(iw, req, end - req->start_ns);
+    }
+    --iw->in_flight;
+    if (iw->backend != IO_BACKEND_THREADS) --iw->sched->poll_pending;
+    ++iw->completed_total;
+    sched_resume(t);
+}
+
+static io_request* io_request_of(ut_dlink* link) noexcept {
+    return (io_request*)((char*)link - IB_OFFSET_OF(io_request, link));
+}
+
+// -----------------------------------------------------------------------------
+// io_uring backend
+// -----------------------------------------------------------------------------
+
+/// \brief Registered buffer holding all of [buf, buf + len), or -1
+static ib_i32 io_fixed_buffer_index(const io_worker* iw, const void* buf, ib_u64 len) noexcept {
+    const char* p = (const char*)buf;
+    for (ib_u32 i = 0; i < iw->fixed_buffer_count; ++i) {
+        const io_fixed_buffer* b = &iw->fixed_buffers[i];
+        if (p >= b->base && len <= b->len && (ib_size)(p - b->base) <= b->len - len) return (ib_i32)i;
+    }
+    return -1;
+}
+
+/// \brief Tags the user data of the SQEs of merged requests (io_merge is pointer aligned)
+static constexpr ib_u64 IO_USER_DATA_MERGE = 1;
+
+/// \brief Takes an SQE for an operation on `fd`
+/// \return nullptr if the submission ring is full or the completion ring could overflow
+static io_uring_sqe* io_uring_sqe_for(io_worker* iw, ib_i32 fd) noexcept {
+    io_ring* r = &iw->ring;
+    if (iw->in_ring >= r->cq_entries) return nullptr;
+    io_uring_sqe* sqe = io_ring_get_sqe(r);
+    if (sqe == nullptr) return nullptr;
+    sqe->fd = fd;
+    if (fd >= 0 && (ib_u32)fd < IO_MAX_FIXED_FDS && iw->fixed_file_slot[fd] != 0) {
+        sqe->fd     = iw->fixed_file_slot[fd] - 1;
+        sqe->flags |= IOSQE_FIXED_FILE;
+        ++iw->fixed_file_ops;
+    }
+    ++iw->in_ring;
+    return sqe;
+}
+
+/// \brief Fills an SQE for `req`
+/// \return false if there is no room in the rings
+static bool io_uring_prep(io_worker* iw, io_request* req) noexcept {
+    io_uring_sqe* sqe = io_uring_sqe_for(iw, req->fd);
+    if (sqe == nullptr) return false;
+    sqe->user_data = (ib_u64)(ib_uintptr)req;
+    switch (req->op) {
+    case IO_OP_READ:
+    case IO_OP_WRITE: {
+        const ib_i32 idx = io_fixed_buffer_index(iw, req->buf, req->len);
+        if (idx >= 0) {
+            sqe->opcode    = req->op == IO_OP_READ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+            sqe->buf_index = (ib_u16)idx;
+            ++iw->fixed_buffer_ops;
+        } else {
+            sqe->opcode = req->op == IO_OP_READ ? IORING_OP_READ : IORING_OP_WRITE;
+        }
+        sqe->addr = (ib_u64)(ib_uintptr)req->buf;
+        sqe->len  = (ib_u32)(req->len < IO_MAX_TRANSFER ? req->len : IO_MAX_TRANSFER);
+        sqe->off  = req->offset;
+        break;
+    }
+    case IO_OP_READV:
+    case IO_OP_WRITEV:
+        sqe->opcode = req->op == IO_OP_READV ? IORING_OP_READV : IORING_OP_WRITEV;
+        sqe->addr   = (ib_u64)(ib_uintptr)req->buf;
+        sqe->len    = (ib_u32)req->len;
+        sqe->off    = req->offset;
+        break;
+    case IO_OP_FSYNC:
+        sqe->opcode      = IORING_OP_FSYNC;
+        sqe->fsync_flags = (req->flags & IO_FLAG_DATASYNC) != 0 ? IORING_FSYNC_DATASYNC : 0;
+        break;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Coalescing
+// -----------------------------------------------------------------------------
+
+/// \brief Order of the staged list: by fd, then operation, then offset
+static bool io_stage_after(const io_request* a, const io_request* b) noexcept {
+    if (a->fd != b->fd) return a->fd > b->fd;
+    if (a->op != b->op) return a->op > b->op;
+    return a->offset > b->offset;
+}
+
+/// \brief Holds `req` until the end of the loop iteration so that neighbours can join it
+/// \details Scans from the largest key: requests of a sequential scan or flush arrive in order.
+static void io_stage(io_worker* iw, io_request* req) noexcept {
+    ut_dlink* it = iw->staged.prev;
+    while (it != &iw->staged && io_stage_after(io_request_of(it), req)) it = it->prev;
+    ut_dlink_insert_next(it, &req->link);
+}
+
+static io_merge* io_merge_take(io_worker* iw) noexcept {
+    for (ib_u32 i = 0; i < IO_MAX_MERGES; ++i) {
+        if (iw->merges[i].count == 0) return &iw->merges[i];
+    }
+    return nullptr;
+}
+
+/// \brief Length of the run of staged requests starting at `first` that can share one SQE
+static ib_u32 io_stage_run(io_worker* iw, io_request* first) noexcept {
+    ib_u32      n    = 1;
+    io_request* last = first;
+    for (ut_dlink* it = first->link.next; it != &iw->staged && n < IO_MERGE_MAX_IOVS; it = it->next, ++n) {
+        io_request* next = io_request_of(it);
+        if (next->fd != first->fd || next->op != first->op || next->offset != last->offset + last->len) break;
+        last = next;
+    }
+    return n;
+}
+
+/// \brief Submits the staged requests, runs of adjacent ones as one READV / WRITEV
+/// \details Requests that find no room in the rings move to `overflow`, in order, and go out
+/// one by one as completions free slots.
+static void io_uring_submit_staged(io_worker* iw) noexcept {
+    while (!ut_dlink_is_detached(&iw->staged)) {
+        io_request*  first = io_request_of(iw->staged.next);
+        const ib_u32 n     = io_stage_run(iw, first);
+        io_merge*    m     = n > 1 ? io_merge_take(iw) : nullptr;
+        if (m == nullptr) {
+            if (!io_uring_prep(iw, first)) break;
+            ut_dlink_detach(&first->link);
+            continue;
+        }
+        io_uring_sqe* sqe = io_uring_sqe_for(iw, first->fd);
+        if (sqe == nullptr) break;
+        for (ib_u32 i = 0; i < n; ++i) {
+            io_request* req = io_request_of(iw->staged.next);
+            ut_dlink_detach(&req->link);
+            m->iov[i]  = { req->buf, req->len };
+            m->reqs[i] = req;
+        }
+        m->count       = n;
+        sqe->opcode    = first->op == IO_OP_READ ? IORING_OP_READV : IORING_OP_WRITEV;
+        sqe->addr      = (ib_u64)(ib_uintptr)m->iov;
+        sqe->len       = n;
+        sqe->off       = first->offset;
+        sqe->user_data = (ib_u64)(ib_uintptr)m | IO_USER_DATA_MERGE;
+        ++iw->vectored_sqes;
+        iw->coalesced_requests += n;
+    }
+    while (!ut_dlink_is_detached(&iw->staged)) {
+        ut_dlink* link = iw->staged.next;
+        ut_dlink_detach(link);
+        ut_dlink_enqueue(&iw->overflow, link);
+        ++iw->overflow_waits;
+    }
+}
+
+/// \brief Splits the result of a merged SQE between its requests, in file order
+static void io_merge_complete(io_worker* iw, io_merge* m, ib_i64 res) noexcept {
+    const ib_u32 n = m->count;
+    m->count = 0;
+    for (ib_u32 i = 0; i < n; ++i) {
+        io_request* req = m->reqs[i];
+        if (res < 0) {
+            req->result = res;
+        } else {
+            req->result = res < (ib_i64)req->len ? res : (ib_i64)req->len;
+            res        -= req->result;
+        }
+        io_complete(iw, req);
+    }
+}
+
+/// \brief Hands the filled SQEs to the kernel
+/// \details A failed io_uring_enter (EAGAIN, EBUSY, EINTR) leaves them in the ring; the poller
+/// retries on its next pass. With SQPOLL, publishing the tail is enough unless the polling thread
+/// went to sleep.
+static void io_uring_flush(io_worker* iw) noexcept {
+    io_ring* r = &iw->ring;
+    if (r->to_submit == 0) return;
+    io_ring_publish(r);
+    if (iw->submit == IO_SUBMIT_SQPOLL) {
+        r->to_submit = 0;
+        // The thread sets NEED_WAKEUP and then rechecks the tail: order our tail store before the flag load
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((r->sq_kflags->load(std::memory_order_relaxed) & IORING_SQ_NEED_WAKEUP) != 0) {
+            ++iw->enter_calls;
+            ++iw->sqpoll_wakeups;
+            io_uring_sys_enter(r->fd, 0, 0, IORING_ENTER_SQ_WAKEUP);
+        }
+        return;
+    }
+    ++iw->enter_calls;
+    const int n = io_uring_sys_enter(r->fd, r->to_submit, 0, 0);
+    if (n > 0) r->to_submit -= (ib_u32)n;
+}
+
+/// \brief Moves requests waiting for ring space into the ring
+static void io_uring_drain_overflow(io_worker* iw) noexcept {
+    while (!ut_dlink_is_detached(&iw->overflow)) {
+        ut_dlink*   link = iw->overflow.prev;
+        io_request* req  = io_request_of(link);
+        if (!io_uring_prep(iw, req)) break;
+        ut_dlink_detach(link);
+    }
+}
+
+static ib_u64 io_uring_reap(io_worker* iw) noexcept {
+    io_ring*     r = &iw->ring;
+    ib_u32       head;
+    const ib_u32 ready = io_ring_cq_ready(r, &head);
+    for (ib_u32 i = 0; i < ready; ++i) {
+        const io_uring_cqe* cqe = io_ring_peek_cqe(r, head + i);
+        if ((cqe->user_data & IO_USER_DATA_MERGE) != 0) {
+            io_merge_complete(iw, (io_merge*)(ib_uintptr)(cqe->user_data & ~IO_USER_DATA_MERGE), cqe->res);
+            continue;
+        }
+        io_request* req = (io_request*)(ib_uintptr)cqe->user_data;
+        req->result = cqe->res;
+        io_complete(iw, req);
+    }
+    iw->in_ring -= ready;
+    if (ready != 0) io_ring_cq_advance(r, head + ready);
+    io_uring_drain_overflow(iw);
+    io_uring_submit_staged(iw);
+    io_uring_flush(iw);
+    return ready;
+}
+
+// -----------------------------------------------------------------------------
+// Threads backend
+// -----------------------------------------------------------------------------
+
+static ib_u64 io_threads_reap(io_worker* iw) noexcept {
+    io_request* req = iw->completed.exchange(nullptr, std::memory_order_acquire);
+    ib_u64      n   = 0;
+    while (req != nullptr) {
+        io_request* next = req->next;
+        io_complete(iw, req);
+        req = next;
+        ++n;
+    }
+    return n;
+}
+
+// -----------------------------------------------------------------------------
+// Simulated backend and io_worker
+// -----------------------------------------------------------------------------
+
+/// \brief Queues `req`, already run by the disk, until its completion time
+static void io_sim_submit(io_worker* iw, io_request* req) noexcept {
+    io_sim_start(iw->sim, req);
+    ut_dlink* it = iw->sim_pending.prev;
+    while (it != &iw->sim_pending && io_request_of(it)->due_ns > req->due_ns) it = it->prev;
+    ut_dlink_insert_next(it, &req->link);
+}
+
+/// \brief Completes the requests that are due; with virtual time, first jumps to the earliest one
+static ib_u64 io_sim_reap(io_worker* iw) noexcept {
+    if (ut_dlink_is_detached(&iw->sim_pending)) return 0;
+    ib_u64 now = io_sim_now(iw->sim);
+    if (iw->sim->opts.virtual_time) {
+        const ib_u64 first = io_request_of(iw->sim_pending.next)->due_ns;
+        if (first > now) io_sim_advance(iw->sim, now = first);
+    }
+    ib_u64 n = 0;
+    while (!ut_dlink_is_detached(&iw->sim_pending)) {
+        io_request* req = io_request_of(iw->sim_pending.next);
+        if (req->due_ns > now) break;
+        ut_dlink_detach(&req->link);
+        io_complete(iw, req);
+        ++n;
+    }
+    return n;
+}
+
+static ib_u64 io_poll(sched_worker*, void* ctx) noexcept {
+    return io_reap((io_worker*)ctx);
+}
+
+/// \brief Sets up the I/O state of `w`; call on the thread that owns `w` before it runs tasks
+/// \details With IO_BACKEND_AUTO the worker gets its own io_uring instance, or uses `opts->pool`
+/// when io_uring cannot be set up. A SQPOLL ring that cannot be created (older kernels require
+/// privileges for it) falls back to batched submission.
+/// \return 0 on success, -errno otherwise (-EINVAL for the threads backend without a pool, -EEXIST
+/// if the settings of the module could not be registered)
+int io_worker_init(io_worker* iw, sched_worker* w, const io_options* opts) noexcept {
+    IB_ASSERT_NOT_NULL(iw);
+    IB_ASSERT_NOT_NULL(w);
+    if (io_cfg_init() != 0) return -EEXIST;
+    std::memset((void*)iw, 0, sizeof(*iw));
+    iw->sched   = w;
+    iw->ring.fd = -1;
+    iw->pool    = opts != nullptr ? opts->pool : nullptr;
+    iw->backend = opts != nullptr ? opts->backend : IO_BACKEND_AUTO;
+    iw->completed.store(nullptr, std::memory_order_relaxed);
+    ut_dlink_init(&iw->overflow);
+    ut_dlink_init(&iw->staged);
+    ut_dlink_init(&iw->sim_pending);
+
+    iw->submit  = opts != nullptr ? opts->submit : IO_SUBMIT_CONFIGURED;
+    if (iw->submit == IO_SUBMIT_CONFIGURED) {
+        iw->submit             = (io_submit_mode)io_cfg_submit.load(std::memory_order_relaxed);
+        iw->submit_follows_cfg = iw->submit != IO_SUBMIT_SQPOLL;
+    }
+
+    if (iw->backend == IO_BACKEND_SIM) {
+        iw->sim = opts->sim;
+        if (iw->sim == nullptr) return -EINVAL;
+        iw->submit             = IO_SUBMIT_IMMEDIATE;
+        iw->submit_follows_cfg = false;
+    } else if (iw->backend != IO_BACKEND_THREADS) {
+        const ib_u32 entries = opts != nullptr && opts->entries != 0 ? opts->entries : IO_RING_DEFAULT_ENTRIES;
+        int          rc;
+        if (iw->submit == IO_SUBMIT_SQPOLL) {
+            ib_ulint idle = opts != nullptr ? opts->sqpoll_idle_ms : 0;
+            if (idle == 0) ut_cfg_get("io_sqpoll_idle_ms", &idle);
+            rc = io_ring_init(&iw->ring, entries, IORING_SETUP_SQPOLL, (ib_u32)idle);
+            if (rc != 0) iw->submit = IO_SUBMIT_BATCH;
+        }
+        if (iw->submit != IO_SUBMIT_SQPOLL) rc = io_ring_init(&iw->ring, entries);
+        if (rc == 0) {
+            iw->backend = IO_BACKEND_URING;
+        } else if (iw->backend == IO_BACKEND_URING || iw->pool == nullptr) {
+            return rc;
+        } else {
+            iw->backend = IO_BACKEND_THREADS;
+        }
+    }
+    if (iw->backend == IO_BACKEND_THREADS) {
+        if (iw->pool == nullptr) return -EINVAL;
+        iw->submit             = IO_SUBMIT_IMMEDIATE;
+        iw->submit_follows_cfg = false;
+    }
+
+    sched_poller_register(w, &iw->poller, io_poll, iw);
+    w->ext[SCHED_EXT_IO] = iw;
+    return 0;
+}
+
+/// \brief Releases the ring; every request must have completed
+void io_worker_detach(io_worker* iw) noexcept {
+    IB_ASSERT(iw->in_flight == 0, "I/O requests still in flight");
+    sched_poller_unregister(&iw->poller);
+    iw->sched->ext[SCHED_EXT_IO] = nullptr;
+    if (iw->backend == IO_BACKEND_URING) io_ring_destroy(&iw->ring);
+}
+
+/// \brief Starts `req` on `iw`; `req->task` is resumed by the poller once `req->result` is set
+/// \details The caller suspends the task (sched_suspend() or task_park()) before or right after
+/// the call, within the same step. Requests that find the ring full wait on `overflow`.
+void io_submit(io_worker* iw, io_request* req) noexcept {
+    IB_ASSERT_NOT_NULL(req->task);
+    req->owner = iw;
+    if (iw->stats != nullptr) req->start_ns = ut_clock_ns(UT_CLOCK_TSC);   // the disk clock replaces it for SIM
+    ++iw->submitted_total;
+    ++iw->in_flight;
+    if (iw->backend == IO_BACKEND_THREADS) {
+        io_pool_submit(iw->pool, req);
+        return;
+    }
+    ++iw->sched->poll_pending;
+    if (iw->backend == IO_BACKEND_SIM) {
+        io_sim_submit(iw, req);
+        return;
+    }
+    const io_submit_mode mode = io_submit_mode_now(iw);
+    if ((req->op == IO_OP_READ || req->op == IO_OP_WRITE) && mode != IO_SUBMIT_IMMEDIATE &&
+        io_cfg_coalesce_on.load(std::memory_order_relaxed)) {
+        io_stage(iw, req);
+        return;
+    }
+    if (!ut_dlink_is_detached(&iw->overflow) || !io_uring_prep(iw, req)) {
+        ++iw->overflow_waits;
+        ut_dlink_enqueue(&iw->overflow, &req->link);
+        return;
+    }
+    // BATCH leaves the SQE for the poller at the end of the loop iteration
+    if (mode != IO_SUBMIT_BATCH) io_uring_flush(iw);
+}
+
+/// \brief Resumes the tasks whose requests completed and submits the waiting ones
+/// \return Tasks resumed
+ib_u64 io_reap(io_worker* iw) noexcept {
+    switch (iw->backend) {
+    case IO_BACKEND_URING: return io_uring_reap(iw);
+    case IO_BACKEND_SIM:   return io_sim_reap(iw);
+    default:               return io_threads_reap(iw);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Registration
+// -----------------------------------------------------------------------------
+
+/// \brief Registers up to IO_MAX_FIXED_BUFFERS memory regions (typically the buffer pool) with the ring
+/// \details The pages stay pinned until io_unregister_buffers(); pinned memory counts against
+/// RLIMIT_MEMLOCK. Reads and writes that fall inside a region are then issued as READ_FIXED and
+/// WRITE_FIXED.
+/// \return 0 on success (always on the threads backend), -errno otherwise (-EBUSY if already registered)
+int io_register_buffers(io_worker* iw, const io_fixed_buffer* buffers, ib_u32 count) noexcept {
+    IB_ASSERT(count > 0 && count <= IO_MAX_FIXED_BUFFERS, "invalid fixed buffer count");
+    if (iw->backend != IO_BACKEND_URING) return 0;
+    if (iw->fixed_buffer_count != 0) return -EBUSY;
+    iovec iov[IO_MAX_FIXED_BUFFERS];
+    for (ib_u32 i = 0; i < count; ++i) iov[i] = { buffers[i].base, buffers[i].len };
+    if (io_uring_sys_register(iw->ring.fd, IORING_REGISTER_BUFFERS, iov, count) < 0) return -errno;
+    for (ib_u32 i = 0; i < count; ++i) iw->fixed_buffers[i] = buffers[i];
+    iw->fixed_buffer_count = count;
+    return 0;
+}
+
+int io_unregister_buffers(io_worker* iw) noexcept {
+    if (iw->fixed_buffer_count == 0) return 0;
+    iw->fixed_buffer_count = 0;
+    return io_uring_sys_register(iw->ring.fd, IORING_UNREGISTER_BUFFERS, nullptr, 0) < 0 ? -errno : 0;
+}
+
+/// \brief Registers open files (typically the tablespaces) with the ring
+/// \details Requests on a registered fd then use its slot with IOSQE_FIXED_FILE. Every fd must be
+/// below IO_MAX_FIXED_FDS. The fds must stay open until io_unregister_files().
+/// \return 0 on success (always on the threads backend), -errno otherwise (-EBUSY if already registered)
+int io_register_files(io_worker* iw, const ib_i32* fds, ib_u32 count) noexcept {
+    IB_ASSERT(count > 0 && count <= IO_MAX_FIXED_FDS, "invalid fixed file count");
+    for (ib_u32 i = 0; i < count; ++i) {
+        if (fds[i] < 0 || (ib_u32)fds[i] >= IO_MAX_FIXED_FDS) return -EINVAL;
+    }
+    if (iw->backend != IO_BACKEND_URING) return 0;
+    if (iw->fixed_file_count != 0) return -EBUSY;
+    if (io_uring_sys_register(iw->ring.fd, IORING_REGISTER_FILES, fds, count) < 0) return -errno;
+    for (ib_u32 i = 0; i < count; ++i) iw->fixed_file_slot[fds[i]] = (ib_u16)(i + 1);
+    iw->fixed_file_count = count;
+    return 0;
+}
+
+int io_unregister_files(io_worker* iw) noexcept {
+    if (iw->fixed_file_count == 0) return 0;
+    std::memset(iw->fixed_file_slot, 0, sizeof(iw->fixed_file_slot));
+    iw->fixed_file_count = 0;
+    return io_uring_sys_register(iw->ring.fd, IORING_UNREGISTER_FILES, nullptr, 0) < 0 ? -errno : 0;
+}
+
+/// \brief Runs `req` synchronously on the calling thread
+/// \return Bytes transferred (0 for fsync), or -errno
+ib_i64 io_execute(io_request* req) noexcept {
+    ib_i64 rc;
+    do {
+        switch (req->op) {
+        case IO_OP_READ:  rc = pread(req->fd, req->buf, req->len, (off_t)req->offset); break;
+        case IO_OP_WRITE: rc = pwrite(req->fd, req->buf, req->len, (off_t)req->offset); break;
+        case IO_OP_READV:  rc = preadv(req->fd, (const iovec*)req->buf, (int)req->len, (off_t)req->offset); break;
+        case IO_OP_WRITEV: rc = pwritev(req->fd, (const iovec*)req->buf, (int)req->len, (off_t)req->offset); break;
+        case IO_OP_FSYNC: rc = (req->flags & IO_FLAG_DATASYNC) != 0 ? fdatasync(req->fd) : fsync(req->fd); break;
+        default:          rc = -1; errno = EINVAL; break;
+        }
+    } while (rc < 0 && errno == EINTR);
+    return rc < 0 ? -(ib_i64)errno : rc;
+}
+
+const char* io_submit_mode_name(io_submit_mode mode) noexcept {
+    switch (mode) {
+    case IO_SUBMIT_CONFIGURED: return "configured";
+    case IO_SUBMIT_IMMEDIATE:  return "immediate";
+    case IO_SUBMIT_BATCH:      return "batch";
+    case IO_SUBMIT_SQPOLL:     return "sqpoll";
+    }
+    return "unknown";
+}
+
+const char* io_backend_name(io_backend backend) noexcept {
+    switch (backend) {
+    case IO_BACKEND_AUTO:    return "auto";
+    case IO_BACKEND_URING:   return "io_uring";
+    case IO_BACKEND_THREADS: return "threads";
+    case IO_BACKEND_SIM:     return "sim";
+    }
+    return "unknown";
+}
@@ -0,0 +1,361 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "io.hpp"        // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+#include "ut_cfg.hpp"    // IWYU pragma: keep
+
+namespace {
+
+struct IoFixture : ::testing::TestWithParam<io_backend>, task_test_env {
+    io_pool   pool;
+    io_worker iw;
+    int       fd = -1;
+
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this, 0, 256 * 1024), 0);
+        ASSERT_EQ(io_pool_start(&pool, 2), 0);
+        char path[] = "/tmp/xinnodb_io_XXXXXX";
+        fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        unlink(path);
+    }
+
+    void TearDown() override {
+        if (fd >= 0) close(fd);
+        io_pool_stop(&pool);
+        task_test_env_destroy(this);
+    }
+
+    /// Attaches the backend under test; skips when io_uring is not available here
+    void attach(ib_u32 entries = 0, io_submit_mode submit = IO_SUBMIT_CONFIGURED, ib_u32 idle_ms = 0) {
+        io_options opts{};
+        opts.backend        = GetParam();
+        opts.entries        = entries;
+        opts.pool           = &pool;
+        opts.submit         = submit;
+        opts.sqpoll_idle_ms = idle_ms;
+
+        const int rc = io_worker_init(&iw, &worker, &opts);
+        if (rc == -ENOSYS || rc == -EPERM) GTEST_SKIP() << "io_uring unavailable";
+        ASSERT_EQ(rc, 0);
+        ASSERT_EQ(iw.backend, GetParam());
+    }
+};
+
+ib_async<void> write_sync_read(int fd, ib_i64* results, char* back) {
+    char block[4096];
+    std::memset(block, 'x', sizeof(block));
+    results[0] = co_await io_write(fd, block, sizeof(block), 8192);
+    results[1] = co_await io_fsync(fd, true);
+    results[2] = co_await io_read(fd, back, sizeof(block), 8192);
+}
+
+ib_async<void> write_block(int fd, ib_u32 i, ib_i64* result) {
+    char block[512];
+    std::memset(block, 'a' + (int)(i % 26), sizeof(block));
+    *result = co_await io_write(fd, block, sizeof(block), (ib_u64)i * sizeof(block));
+}
+
+ib_async<void> read_at(int fd, void* buf, ib_u64 len, ib_u64 off, ib_i64* result) {
+    *result = co_await io_read(fd, buf, len, off);
+}
+
+/// Writes two frames that are far apart in memory to neighbouring pages, then reads them back swapped
+ib_async<void> scatter_gather(int fd, char* frames, ib_i64* results) {
+    iovec out[2] = { { frames, 4096 }, { frames + 3 * 4096, 4096 } };
+    results[0]   = co_await io_writev(fd, out, 2, 4096);
+    iovec in[2]  = { { frames + 2 * 4096, 4096 }, { frames + 4096, 4096 } };
+    results[1]   = co_await io_readv(fd, in, 2, 4096);
+}
+
+} // namespace
+
+TEST_P(IoFixture, WriteSyncReadRoundTrip) {
+    attach();
+    if (IsSkipped()) return;
+    ib_i64 results[3] = { -1, -1, -1 };
+    char   back[4096] = {};
+    ASSERT_EQ(task_spawn(&worker, write_sync_read(fd, results, back)), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    EXPECT_EQ(results[0], 4096);
+    EXPECT_EQ(results[1], 0);
+    EXPECT_EQ(results[2], 4096);
+    EXPECT_EQ(back[0], 'x');
+    EXPECT_EQ(back[4095], 'x');
+    EXPECT_EQ(iw.submitted_total, 3u);
+    EXPECT_EQ(iw.completed_total, 3u);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_IO], 3u);
+    EXPECT_EQ(worker.poll_pending, 0u);
+
+    const ut_acct* acct = &worker.classes[SCHED_CLASS_OLTP].acct;
+    EXPECT_EQ(acct->io_write_bytes, 4096u);
+    EXPECT_EQ(acct->io_read_bytes, 4096u);
+    EXPECT_EQ(acct->io_waits, 3u);
+}
+
+TEST_P(IoFixture, ManyRequestsOverflowASmallRing) {
+    attach(4);
+    if (IsSkipped()) return;
+    constexpr ib_u32    N = 64;
+    std::vector<ib_i64> results(N, -1);
+    for (ib_u32 i = 0; i < N; ++i) ASSERT_EQ(task_spawn(&worker, write_block(fd, i, &results[i])), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    for (ib_u32 i = 0; i < N; ++i) EXPECT_EQ(results[i], 512) << i;
+    EXPECT_EQ(iw.completed_total, N);
+    EXPECT_EQ(iw.in_flight, 0u);
+    if (GetParam() == IO_BACKEND_URING) {
+        EXPECT_GT(iw.overflow_waits, 0u);
+    }
+
+    char block[512];
+    for (ib_u32 i = 0; i < N; ++i) {
+        ASSERT_EQ(pread(fd, block, sizeof(block), (off_t)i * 512), 512);
+        EXPECT_EQ(block[0], 'a' + (int)(i % 26));
+        EXPECT_EQ(block[511], 'a' + (int)(i % 26));
+    }
+}
+
+TEST_P(IoFixture, ErrorsAndEndOfFile) {
+    attach();
+    if (IsSkipped()) return;
+    char   buf[64];
+    ib_i64 bad = 0, eof = -1;
+    ASSERT_EQ(task_spawn(&worker, read_at(-1, buf, sizeof(buf), 0, &bad)), 0);
+    ASSERT_EQ(task_spawn(&worker, read_at(fd, buf, sizeof(buf), 1 << 20, &eof)), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    EXPECT_EQ(bad, -EBADF);
+    EXPECT_EQ(eof, 0);
+}
+
+TEST_P(IoFixture, RegisteredBuffersAndFilesAreTransparent) {
+    attach();
+    if (IsSkipped()) return;
+    alignas(4096) static char region[3 * 4096];
+    const io_fixed_buffer buffers[] = { { region, 2 * 4096 } };
+    const ib_i32          fds[]     = { fd };
+    ASSERT_EQ(io_register_buffers(&iw, buffers, 1), 0);
+    ASSERT_EQ(io_register_files(&iw, fds, 1), 0);
+    EXPECT_EQ(io_register_files(&iw, fds, 1), GetParam() == IO_BACKEND_URING ? -EBUSY : 0);
+
+    std::memset(region, 'p', 4096);
+    ib_i64 results[3] = { -1, -1, -1 };
+    ASSERT_EQ(task_spawn(&worker, write_block(fd, 1, &results[0])), 0);
+    sched_run(&worker);
+    // Inside the region: fixed; straddling its end: plain
+    ASSERT_EQ(task_spawn(&worker, read_at(fd, region + 4096, 512, 512, &results[1])), 0);
+    ASSERT_EQ(task_spawn(&worker, read_at(fd, region + 2 * 4096 - 256, 512, 512, &results[2])), 0);
+    sched_run(&worker);
+
+    EXPECT_EQ(results[0], 512);
+    EXPECT_EQ(results[1], 512);
+    EXPECT_EQ(results[2], 512);
+    EXPECT_EQ(region[4096], 'b');
+    EXPECT_EQ(region[2 * 4096 + 255], 'b');
+    if (GetParam() == IO_BACKEND_URING) {
+        EXPECT_EQ(iw.fixed_file_ops, 3u);
+        EXPECT_EQ(iw.fixed_buffer_ops, 1u);
+    }
+    EXPECT_EQ(io_unregister_files(&iw), 0);
+    EXPECT_EQ(io_unregister_buffers(&iw), 0);
+    io_worker_detach(&iw);
+}
+
+TEST_P(IoFixture, BatchModeSubmitsOncePerLoopIteration) {
+    if (GetParam() != IO_BACKEND_URING) GTEST_SKIP() << "io_uring only";
+    attach(0, IO_SUBMIT_BATCH);
+    if (IsSkipped()) return;
+    constexpr ib_u32    N = 48;
+    std::vector<ib_i64> results(N, -1);
+    for (ib_u32 i = 0; i < N; ++i) ASSERT_EQ(task_spawn(&worker, write_block(fd, i, &results[i])), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    for (ib_u32 i = 0; i < N; ++i) EXPECT_EQ(results[i], 512) << i;
+    // All 48 tasks suspend in the first iteration (SCHED_RUN_BATCH = 64): one enter submits them all
+    EXPECT_EQ(iw.submit, IO_SUBMIT_BATCH);
+    EXPECT_LE(iw.enter_calls, 4u);
+}
+
+TEST_P(IoFixture, BatchModeCoalescesAdjacentPages) {
+    if (GetParam() != IO_BACKEND_URING) GTEST_SKIP() << "io_uring only";
+    attach(0, IO_SUBMIT_BATCH);
+    if (IsSkipped()) return;
+    constexpr ib_u32    N = IO_MERGE_MAX_IOVS;
+    std::vector<ib_i64> results(N, -1);
+    // Spawned in reverse: staging sorts them by offset
+    for (ib_u32 i = N; i-- > 0;) ASSERT_EQ(task_spawn(&worker, write_block(fd, i, &results[i])), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    for (ib_u32 i = 0; i < N; ++i) EXPECT_EQ(results[i], 512) << i;
+    EXPECT_EQ(iw.vectored_sqes, 1u);
+    EXPECT_EQ(iw.coalesced_requests, N);
+    EXPECT_EQ(iw.completed_total, N);
+    EXPECT_EQ(worker.poll_pending, 0u);
+    EXPECT_EQ(worker.classes[SCHED_CLASS_OLTP].acct.io_write_bytes, N * 512u);
+
+    char block[512];
+    for (ib_u32 i = 0; i < N; ++i) {
+        ASSERT_EQ(pread(fd, block, sizeof(block), (off_t)i * 512), 512);
+        EXPECT_EQ(block[0], 'a' + (int)(i % 26));
+        EXPECT_EQ(block[511], 'a' + (int)(i % 26));
+    }
+}
+
+TEST_P(IoFixture, ShortMergedReadIsSplitInFileOrder) {
+    if (GetParam() != IO_BACKEND_URING) GTEST_SKIP() << "io_uring only";
+    attach(0, IO_SUBMIT_BATCH);
+    if (IsSkipped()) return;
+    char data[4096 + 100];
+    std::memset(data, 'z', sizeof(data));
+    ASSERT_EQ(pwrite(fd, data, sizeof(data), 0), (ssize_t)sizeof(data));   // the file ends 100 bytes into the second page
+
+    char   back[3][4096];
+    ib_i64 results[3] = { -1, -1, -1 };
+    for (ib_u32 i = 0; i < 3; ++i) ASSERT_EQ(task_spawn(&worker, read_at(fd, back[i], 4096, i * 4096, &results[i])), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    EXPECT_EQ(iw.vectored_sqes, 1u);
+    EXPECT_EQ(results[0], 4096);
+    EXPECT_EQ(results[1], 100);
+    EXPECT_EQ(results[2], 0);
+    EXPECT_EQ(back[1][99], 'z');
+}
+
+TEST_P(IoFixture, VectoredWriteAndReadOfScatteredFrames) {
+    attach();
+    if (IsSkipped()) return;
+    std::vector<char> frames(4 * 4096, 0);
+    std::memset(frames.data(), 'p', 4096);
+    std::memset(frames.data() + 3 * 4096, 'q', 4096);
+    ib_i64 results[2] = { -1, -1 };
+    ASSERT_EQ(task_spawn(&worker, scatter_gather(fd, frames.data(), results)), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    EXPECT_EQ(results[0], 8192);
+    EXPECT_EQ(results[1], 8192);
+    EXPECT_EQ(frames[2 * 4096], 'p');
+    EXPECT_EQ(frames[2 * 4096 + 4095], 'p');
+    EXPECT_EQ(frames[4096], 'q');
+    EXPECT_EQ(frames[2 * 4096 - 1], 'q');
+    const ut_acct* acct = &worker.classes[SCHED_CLASS_OLTP].acct;
+    EXPECT_EQ(acct->io_write_bytes, 8192u);
+    EXPECT_EQ(acct->io_read_bytes, 8192u);
+}
+
+TEST_P(IoFixture, SqpollSubmitsWithoutSyscalls) {
+    if (GetParam() != IO_BACKEND_URING) GTEST_SKIP() << "io_uring only";
+    attach(0, IO_SUBMIT_SQPOLL, 50);
+    if (IsSkipped()) return;
+    if (iw.submit != IO_SUBMIT_SQPOLL) GTEST_SKIP() << "SQPOLL not permitted";
+    constexpr ib_u32    N = 32;
+    std::vector<ib_i64> results(N, -1);
+    for (ib_u32 i = 0; i < N; ++i) ASSERT_EQ(task_spawn(&worker, write_block(fd, i, &results[i])), 0);
+    sched_run(&worker);
+    io_worker_detach(&iw);
+
+    for (ib_u32 i = 0; i < N; ++i) EXPECT_EQ(results[i], 512) << i;
+    // Only wakeups of the polling thread enter the kernel
+    EXPECT_EQ(iw.enter_calls, iw.sqpoll_wakeups);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, IoFixture, ::testing::Values(IO_BACKEND_URING, IO_BACKEND_THREADS),
+                         [](const ::testing::TestParamInfo<io_backend>& info) {
+                             return std::string(info.param == IO_BACKEND_URING ? "Uring" : "Threads");
+                         });
+
+TEST(IO, SettingsAreRegisteredOnce) {
+    ASSERT_EQ(io_cfg_init(), 0);
+    EXPECT_EQ(io_cfg_init(), 0);
+    ib_cfg_type type;
+    ASSERT_EQ(ut_cfg_type_of("io_submit_policy", &type), 0);
+    EXPECT_EQ(type, IB_CFG_TEXT);
+    ASSERT_EQ(ut_cfg_type_of("io_coalesce", &type), 0);
+    EXPECT_EQ(type, IB_CFG_IBOOL);
+
+    const char*  names[256];
+    const ib_u32 n      = ut_cfg_names(names, 256);
+    ib_u32       sqpoll = 0;
+    for (ib_u32 i = 0; i < n && i < 256; ++i) sqpoll += std::strcmp(names[i], "io_sqpoll_idle_ms") == 0;
+    EXPECT_EQ(sqpoll, 1u);
+}
+
+TEST(IO, ThreadsBackendNeedsAPool) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    io_worker  iw;
+    io_options opts{};
+    opts.backend = IO_BACKEND_THREADS;
+    EXPECT_EQ(io_worker_init(&iw, &w, &opts), -EINVAL);
+    EXPECT_EQ(io_worker_of(&w), nullptr);
+}
+
+TEST(IO, WithoutAnIoWorkerTheSyscallRunsInline) {
+    task_test_env env;
+    ASSERT_EQ(task_test_env_init(&env), 0);
+    sched_worker* w = &env.worker;
+
+    char buf[16];
+    ib_i64 result = -1;
+    const int fd  = open("/dev/zero", O_RDONLY);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(task_spawn(w, read_at(fd, buf, sizeof(buf), 0, &result)), 0);
+    sched_run(w);
+    close(fd);
+    task_test_env_destroy(&env);
+
+    EXPECT_EQ(result, 16);
+    EXPECT_EQ(w->suspends[SCHED_SUSPEND_IO], 0u);
+    EXPECT_EQ(w->classes[SCHED_CLASS_OLTP].acct.io_read_bytes, 16u);
+}
+
+namespace {
+
+ib_async<void> set_policy(const char* policy, ib_err* err) {
+    *err = co_await ib_cfg_set(ib_state_hdl{ 0 }, "io_submit_policy", policy);
+}
+
+} // namespace
+
+TEST(IO, SubmitPolicyFollowsTheConfiguration) {
+    ASSERT_EQ(io_cfg_init(), 0);
+    task_test_env env;
+    ASSERT_EQ(task_test_env_init(&env), 0);
+    sched_worker* w = &env.worker;
+
+    ib_err ok = DB_ERROR, bad = DB_SUCCESS;
+    ASSERT_EQ(task_spawn(w, set_policy("batch", &ok)), 0);
+    ASSERT_EQ(task_spawn(w, set_policy("eventually", &bad)), 0);
+    sched_run(w);
+    EXPECT_EQ(ok, DB_SUCCESS);
+    EXPECT_EQ(bad, DB_INVALID_INPUT);
+
+    io_worker iw;
+    const int rc = io_worker_init(&iw, w);
+    if (rc == 0) {
+        EXPECT_EQ(iw.submit, IO_SUBMIT_BATCH);
+        EXPECT_TRUE(iw.submit_follows_cfg);
+        io_worker_detach(&iw);
+    }
+    ASSERT_EQ(task_spawn(w, set_policy("immediate", &ok)), 0);
+    sched_run(w);
+    EXPECT_EQ(ok, DB_SUCCESS);
+    task_test_env_destroy(&env);
+}
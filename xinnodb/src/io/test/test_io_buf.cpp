@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+
+#include "io.hpp" // IWYU pragma: keep
+
+TEST(IoBuf, FramesAreAlignedDistinctAndReusable) {
+    io_buf_pool pool;
+    ASSERT_EQ(io_buf_pool_init(&pool, 40, 16 * 1024), 0);
+    EXPECT_EQ((ib_uintptr)pool.base % IO_HUGE_PAGE_SIZE, 0u);
+    EXPECT_EQ(pool.map_size % IO_HUGE_PAGE_SIZE, 0u);
+
+    std::set<void*> frames;
+    for (ib_u32 i = 0; i < 40; ++i) {
+        void* f = io_buf_get(&pool);
+        ASSERT_NE(f, nullptr);
+        EXPECT_EQ((ib_uintptr)f % IO_DIRECT_ALIGN, 0u);
+        std::memset(f, (int)i, 16 * 1024);
+        frames.insert(f);
+    }
+    EXPECT_EQ(frames.size(), 40u);
+    EXPECT_EQ(io_buf_get(&pool), nullptr);
+    EXPECT_EQ(pool.free_count.load(), 0u);
+
+    void* back = *frames.begin();
+    io_buf_put(&pool, back);
+    EXPECT_EQ(io_buf_get(&pool), back);
+    for (void* f : frames) io_buf_put(&pool, f);
+    EXPECT_EQ(pool.free_count.load(), 40u);
+
+    const io_fixed_buffer region = io_buf_pool_region(&pool);
+    EXPECT_EQ(region.base, pool.base);
+    EXPECT_EQ(region.len, 40u * 16 * 1024);
+    io_buf_pool_destroy(&pool);
+}
+
+TEST(IoBuf, FrameSizeMustBeAlignedForDirectIo) {
+    io_buf_pool pool;
+    EXPECT_EQ(io_buf_pool_init(&pool, 4, 6000), -EINVAL);
+    EXPECT_EQ(io_buf_pool_init(&pool, 0, 4096), -EINVAL);
+}
+
+TEST(IoBuf, AlignmentCheckCoversEveryBufferOfAVector) {
+    alignas(4096) static char frames[3][4096];
+    io_request req;
+    io_request_init(&req, IO_OP_READ, 0, frames[0], 4096, 8192);
+    EXPECT_TRUE(io_request_aligned(&req));
+    io_request_init(&req, IO_OP_WRITE, 0, frames[0] + 512, 4096, 8192);
+    EXPECT_FALSE(io_request_aligned(&req));
+    io_request_init(&req, IO_OP_READ, 0, frames[0], 4096, 100);
+    EXPECT_FALSE(io_request_aligned(&req));
+
+    iovec iov[2] = { { frames[2], 4096 }, { frames[0], 4096 } };
+    io_request_init(&req, IO_OP_READV, 0, iov, 2, 0);
+    EXPECT_TRUE(io_request_aligned(&req));
+    iov[1].iov_len = 1000;
+    EXPECT_FALSE(io_request_aligned(&req));
+    io_request_init(&req, IO_OP_FSYNC, 0, nullptr, 0, 0);
+    EXPECT_TRUE(io_request_aligned(&req));
+}
+
+TEST(IoBuf, DirectFilesRejectMisalignedRequestsBeforeTheKernel) {
+    char path[] = "/var/tmp/xinnodb_io_buf_XXXXXX";
+    int  tmp    = mkstemp(path);
+    ASSERT_GE(tmp, 0);
+    close(tmp);
+    const int fd = io_file_open(path, O_RDWR);
+    unlink(path);
+    ASSERT_GE(fd, 0);
+    if (!io_fd_is_direct(fd)) {
+        io_file_close(fd);
+        GTEST_SKIP() << "no O_DIRECT on this filesystem";
+    }
+
+    io_buf_pool pool;
+    ASSERT_EQ(io_buf_pool_init(&pool, 2, 4096), 0);
+    char* frame = (char*)io_buf_get(&pool);
+    std::memset(frame, 'd', 4096);
+
+    // Outside of a task the awaiters run the syscall inline
+    io_awaiter good = io_write(fd, frame, 4096, 0);
+    EXPECT_FALSE(good.await_suspend({}));
+    EXPECT_EQ(good.await_resume(), 4096);
+    io_awaiter bad = io_read(fd, frame + 512, 512, 0);
+    EXPECT_FALSE(bad.await_suspend({}));
+    EXPECT_EQ(bad.await_resume(), -EINVAL);
+
+    io_buf_put(&pool, frame);
+    io_buf_pool_destroy(&pool);
+    EXPECT_EQ(io_file_close(fd), 0);
+    EXPECT_FALSE(io_fd_is_direct(fd));
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "io_sim.hpp"    // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+
+namespace {
+
+constexpr ib_u64 US = 1000;
+constexpr ib_u64 MS = 1000 * US;
+
+io_sim_options sim_options(ib_u64 seed) {
+    io_sim_options o{};
+    o.seed          = seed;
+    o.read_latency  = { IO_SIM_FIXED, 0, 100 * US, 0 };
+    o.write_latency = { IO_SIM_FIXED, 0, 200 * US, 0 };
+    o.fsync_latency = { IO_SIM_FIXED, 0, 1 * MS, 0 };
+    o.virtual_time  = true;
+    return o;
+}
+
+struct SimFixture : ::testing::Test, task_test_env {
+    io_sim_disk disk;
+    io_worker   iw;
+    bool        attached = false;
+
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this, 0, 256 * 1024), 0);
+    }
+
+    void TearDown() override {
+        if (attached) {
+            io_worker_detach(&iw);
+            io_sim_disk_destroy(&disk);
+        }
+        task_test_env_destroy(this);
+    }
+
+    void attach(const io_sim_options& o) {
+        ASSERT_EQ(io_sim_disk_init(&disk, &o), 0);
+        io_options opts{};
+        opts.backend = IO_BACKEND_SIM;
+        opts.sim     = &disk;
+        ASSERT_EQ(io_worker_init(&iw, &worker, &opts), 0);
+        ASSERT_EQ(iw.backend, IO_BACKEND_SIM);
+        attached = true;
+    }
+};
+
+struct Completion {
+    ib_i64  result;
+    ib_u32* order;
+    ib_u32  rank;
+};
+
+ib_async<void> sim_read(int fd, void* buf, ib_u64 len, ib_u64 off, Completion* c) {
+    c->result = co_await io_read(fd, buf, len, off);
+    c->rank   = (*c->order)++;
+}
+
+ib_async<void> sim_write(int fd, const void* buf, ib_u64 len, ib_u64 off, Completion* c) {
+    c->result = co_await io_write(fd, buf, len, off);
+    c->rank   = (*c->order)++;
+}
+
+ib_async<void> sim_write_sync(int fd, const void* buf, ib_u64 len, ib_u64 off, ib_i64* results) {
+    results[0] = co_await io_write(fd, buf, len, off);
+    results[1] = co_await io_fsync(fd);
+}
+
+} // namespace
+
+TEST_F(SimFixture, RequestsCompleteInOrderOfSimulatedServiceTime) {
+    attach(sim_options(1));
+    if (HasFatalFailure()) return;
+    const int fd = io_sim_open(&disk, "ibdata1", true);
+    ASSERT_GE(fd, IO_SIM_FD_BASE);
+    EXPECT_EQ(io_sim_open(&disk, "ibdata1", false), fd);
+    EXPECT_EQ(io_sim_open(&disk, "missing", false), -ENOENT);
+
+    char       page[4096], back[4096];
+    ib_u32     order = 0;
+    Completion w{ -1, &order, 0 }, r{ -1, &order, 0 }, eof{ -1, &order, 0 };
+    std::memset(page, 'w', sizeof(page));
+    ASSERT_EQ(task_spawn(&worker, sim_write(fd, page, sizeof(page), 0, &w)), 0);
+    ASSERT_EQ(task_spawn(&worker, sim_read(fd, back, sizeof(back), 0, &r)), 0);
+    ASSERT_EQ(task_spawn(&worker, sim_read(fd, back, sizeof(back), 1 << 20, &eof)), 0);
+    sched_run(&worker);
+
+    // The write is issued first, but the reads have half its latency
+    EXPECT_EQ(w.result, 4096);
+    EXPECT_EQ(r.result, 4096);
+    EXPECT_EQ(eof.result, 0);
+    EXPECT_EQ(w.rank, 2u);
+    EXPECT_EQ(back[4095], 'w');
+    EXPECT_EQ(io_sim_now(&disk), 200 * US);
+    EXPECT_EQ(worker.poll_pending, 0u);
+    EXPECT_EQ(worker.classes[SCHED_CLASS_OLTP].acct.io_write_bytes, 4096u);
+}
+
+TEST_F(SimFixture, BandwidthCapSerializesTransfers) {
+    io_sim_options o = sim_options(2);
+    o.bandwidth      = 64 * 1024 * 1000;   // 1 ms per 64 KiB
+    o.write_latency  = { IO_SIM_FIXED, 0, 0, 0 };
+    attach(o);
+    if (HasFatalFailure()) return;
+    const int fd = io_sim_open(&disk, "ibdata1", true);
+
+    std::vector<char>       data(64 * 1024, 'b');
+    ib_u32                  order = 0;
+    std::vector<Completion> c(4, Completion{ -1, &order, 0 });
+    for (ib_u32 i = 0; i < 4; ++i) ASSERT_EQ(task_spawn(&worker, sim_write(fd, data.data(), data.size(), i * data.size(), &c[i])), 0);
+    sched_run(&worker);
+
+    for (ib_u32 i = 0; i < 4; ++i) {
+        EXPECT_EQ(c[i].result, 64 * 1024);
+        EXPECT_EQ(c[i].rank, i);
+    }
+    EXPECT_EQ(io_sim_now(&disk), 4 * MS);
+    EXPECT_EQ(io_sim_file_size(&disk, fd), 256u * 1024);
+}
+
+TEST_F(SimFixture, InjectedAndRandomFaultsReachTheTask) {
+    io_sim_options o = sim_options(3);
+    o.capacity       = 8192;
+    attach(o);
+    if (HasFatalFailure()) return;
+    const int fd = io_sim_open(&disk, "ibdata1", true);
+
+    char       page[4096] = {};
+    ib_u32     order      = 0;
+    Completion c[4]       = { { -1, &order, 0 }, { -1, &order, 0 }, { -1, &order, 0 }, { -1, &order, 0 } };
+    ASSERT_EQ(io_sim_inject(ENOSPC), 0);
+    EXPECT_EQ(io_sim_inject(EPERM), -EINVAL);
+    ASSERT_EQ(task_spawn(&worker, sim_read(fd, page, sizeof(page), 0, &c[0])), 0);   // ENOSPC skips reads
+    ASSERT_EQ(task_spawn(&worker, sim_write(fd, page, sizeof(page), 0, &c[1])), 0);
+    ASSERT_EQ(task_spawn(&worker, sim_write(fd, page, sizeof(page), 0, &c[2])), 0);
+    ASSERT_EQ(task_spawn(&worker, sim_write(fd, page, sizeof(page), 8192, &c[3])), 0);   // over capacity
+    sched_run(&worker);
+    EXPECT_EQ(c[0].result, 0);
+    EXPECT_EQ(c[1].result, -ENOSPC);
+    EXPECT_EQ(c[2].result, 4096);
+    EXPECT_EQ(c[3].result, -ENOSPC);
+
+    ASSERT_EQ(io_sim_inject(EIO), 0);
+    ASSERT_EQ(task_spawn(&worker, sim_read(fd, page, sizeof(page), 0, &c[0])), 0);
+    sched_run(&worker);
+    EXPECT_EQ(c[0].result, -EIO);
+    EXPECT_EQ(disk.errors, 3u);
+}
+
+TEST_F(SimFixture, CrashKeepsSyncedDataAndDropsLostFsyncs) {
+    attach(sim_options(4));
+    if (HasFatalFailure()) return;
+    const int fd = io_sim_open(&disk, "ib_logfile0", true);
+
+    char   a[4096], b[4096];
+    ib_i64 ra[2] = { -1, -1 }, rb[2] = { -1, -1 };
+    std::memset(a, 'a', sizeof(a));
+    std::memset(b, 'b', sizeof(b));
+    ASSERT_EQ(task_spawn(&worker, sim_write_sync(fd, a, sizeof(a), 0, ra)), 0);
+    sched_run(&worker);
+    ASSERT_EQ(io_sim_inject(IO_SIM_FAULT_LOST_FSYNC), 0);
+    ASSERT_EQ(task_spawn(&worker, sim_write_sync(fd, b, sizeof(b), 4096, rb)), 0);
+    sched_run(&worker);
+    EXPECT_EQ(ra[0], 4096);
+    EXPECT_EQ(ra[1], 0);
+    EXPECT_EQ(rb[0], 4096);
+    EXPECT_EQ(rb[1], 0);   // acknowledged...
+    EXPECT_EQ(io_sim_file_size(&disk, fd), 8192u);
+
+    io_sim_crash(&disk);
+    EXPECT_EQ(io_sim_file_size(&disk, fd), 4096u);   // ...but lost
+    EXPECT_EQ(disk.lost_fsyncs, 1u);
+    EXPECT_EQ(disk.files[fd - IO_SIM_FD_BASE].data[4095], 'a');
+}
+
+TEST(IoSim, CrashesTearAndReorderUnsyncedWritesReproducibly) {
+    auto run = [](ib_u64 seed, std::vector<char>* image, ib_u64* torn) {
+        io_sim_options o    = sim_options(seed);
+        o.reorder           = true;
+        o.torn_write_one_in = 2;
+        io_sim_disk disk;
+        ASSERT_EQ(io_sim_disk_init(&disk, &o), 0);
+        const int fd = io_sim_open(&disk, "t", true);
+        char      page[4096];
+        for (ib_u32 i = 0; i < 8; ++i) {
+            std::memset(page, '0' + (int)i, sizeof(page));
+            io_request req;
+            io_request_init(&req, IO_OP_WRITE, fd, page, sizeof(page), (i % 4) * 4096);
+            io_sim_start(&disk, &req);
+            ASSERT_EQ(req.result, 4096);
+        }
+        io_sim_crash(&disk);
+        const io_sim_file* f = &disk.files[fd - IO_SIM_FD_BASE];
+        image->assign(f->data, f->data + f->size);
+        *torn = disk.torn_writes;
+        io_sim_disk_destroy(&disk);
+    };
+
+    ib_u64 torn_total = 0, reordered = 0;
+    for (ib_u64 seed = 1; seed <= 32; ++seed) {
+        std::vector<char> first, second;
+        ib_u64            torn = 0, torn_again = 0;
+        run(seed, &first, &torn);
+        run(seed, &second, &torn_again);
+        EXPECT_EQ(first, second) << seed;
+        EXPECT_EQ(torn, torn_again);
+        torn_total += torn;
+        // Each sector holds one write's data, or zeros where nothing landed
+        for (ib_u64 s = 0; s < first.size(); s += IO_SIM_SECTOR_SIZE) {
+            for (ib_u64 i = 1; i < IO_SIM_SECTOR_SIZE && s + i < first.size(); ++i) ASSERT_EQ(first[s + i], first[s]);
+        }
+        // Page 0 got writes '0' then '4': ending with '0' means the older write landed last
+        reordered += !first.empty() && first[0] == '0';
+    }
+    EXPECT_GT(torn_total, 0u);
+    EXPECT_GT(reordered, 0u);
+}
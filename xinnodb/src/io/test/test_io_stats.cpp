@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+
+#include "io_sim.hpp"    // IWYU pragma: keep
+#include "io_stats.hpp"  // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+
+namespace {
+
+constexpr ib_u64 US = 1000;
+
+/// Two workers with their own io_worker on one simulated disk, each recording on its own shard
+struct StatsFixture : ::testing::Test {
+    static constexpr ib_u32 WORKERS = 2;
+
+    task_test_env env[WORKERS];
+    io_worker     iw[WORKERS];
+    io_sim_disk   disk;
+    std::unique_ptr<io_stats_shard[]> shards{ new io_stats_shard[WORKERS] };
+    std::unique_ptr<io_stats>         stats{ new io_stats };
+
+    void SetUp() override {
+        io_sim_options o{};
+        o.read_latency  = { IO_SIM_FIXED, 0, 100 * US, 0 };
+        o.write_latency = { IO_SIM_FIXED, 0, 20 * US, 0 };
+        o.fsync_latency = { IO_SIM_FIXED, 0, 2000 * US, 0 };
+        o.virtual_time  = true;
+        ASSERT_EQ(io_sim_disk_init(&disk, &o), 0);
+        ASSERT_EQ(io_stats_register(stats.get(), shards.get(), WORKERS), 0);
+        for (ib_u32 i = 0; i < WORKERS; ++i) {
+            ASSERT_EQ(task_test_env_init(&env[i], i, 128 * 1024), 0);
+            io_options opts{};
+            opts.backend = IO_BACKEND_SIM;
+            opts.sim     = &disk;
+            ASSERT_EQ(io_worker_init(&iw[i], &env[i].worker, &opts), 0);
+            io_stats_attach(&iw[i], stats.get(), i);
+        }
+    }
+
+    void TearDown() override {
+        io_stats_unregister(stats.get());
+        for (ib_u32 i = 0; i < WORKERS; ++i) {
+            io_worker_detach(&iw[i]);
+            task_test_env_destroy(&env[i]);
+        }
+        io_sim_disk_destroy(&disk);
+    }
+
+    static ib_i64 status(const char* name) {
+        ib_i64 v = -1;
+        EXPECT_EQ(ut_status_get_i64(name, &v), 0) << name;
+        return v;
+    }
+};
+
+ib_async<void> page_traffic(int fd, ib_u32 reads, bool readahead) {
+    char page[4096] = {};
+    for (ib_u32 i = 0; i < reads; ++i) co_await io_read(fd, page, sizeof(page), 0);
+    if (readahead) co_await io_readahead(fd, page, sizeof(page), 0);
+    co_await io_write(fd, page, sizeof(page), 4096);
+    co_await io_fsync(fd);
+}
+
+} // namespace
+
+TEST_F(StatsFixture, HistogramsAreShardedPerWorkerAndMergedOnRead) {
+    const int data = io_sim_open(&disk, "ibdata1", true);
+    const int log  = io_sim_open(&disk, "ib_logfile0", true);
+    ASSERT_EQ(io_stats_track_file(stats.get(), data, "ibdata1"), 0);
+    EXPECT_EQ(io_stats_track_file(stats.get(), log, "a_name_longer_than_the_limit"), -1);
+
+    ASSERT_EQ(task_spawn(&env[0].worker, page_traffic(data, 3, true)), 0);
+    ASSERT_EQ(task_spawn(&env[1].worker, page_traffic(log, 5, false)), 0);
+    sched_run(&env[0].worker);
+    sched_run(&env[1].worker);
+
+    EXPECT_EQ(shards[0].hist[0][IO_STAT_READ].count, 3u);
+    EXPECT_EQ(shards[1].hist[0][IO_STAT_READ].count, 5u);
+    EXPECT_EQ(status("io.all.read.count"), 8);
+    EXPECT_EQ(status("io.all.readahead.count"), 1);
+    EXPECT_EQ(status("io.all.write.count"), 2);
+    EXPECT_EQ(status("io.all.fsync.count"), 2);
+    EXPECT_EQ(status("io.ibdata1.read.count"), 3);
+    EXPECT_EQ(status("io.ibdata1.fsync.count"), 1);
+
+    // Latencies come from the disk clock: exact up to the bucket width (1/32)
+    EXPECT_EQ(status("io.all.read.max_ns"), (ib_i64)(100 * US));
+    EXPECT_GE(status("io.all.read.p50_ns"), (ib_i64)(100 * US * 31 / 32));
+    EXPECT_LE(status("io.all.read.p50_ns"), (ib_i64)(100 * US));
+    EXPECT_EQ(status("io.all.fsync.p999_ns"), (ib_i64)(2000 * US));
+    EXPECT_EQ(status("io.ibdata1.write.max_ns"), (ib_i64)(20 * US));
+}
+
+TEST_F(StatsFixture, NamesAreListedAndWithdrawn) {
+    const char* names[1024];
+    const ib_u32 n = ut_status_names(names, 1024);
+    int          found = 0;
+    for (ib_u32 i = 0; i < n && i < 1024; ++i) found += std::strncmp(names[i], "io.all.", 7) == 0;
+    EXPECT_EQ(found, (int)(IO_STAT_OPS * IO_STATS_FIELDS));
+
+    auto other       = std::make_unique<io_stats>();
+    auto other_shard = std::make_unique<io_stats_shard>();
+    EXPECT_EQ(io_stats_register(other.get(), other_shard.get(), 1), -1);   // the names are taken
+    ib_i64 v = 0;
+    EXPECT_EQ(ut_status_get_i64("io.all.fsync.p99_ns", &v), 0);
+}
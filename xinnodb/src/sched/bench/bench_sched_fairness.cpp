@@ -0,0 +1,96 @@
+// Latency fairness benchmark: point lookups sharing one worker with a long range scan.
+// A generator task releases a point lookup every BENCH_ARRIVAL_NS; each lookup records the time from
+// its release to its completion. The scan runs either as one OLTP task without preemption points
+// or as a background task that passes a checkpoint per row. The generator polls the clock as an
+// OLTP task and so takes the OLTP share of the worker: scan rows/s is what is left to the scan.
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "sched.hpp"
+
+constexpr ib_u64 BENCH_RUN_NS     = 500'000'000;
+constexpr ib_u64 BENCH_ARRIVAL_NS = 20'000;
+constexpr ib_u32 BENCH_ROW_SPIN   = 200;
+constexpr ib_u32 BENCH_SCAN_CHUNK = 20'000;     ///< Rows per step of the unpreempted scan
+
+struct bench_state {
+    ib_u64              stop_ns;
+    ib_u64              next_release_ns;
+    bool                preemptible;
+    std::vector<ib_u64> latencies;
+    std::vector<sched_task> points;
+    ib_u64              released;
+    ib_u64              rows;
+};
+
+static bench_state* bench;
+
+static void bench_row() noexcept {
+    volatile ib_u32 x = 0;
+    for (ib_u32 i = 0; i < BENCH_ROW_SPIN; ++i) x = x + i;
+    ++bench->rows;
+}
+
+static void bench_scan_step(sched_worker*, sched_task* t) noexcept {
+    if (ut_clock_ns(UT_CLOCK_MONOTONIC) >= bench->stop_ns) return;
+    if (bench->preemptible) {
+        for (;;) {
+            bench_row();
+            if (sched_checkpoint(t, bench_scan_step)) return;
+        }
+    }
+    for (ib_u32 i = 0; i < BENCH_SCAN_CHUNK; ++i) bench_row();
+    sched_yield(t, bench_scan_step);
+}
+
+static void bench_point_step(sched_worker*, sched_task* t) noexcept {
+    const ib_u64 released = (ib_u64)(std::uintptr_t)t->arg;
+    bench->latencies.push_back(ut_clock_ns(UT_CLOCK_MONOTONIC) - released);
+}
+
+static void bench_generator_step(sched_worker* w, sched_task* t) noexcept {
+    const ib_u64 now = ut_clock_ns(UT_CLOCK_MONOTONIC);
+    if (now >= bench->stop_ns) return;
+    while (bench->next_release_ns <= now && bench->released < bench->points.size()) {
+        sched_task* p = &bench->points[bench->released++];
+        sched_task_init(p, bench_point_step, (void*)(std::uintptr_t)bench->next_release_ns);
+        sched_spawn(w, p);
+        bench->next_release_ns += BENCH_ARRIVAL_NS;
+    }
+    sched_yield(t, bench_generator_step);
+}
+
+static void bench_run(const char* name, bool preemptible) {
+    bench_state state{};
+    bench              = &state;
+    state.preemptible  = preemptible;
+    state.points.resize(BENCH_RUN_NS / BENCH_ARRIVAL_NS + 1);
+    state.latencies.reserve(state.points.size());
+
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_task scan, generator;
+    sched_task_init(&scan, bench_scan_step, nullptr);
+    sched_task_init(&generator, bench_generator_step, nullptr);
+    if (preemptible) scan.cls = SCHED_CLASS_BACKGROUND;
+    state.stop_ns         = ut_clock_ns(UT_CLOCK_MONOTONIC) + BENCH_RUN_NS;
+    state.next_release_ns = ut_clock_ns(UT_CLOCK_MONOTONIC);
+    sched_spawn(&w, &scan);
+    sched_spawn(&w, &generator);
+    sched_run(&w);
+
+    auto& l = state.latencies;
+    std::sort(l.begin(), l.end());
+    auto pct = [&](double p) { return l.empty() ? 0.0 : l[(size_t)(p * (l.size() - 1))] / 1e3; };
+    fmt::print("{:<22} {:>7} lookups p50 {:>8.1f} us p99 {:>8.1f} us max {:>8.1f} us  scan {:>6.2f} M rows/s\n", name,
+               l.size(), pct(0.5), pct(0.99), pct(1.0), state.rows * 1e3 / BENCH_RUN_NS);
+}
+
+int main() {
+    bench_run("scan oltp, no budget", false);
+    bench_run("scan background", true);
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Worker pool scaling benchmark: throughput of short point-lookup tasks over 1..N workers.
+// A client thread injects batches of lookup tasks; each task probes an open-addressing hash table
+// and spawns a follow-up lookup on its worker, so the run mixes injection, local spawns and steals.
+
+#include <fmt/format.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "sched_pool.hpp"
+
+constexpr ib_u64 BENCH_KEYS          = 1 << 20;
+constexpr ib_u64 BENCH_ROOT_TASKS    = 1 << 16;
+constexpr ib_u32 BENCH_LOOKUPS_CHAIN = 16;
+
+using bench_clock = std::chrono::steady_clock;
+
+struct bench_table {
+    std::vector<ib_u64> keys;
+    std::vector<ib_u64> values;
+    ib_u64              mask;
+};
+
+struct bench_lookup {
+    sched_task   task;
+    bench_table* table;
+    ib_u32       left;
+    ib_u64       sum;
+};
+
+static ib_u64 bench_hash(ib_u64 k) noexcept {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    return k;
+}
+
+static ib_u64 bench_probe(const bench_table* t, ib_u64 key) noexcept {
+    for (ib_u64 i = bench_hash(key) & t->mask;; i = (i + 1) & t->mask) {
+        if (t->keys[i] == key) return t->values[i];
+        if (t->keys[i] == 0) return 0;
+    }
+}
+
+static void bench_lookup_step(sched_worker*, sched_task* st) noexcept {
+    bench_lookup* l = (bench_lookup*)st;
+    l->sum += bench_probe(l->table, 1 + ut_rnd_bounded(&st->rnd, BENCH_KEYS));
+    // Point lookups of a transaction are separate steps: the task can move between them
+    if (--l->left != 0) sched_yield(st, bench_lookup_step);
+}
+
+static void bench_run(bench_table* table, ib_u32 workers) {
+    std::unique_ptr<sched_worker[]> ws(new sched_worker[workers]);
+    std::unique_ptr<sched_pool>     pool(new sched_pool);
+    sched_pool_init(pool.get(), ws.get(), workers);
+    std::vector<bench_lookup> lookups(BENCH_ROOT_TASKS);
+    for (auto& l : lookups) {
+        sched_task_init(&l.task, bench_lookup_step, nullptr);
+        l.table = table;
+        l.left  = BENCH_LOOKUPS_CHAIN;
+        l.sum   = 0;
+    }
+    sched_pool_start(pool.get());
+    auto begin = bench_clock::now();
+    for (auto& l : lookups) sched_pool_inject(pool.get(), &l.task);
+    sched_pool_wait_idle(pool.get());
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - begin).count();
+    sched_pool_stop(pool.get());
+
+    ib_u64 steals = 0, stolen = 0, parks = 0;
+    for (ib_u32 i = 0; i < workers; ++i) {
+        steals += ws[i].steals;
+        stolen += ws[i].stolen_tasks;
+        parks  += ws[i].parks;
+    }
+    const ib_u64 lookups_done = BENCH_ROOT_TASKS * BENCH_LOOKUPS_CHAIN;
+    fmt::print("{:>3} workers {:>8.2f} M lookups/s {:>8} steals {:>9} stolen {:>7} parks\n", workers,
+               lookups_done * 1e3 / ns, steals, stolen, parks);
+}
+
+int main() {
+    bench_table table;
+    table.keys.assign(BENCH_KEYS * 2, 0);
+    table.values.assign(BENCH_KEYS * 2, 0);
+    table.mask = BENCH_KEYS * 2 - 1;
+    for (ib_u64 k = 1; k <= BENCH_KEYS; ++k) {
+        ib_u64 i = bench_hash(k) & table.mask;
+        while (table.keys[i] != 0) i = (i + 1) & table.mask;
+        table.keys[i]   = k;
+        table.values[i] = k * 7;
+    }
+    const ib_u32 cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (ib_u32 n = 1; n <= cpus && n <= SCHED_POOL_MAX_WORKERS; n *= 2) bench_run(&table, n);
+    if ((cpus & (cpus - 1)) != 0) bench_run(&table, cpus);
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Context switch benchmark: sched_yield() continuations vs C++20 coroutines vs ucontext.
+// Each variant ping-pongs between two tasks; one switch is one hand-off from a task to the next.
+
+#include <fmt/format.h>
+#include <chrono>
+#include <coroutine>
+#include <ucontext.h>
+
+#include "sched.hpp"
+
+constexpr ib_u64 BENCH_SWITCHES = 20'000'000;
+
+using bench_clock = std::chrono::steady_clock;
+
+static void bench_report(const char* name, ib_u64 switches, bench_clock::time_point begin) {
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - begin).count();
+    fmt::print("{:<12} {:>12} switches {:>8.2f} ns/switch {:>8.1f} M switches/s\n", name, switches, ns / switches, switches * 1e3 / ns);
+}
+
+// -----------------------------------------------------------------------------
+// sched continuations
+// -----------------------------------------------------------------------------
+
+static void bench_sched_step(sched_worker*, sched_task* t) noexcept {
+    ib_u64* left = static_cast<ib_u64*>(t->arg);
+    if (--*left != 0) sched_yield(t, bench_sched_step);
+}
+
+static void bench_sched() {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    ib_u64 left_a = BENCH_SWITCHES / 2, left_b = BENCH_SWITCHES / 2;
+    sched_task a, b;
+    sched_task_init(&a, bench_sched_step, &left_a);
+    sched_task_init(&b, bench_sched_step, &left_b);
+    sched_spawn(&w, &a);
+    sched_spawn(&w, &b);
+    auto begin = bench_clock::now();
+    sched_run(&w);
+    bench_report("sched", w.switches, begin);
+}
+
+// -----------------------------------------------------------------------------
+// C++20 coroutines driven by a round-robin loop
+// -----------------------------------------------------------------------------
+
+struct bench_coro {
+    struct promise_type {
+        bench_coro          get_return_object() noexcept { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void                return_void() noexcept {}
+        void                unhandled_exception() noexcept {}
+    };
+    std::coroutine_handle<promise_type> handle;
+};
+
+static bench_coro bench_coro_body(ib_u64 n) {
+    while (n-- != 0) co_await std::suspend_always{};
+}
+
+static void bench_coroutines() {
+    bench_coro a = bench_coro_body(BENCH_SWITCHES / 2);
+    bench_coro b = bench_coro_body(BENCH_SWITCHES / 2);
+    std::coroutine_handle<> ring[2] = { a.handle, b.handle };
+    ib_u64 switches = 0;
+    auto begin = bench_clock::now();
+    for (ib_u32 i = 0; !a.handle.done() || !b.handle.done(); i ^= 1) {
+        if (ring[i].done()) continue;
+        ring[i].resume();
+        ++switches;
+    }
+    bench_report("coroutine", switches, begin);
+    a.handle.destroy();
+    b.handle.destroy();
+}
+
+// -----------------------------------------------------------------------------
+// ucontext
+// -----------------------------------------------------------------------------
+
+static ucontext_t bench_uctx_main, bench_uctx[2];
+static ib_u64     bench_uctx_switches;
+
+static void bench_uctx_body(int self) {
+    for (ib_u64 i = 0; i < BENCH_SWITCHES / 4; ++i) {
+        ++bench_uctx_switches;
+        swapcontext(&bench_uctx[self], &bench_uctx[self ^ 1]);
+    }
+}
+
+static void bench_ucontext() {
+    alignas(64) static char stacks[2][64 * 1024];
+    for (int i = 0; i < 2; ++i) {
+        getcontext(&bench_uctx[i]);
+        bench_uctx[i].uc_stack.ss_sp   = stacks[i];
+        bench_uctx[i].uc_stack.ss_size = sizeof(stacks[i]);
+        bench_uctx[i].uc_link          = &bench_uctx_main;
+        makecontext(&bench_uctx[i], (void (*)())bench_uctx_body, 1, i);
+    }
+    auto begin = bench_clock::now();
+    swapcontext(&bench_uctx_main, &bench_uctx[0]);
+    bench_report("ucontext", bench_uctx_switches, begin);
+}
+
+int main() {
+    bench_sched();
+    bench_coroutines();
+    bench_ucontext();
+    return 0;
+}
@@ -0,0 +1,394 @@
+#pragma once
+
+#include "xinnodb.hpp"               // IWYU pragma: keep
+#include "ut.hpp"                    // IWYU pragma: keep
+#include "ut_assert.hpp"             // IWYU pragma: keep
+#include "ut_dlink.hpp"              // IWYU pragma: keep
+#include "ut_ebr.hpp"                // IWYU pragma: keep
+#include "ut_rnd.hpp"                // IWYU pragma: keep
+#include "ut_clock.hpp"              // IWYU pragma: keep
+#include "ut_acct.hpp"               // IWYU pragma: keep
+#include "sched_frame.hpp"           // IWYU pragma: keep
+
+#include <atomic>
+
+/// \defgroup sched sched
+/// \ingroup components
+/// \brief Cooperative task scheduler
+/// \details One `sched_worker` per core runs a loop over an intrusive FIFO of ready tasks. A task is
+/// a continuation: a step function plus the `sched_task` context it runs on. A step runs to
+/// completion on the worker stack and, before returning to the loop, says what happens next:
+///
+/// - sched_yield(): requeue at the tail and continue with `next` on the next turn;
+/// - sched_suspend(): park until someone calls sched_resume() (I/O completion, latch release,
+///   memory becoming available, timer expiry), then continue with `next`;
+/// - plain return: the task is done and its `on_exit` callback runs.
+///
+/// Because a step always returns to the loop, no stack grows across switches and a switch costs an
+/// indirect call plus two list operations. C++20 coroutine tasks (`ib_async`) are driven by a step
+/// that resumes the coroutine handle. The `co_do` tail calls of task/example/tail_call.hpp are a
+/// standalone primitive: they need clang's `preserve_none`, the loop does not use them and
+/// bench_sched_switch does not measure them. A chain of them can only run inside one step; the
+/// frames its co_spill calls pack live in the task's `co_arena` (sched_frame.hpp), which the loop
+/// makes current for each step, so chains of interleaved or stolen tasks never share them.
+///
+/// Subsystems that complete work outside of tasks (I/O rings, timer wheels) register a
+/// `sched_poller`; the loop polls them when it runs out of ready tasks and between batches.
+/// Every task boundary is a quiescent point for the worker's EBR participant.
+///
+/// Ready tasks live in a bounded ring that the owner fills and drains FIFO and that idle siblings
+/// of a `sched_pool` steal half of at a time; tasks that do not fit spill to a local overflow list.
+/// Everything else in a worker is owned by its thread. sched_resume() may be called from any
+/// thread: resumes for another worker go through that worker's lock-free inbox. sched_resume_list()
+/// wakes a whole queue of waiters with one splice per worker instead of one enqueue per task.
+///
+/// Every task belongs to a priority class. OLTP tasks use the stealable ring; background and
+/// maintenance tasks wait on per-class lists of their worker. The loop shares the worker between
+/// classes by weighted fair queueing: each class has a virtual time that advances by the TSC cycles
+/// its steps consumed divided by its weight, and the non-empty class with the smallest virtual
+/// time runs next. A step that runs long is preempted cooperatively: sched_budget_exceeded() (and
+/// sched_checkpoint(), and every `ib_async` await) compares the iterations and cycles of the
+/// current step with the budget of the task's class and requeues the task once it is used up.
+///
+/// Tasks carry task-local slots (transaction, session) read with sched_local() from whatever code
+/// runs on their behalf, and a `ut_acct` that the run loop publishes while their steps run so the
+/// allocator, the I/O layer and the scheduler can charge it; see ut_acct.hpp.
+///
+/// A worker with a `sched_trace` attached records every task transition (create, run, yield,
+/// suspend with its reason, resume, complete, steal) with a TSC timestamp into a ring; see
+/// sched_trace.hpp. Without one, each hook costs a test of `w->trace`.
+///
+/// In simulation mode (`sched_sim`) a standalone worker picks ready tasks with a seeded PRNG and
+/// logs every decision so that an interleaving can be replayed exactly.
+
+/// \addtogroup sched
+/// @{
+
+/// \brief Maximum number of tasks run between two poller passes
+constexpr ib_u32 SCHED_RUN_BATCH = 64;
+
+/// \brief Capacity of the stealable ready ring of a worker (power of two)
+constexpr ib_u32 SCHED_RUNQ_SIZE = 256;
+
+/// \brief Budget checks between two TSC reads in sched_budget_exceeded()
+constexpr ib_u32 SCHED_BUDGET_TSC_INTERVAL = 16;
+
+/// \brief Priority class of a task
+enum sched_class : ib_u32 {
+    SCHED_CLASS_OLTP        = 0,    ///< Point queries and short transactions
+    SCHED_CLASS_BACKGROUND  = 1,    ///< Long scans, bulk loads
+    SCHED_CLASS_MAINTENANCE = 2,    ///< Purge, flushing, statistics
+    SCHED_CLASS_COUNT
+};
+
+/// \brief Lifecycle of a task
+enum sched_task_state : ib_u32 {
+    SCHED_TASK_CREATED   = 0,
+    SCHED_TASK_READY     = 1,
+    SCHED_TASK_RUNNING   = 2,
+    SCHED_TASK_SUSPENDED = 3,
+    SCHED_TASK_DONE      = 4,
+};
+
+/// \brief Why a task is suspended (statistics and tracing)
+enum sched_suspend_reason : ib_u32 {
+    SCHED_SUSPEND_NONE  = 0,
+    SCHED_SUSPEND_IO    = 1,
+    SCHED_SUSPEND_LATCH = 2,
+    SCHED_SUSPEND_ALLOC = 3,
+    SCHED_SUSPEND_TIMER = 4,
+    SCHED_SUSPEND_EVENT = 5,
+    SCHED_SUSPEND_REASON_COUNT
+};
+
+/// \brief Task transition recorded by the tracer
+enum sched_trace_kind : ib_u8 {
+    SCHED_TRACE_CREATE   = 1,   ///< arg: 1 if taken from the pool injection queue
+    SCHED_TRACE_RUN      = 2,   ///< A step starts
+    SCHED_TRACE_YIELD    = 3,   ///< The step ended with the task requeued
+    SCHED_TRACE_SUSPEND  = 4,   ///< The step ended with the task parked; arg: sched_suspend_reason
+    SCHED_TRACE_COMPLETE = 5,   ///< The step ended with the task finished
+    SCHED_TRACE_RESUME   = 6,   ///< arg: 1 if the resume came through the inbox
+    SCHED_TRACE_STEAL    = 7,   ///< arg: index of the victim worker
+};
+
+/// \brief Task-local storage slots
+enum sched_local_slot : ib_u32 {
+    SCHED_LOCAL_TRX   = 0,  ///< Transaction the task works for
+    SCHED_LOCAL_PCA   = 1,  ///< Private client area: the session
+    SCHED_LOCAL_USER  = 2,  ///< First slot free for other layers
+    SCHED_LOCAL_COUNT = 4
+};
+
+/// \brief Per-worker state slots of the modules layered on the scheduler
+enum sched_ext : ib_u32 {
+    SCHED_EXT_TASK  = 0,    ///< task_worker: coroutine frame allocator
+    SCHED_EXT_TIMER = 1,    ///< sched_timer_wheel: sleeps and timeouts
+    SCHED_EXT_PWA   = 2,    ///< Private worker area, see sched_pwa()
+    SCHED_EXT_IO    = 3,    ///< io_worker: file I/O rings
+    SCHED_EXT_SYNC  = 4,    ///< sync_shm_worker: tasks waiting for cross-process latches
+    SCHED_EXT_COUNT = 8
+};
+
+struct sched_worker;
+struct sched_task;
+struct sched_pool;
+struct sched_sim;
+struct sched_trace;
+
+/// \brief A task step: runs on the worker stack and returns to the run loop
+using sched_fn = void(sched_worker* w, sched_task* t) noexcept;
+
+/// \brief Called once when a task finishes; may free the task
+using sched_exit_fn = void(sched_worker* w, sched_task* t) noexcept;
+
+/// \brief Continuation context of a task
+struct sched_task {
+    ut_dlink             link;           ///< Ready queue or waiter queue membership
+    sched_fn*            fn;             ///< Next step
+    void*                arg;            ///< Step argument (owned by the caller)
+    sched_exit_fn*       on_exit;
+    sched_worker*        worker;         ///< Worker that last ran the task (changes on steals)
+    sched_task*          inbox_next;     ///< Remote resume inbox link
+    ib_u64               id;
+    sched_task_state     state;
+    sched_suspend_reason suspend_reason;
+    sched_class          cls;            ///< Priority class, OLTP unless set before spawn
+    ut_rnd               rnd;            ///< Per-task PRNG, forked from the worker on spawn
+    void*                locals[SCHED_LOCAL_COUNT];
+    ut_acct              acct;           ///< Resources consumed so far
+    co_arena*            arena;          ///< Frames of its co_spill calls; nullptr: the worker thread's
+};
+
+/// \brief Polls a completion source; returns the number of tasks it resumed
+using sched_poll_fn = ib_u64(sched_worker* w, void* ctx) noexcept;
+
+/// \brief Completion source polled by the run loop
+struct sched_poller {
+    ut_dlink       link;
+    sched_poll_fn* poll;
+    void*          ctx;
+};
+
+/// \brief Stealable FIFO ring of ready tasks
+/// \details Single producer (the owner pushes at `tail`), multiple consumers (the owner and thieves
+/// advance `head` with a CAS).
+struct sched_runq {
+    alignas(64) std::atomic<ib_u32> head;
+    alignas(64) std::atomic<ib_u32> tail;
+    std::atomic<sched_task*>        slots[SCHED_RUNQ_SIZE];
+};
+
+/// \brief Fair-queueing state of one priority class on a worker
+struct sched_class_state {
+    ut_dlink ready;             ///< Ready tasks (background and maintenance; OLTP uses the ring)
+    ib_u64   ready_count;
+    ib_u64   vtime;             ///< Cycles run divided by the weight
+    ib_u32   weight;
+    ib_u32   budget_iters;      ///< Checkpoints per step before a preemption, 0 for no limit
+    ib_u64   budget_cycles;     ///< TSC cycles per step before a preemption
+    ib_u64   cycles;            ///< Statistics
+    ib_u64   steps;
+    ib_u64   preemptions;
+    ib_u64   finished;          ///< Tasks finished, their accounts are summed in `acct`
+    ut_acct  acct;
+};
+
+/// \brief Per-worker scheduler state
+struct sched_worker {
+    sched_runq                runq;
+    ut_dlink                  ready;           ///< Overflow FIFO of ready tasks (not stealable)
+    ib_u64                    ready_overflow;
+    alignas(64) std::atomic<sched_task*> inbox; ///< Tasks resumed by other threads (LIFO)
+    std::atomic<ib_u32>       sleeping;        ///< Futex word: 1 while parked in the pool
+    alignas(64) ut_dlink      pollers;
+    sched_task*               current;
+    sched_pool*               pool;            ///< nullptr for a standalone worker
+    sched_sim*                sim;             ///< Deterministic simulation mode when not nullptr
+    ut_ebr_participant*       ebr;             ///< Optional; reports a quiescent point after each step
+    sched_trace*              trace;           ///< Event ring, nullptr when tracing is off
+    ut_rnd                    rnd;
+    void*                     ext[SCHED_EXT_COUNT]; ///< Module state, opaque to the scheduler
+    ib_u32                    index;
+    ib_i32                    cpu;             ///< Pinned CPU, -1 if not pinned
+    ib_u32                    numa_node;
+    bool                      stop;
+    ib_u64                    tick;
+    ib_u64                    next_task_seq;
+    sched_class_state         classes[SCHED_CLASS_COUNT];
+    ib_u64                    vclock;          ///< Virtual time of the last class picked
+    ib_u64                    step_start;      ///< TSC at the start of the current step
+    sched_task_state          step_state;      ///< Outcome of the current step: READY (yield), SUSPENDED, RUNNING (done)
+    sched_suspend_reason      step_reason;
+    ib_u32                    step_iters;      ///< Budget checkpoints passed in the current step
+    std::atomic<ib_u64>       spawned_total;   ///< Written by the owner only, read by sched_pool_wait_idle()
+    std::atomic<ib_u64>       finished_total;
+    ib_i64                    live_tasks;      ///< Spawned here minus finished here
+    ib_i64                    suspended_tasks; ///< Suspended here minus resumed here
+    ib_u64                    poll_pending;    ///< Completions the pollers wait for without a wakeup; a pool worker does not park while non-zero
+    ib_u64                    switches;        ///< Steps run
+    ib_u64                    yields;
+    ib_u64                    suspends[SCHED_SUSPEND_REASON_COUNT];
+    ib_u64                    resumes;
+    ib_u64                    remote_resumes;  ///< Received through the inbox
+    ib_u64                    steals;          ///< Successful steal operations
+    ib_u64                    stolen_tasks;
+    ib_u64                    injected_tasks;  ///< Taken from the pool injection queue
+    ib_u64                    parks;
+};
+
+void   sched_worker_init(sched_worker* w, ib_u32 index, ut_ebr_participant* ebr = nullptr) noexcept;
+void   sched_task_init(sched_task* t, sched_fn* fn, void* arg, sched_exit_fn* on_exit = nullptr) noexcept;
+void   sched_task_inherit(sched_task* t, const sched_task* parent) noexcept;
+void   sched_class_configure(sched_worker* w, sched_class cls, ib_u32 weight, ib_u64 budget_ns, ib_u32 budget_iters = 0) noexcept;
+void   sched_spawn(sched_worker* w, sched_task* t) noexcept;
+void   sched_poller_register(sched_worker* w, sched_poller* p, sched_poll_fn* poll, void* ctx) noexcept;
+void   sched_poller_unregister(sched_poller* p) noexcept;
+ib_u64 sched_poll(sched_worker* w) noexcept;
+ib_u64 sched_run_once(sched_worker* w) noexcept;
+void   sched_run(sched_worker* w) noexcept;
+void   sched_ready_push(sched_worker* w, sched_task* t) noexcept;
+bool   sched_ready_empty(const sched_worker* w) noexcept;
+void   sched_resume_remote(sched_task* t) noexcept;
+void   sched_resume_list(ut_dlink* list) noexcept;
+ib_u32 sched_runq_steal(sched_worker* victim, sched_worker* thief) noexcept;
+void   sched_trace_emit(sched_worker* w, sched_trace_kind kind, const sched_task* t, ib_u32 arg = 0) noexcept;
+
+inline static sched_task*   sched_task_from_link(ut_dlink* link) noexcept;
+inline static sched_worker* sched_current_worker() noexcept;
+inline static sched_task*   sched_current_task() noexcept;
+inline static void          sched_yield(sched_task* t, sched_fn* next) noexcept;
+inline static void          sched_suspend(sched_task* t, sched_fn* next, sched_suspend_reason reason) noexcept;
+inline static void          sched_resume(sched_task* t) noexcept;
+inline static void          sched_stop(sched_worker* w) noexcept;
+inline static bool          sched_budget_exceeded(sched_task* t) noexcept;
+inline static bool          sched_checkpoint(sched_task* t, sched_fn* next) noexcept;
+inline static void          sched_charge(sched_task* t, ib_u64 cycles) noexcept;
+inline static void*         sched_local(sched_local_slot slot) noexcept;
+inline static void          sched_local_set(sched_task* t, sched_local_slot slot, void* value) noexcept;
+inline static void*         sched_pwa() noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+extern thread_local sched_worker* sched_tls_worker;
+
+inline sched_task* sched_task_from_link(ut_dlink* link) noexcept {
+    return (sched_task*)((char*)link - IB_OFFSET_OF(sched_task, link));
+}
+
+inline sched_worker* sched_current_worker() noexcept {
+    return sched_tls_worker;
+}
+
+inline sched_task* sched_current_task() noexcept {
+    sched_worker* w = sched_tls_worker;
+    return w != nullptr ? w->current : nullptr;
+}
+
+/// \brief Requeues the running task at the tail of the ready queue; it continues with `next`
+/// \details The run loop requeues the task once the step has returned, so no other worker can
+/// steal and run it while the step is still unwinding.
+inline void sched_yield(sched_task* t, sched_fn* next) noexcept {
+    IB_ASSERT_EQ(t->state, SCHED_TASK_RUNNING, "only the running task can yield");
+    t->fn    = next;
+    t->state = SCHED_TASK_READY;
+    t->worker->step_state = SCHED_TASK_READY;
+    ++t->worker->yields;
+}
+
+/// \brief Parks the running task; it continues with `next` after sched_resume()
+/// \details The caller links the task into its own waiter queue (through `t->link`) before or
+/// after this call, but before returning to the run loop.
+inline void sched_suspend(sched_task* t, sched_fn* next, sched_suspend_reason reason) noexcept {
+    IB_ASSERT_EQ(t->state, SCHED_TASK_RUNNING, "only the running task can suspend");
+    t->fn             = next;
+    t->state          = SCHED_TASK_SUSPENDED;
+    t->suspend_reason = reason;
+    t->worker->step_state  = SCHED_TASK_SUSPENDED;
+    t->worker->step_reason = reason;
+    ++t->worker->suspended_tasks;
+    ++t->worker->suspends[reason];
+    if (reason == SCHED_SUSPEND_IO) ++t->acct.io_waits;
+    if (reason == SCHED_SUSPEND_LATCH) ++t->acct.latch_waits;
+}
+
+/// \brief Makes a suspended task ready again, on the worker that last ran it
+/// \details The task must already be unlinked from the waiter queue it was parked on. From a
+/// thread other than the worker's, the task is pushed to the worker inbox and the worker woken.
+inline void sched_resume(sched_task* t) noexcept {
+    IB_ASSERT_EQ(t->state, SCHED_TASK_SUSPENDED, "resuming a task that is not suspended");
+    sched_worker* w = t->worker;
+    if (w != sched_tls_worker) {
+        sched_resume_remote(t);
+        return;
+    }
+    t->state          = SCHED_TASK_READY;
+    t->suspend_reason = SCHED_SUSPEND_NONE;
+    if (t == w->current) {
+        // Resumed by its own step (the wait was satisfied before the step returned): a yield
+        w->step_state = SCHED_TASK_READY;
+    } else {
+        sched_ready_push(w, t);
+    }
+    --w->suspended_tasks;
+    ++w->resumes;
+    if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_RESUME, t);
+}
+
+/// \brief Asks sched_run() to return after the current step
+inline void sched_stop(sched_worker* w) noexcept {
+    w->stop = true;
+}
+
+/// \brief True once the running task has used up the step budget of its class
+/// \details Call at natural preemption points (loop iterations, page boundaries). Counts one
+/// iteration; the TSC is read every SCHED_BUDGET_TSC_INTERVAL calls only.
+inline bool sched_budget_exceeded(sched_task* t) noexcept {
+    sched_worker*            w = t->worker;
+    const sched_class_state* c = &w->classes[t->cls];
+    const ib_u32             n = ++w->step_iters;
+    if (c->budget_iters != 0 && n >= c->budget_iters) return true;
+    if (n % SCHED_BUDGET_TSC_INTERVAL != 0) return false;
+    return __rdtsc() - w->step_start >= c->budget_cycles;
+}
+
+/// \brief Preemption point of a CPS step: requeues the task to continue with `next` if its budget is used up
+/// \return True if the task was requeued; the step must then return to the loop
+inline bool sched_checkpoint(sched_task* t, sched_fn* next) noexcept {
+    if (!sched_budget_exceeded(t)) return false;
+    ++t->worker->classes[t->cls].preemptions;
+    sched_yield(t, next);
+    return true;
+}
+
+/// \brief Charges work done on behalf of `t` outside of its own steps (completion handling, I/O
+/// submitted for it) to its class, on top of the cycles its steps are measured to consume
+inline void sched_charge(sched_task* t, ib_u64 cycles) noexcept {
+    sched_class_state* c = &t->worker->classes[t->cls];
+    c->cycles += cycles;
+    c->vtime  += cycles / c->weight;
+}
+
+/// \brief Task-local slot of the running task (nullptr outside of a task or when unset)
+inline void* sched_local(sched_local_slot slot) noexcept {
+    IB_ASSERT(slot < SCHED_LOCAL_COUNT, "invalid task-local slot");
+    sched_worker* w = sched_tls_worker;
+    return w != nullptr && w->current != nullptr ? w->current->locals[slot] : nullptr;
+}
+
+inline void sched_local_set(sched_task* t, sched_local_slot slot, void* value) noexcept {
+    IB_ASSERT(slot < SCHED_LOCAL_COUNT, "invalid task-local slot");
+    t->locals[slot] = value;
+}
+
+/// \brief Private worker area of the worker running the caller
+/// \details Per worker rather than per task: a stolen task sees the area of its new worker.
+inline void* sched_pwa() noexcept {
+    sched_worker* w = sched_tls_worker;
+    return w != nullptr ? w->ext[SCHED_EXT_PWA] : nullptr;
+}
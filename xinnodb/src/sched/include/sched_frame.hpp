@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/// \defgroup sched_frame Continuation frames
+/// \ingroup sched
+/// \brief Arguments of CPS tail calls that do not fit in registers
+/// \details co_do passes every argument in a general purpose register, so it rejects floating-point
+/// values, anything wider than 8 bytes and more than 13 arguments. co_spill packs such arguments
+/// into a `co_frame` carved from the arena of the running task and passes only the frame pointer.
+/// The frame layout (offset of every argument, size, alignment) is computed at compile time from
+/// the argument types, which must match the callee frame exactly, so packing is a few stores and
+/// unpacking a load at a constant offset:
+///
+///     IB_ASYNC eval_step(co_frame<double, key16, int>* f) {
+///         double sel = co_arg<0>(f);
+///         ...
+///         co_spill(eval_step, sel * 0.5, co_arg<1>(f), co_arg<2>(f) + 1);
+///     }
+///
+/// An arena alternates between two slots: the frame received by a step stays valid until that
+/// step has spilled twice, so a step can forward fields of its own frame to the next one.
+///
+/// A `sched_task` may own an arena (`sched_task::arena`); the run loop makes it the current one
+/// for each step of the task, so CPS chains of tasks interleaved on a worker, or stolen by another
+/// one, never share slots. Code running outside a task, or in a task without an arena, spills to
+/// an arena of its thread.
+
+/// \addtogroup sched_frame
+/// @{
+
+/// \brief Bytes of one arena slot: the largest continuation frame
+constexpr std::size_t CO_FRAME_SLOT_SIZE = 256;
+
+/// \brief Two frame slots used in turn
+struct co_arena {
+    alignas(64) unsigned char slots[2][CO_FRAME_SLOT_SIZE];
+    unsigned next;      ///< Slot of the last frame packed
+};
+
+/// \brief Arena of the thread, used when the running task has none
+inline thread_local constinit co_arena co_arena_thread{};
+
+/// \brief Arena of the running task, set by the run loop for each step; nullptr: co_arena_thread
+inline thread_local constinit co_arena* co_arena_tls = nullptr;
+
+/// \brief Compile-time layout of a frame holding Args... in declaration order
+template <typename... Args>
+struct co_frame_layout {
+    static constexpr std::size_t count = sizeof...(Args);
+    static constexpr std::size_t align = std::max({ std::size_t(1), alignof(Args)... });
+
+    static constexpr std::array<std::size_t, count> offsets = [] {
+        std::array<std::size_t, count> offs{};
+        constexpr std::size_t sizes[]  = { sizeof(Args)... };
+        constexpr std::size_t aligns[] = { alignof(Args)... };
+        std::size_t at = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            at      = (at + aligns[i] - 1) / aligns[i] * aligns[i];
+            offs[i] = at;
+            at     += sizes[i];
+        }
+        return offs;
+    }();
+
+    static constexpr std::size_t size = [] {
+        constexpr std::size_t sizes[] = { sizeof(Args)... };
+        return count == 0 ? 1 : offsets[count - 1] + sizes[count - 1];
+    }();
+};
+
+/// \brief A continuation frame holding Args...
+template <typename... Args>
+struct co_frame {
+    using layout = co_frame_layout<Args...>;
+    static_assert((... && std::is_trivially_copyable_v<Args>), "co_spill: frame arguments are never destroyed");
+    static_assert(layout::size <= CO_FRAME_SLOT_SIZE, "co_spill: frame does not fit in an arena slot");
+    static_assert(layout::align <= 64, "co_spill: over-aligned frame argument");
+
+    alignas(layout::align) unsigned char bytes[layout::size];
+};
+
+template <std::size_t I, typename... Args>
+using co_frame_arg_t = std::tuple_element_t<I, std::tuple<Args...>>;
+
+inline static void co_arena_init(co_arena* arena) noexcept;
+inline static co_arena* co_arena_current() noexcept;
+
+template <std::size_t I, typename... Args>
+inline static co_frame_arg_t<I, Args...>& co_arg(co_frame<Args...>* f) noexcept;
+template <typename... Vals>
+inline static co_frame<std::decay_t<Vals>...>* co_frame_pack(Vals... vals) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline void co_arena_init(co_arena* arena) noexcept {
+    arena->next = 0;
+}
+
+/// \brief The arena co_frame_pack() packs into
+inline co_arena* co_arena_current() noexcept {
+    co_arena* arena = co_arena_tls;
+    return arena != nullptr ? arena : &co_arena_thread;
+}
+
+/// \brief Argument I of a frame
+template <std::size_t I, typename... Args>
+inline co_frame_arg_t<I, Args...>& co_arg(co_frame<Args...>* f) noexcept {
+    return *std::launder(reinterpret_cast<co_frame_arg_t<I, Args...>*>(f->bytes + co_frame<Args...>::layout::offsets[I]));
+}
+
+template <typename Frame, std::size_t... I, typename... Vals>
+inline void co_frame_store(Frame* f, std::index_sequence<I...>, Vals&&... vals) noexcept {
+    using layout = typename Frame::layout;
+    (..., ::new (f->bytes + layout::offsets[I]) std::remove_reference_t<decltype(co_arg<I>(f))>(static_cast<Vals&&>(vals)));
+}
+
+/// \brief Packs `vals` into the next slot of the current arena
+/// \details The values are copied before the slot is written, so they may be read from the frame
+/// that occupies it.
+template <typename... Vals>
+inline co_frame<std::decay_t<Vals>...>* co_frame_pack(Vals... vals) noexcept {
+    using frame = co_frame<std::decay_t<Vals>...>;
+    co_arena* arena = co_arena_current();
+    arena->next ^= 1;
+    frame* f = reinterpret_cast<frame*>(arena->slots[arena->next]);
+    co_frame_store(f, std::make_index_sequence<sizeof...(Vals)>{}, vals...);
+    return f;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "sched.hpp"                 // IWYU pragma: keep
+
+#include <atomic>
+#include <pthread.h>
+
+/// \defgroup sched_pool Worker pool
+/// \ingroup sched
+/// \brief Work-stealing pool of pinned workers
+/// \details One thread per worker, each pinned to its own CPU. A worker runs its own ready ring
+/// first; when it is empty it takes a batch from the pool injection queue (work submitted by
+/// client threads with sched_pool_inject()) and then steals half of the ring of a sibling.
+/// Victims are visited in random order, siblings on the same NUMA node before the others, so
+/// stolen tasks mostly stay close to the memory they touch.
+///
+/// A worker that finds nothing to do spins with a randomized backoff, then parks on a futex.
+/// Spawns, injections and remote resumes wake parked workers; parked workers also wake up
+/// periodically to poll their completion sources and to look for work to steal.
+
+/// \addtogroup sched_pool
+/// @{
+
+/// \brief Maximum number of workers in a pool
+constexpr ib_u32 SCHED_POOL_MAX_WORKERS = 256;
+
+/// \brief Maximum number of tasks moved from the injection queue per take
+constexpr ib_u32 SCHED_POOL_INJECT_BATCH = 32;
+
+/// \brief Park timeout of an idle worker, in microseconds
+constexpr ib_u64 SCHED_POOL_PARK_USEC = 1000;
+
+/// \brief Pool of workers sharing an injection queue
+struct sched_pool {
+    sched_worker*               workers;            ///< `count` workers, initialized by sched_pool_init()
+    ib_u32                      count;
+    bool                        pin;                ///< Pin worker `i` to `cpus[i]`
+    ib_u32                      numa_nodes;
+    alignas(64) std::atomic<bool>   inject_lock;
+    ut_dlink                        inject;         ///< Guarded by inject_lock
+    std::atomic<ib_u64>             inject_count;
+    std::atomic<ib_u64>             injected_total;
+    alignas(64) std::atomic<ib_u32> idle_workers;   ///< Workers parked or about to park
+    std::atomic<bool>               stop;
+    pthread_t                       threads[SCHED_POOL_MAX_WORKERS];
+};
+
+int    sched_pool_init(sched_pool* pool, sched_worker* workers, ib_u32 count, const ib_i32* cpus = nullptr) noexcept;
+int    sched_pool_start(sched_pool* pool) noexcept;
+void   sched_pool_stop(sched_pool* pool) noexcept;
+void   sched_pool_wait_idle(sched_pool* pool) noexcept;
+void   sched_pool_inject(sched_pool* pool, sched_task* t) noexcept;
+void   sched_pool_notify(sched_pool* pool) noexcept;
+void   sched_pool_wake(sched_worker* w) noexcept;
+sched_task* sched_pool_take(sched_pool* pool, sched_worker* w) noexcept;
+ib_u32 sched_pool_steal(sched_pool* pool, sched_worker* w) noexcept;
+ib_u32 sched_cpu_numa_node(ib_i32 cpu) noexcept;
+
+/// @}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "sched.hpp"                 // IWYU pragma: keep
+
+/// \defgroup sched_sim Simulation
+/// \ingroup sched
+/// \brief Deterministic simulation mode of a worker
+/// \details A worker with a `sched_sim` attached runs single-threaded and picks the next ready task
+/// with a PRNG seeded by the caller instead of in FIFO order. Task ids and per-task PRNGs are derived
+/// from the seed too, so a seed fully determines the interleaving of the tasks.
+///
+/// Every nondeterministic decision is appended to an event log: task picks, completions delivered
+/// by simulated sources (sched_sim_complete()) and their choices (sched_sim_choose()). Given a log,
+/// sched_sim_replay() makes the same decisions again and flags the first event that no longer
+/// matches. sched_sim_explore() runs a test body under thousands of seeds and reports the first one
+/// that fails, whose log can then be replayed under a debugger.
+
+/// \addtogroup sched_sim
+/// @{
+
+/// \brief Kind of a logged decision
+enum sched_sim_event_kind : ib_u32 {
+    SCHED_SIM_PICK     = 1,     ///< Ready task chosen by the run loop
+    SCHED_SIM_COMPLETE = 2,     ///< Completion delivered to a task by a simulated source
+    SCHED_SIM_CHOICE   = 3,     ///< Other choice made by a simulated source
+};
+
+/// \brief One logged decision
+struct sched_sim_event {
+    sched_sim_event_kind kind;
+    ib_u32               choice;    ///< Index among the candidates
+    ib_u64               task_id;   ///< Task picked or completed, 0 for choices
+};
+static_assert(sizeof(sched_sim_event) == 16);
+
+/// \brief Simulation state of one worker
+struct sched_sim {
+    sched_worker*          worker;
+    ut_rnd                 rnd;
+    ib_u64                 seed;
+    sched_sim_event*       log;             ///< Decisions taken, may be nullptr
+    ib_u64                 log_capacity;
+    ib_u64                 log_len;
+    bool                   log_truncated;   ///< The log ran out of space
+    const sched_sim_event* replay;          ///< Decisions to repeat, nullptr when exploring
+    ib_u64                 replay_len;
+    ib_u64                 replay_pos;
+    bool                   diverged;        ///< The run no longer follows `replay`
+    ib_u64                 diverged_at;     ///< Index of the first mismatching event
+};
+
+/// \brief Test body run once per seed; returns non-zero when an invariant is broken
+using sched_sim_body = int(sched_worker* w, void* ctx) noexcept;
+
+/// \brief First failing run found by sched_sim_explore()
+struct sched_sim_failure {
+    ib_u64 seed;
+    ib_u64 log_len;     ///< Events of the failing run in the explore log
+    int    rc;          ///< Result of the body
+};
+
+void        sched_sim_init(sched_sim* sim, sched_worker* w, ib_u64 seed, sched_sim_event* log = nullptr, ib_u64 log_capacity = 0) noexcept;
+void        sched_sim_replay(sched_sim* sim, const sched_sim_event* events, ib_u64 count) noexcept;
+void        sched_sim_detach(sched_sim* sim) noexcept;
+sched_task* sched_sim_pick(sched_sim* sim) noexcept;
+ib_u32      sched_sim_choose(sched_sim* sim, ib_u32 n) noexcept;
+void        sched_sim_complete(sched_sim* sim, sched_task* t) noexcept;
+int         sched_sim_explore(ib_u64 first_seed, ib_u64 seeds, sched_sim_body* body, void* ctx, sched_sim_failure* failure,
+                              sched_sim_event* log = nullptr, ib_u64 log_capacity = 0) noexcept;
+
+/// @}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "sched.hpp"                 // IWYU pragma: keep
+#include "ut_clock.hpp"              // IWYU pragma: keep
+
+/// \defgroup sched_timer Timers
+/// \ingroup sched
+/// \brief Per-worker hierarchical timing wheel
+/// \details Sleeps, lock-wait timeouts and I/O timeouts are `sched_timer`s embedded in the waiting
+/// task (or in its coroutine frame): arming links the timer into a slot list and cancelling unlinks
+/// it, both O(1) and without allocation, however many timers are pending.
+///
+/// The wheel has SCHED_TIMER_LEVELS levels of SCHED_TIMER_SLOTS slots. Level 0 slots are one tick
+/// wide, each higher level is SCHED_TIMER_SLOTS times coarser. A timer goes into the finest level
+/// that covers its distance; when the level below wraps around, the slot due next is cascaded one
+/// level down. Timers further away than the wheel span are parked in the last level and cascaded
+/// again until they are in range.
+///
+/// The wheel is a scheduler poller: each pass reads the clock and fires the timers whose tick has
+/// passed. A timer fires by calling its callback on the worker; the default one resumes the task.
+
+/// \addtogroup sched_timer
+/// @{
+
+/// \brief Number of wheel levels
+constexpr ib_u32 SCHED_TIMER_LEVELS = 4;
+
+/// \brief Slots per level (a power of two, at most 64: one occupancy bit per slot)
+constexpr ib_u32 SCHED_TIMER_SLOTS = 64;
+
+/// \brief Default tick length: one millisecond, about the resolution of the coarse clock
+constexpr ib_u64 SCHED_TIMER_TICK_NS = 1'000'000;
+
+struct sched_timer;
+
+/// \brief Expiry callback, runs on the worker that owns the wheel
+using sched_timer_fn = void(sched_timer* timer, void* arg) noexcept;
+
+/// \brief A pending timeout
+struct sched_timer {
+    ut_dlink        link;       ///< Slot membership, detached when not armed
+    ib_u64          expires;    ///< Expiry tick
+    sched_timer_fn* fn;
+    void*           arg;
+    bool            fired;
+};
+
+/// \brief Timing wheel of one worker
+struct sched_timer_wheel {
+    ut_dlink        slots[SCHED_TIMER_LEVELS][SCHED_TIMER_SLOTS];
+    ib_u64          occupied[SCHED_TIMER_LEVELS];   ///< Slots that may hold timers (cleared lazily)
+    ib_u64          tick;                           ///< Last processed tick
+    ib_u64          tick_ns;
+    ib_u64          origin_ns;                      ///< Clock reading of tick 0
+    ib_u64          now_ns;                         ///< Clock reading of the last advance
+    ut_clock_source clock;
+    sched_worker*   worker;
+    sched_poller    poller;
+    ib_u64          pending;
+    ib_u64          armed_total;
+    ib_u64          cancelled_total;
+    ib_u64          fired_total;
+    ib_u64          cascaded_total;
+};
+
+void   sched_timer_wheel_init(sched_timer_wheel* wh, sched_worker* w, ut_clock_source clock = UT_CLOCK_COARSE, ib_u64 tick_ns = SCHED_TIMER_TICK_NS) noexcept;
+void   sched_timer_wheel_detach(sched_timer_wheel* wh) noexcept;
+void   sched_timer_init(sched_timer* t, sched_timer_fn* fn, void* arg) noexcept;
+void   sched_timer_arm(sched_timer_wheel* wh, sched_timer* t, ib_u64 deadline_ns) noexcept;
+bool   sched_timer_cancel(sched_timer_wheel* wh, sched_timer* t) noexcept;
+ib_u64 sched_timer_advance(sched_timer_wheel* wh, ib_u64 now_ns) noexcept;
+void   sched_timer_resume_task(sched_timer* t, void* task) noexcept;
+
+inline static sched_timer_wheel* sched_timer_wheel_of(sched_worker* w) noexcept;
+inline static ib_u64             sched_timer_now(const sched_timer_wheel* wh) noexcept;
+inline static bool               sched_timer_armed(const sched_timer* t) noexcept;
+inline static void               sched_timer_arm_after(sched_timer_wheel* wh, sched_timer* t, ib_u64 delay_ns) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Wheel attached to `w`, or nullptr
+inline sched_timer_wheel* sched_timer_wheel_of(sched_worker* w) noexcept {
+    return (sched_timer_wheel*)w->ext[SCHED_EXT_TIMER];
+}
+
+/// \brief Time of the last advance, in clock nanoseconds
+inline ib_u64 sched_timer_now(const sched_timer_wheel* wh) noexcept {
+    return wh->now_ns;
+}
+
+inline bool sched_timer_armed(const sched_timer* t) noexcept {
+    return !ut_dlink_is_detached(&t->link);
+}
+
+/// \brief Arms `t` to fire `delay_ns` after the last advance
+inline void sched_timer_arm_after(sched_timer_wheel* wh, sched_timer* t, ib_u64 delay_ns) noexcept {
+    sched_timer_arm(wh, t, wh->now_ns + delay_ns);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "sched.hpp"                 // IWYU pragma: keep
+
+#include <cstdio>
+
+/// \defgroup sched_trace Tracing
+/// \ingroup sched
+/// \brief Per-worker task event rings and their Chrome trace export
+/// \details Averages do not say why one transaction took 40 ms. A `sched_trace` attached to a
+/// worker records every transition of the tasks it runs: creation, the start and the end of each
+/// step (yield, suspend with its reason, completion), resumes and steals. Events are 24 bytes,
+/// stamped with `rdtsc` and written by the owning thread only, without atomics; the ring keeps the
+/// most recent events and overwrites the oldest, so it can stay attached as a flight recorder.
+///
+/// sched_trace_export_chrome() merges the rings of several workers into the Chrome trace event
+/// JSON format, which both `chrome://tracing` and the Perfetto UI open:
+///
+/// - one thread per worker, with a slice per step named after the task class;
+/// - one async track per task spanning its life, with nested spans for the time it spent
+///   suspended (named after the reason) and runnable but waiting for a worker (`runnable`);
+/// - instant events for steals.
+///
+/// Rings are read without synchronization: export them after the workers stopped, or from the
+/// thread that owns them.
+
+/// \addtogroup sched_trace
+/// @{
+
+/// \brief One recorded transition
+struct sched_trace_event {
+    ib_u64 tsc;
+    ib_u64 task;        ///< sched_task::id
+    ib_u8  kind;        ///< sched_trace_kind
+    ib_u8  cls;         ///< sched_class of the task
+    ib_u16 arg;         ///< Depends on the kind
+    ib_u32 reserved;
+};
+static_assert(sizeof(sched_trace_event) == 24, "events must stay packed");
+
+/// \brief Event ring of one worker
+struct sched_trace {
+    sched_trace_event* events;
+    ib_u64             mask;        ///< Capacity - 1 (a power of two)
+    ib_u64             head;        ///< Events recorded so far; the ring keeps the last `mask + 1`
+    ib_u32             worker;      ///< Index of the worker it was attached to
+};
+
+int    sched_trace_init(sched_trace* tr, void* mem, ib_size size) noexcept;
+void   sched_trace_attach(sched_worker* w, sched_trace* tr) noexcept;
+void   sched_trace_detach(sched_worker* w) noexcept;
+int    sched_trace_export_chrome(std::FILE* out, const sched_trace* const* traces, ib_u32 count) noexcept;
+const char* sched_trace_kind_name(sched_trace_kind kind) noexcept;
+const char* sched_suspend_reason_name(sched_suspend_reason reason) noexcept;
+
+inline static ib_u64                   sched_trace_size(const sched_trace* tr) noexcept;
+inline static const sched_trace_event* sched_trace_at(const sched_trace* tr, ib_u64 i) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Number of events retained
+inline ib_u64 sched_trace_size(const sched_trace* tr) noexcept {
+    return tr->head <= tr->mask ? tr->head : tr->mask + 1;
+}
+
+/// \brief The `i`-th oldest retained event
+inline const sched_trace_event* sched_trace_at(const sched_trace* tr, ib_u64 i) noexcept {
+    IB_ASSERT(i < sched_trace_size(tr), "trace index out of range");
+    return &tr->events[(tr->head - sched_trace_size(tr) + i) & tr->mask];
+}
@@ -0,0 +1,280 @@
+#include "sched_pool.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static void sched_futex_wait(std::atomic<ib_u32>* word, ib_u32 expected, ib_u64 usec) noexcept {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(usec / 1000000);
+    ts.tv_nsec = (long)((usec % 1000000) * 1000);
+    syscall(SYS_futex, (ib_u32*)word, FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+}
+
+static void sched_futex_wake(std::atomic<ib_u32>* word) noexcept {
+    syscall(SYS_futex, (ib_u32*)word, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+/// \brief NUMA node of `cpu` as reported by sysfs (0 when unknown)
+ib_u32 sched_cpu_numa_node(ib_i32 cpu) noexcept {
+    if (cpu < 0) return 0;
+    char path[64];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR* dir = opendir(path);
+    if (dir == nullptr) return 0;
+    ib_u32 node = 0;
+    while (struct dirent* e = readdir(dir)) {
+        unsigned n;
+        if (std::sscanf(e->d_name, "node%u", &n) == 1) {
+            node = n;
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+/// \brief Initializes `count` workers and binds them to the pool
+/// \param cpus CPU of each worker; nullptr pins worker `i` to the i-th CPU of the process
+/// affinity mask, or leaves the workers unpinned when there are more workers than CPUs
+/// \return 0 on success, -1 if `count` is out of range
+int sched_pool_init(sched_pool* pool, sched_worker* workers, ib_u32 count, const ib_i32* cpus) noexcept {
+    IB_ASSERT_NOT_NULL(pool);
+    IB_ASSERT_NOT_NULL(workers);
+    if (count == 0 || count > SCHED_POOL_MAX_WORKERS) return -1;
+
+    ib_i32 allowed[SCHED_POOL_MAX_WORKERS];
+    ib_u32 allowed_count = 0;
+    if (cpus == nullptr) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int c = 0; c < CPU_SETSIZE && allowed_count < SCHED_POOL_MAX_WORKERS; ++c) {
+                if (CPU_ISSET(c, &set)) allowed[allowed_count++] = c;
+            }
+        }
+    }
+
+    pool->workers    = workers;
+    pool->count      = count;
+    pool->pin        = cpus != nullptr || allowed_count >= count;
+    pool->numa_nodes = 1;
+    pool->inject_lock.store(false, std::memory_order_relaxed);
+    ut_dlink_init(&pool->inject);
+    pool->inject_count.store(0, std::memory_order_relaxed);
+    pool->injected_total.store(0, std::memory_order_relaxed);
+    pool->idle_workers.store(0, std::memory_order_relaxed);
+    pool->stop.store(false, std::memory_order_relaxed);
+
+    for (ib_u32 i = 0; i < count; ++i) {
+        sched_worker* w = &workers[i];
+        sched_worker_init(w, i);
+        w->pool = pool;
+        if (pool->pin) {
+            w->cpu       = cpus != nullptr ? cpus[i] : allowed[i];
+            w->numa_node = sched_cpu_numa_node(w->cpu);
+            if (w->numa_node + 1 > pool->numa_nodes) pool->numa_nodes = w->numa_node + 1;
+        }
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Injection queue
+// -----------------------------------------------------------------------------
+
+static void sched_pool_lock(sched_pool* pool) noexcept {
+    ut_backoff backoff;
+    ut_backoff_init(&backoff, ut_rnd_thread(), 1, 64);
+    while (pool->inject_lock.exchange(true, std::memory_order_acquire)) {
+        while (pool->inject_lock.load(std::memory_order_relaxed)) ut_backoff_pause(&backoff);
+    }
+}
+
+static void sched_pool_unlock(sched_pool* pool) noexcept {
+    pool->inject_lock.store(false, std::memory_order_release);
+}
+
+/// \brief Submits a new task from any thread; the first worker to look at the queue runs it
+void sched_pool_inject(sched_pool* pool, sched_task* t) noexcept {
+    IB_ASSERT_EQ(t->state, SCHED_TASK_CREATED, "task spawned twice");
+    t->state = SCHED_TASK_READY;
+    pool->injected_total.fetch_add(1, std::memory_order_release);
+    sched_pool_lock(pool);
+    ut_dlink_enqueue(&pool->inject, &t->link);
+    pool->inject_count.fetch_add(1, std::memory_order_relaxed);
+    sched_pool_unlock(pool);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    sched_pool_notify(pool);
+}
+
+/// \brief Takes a batch of injected tasks for `w`: the first is returned, the rest made ready
+sched_task* sched_pool_take(sched_pool* pool, sched_worker* w) noexcept {
+    const ib_u64 pending = pool->inject_count.load(std::memory_order_relaxed);
+    if (pending == 0) return nullptr;
+    ib_u64 batch = pending / pool->count + 1;
+    if (batch > SCHED_POOL_INJECT_BATCH) batch = SCHED_POOL_INJECT_BATCH;
+
+    sched_task* first = nullptr;
+    sched_pool_lock(pool);
+    for (ib_u64 i = 0; i < batch; ++i) {
+        ut_dlink* link = ut_dlink_dequeue(&pool->inject);
+        if (link == nullptr) break;
+        pool->inject_count.fetch_sub(1, std::memory_order_relaxed);
+        sched_task* t = sched_task_from_link(link);
+        t->worker = w;
+        t->id     = ((ib_u64)w->index << 48) | ++w->next_task_seq;
+        ut_rnd_fork(&w->rnd, &t->rnd);
+        ++w->live_tasks;
+        ++w->injected_tasks;
+        if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_CREATE, t, 1);
+        if (first == nullptr) {
+            first = t;
+        } else {
+            sched_ready_push(w, t);
+        }
+    }
+    sched_pool_unlock(pool);
+    return first;
+}
+
+// -----------------------------------------------------------------------------
+// Stealing
+// -----------------------------------------------------------------------------
+
+/// \brief Steals from a random sibling, same NUMA node first
+/// \return The number of tasks moved to `w`
+ib_u32 sched_pool_steal(sched_pool* pool, sched_worker* w) noexcept {
+    if (pool->count < 2) return 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1 && pool->numa_nodes == 1) break;
+        const ib_u32 start = (ib_u32)ut_rnd_bounded(&w->rnd, pool->count);
+        for (ib_u32 i = 0; i < pool->count; ++i) {
+            sched_worker* victim = &pool->workers[(start + i) % pool->count];
+            if (victim == w) continue;
+            if ((victim->numa_node == w->numa_node) != (pass == 0)) continue;
+            if (ib_u32 n = sched_runq_steal(victim, w)) return n;
+        }
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Parking
+// -----------------------------------------------------------------------------
+
+void sched_pool_wake(sched_worker* w) noexcept {
+    if (w->sleeping.exchange(0, std::memory_order_acq_rel) != 0) sched_futex_wake(&w->sleeping);
+}
+
+/// \brief Wakes one parked worker, if any, to pick up new work
+void sched_pool_notify(sched_pool* pool) noexcept {
+    if (pool->idle_workers.load(std::memory_order_relaxed) == 0) return;
+    const ib_u32 start = (ib_u32)ut_rnd_bounded(ut_rnd_thread(), pool->count);
+    for (ib_u32 i = 0; i < pool->count; ++i) {
+        sched_worker* w = &pool->workers[(start + i) % pool->count];
+        if (w->sleeping.load(std::memory_order_relaxed) != 0) {
+            sched_pool_wake(w);
+            return;
+        }
+    }
+}
+
+static void sched_pool_park(sched_pool* pool, sched_worker* w) noexcept {
+    pool->idle_workers.fetch_add(1, std::memory_order_relaxed);
+    w->sleeping.store(1, std::memory_order_relaxed);
+    // Pairs with the fences in sched_resume_remote() and sched_pool_inject()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const bool has_work = w->poll_pending != 0 ||
+                          w->inbox.load(std::memory_order_relaxed) != nullptr ||
+                          pool->inject_count.load(std::memory_order_relaxed) != 0 ||
+                          pool->stop.load(std::memory_order_relaxed);
+    if (!has_work) {
+        ++w->parks;
+        sched_futex_wait(&w->sleeping, 1, SCHED_POOL_PARK_USEC);
+    }
+    w->sleeping.store(0, std::memory_order_relaxed);
+    pool->idle_workers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Worker threads
+// -----------------------------------------------------------------------------
+
+static void* sched_pool_thread_main(void* arg) {
+    sched_worker* w    = (sched_worker*)arg;
+    sched_pool*   pool = w->pool;
+    if (pool->pin && w->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (w->ebr != nullptr) ut_ebr_online(w->ebr);
+    ut_backoff backoff;
+    ut_backoff_init(&backoff, &w->rnd);
+    while (!pool->stop.load(std::memory_order_acquire)) {
+        if (sched_run_once(w) != 0 || !sched_ready_empty(w)) {
+            ut_backoff_reset(&backoff);
+            continue;
+        }
+        if (!ut_backoff_saturated(&backoff)) {
+            ut_backoff_pause(&backoff);
+            continue;
+        }
+        if (w->ebr != nullptr) ut_ebr_offline(w->ebr);
+        sched_pool_park(pool, w);
+        if (w->ebr != nullptr) ut_ebr_online(w->ebr);
+        ut_backoff_reset(&backoff);
+    }
+    if (w->ebr != nullptr) ut_ebr_offline(w->ebr);
+    return nullptr;
+}
+
+/// \brief Starts one thread per worker
+/// \return 0 on success, the pthread error code otherwise (already started threads are stopped)
+int sched_pool_start(sched_pool* pool) noexcept {
+    pool->stop.store(false, std::memory_order_release);
+    for (ib_u32 i = 0; i < pool->count; ++i) {
+        int rc = pthread_create(&pool->threads[i], nullptr, sched_pool_thread_main, &pool->workers[i]);
+        if (rc != 0) {
+            pool->stop.store(true, std::memory_order_release);
+            for (ib_u32 j = 0; j < i; ++j) {
+                sched_pool_wake(&pool->workers[j]);
+                pthread_join(pool->threads[j], nullptr);
+            }
+            return rc;
+        }
+    }
+    return 0;
+}
+
+/// \brief Stops and joins the worker threads; tasks still queued stay queued
+void sched_pool_stop(sched_pool* pool) noexcept {
+    pool->stop.store(true, std::memory_order_release);
+    for (ib_u32 i = 0; i < pool->count; ++i) sched_pool_wake(&pool->workers[i]);
+    for (ib_u32 i = 0; i < pool->count; ++i) pthread_join(pool->threads[i], nullptr);
+}
+
+/// \brief Waits until every spawned or injected task has finished
+/// \details Finished counters are summed before spawned counters: a task always finishes after it
+/// was counted as spawned, so equal sums mean that nothing was running in between.
+void sched_pool_wait_idle(sched_pool* pool) noexcept {
+    for (;;) {
+        ib_u64 finished = 0;
+        for (ib_u32 i = 0; i < pool->count; ++i) {
+            finished += pool->workers[i].finished_total.load(std::memory_order_acquire);
+        }
+        ib_u64 spawned = pool->injected_total.load(std::memory_order_acquire);
+        for (ib_u32 i = 0; i < pool->count; ++i) {
+            spawned += pool->workers[i].spawned_total.load(std::memory_order_acquire);
+        }
+        if (spawned == finished) return;
+        usleep(50);
+    }
+}
@@ -0,0 +1,134 @@
+#include "sched_sim.hpp"
+
+/// \brief Puts `w` in simulation mode
+/// \details The worker must be standalone and have no ready task yet. Its PRNG is reseeded from
+/// `seed` so that the per-task PRNGs forked on spawn are deterministic as well.
+/// \param log Optional buffer receiving the decisions; recording stops when it is full
+void sched_sim_init(sched_sim* sim, sched_worker* w, ib_u64 seed, sched_sim_event* log, ib_u64 log_capacity) noexcept {
+    IB_ASSERT_NOT_NULL(sim);
+    IB_ASSERT_NOT_NULL(w);
+    IB_ASSERT(w->pool == nullptr, "simulation runs on a standalone worker");
+    IB_ASSERT(sched_ready_empty(w), "tasks spawned before the simulation started");
+    sim->worker        = w;
+    sim->seed          = seed;
+    sim->log           = log;
+    sim->log_capacity  = log != nullptr ? log_capacity : 0;
+    sim->log_len       = 0;
+    sim->log_truncated = false;
+    sim->replay        = nullptr;
+    sim->replay_len    = 0;
+    sim->replay_pos    = 0;
+    sim->diverged      = false;
+    sim->diverged_at   = 0;
+    ut_rnd_init(&sim->rnd, seed);
+    ut_rnd_init(&w->rnd, seed ^ 0x5ced5ced5ced5cedULL);
+    w->next_task_seq = 0;
+    w->sim           = sim;
+}
+
+/// \brief Makes the following decisions repeat `events` (a log recorded with the same seed)
+void sched_sim_replay(sched_sim* sim, const sched_sim_event* events, ib_u64 count) noexcept {
+    sim->replay     = events;
+    sim->replay_len = count;
+    sim->replay_pos = 0;
+    sim->diverged   = false;
+}
+
+/// \brief Leaves simulation mode; ready tasks stay queued in FIFO order
+void sched_sim_detach(sched_sim* sim) noexcept {
+    if (sim->worker->sim == sim) sim->worker->sim = nullptr;
+}
+
+static void sched_sim_diverge(sched_sim* sim) noexcept {
+    if (sim->diverged) return;
+    sim->diverged    = true;
+    sim->diverged_at = sim->replay_pos;
+}
+
+/// \brief Decides among `n` candidates: the next replayed event if it matches, the PRNG otherwise
+static ib_u32 sched_sim_decide(sched_sim* sim, sched_sim_event_kind kind, ib_u32 n, const sched_sim_event** expected) noexcept {
+    *expected = nullptr;
+    if (sim->replay != nullptr && !sim->diverged) {
+        if (sim->replay_pos < sim->replay_len) {
+            const sched_sim_event* ev = &sim->replay[sim->replay_pos];
+            if (ev->kind == kind && ev->choice < n) {
+                *expected = ev;
+                ++sim->replay_pos;
+                return ev->choice;
+            }
+        }
+        sched_sim_diverge(sim);
+    }
+    return n > 1 ? (ib_u32)ut_rnd_bounded(&sim->rnd, n) : 0;
+}
+
+static void sched_sim_record(sched_sim* sim, sched_sim_event_kind kind, ib_u32 choice, ib_u64 task_id) noexcept {
+    if (sim->log_len == sim->log_capacity) {
+        sim->log_truncated = true;
+        return;
+    }
+    sim->log[sim->log_len++] = { kind, choice, task_id };
+}
+
+/// \brief Removes and returns a random ready task (the run loop calls this in simulation mode)
+sched_task* sched_sim_pick(sched_sim* sim) noexcept {
+    sched_worker* w = sim->worker;
+    if (w->ready_overflow == 0) return nullptr;
+    const sched_sim_event* expected;
+    const ib_u32 choice = sched_sim_decide(sim, SCHED_SIM_PICK, (ib_u32)w->ready_overflow, &expected);
+    // Index 0 is the oldest ready task
+    ut_dlink* link = w->ready.prev;
+    for (ib_u32 i = 0; i < choice; ++i) link = link->prev;
+    ut_dlink_detach(link);
+    --w->ready_overflow;
+    sched_task* t = sched_task_from_link(link);
+    if (expected != nullptr && expected->task_id != t->id) {
+        --sim->replay_pos;
+        sched_sim_diverge(sim);
+    }
+    sched_sim_record(sim, SCHED_SIM_PICK, choice, t->id);
+    return t;
+}
+
+/// \brief Lets a simulated source choose among `n` candidates (e.g. which pending I/O completes)
+ib_u32 sched_sim_choose(sched_sim* sim, ib_u32 n) noexcept {
+    IB_ASSERT(n > 0, "nothing to choose from");
+    const sched_sim_event* expected;
+    const ib_u32 choice = sched_sim_decide(sim, SCHED_SIM_CHOICE, n, &expected);
+    sched_sim_record(sim, SCHED_SIM_CHOICE, choice, 0);
+    return choice;
+}
+
+/// \brief Delivers a simulated completion: logs it and resumes `t`
+void sched_sim_complete(sched_sim* sim, sched_task* t) noexcept {
+    const sched_sim_event* expected;
+    sched_sim_decide(sim, SCHED_SIM_COMPLETE, 1, &expected);
+    if (expected != nullptr && expected->task_id != t->id) {
+        --sim->replay_pos;
+        sched_sim_diverge(sim);
+    }
+    sched_sim_record(sim, SCHED_SIM_COMPLETE, 0, t->id);
+    sched_resume(t);
+}
+
+/// \brief Runs `body` on a fresh simulated worker for each seed in [first_seed, first_seed + seeds)
+/// \param failure Receives the first seed for which `body` failed
+/// \param log Optional buffer; on failure it holds the decisions of the failing run
+/// \return 0 if every seed passed, the result of the failing body otherwise
+int sched_sim_explore(ib_u64 first_seed, ib_u64 seeds, sched_sim_body* body, void* ctx, sched_sim_failure* failure,
+                      sched_sim_event* log, ib_u64 log_capacity) noexcept {
+    IB_ASSERT_NOT_NULL(body);
+    for (ib_u64 seed = first_seed; seed != first_seed + seeds; ++seed) {
+        sched_worker w;
+        sched_worker_init(&w, 0);
+        sched_sim sim;
+        sched_sim_init(&sim, &w, seed, log, log_capacity);
+        const int rc = body(&w, ctx);
+        sched_sim_detach(&sim);
+        if (rc != 0) {
+            if (failure != nullptr) *failure = { seed, sim.log_len, rc };
+            return rc;
+        }
+    }
+    return 0;
+}
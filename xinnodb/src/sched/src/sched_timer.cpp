@@ -0,0 +1,151 @@
+#include "sched_timer.hpp"
+
+#include <bit>
+
+constexpr ib_u32 SCHED_TIMER_BITS = std::countr_zero(SCHED_TIMER_SLOTS);
+constexpr ib_u64 SCHED_TIMER_MASK = SCHED_TIMER_SLOTS - 1;
+constexpr ib_u64 SCHED_TIMER_SPAN = 1ull << (SCHED_TIMER_BITS * SCHED_TIMER_LEVELS);
+
+static_assert(std::has_single_bit(SCHED_TIMER_SLOTS) && SCHED_TIMER_SLOTS <= 64);
+
+static ib_u64 sched_timer_poll(sched_worker*, void* ctx) noexcept {
+    sched_timer_wheel* wh = (sched_timer_wheel*)ctx;
+    if (wh->pending == 0 || wh->clock == UT_CLOCK_MANUAL) return 0;
+    return sched_timer_advance(wh, ut_clock_ns(wh->clock));
+}
+
+/// \brief Attaches an empty wheel to `w` and registers it as a poller
+/// \param clock Time source read on every poll; with UT_CLOCK_MANUAL time moves only through
+/// sched_timer_advance()
+void sched_timer_wheel_init(sched_timer_wheel* wh, sched_worker* w, ut_clock_source clock, ib_u64 tick_ns) noexcept {
+    IB_ASSERT_NOT_NULL(wh);
+    IB_ASSERT_NOT_NULL(w);
+    IB_ASSERT(tick_ns > 0, "zero tick");
+    for (ib_u32 l = 0; l < SCHED_TIMER_LEVELS; ++l) {
+        for (ib_u32 s = 0; s < SCHED_TIMER_SLOTS; ++s) ut_dlink_init(&wh->slots[l][s]);
+        wh->occupied[l] = 0;
+    }
+    wh->tick            = 0;
+    wh->tick_ns         = tick_ns;
+    wh->origin_ns       = ut_clock_ns(clock);
+    wh->now_ns          = wh->origin_ns;
+    wh->clock           = clock;
+    wh->worker          = w;
+    wh->pending         = 0;
+    wh->armed_total     = 0;
+    wh->cancelled_total = 0;
+    wh->fired_total     = 0;
+    wh->cascaded_total  = 0;
+    sched_poller_register(w, &wh->poller, sched_timer_poll, wh);
+    w->ext[SCHED_EXT_TIMER] = wh;
+}
+
+void sched_timer_wheel_detach(sched_timer_wheel* wh) noexcept {
+    sched_poller_unregister(&wh->poller);
+    if (wh->worker->ext[SCHED_EXT_TIMER] == wh) wh->worker->ext[SCHED_EXT_TIMER] = nullptr;
+}
+
+void sched_timer_init(sched_timer* t, sched_timer_fn* fn, void* arg) noexcept {
+    IB_ASSERT_NOT_NULL(fn);
+    ut_dlink_init(&t->link);
+    t->expires = 0;
+    t->fn      = fn;
+    t->arg     = arg;
+    t->fired   = false;
+}
+
+/// \brief Links `t` into the finest level that covers its distance from the current tick
+static void sched_timer_place(sched_timer_wheel* wh, sched_timer* t) noexcept {
+    const ib_u64 delta = t->expires - wh->tick;
+    // Out of range: park at the far end of the last level, cascades bring it closer
+    const ib_u64 at = delta < SCHED_TIMER_SPAN ? t->expires : wh->tick + SCHED_TIMER_SPAN - 1;
+    ib_u32 level = 0;
+    while (level + 1 < SCHED_TIMER_LEVELS && (at - wh->tick) >= (1ull << (SCHED_TIMER_BITS * (level + 1)))) ++level;
+    const ib_u32 slot = (ib_u32)((at >> (SCHED_TIMER_BITS * level)) & SCHED_TIMER_MASK);
+    ut_dlink_enqueue(&wh->slots[level][slot], &t->link);
+    wh->occupied[level] |= 1ull << slot;
+}
+
+/// \brief Arms (or re-arms) `t` to fire once the clock reaches `deadline_ns`
+/// \details Deadlines are rounded up to the next tick; deadlines in the past fire on the next tick.
+void sched_timer_arm(sched_timer_wheel* wh, sched_timer* t, ib_u64 deadline_ns) noexcept {
+    if (sched_timer_armed(t)) {
+        ut_dlink_detach(&t->link);
+        --wh->pending;
+    }
+    ib_u64 expires = 0;
+    if (deadline_ns > wh->origin_ns) expires = (deadline_ns - wh->origin_ns + wh->tick_ns - 1) / wh->tick_ns;
+    if (expires <= wh->tick) expires = wh->tick + 1;
+    t->expires = expires;
+    t->fired   = false;
+    sched_timer_place(wh, t);
+    ++wh->pending;
+    ++wh->armed_total;
+}
+
+/// \brief Disarms `t`
+/// \return True if the timer was pending, false if it already fired or was never armed
+bool sched_timer_cancel(sched_timer_wheel* wh, sched_timer* t) noexcept {
+    if (!sched_timer_armed(t)) return false;
+    ut_dlink_detach(&t->link);
+    --wh->pending;
+    ++wh->cancelled_total;
+    return true;
+}
+
+static void sched_timer_cascade(sched_timer_wheel* wh, ib_u32 level, ib_u32 slot) noexcept {
+    ut_dlink* list = &wh->slots[level][slot];
+    wh->occupied[level] &= ~(1ull << slot);
+    while (ut_dlink* link = ut_dlink_dequeue(list)) {
+        sched_timer_place(wh, (sched_timer*)((char*)link - IB_OFFSET_OF(sched_timer, link)));
+        ++wh->cascaded_total;
+    }
+}
+
+/// \brief Moves the wheel to `now_ns` and fires every timer whose tick has passed
+/// \return The number of timers fired
+ib_u64 sched_timer_advance(sched_timer_wheel* wh, ib_u64 now_ns) noexcept {
+    if (now_ns > wh->now_ns) wh->now_ns = now_ns;
+    const ib_u64 target = (wh->now_ns - wh->origin_ns) / wh->tick_ns;
+    ib_u64 fired = 0;
+    while (wh->tick < target) {
+        if (wh->pending == 0) {
+            wh->tick = target;
+            break;
+        }
+        if (wh->occupied[0] == 0) {
+            // Nothing on level 0: jump to the tick before the next wrap-around
+            const ib_u64 last = wh->tick | SCHED_TIMER_MASK;
+            if (last >= target) {
+                wh->tick = target;
+                break;
+            }
+            wh->tick = last;
+        }
+        const ib_u64 tick = ++wh->tick;
+        const ib_u32 idx  = (ib_u32)(tick & SCHED_TIMER_MASK);
+        if (idx == 0) {
+            for (ib_u32 level = 1; level < SCHED_TIMER_LEVELS; ++level) {
+                const ib_u32 slot = (ib_u32)((tick >> (SCHED_TIMER_BITS * level)) & SCHED_TIMER_MASK);
+                sched_timer_cascade(wh, level, slot);
+                if (slot != 0) break;
+            }
+        }
+        ut_dlink* list = &wh->slots[0][idx];
+        while (ut_dlink* link = ut_dlink_dequeue(list)) {
+            sched_timer* t = (sched_timer*)((char*)link - IB_OFFSET_OF(sched_timer, link));
+            --wh->pending;
+            ++wh->fired_total;
+            ++fired;
+            t->fired = true;
+            t->fn(t, t->arg);
+        }
+        wh->occupied[0] &= ~(1ull << idx);
+    }
+    return fired;
+}
+
+/// \brief Default expiry callback: resumes the task passed as `arg`
+void sched_timer_resume_task(sched_timer*, void* task) noexcept {
+    sched_resume((sched_task*)task);
+}
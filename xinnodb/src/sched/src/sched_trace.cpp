@@ -0,0 +1,255 @@
+#include "sched_trace.hpp"
+#include "ut_print.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+/// \brief Sets up an event ring in `mem`
+/// \details The ring holds the largest power of two of events that fits in `size` bytes.
+/// \return 0 on success, -1 if not even two events fit
+int sched_trace_init(sched_trace* tr, void* mem, ib_size size) noexcept {
+    IB_ASSERT_NOT_NULL(tr);
+    IB_ASSERT(((ib_uintptr)mem & (alignof(sched_trace_event) - 1)) == 0, "misaligned trace memory");
+    ib_u64 capacity = mem != nullptr ? size / sizeof(sched_trace_event) : 0;
+    if (capacity < 2) return -1;
+    while ((capacity & (capacity - 1)) != 0) capacity &= capacity - 1;
+    tr->events = (sched_trace_event*)mem;
+    tr->mask   = capacity - 1;
+    tr->head   = 0;
+    tr->worker = 0;
+    return 0;
+}
+
+/// \brief Starts recording the tasks of `w` into `tr`; call on the thread that owns `w`
+void sched_trace_attach(sched_worker* w, sched_trace* tr) noexcept {
+    tr->worker = w->index;
+    w->trace   = tr;
+}
+
+void sched_trace_detach(sched_worker* w) noexcept {
+    w->trace = nullptr;
+}
+
+/// \brief Records one transition of `t` on `w` (called by the hooks once `w->trace` is set)
+void sched_trace_emit(sched_worker* w, sched_trace_kind kind, const sched_task* t, ib_u32 arg) noexcept {
+    sched_trace*       tr = w->trace;
+    sched_trace_event* e  = &tr->events[tr->head++ & tr->mask];
+    e->tsc      = __rdtsc();
+    e->task     = t->id;
+    e->kind     = kind;
+    e->cls      = (ib_u8)t->cls;
+    e->arg      = (ib_u16)arg;
+    e->reserved = 0;
+}
+
+const char* sched_trace_kind_name(sched_trace_kind kind) noexcept {
+    switch (kind) {
+    case SCHED_TRACE_CREATE:   return "create";
+    case SCHED_TRACE_RUN:      return "run";
+    case SCHED_TRACE_YIELD:    return "yield";
+    case SCHED_TRACE_SUSPEND:  return "suspend";
+    case SCHED_TRACE_COMPLETE: return "complete";
+    case SCHED_TRACE_RESUME:   return "resume";
+    case SCHED_TRACE_STEAL:    return "steal";
+    }
+    return "unknown";
+}
+
+const char* sched_suspend_reason_name(sched_suspend_reason reason) noexcept {
+    switch (reason) {
+    case SCHED_SUSPEND_NONE:         return "none";
+    case SCHED_SUSPEND_IO:           return "io";
+    case SCHED_SUSPEND_LATCH:        return "latch";
+    case SCHED_SUSPEND_ALLOC:        return "alloc";
+    case SCHED_SUSPEND_TIMER:        return "timer";
+    case SCHED_SUSPEND_EVENT:        return "event";
+    case SCHED_SUSPEND_REASON_COUNT: break;
+    }
+    return "unknown";
+}
+
+// -----------------------------------------------------------------------------
+// Chrome trace export
+// -----------------------------------------------------------------------------
+
+namespace {
+
+constexpr const char* SCHED_TRACE_CLASS_NAME[SCHED_CLASS_COUNT] = { "oltp", "background", "maintenance" };
+
+/// \brief Step being run by a worker
+struct sched_trace_slice {
+    ib_u64 task;
+    ib_u64 start;
+    bool   open;
+};
+
+/// \brief Async track state of a task
+struct sched_trace_task {
+    ib_u64      created;
+    ib_u64      wait_start;
+    const char* wait;           ///< Open wait span, nullptr if none
+    ib_u32      created_on;
+    bool        has_created;    ///< The create event is still in the ring
+};
+
+/// \brief Slot of the task table of an export: open addressing, linear probing, never erased
+struct sched_trace_task_slot {
+    ib_u64           id;
+    bool             used;
+    sched_trace_task st;
+};
+
+struct sched_trace_writer {
+    ut_print* out;
+    ib_u64    base;
+    bool      first;
+};
+
+const char* sched_trace_class_name(ib_u8 cls) noexcept {
+    return cls < SCHED_CLASS_COUNT ? SCHED_TRACE_CLASS_NAME[cls] : "unknown";
+}
+
+/// \brief Microseconds since the first event, as the format wants
+double sched_trace_us(const sched_trace_writer* wr, ib_u64 tsc) noexcept {
+    return (double)ut_clock_tsc_to_ns(tsc - wr->base) / 1000.0;
+}
+
+const char* sched_trace_sep(sched_trace_writer* wr) noexcept {
+    const char* sep = wr->first ? "\n" : ",\n";
+    wr->first = false;
+    return sep;
+}
+
+void sched_trace_async(sched_trace_writer* wr, ib_u64 task, ib_u32 worker, const char* name, ib_u64 begin, ib_u64 end) noexcept {
+    ut_print_fmt(wr->out, "{}{{\"ph\":\"b\",\"cat\":\"task\",\"id\":\"0x{:x}\",\"name\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f}}}",
+                 sched_trace_sep(wr), task, name, worker, sched_trace_us(wr, begin));
+    ut_print_fmt(wr->out, ",\n{{\"ph\":\"e\",\"cat\":\"task\",\"id\":\"0x{:x}\",\"name\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f}}}",
+                 task, name, worker, sched_trace_us(wr, end));
+}
+
+void sched_trace_wait_close(sched_trace_writer* wr, sched_trace_task* st, ib_u64 task, ib_u32 worker, ib_u64 now) noexcept {
+    if (st->wait != nullptr) sched_trace_async(wr, task, worker, st->wait, st->wait_start, now);
+    st->wait = nullptr;
+}
+
+void sched_trace_wait_open(sched_trace_task* st, const char* name, ib_u64 now) noexcept {
+    st->wait       = name;
+    st->wait_start = now;
+}
+
+/// \brief The state of task `id`, zeroed on first use; the table has room for every task
+sched_trace_task* sched_trace_task_of(sched_trace_task_slot* table, ib_u32 bits, ib_u64 id) noexcept {
+    const ib_u64 mask = ((ib_u64)1 << bits) - 1;
+    for (ib_u64 i = ((id ^ (id >> 31)) * 0x9e37'79b9'7f4a'7c15) >> (64 - bits);; i = (i + 1) & mask) {
+        sched_trace_task_slot* slot = &table[i];
+        if (slot->used && slot->id == id) return &slot->st;
+        if (!slot->used) {
+            slot->used = true;
+            slot->id   = id;
+            return &slot->st;
+        }
+    }
+}
+
+} // namespace
+
+/// \brief Writes the rings of `count` workers as one Chrome trace event JSON document
+/// \details Rings are merged by timestamp, which assumes a TSC synchronized across cores (any
+/// invariant TSC). Spans cut by ring wraparound at the start of the trace are dropped; spans still
+/// open at the end are left out. The per-task state of the export is one `malloc()` block, sized
+/// from the number of retained events.
+/// \return 0 on success, -1 if writing to `out` failed or the export state could not be allocated
+int sched_trace_export_chrome(std::FILE* out, const sched_trace* const* traces, ib_u32 count) noexcept {
+    IB_ASSERT_NOT_NULL(out);
+    ib_u64 events = 0;
+    for (ib_u32 i = 0; i < count; ++i) events += sched_trace_size(traces[i]);
+    ib_u32 bits = 1;
+    while (((ib_u64)1 << bits) < 2 * events) ++bits;
+    const ib_size table_size = sizeof(sched_trace_task_slot) << bits;
+    const ib_size state_size = table_size + count * (sizeof(sched_trace_slice) + sizeof(ib_u64));
+    void*         mem        = std::malloc(state_size);
+    if (mem == nullptr) return -1;
+    std::memset(mem, 0, state_size);
+    sched_trace_task_slot* table   = (sched_trace_task_slot*)mem;
+    sched_trace_slice*     running = (sched_trace_slice*)((char*)mem + table_size);   // by ring
+    ib_u64*                next    = (ib_u64*)(running + count);                        // next event of each ring
+
+    ib_u64 base = ~(ib_u64)0;
+    for (ib_u32 i = 0; i < count; ++i) {
+        if (sched_trace_size(traces[i]) != 0 && sched_trace_at(traces[i], 0)->tsc < base) base = sched_trace_at(traces[i], 0)->tsc;
+    }
+    ut_print           p;
+    sched_trace_writer wr = { &p, events == 0 ? 0 : base, true };
+    ut_print_init(&p, out);
+    ut_print_fmt(&p, "{{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    ut_print_fmt(&p, "{}{{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{{\"name\":\"xinnodb\"}}}}", sched_trace_sep(&wr));
+    for (ib_u32 i = 0; i < count; ++i) {
+        ut_print_fmt(&p, "{}{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"worker {}\"}}}}",
+                     sched_trace_sep(&wr), traces[i]->worker, traces[i]->worker);
+    }
+
+    for (;;) {
+        // The oldest pending event of all rings; on a tie, the ring listed first
+        ib_u32 r = count;
+        for (ib_u32 i = 0; i < count; ++i) {
+            if (next[i] == sched_trace_size(traces[i])) continue;
+            if (r == count || sched_trace_at(traces[i], next[i])->tsc < sched_trace_at(traces[r], next[r])->tsc) r = i;
+        }
+        if (r == count) break;
+        const sched_trace_event* e      = sched_trace_at(traces[r], next[r]++);
+        const ib_u32             worker = traces[r]->worker;
+        sched_trace_task&        st     = *sched_trace_task_of(table, bits, e->task);
+        sched_trace_slice&       step   = running[r];
+        switch ((sched_trace_kind)e->kind) {
+        case SCHED_TRACE_CREATE:
+            st.created     = e->tsc;
+            st.created_on  = worker;
+            st.has_created = true;
+            sched_trace_wait_open(&st, "runnable", e->tsc);
+            break;
+        case SCHED_TRACE_RUN:
+            sched_trace_wait_close(&wr, &st, e->task, worker, e->tsc);
+            step = { e->task, e->tsc, true };
+            break;
+        case SCHED_TRACE_YIELD:
+        case SCHED_TRACE_SUSPEND:
+        case SCHED_TRACE_COMPLETE: {
+            const char* end = sched_trace_kind_name((sched_trace_kind)e->kind);
+            if (step.open && step.task == e->task) {
+                ut_print_fmt(&p, "{}{{\"ph\":\"X\",\"name\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},"
+                                 "\"args\":{{\"task\":\"0x{:x}\",\"end\":\"{}\"",
+                             sched_trace_sep(&wr), sched_trace_class_name(e->cls), worker, sched_trace_us(&wr, step.start),
+                             (double)ut_clock_tsc_to_ns(e->tsc - step.start) / 1000.0, e->task, end);
+                if (e->kind == SCHED_TRACE_SUSPEND) {
+                    ut_print_fmt(&p, ",\"reason\":\"{}\"", sched_suspend_reason_name((sched_suspend_reason)e->arg));
+                }
+                ut_print_fmt(&p, "}}}}");
+            }
+            step.open = false;
+            if (e->kind == SCHED_TRACE_YIELD) {
+                sched_trace_wait_open(&st, "runnable", e->tsc);
+            } else if (e->kind == SCHED_TRACE_SUSPEND) {
+                sched_trace_wait_open(&st, sched_suspend_reason_name((sched_suspend_reason)e->arg), e->tsc);
+            } else {
+                if (st.has_created) {
+                    sched_trace_async(&wr, e->task, st.created_on, sched_trace_class_name(e->cls), st.created, e->tsc);
+                }
+                st = {};
+            }
+            break;
+        }
+        case SCHED_TRACE_RESUME:
+            sched_trace_wait_close(&wr, &st, e->task, worker, e->tsc);
+            sched_trace_wait_open(&st, "runnable", e->tsc);
+            break;
+        case SCHED_TRACE_STEAL:
+            ut_print_fmt(&p, "{}{{\"ph\":\"i\",\"s\":\"t\",\"name\":\"steal\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},"
+                             "\"args\":{{\"task\":\"0x{:x}\",\"from\":{}}}}}",
+                         sched_trace_sep(&wr), worker, sched_trace_us(&wr, e->tsc), e->task, e->arg);
+            break;
+        }
+    }
+    ut_print_fmt(&p, "\n]}}\n");
+    std::free(mem);
+    return ut_print_finish(&p);
+}
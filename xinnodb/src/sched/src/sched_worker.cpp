@@ -0,0 +1,505 @@
+#include "sched.hpp"
+#include "sched_pool.hpp"
+#include "sched_sim.hpp"
+
+#include <cstring>
+
+thread_local sched_worker* sched_tls_worker = nullptr;
+
+constexpr ib_u32 SCHED_RUNQ_MASK = SCHED_RUNQ_SIZE - 1;
+
+/// \brief Ticks between two checks of the pool injection queue while local work is available
+constexpr ib_u64 SCHED_INJECT_CHECK_INTERVAL = 61;
+
+/// \brief Default fair-queueing weight of each class
+constexpr ib_u32 SCHED_CLASS_DEFAULT_WEIGHT[SCHED_CLASS_COUNT] = { 16, 4, 1 };
+
+/// \brief Default step budget of each class, in nanoseconds
+constexpr ib_u64 SCHED_CLASS_DEFAULT_BUDGET_NS[SCHED_CLASS_COUNT] = { 1'000'000, 100'000, 100'000 };
+
+/// \brief Initializes a worker
+/// \param ebr Optional EBR participant; the worker keeps it online and reports quiescent points
+void sched_worker_init(sched_worker* w, ib_u32 index, ut_ebr_participant* ebr) noexcept {
+    IB_ASSERT_NOT_NULL(w);
+    std::memset((void*)w, 0, sizeof(*w));
+    w->runq.head.store(0, std::memory_order_relaxed);
+    w->runq.tail.store(0, std::memory_order_relaxed);
+    w->inbox.store(nullptr, std::memory_order_relaxed);
+    w->sleeping.store(0, std::memory_order_relaxed);
+    w->spawned_total.store(0, std::memory_order_relaxed);
+    w->finished_total.store(0, std::memory_order_relaxed);
+    ut_dlink_init(&w->ready);
+    ut_dlink_init(&w->pollers);
+    for (ib_u32 c = 0; c < SCHED_CLASS_COUNT; ++c) {
+        ut_dlink_init(&w->classes[c].ready);
+        sched_class_configure(w, (sched_class)c, SCHED_CLASS_DEFAULT_WEIGHT[c], SCHED_CLASS_DEFAULT_BUDGET_NS[c]);
+    }
+    w->index = index;
+    w->cpu   = -1;
+    w->ebr   = ebr;
+    ut_rnd_init(&w->rnd, ((ib_u64)index << 32) ^ ut_rnd_entropy());
+}
+
+void sched_task_init(sched_task* t, sched_fn* fn, void* arg, sched_exit_fn* on_exit) noexcept {
+    IB_ASSERT_NOT_NULL(t);
+    IB_ASSERT_NOT_NULL(fn);
+    ut_dlink_init(&t->link);
+    t->fn             = fn;
+    t->arg            = arg;
+    t->on_exit        = on_exit;
+    t->worker         = nullptr;
+    t->inbox_next     = nullptr;
+    t->id             = 0;
+    t->state          = SCHED_TASK_CREATED;
+    t->suspend_reason = SCHED_SUSPEND_NONE;
+    t->cls            = SCHED_CLASS_OLTP;
+    t->rnd.state      = 0;
+    std::memset(t->locals, 0, sizeof(t->locals));
+    std::memset(&t->acct, 0, sizeof(t->acct));
+    t->arena = nullptr;
+}
+
+/// \brief Gives a task about to be spawned the task-local slots and the class of `parent`
+void sched_task_inherit(sched_task* t, const sched_task* parent) noexcept {
+    IB_ASSERT_EQ(t->state, SCHED_TASK_CREATED, "task already spawned");
+    std::memcpy(t->locals, parent->locals, sizeof(t->locals));
+    t->cls = parent->cls;
+}
+
+/// \brief Sets the share and the step budget of a priority class on `w`
+/// \param weight Relative share of the worker while several classes have ready tasks
+/// \param budget_ns Run time of a step before sched_budget_exceeded() asks it to yield, 0 for no limit
+/// \param budget_iters Checkpoints of a step before it is asked to yield, 0 for no limit
+void sched_class_configure(sched_worker* w, sched_class cls, ib_u32 weight, ib_u64 budget_ns, ib_u32 budget_iters) noexcept {
+    IB_ASSERT(cls < SCHED_CLASS_COUNT, "invalid class");
+    sched_class_state* c = &w->classes[cls];
+    c->weight        = weight != 0 ? weight : 1;
+    c->budget_cycles = budget_ns != 0 ? ut_clock_ns_to_tsc(budget_ns) : ~0ull;
+    c->budget_iters  = budget_iters;
+}
+
+/// \brief Binds a task to `w` and makes it ready
+/// \details Must run on the thread that owns `w`; other threads use sched_pool_inject().
+void sched_spawn(sched_worker* w, sched_task* t) noexcept {
+    IB_ASSERT_EQ(t->state, SCHED_TASK_CREATED, "task spawned twice");
+    t->worker = w;
+    t->id     = ((ib_u64)w->index << 48) | ++w->next_task_seq;
+    t->state  = SCHED_TASK_READY;
+    ut_rnd_fork(&w->rnd, &t->rnd);
+    ++w->live_tasks;
+    w->spawned_total.store(w->spawned_total.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    sched_ready_push(w, t);
+    if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_CREATE, t);
+    if (w->pool != nullptr) sched_pool_notify(w->pool);
+}
+
+// -----------------------------------------------------------------------------
+// Ready queue
+// -----------------------------------------------------------------------------
+
+static bool sched_runq_push(sched_runq* q, sched_task* t) noexcept {
+    const ib_u32 tail = q->tail.load(std::memory_order_relaxed);
+    const ib_u32 head = q->head.load(std::memory_order_acquire);
+    if (tail - head >= SCHED_RUNQ_SIZE) return false;
+    q->slots[tail & SCHED_RUNQ_MASK].store(t, std::memory_order_relaxed);
+    q->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+/// \brief Moves the oldest tasks of `list` (linked FIFO, `count` of them) into the free slots of the
+/// ring, published with one release store of the tail
+/// \return The number of tasks moved; the others stay on `list`
+static ib_u64 sched_runq_push_list(sched_runq* q, ut_dlink* list, ib_u64 count) noexcept {
+    const ib_u32 tail = q->tail.load(std::memory_order_relaxed);
+    const ib_u32 head = q->head.load(std::memory_order_acquire);
+    const ib_u64 free = SCHED_RUNQ_SIZE - (tail - head);
+    const ib_u32 n    = (ib_u32)(count < free ? count : free);
+    for (ib_u32 i = 0; i < n; ++i) {
+        q->slots[(tail + i) & SCHED_RUNQ_MASK].store(sched_task_from_link(ut_dlink_dequeue(list)), std::memory_order_relaxed);
+    }
+    if (n != 0) q->tail.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+static sched_task* sched_runq_pop(sched_runq* q) noexcept {
+    ib_u32 head = q->head.load(std::memory_order_acquire);
+    for (;;) {
+        const ib_u32 tail = q->tail.load(std::memory_order_relaxed);
+        if (tail == head) return nullptr;
+        sched_task* t = q->slots[head & SCHED_RUNQ_MASK].load(std::memory_order_relaxed);
+        if (q->head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_acquire)) return t;
+    }
+}
+
+/// \brief Moves about half of `victim`'s ring to `thief`'s (empty) ring
+/// \return The number of stolen tasks
+ib_u32 sched_runq_steal(sched_worker* victim, sched_worker* thief) noexcept {
+    sched_task* grabbed[SCHED_RUNQ_SIZE / 2];
+    sched_runq* q = &victim->runq;
+    ib_u32 n;
+    for (;;) {
+        ib_u32 head = q->head.load(std::memory_order_acquire);
+        const ib_u32 tail = q->tail.load(std::memory_order_acquire);
+        n = tail - head;
+        n = n - n / 2;
+        if (n == 0) return 0;
+        if (n > SCHED_RUNQ_SIZE / 2) continue;  // inconsistent snapshot, the owner raced ahead
+        for (ib_u32 i = 0; i < n; ++i) {
+            grabbed[i] = q->slots[(head + i) & SCHED_RUNQ_MASK].load(std::memory_order_relaxed);
+        }
+        if (q->head.compare_exchange_strong(head, head + n, std::memory_order_acq_rel, std::memory_order_acquire)) break;
+    }
+    for (ib_u32 i = 0; i < n; ++i) {
+        grabbed[i]->worker = thief;
+        sched_ready_push(thief, grabbed[i]);
+        if (thief->trace != nullptr) [[unlikely]] sched_trace_emit(thief, SCHED_TRACE_STEAL, grabbed[i], victim->index);
+    }
+    ++thief->steals;
+    thief->stolen_tasks += n;
+    return n;
+}
+
+static bool sched_oltp_empty(const sched_worker* w) noexcept {
+    return w->ready_overflow == 0 &&
+           w->runq.head.load(std::memory_order_acquire) == w->runq.tail.load(std::memory_order_acquire);
+}
+
+/// \brief A class that was idle does not bank the time it did not use
+static void sched_class_activate(sched_worker* w, sched_class cls) noexcept {
+    sched_class_state* c = &w->classes[cls];
+    if (c->vtime < w->vclock) c->vtime = w->vclock;
+}
+
+/// \brief Appends a ready task to the FIFO of its class (OLTP: ring first, overflow list when full)
+void sched_ready_push(sched_worker* w, sched_task* t) noexcept {
+    if (w->sim != nullptr) [[unlikely]] {
+        // Simulation picks among all ready tasks: keep them on the list only
+        ut_dlink_enqueue(&w->ready, &t->link);
+        ++w->ready_overflow;
+        return;
+    }
+    if (t->cls != SCHED_CLASS_OLTP) {
+        sched_class_state* c = &w->classes[t->cls];
+        if (c->ready_count++ == 0) sched_class_activate(w, t->cls);
+        ut_dlink_enqueue(&c->ready, &t->link);
+        return;
+    }
+    if (sched_oltp_empty(w)) sched_class_activate(w, SCHED_CLASS_OLTP);
+    // Once tasks spilled, keep FIFO order by queueing behind them
+    if (w->ready_overflow == 0 && sched_runq_push(&w->runq, t)) return;
+    ut_dlink_enqueue(&w->ready, &t->link);
+    ++w->ready_overflow;
+}
+
+static sched_task* sched_oltp_pop(sched_worker* w) noexcept {
+    sched_task* t = sched_runq_pop(&w->runq);
+    if (t != nullptr || w->ready_overflow == 0) return t;
+    // Refill the ring from the overflow list so the spilled tasks become stealable again
+    for (ib_u32 i = 0; i < SCHED_RUNQ_SIZE / 2 && w->ready_overflow != 0; ++i) {
+        sched_task* o = sched_task_from_link(ut_dlink_dequeue(&w->ready));
+        --w->ready_overflow;
+        if (!sched_runq_push(&w->runq, o)) {
+            ut_dlink_insert_prev(&w->ready, &o->link);
+            ++w->ready_overflow;
+            break;
+        }
+    }
+    return sched_runq_pop(&w->runq);
+}
+
+/// \brief Weighted fair queueing: the class with ready tasks and the smallest virtual time runs
+static sched_task* sched_ready_pop(sched_worker* w) noexcept {
+    if (w->sim != nullptr) [[unlikely]] return sched_sim_pick(w->sim);
+    sched_class_state* classes = w->classes;
+    if (classes[SCHED_CLASS_BACKGROUND].ready_count == 0 && classes[SCHED_CLASS_MAINTENANCE].ready_count == 0) [[likely]] {
+        sched_task* t = sched_oltp_pop(w);
+        if (t != nullptr) w->vclock = classes[SCHED_CLASS_OLTP].vtime;
+        return t;
+    }
+    bool skip_oltp = false;
+    for (;;) {
+        ib_u32 best = SCHED_CLASS_COUNT;
+        for (ib_u32 c = 0; c < SCHED_CLASS_COUNT; ++c) {
+            const bool ready = c == SCHED_CLASS_OLTP ? !skip_oltp && !sched_oltp_empty(w) : classes[c].ready_count != 0;
+            if (ready && (best == SCHED_CLASS_COUNT || classes[c].vtime < classes[best].vtime)) best = c;
+        }
+        if (best == SCHED_CLASS_COUNT) return nullptr;
+        w->vclock = classes[best].vtime;
+        if (best != SCHED_CLASS_OLTP) {
+            --classes[best].ready_count;
+            return sched_task_from_link(ut_dlink_dequeue(&classes[best].ready));
+        }
+        if (sched_task* t = sched_oltp_pop(w)) return t;
+        skip_oltp = true;  // thieves emptied the ring meanwhile
+    }
+}
+
+bool sched_ready_empty(const sched_worker* w) noexcept {
+    return sched_oltp_empty(w) && w->classes[SCHED_CLASS_BACKGROUND].ready_count == 0 &&
+           w->classes[SCHED_CLASS_MAINTENANCE].ready_count == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Remote resumes
+// -----------------------------------------------------------------------------
+
+/// \brief Hands a resumed task to its worker from another thread
+void sched_resume_remote(sched_task* t) noexcept {
+    sched_worker* w   = t->worker;
+    t->state          = SCHED_TASK_READY;
+    t->suspend_reason = SCHED_SUSPEND_NONE;
+    sched_task* head = w->inbox.load(std::memory_order_relaxed);
+    do {
+        t->inbox_next = head;
+    } while (!w->inbox.compare_exchange_weak(head, t, std::memory_order_release, std::memory_order_relaxed));
+    // Pairs with the fence in sched_pool_park(): either the worker sees the task or we see it asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w->sleeping.load(std::memory_order_relaxed) != 0) sched_pool_wake(w);
+}
+
+static void sched_inbox_drain(sched_worker* w) noexcept {
+    if (w->inbox.load(std::memory_order_relaxed) == nullptr) return;
+    sched_task* list = w->inbox.exchange(nullptr, std::memory_order_acquire);
+    // The inbox is LIFO: reverse it so remote resumes keep their order
+    sched_task* fifo = nullptr;
+    while (list != nullptr) {
+        sched_task* next = list->inbox_next;
+        list->inbox_next = fifo;
+        fifo = list;
+        list = next;
+    }
+    for (sched_task* t = fifo; t != nullptr;) {
+        sched_task* next = t->inbox_next;
+        t->inbox_next = nullptr;
+        --w->suspended_tasks;
+        ++w->resumes;
+        ++w->remote_resumes;
+        sched_ready_push(w, t);
+        if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_RESUME, t, 1);
+        t = next;
+    }
+}
+
+/// \brief Chains the tasks of `list` that belong to worker `w` in reverse order (the inbox is LIFO)
+/// \return The head of the chain, nullptr if there are none; `*tail` is its last task
+static sched_task* sched_inbox_chain(ut_dlink* list, sched_worker* w, sched_task** tail) noexcept {
+    sched_task* head = nullptr;
+    for (ut_dlink* it = list->prev; it != list;) {
+        sched_task* t    = sched_task_from_link(it);
+        ut_dlink*   prev = it->prev;
+        if (t->worker == w) {
+            ut_dlink_detach(it);
+            t->state          = SCHED_TASK_READY;
+            t->suspend_reason = SCHED_SUSPEND_NONE;
+            if (head == nullptr) *tail = t;
+            t->inbox_next = head;
+            head          = t;
+        }
+        it = prev;
+    }
+    return head;
+}
+
+/// \brief Makes ready every suspended task linked on `list` (through `sched_task::link`), in order
+/// \details The batch counterpart of sched_resume(), for wakeups of many waiters (events,
+/// barriers, group commit). The OLTP tasks of the calling worker fill the free slots of its ring,
+/// where siblings can steal them, with one release store of the ring's tail; the rest is spliced
+/// onto the tail of its ready FIFO, one splice per class; the tasks of another worker are pushed to its inbox as one chain, with one
+/// compare-and-swap and at most one wakeup per worker. `list` is left empty.
+void sched_resume_list(ut_dlink* list) noexcept {
+    sched_worker* self = sched_tls_worker;
+    ut_dlink      local[SCHED_CLASS_COUNT];
+    ib_u64        count[SCHED_CLASS_COUNT] = {};
+    ut_dlink      remote;
+    for (ib_u32 c = 0; c < SCHED_CLASS_COUNT; ++c) ut_dlink_init(&local[c]);
+    ut_dlink_init(&remote);
+
+    while (ut_dlink* link = ut_dlink_dequeue(list)) {
+        sched_task* t = sched_task_from_link(link);
+        IB_ASSERT_EQ(t->state, SCHED_TASK_SUSPENDED, "resuming a task that is not suspended");
+        if (t->worker != self) {
+            ut_dlink_enqueue(&remote, link);
+            continue;
+        }
+        t->state          = SCHED_TASK_READY;
+        t->suspend_reason = SCHED_SUSPEND_NONE;
+        --self->suspended_tasks;
+        ++self->resumes;
+        if (self->trace != nullptr) [[unlikely]] sched_trace_emit(self, SCHED_TRACE_RESUME, t);
+        if (t == self->current) {
+            self->step_state = SCHED_TASK_READY;
+            continue;
+        }
+        const sched_class cls = self->sim != nullptr ? SCHED_CLASS_OLTP : t->cls;
+        ut_dlink_enqueue(&local[cls], link);
+        ++count[cls];
+    }
+
+    if (count[SCHED_CLASS_OLTP] != 0) {
+        if (self->sim == nullptr && sched_oltp_empty(self)) sched_class_activate(self, SCHED_CLASS_OLTP);
+        // As many as fit into the ring, in one batch, so that idle siblings can steal them; once
+        // tasks spilled, FIFO order keeps the rest behind them
+        if (self->sim == nullptr && self->ready_overflow == 0) {
+            count[SCHED_CLASS_OLTP] -= sched_runq_push_list(&self->runq, &local[SCHED_CLASS_OLTP], count[SCHED_CLASS_OLTP]);
+        }
+        // The rest goes through the overflow list: sched_oltp_pop() refills the ring from it
+        ut_dlink_splice(&self->ready, &local[SCHED_CLASS_OLTP]);
+        self->ready_overflow += count[SCHED_CLASS_OLTP];
+    }
+    for (ib_u32 c = 0; c < SCHED_CLASS_COUNT; ++c) {
+        if (c == SCHED_CLASS_OLTP || count[c] == 0) continue;
+        sched_class_state* cs = &self->classes[c];
+        if (cs->ready_count == 0) sched_class_activate(self, (sched_class)c);
+        ut_dlink_splice(&cs->ready, &local[c]);
+        cs->ready_count += count[c];
+    }
+
+    while (!ut_dlink_is_detached(&remote)) {
+        sched_worker* w    = sched_task_from_link(remote.prev)->worker;
+        sched_task*   tail = nullptr;
+        sched_task*   head = sched_inbox_chain(&remote, w, &tail);
+        sched_task*   top  = w->inbox.load(std::memory_order_relaxed);
+        do {
+            tail->inbox_next = top;
+        } while (!w->inbox.compare_exchange_weak(top, head, std::memory_order_release, std::memory_order_relaxed));
+        // Pairs with the fence in sched_pool_park(), as in sched_resume_remote()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (w->sleeping.load(std::memory_order_relaxed) != 0) sched_pool_wake(w);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Pollers
+// -----------------------------------------------------------------------------
+
+void sched_poller_register(sched_worker* w, sched_poller* p, sched_poll_fn* poll, void* ctx) noexcept {
+    IB_ASSERT_NOT_NULL(poll);
+    p->poll = poll;
+    p->ctx  = ctx;
+    ut_dlink_enqueue(&w->pollers, &p->link);
+}
+
+void sched_poller_unregister(sched_poller* p) noexcept {
+    ut_dlink_detach(&p->link);
+}
+
+/// \brief Polls every registered completion source once
+/// \return The number of tasks resumed by the pollers
+ib_u64 sched_poll(sched_worker* w) noexcept {
+    ib_u64 resumed = 0;
+    for (ut_dlink* it = w->pollers.next; it != &w->pollers;) {
+        ut_dlink*     next = it->next;  // a poller may unregister itself
+        sched_poller* p    = (sched_poller*)((char*)it - IB_OFFSET_OF(sched_poller, link));
+        resumed += p->poll(w, p->ctx);
+        it = next;
+    }
+    return resumed;
+}
+
+// -----------------------------------------------------------------------------
+// Run loop
+// -----------------------------------------------------------------------------
+
+/// \brief Runs one step of `t`, then settles the task according to what the step asked for
+/// \details The outcome is read from the worker, not from the task: a task suspended by the step
+/// may already be in the hands of the thread that resumes it.
+static void sched_run_step(sched_worker* w, sched_task* t) noexcept {
+    t->worker  = w;
+    t->state   = SCHED_TASK_RUNNING;
+    w->current = t;
+    sched_class_state* c = &w->classes[t->cls];
+    w->step_iters = 0;
+    w->step_state = SCHED_TASK_RUNNING;
+    if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_RUN, t);
+    ut_acct_tls   = &t->acct;
+    co_arena_tls  = t->arena;
+    w->step_start = __rdtsc();
+    t->fn(w, t);
+    const ib_u64 cycles = __rdtsc() - w->step_start;
+    ut_acct_tls  = nullptr;
+    co_arena_tls = nullptr;
+    t->acct.cycles += cycles;
+    ++t->acct.steps;
+    c->cycles += cycles;
+    c->vtime  += cycles / c->weight;
+    ++c->steps;
+    w->current = nullptr;
+    ++w->switches;
+    switch (w->step_state) {
+    case SCHED_TASK_READY:
+        if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_YIELD, t);
+        sched_ready_push(w, t);
+        break;
+    case SCHED_TASK_SUSPENDED:
+        if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_SUSPEND, t, w->step_reason);
+        break;
+    default:
+        // The step returned without yielding or suspending: the task is finished
+        if (w->trace != nullptr) [[unlikely]] sched_trace_emit(w, SCHED_TRACE_COMPLETE, t);
+        t->state = SCHED_TASK_DONE;
+        --w->live_tasks;
+        ++c->finished;
+        ut_acct_add(&c->acct, &t->acct);
+        if (t->on_exit != nullptr) t->on_exit(w, t);
+        w->finished_total.store(w->finished_total.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        break;
+    }
+    if (w->ebr != nullptr) ut_ebr_quiescent(w->ebr);
+}
+
+/// \brief Picks the next task: local FIFO, then (in a pool) the injection queue and siblings
+static sched_task* sched_next_task(sched_worker* w) noexcept {
+    sched_pool* pool = w->pool;
+    // Check the injection queue now and then so client work is not starved by local work
+    if (pool != nullptr && ++w->tick % SCHED_INJECT_CHECK_INTERVAL == 0) {
+        if (sched_task* t = sched_pool_take(pool, w)) return t;
+    }
+    if (sched_task* t = sched_ready_pop(w)) return t;
+    if (pool == nullptr) return nullptr;
+    if (sched_task* t = sched_pool_take(pool, w)) return t;
+    if (sched_pool_steal(pool, w) != 0) return sched_ready_pop(w);
+    return nullptr;
+}
+
+/// \brief Runs up to SCHED_RUN_BATCH ready tasks, then polls the completion sources
+/// \return The number of steps run
+ib_u64 sched_run_once(sched_worker* w) noexcept {
+    sched_worker* saved = sched_tls_worker;
+    sched_tls_worker = w;
+    sched_inbox_drain(w);
+    ib_u64 ran = 0;
+    while (ran < SCHED_RUN_BATCH && !w->stop) {
+        sched_task* t = sched_next_task(w);
+        if (t == nullptr) break;
+        sched_run_step(w, t);
+        ++ran;
+    }
+    sched_poll(w);
+    sched_tls_worker = saved;
+    return ran;
+}
+
+/// \brief Runs a standalone worker loop
+/// \details Returns when sched_stop() is called, when every task has finished, or when only
+/// suspended tasks are left and no poller is registered that could resume them.
+/// While idle the worker goes offline for EBR so it does not hold back reclamation.
+void sched_run(sched_worker* w) noexcept {
+    w->stop = false;
+    if (w->ebr != nullptr) ut_ebr_online(w->ebr);
+    ut_backoff backoff;
+    ut_backoff_init(&backoff, &w->rnd);
+    bool idle = false;
+    while (!w->stop && w->live_tasks != 0) {
+        if (sched_run_once(w) != 0 || !sched_ready_empty(w) || w->inbox.load(std::memory_order_acquire) != nullptr) {
+            if (idle && w->ebr != nullptr) ut_ebr_online(w->ebr);
+            idle = false;
+            ut_backoff_reset(&backoff);
+            continue;
+        }
+        if (ut_dlink_is_detached(&w->pollers)) break;
+        if (!idle && w->ebr != nullptr) ut_ebr_offline(w->ebr);
+        idle = true;
+        ut_backoff_pause(&backoff);
+    }
+    if (!idle && w->ebr != nullptr) ut_ebr_offline(w->ebr);
+}
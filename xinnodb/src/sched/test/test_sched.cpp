@@ -0,0 +1,330 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sched.hpp" // IWYU pragma: keep
+
+namespace {
+
+struct Trace {
+    std::string out;
+    int         steps_left;
+    char        tag;
+};
+
+void yield_step(sched_worker*, sched_task* t) noexcept {
+    Trace* tr = static_cast<Trace*>(t->arg);
+    tr->out.push_back(tr->tag);
+    if (--tr->steps_left > 0) sched_yield(t, yield_step);
+}
+
+struct Shared {
+    std::string out;
+    ut_dlink    waiters;
+};
+
+struct Waiter {
+    sched_task task;
+    Shared*    shared;
+};
+
+void waiter_resumed(sched_worker*, sched_task* t) noexcept {
+    Waiter* w = (Waiter*)t;
+    w->shared->out += "resumed;";
+}
+
+void waiter_start(sched_worker*, sched_task* t) noexcept {
+    Waiter* w = (Waiter*)t;
+    w->shared->out += "wait;";
+    ut_dlink_enqueue(&w->shared->waiters, &t->link);
+    sched_suspend(t, waiter_resumed, SCHED_SUSPEND_EVENT);
+}
+
+void tagged_resumed(sched_worker*, sched_task* t) noexcept {
+    Waiter* w = (Waiter*)t;
+    w->shared->out.push_back(*static_cast<const char*>(t->arg));
+}
+
+void tagged_start(sched_worker*, sched_task* t) noexcept {
+    Waiter* w = (Waiter*)t;
+    ut_dlink_enqueue(&w->shared->waiters, &t->link);
+    sched_suspend(t, tagged_resumed, SCHED_SUSPEND_EVENT);
+}
+
+void batch_waker_start(sched_worker*, sched_task* t) noexcept {
+    Shared* s = static_cast<Shared*>(t->arg);
+    s->out += "wake;";
+    sched_resume_list(&s->waiters);
+}
+
+/// Where a batch of woken OLTP tasks landed: in the ring, or on the overflow list
+struct Landing {
+    Shared              shared;
+    ib_u32              in_ring;
+    ib_u64              overflow;
+    std::vector<ib_u32> order;   ///< Indexes of the woken tasks, in the order they ran
+};
+
+struct LandingWaiter {
+    sched_task task;
+    Landing*   landing;
+    ib_u32     index;
+};
+
+void landing_resumed(sched_worker*, sched_task* t) noexcept {
+    LandingWaiter* w = (LandingWaiter*)t;
+    w->landing->order.push_back(w->index);
+}
+
+void landing_start(sched_worker*, sched_task* t) noexcept {
+    LandingWaiter* w = (LandingWaiter*)t;
+    ut_dlink_enqueue(&w->landing->shared.waiters, &t->link);
+    sched_suspend(t, landing_resumed, SCHED_SUSPEND_EVENT);
+}
+
+void landing_waker_start(sched_worker* w, sched_task* t) noexcept {
+    Landing* l = static_cast<Landing*>(t->arg);
+    sched_resume_list(&l->shared.waiters);
+    l->in_ring  = w->runq.tail.load() - w->runq.head.load();
+    l->overflow = w->ready_overflow;
+}
+
+void waker_start(sched_worker*, sched_task* t) noexcept {
+    Shared* s = static_cast<Shared*>(t->arg);
+    s->out += "wake;";
+    while (ut_dlink* link = ut_dlink_dequeue(&s->waiters)) {
+        sched_resume(sched_task_from_link(link));
+    }
+}
+
+struct Poll {
+    sched_task* parked;
+    int         polls_before_wake;
+    int         polls;
+};
+
+ib_u64 poll_wake(sched_worker*, void* ctx) noexcept {
+    Poll* p = static_cast<Poll*>(ctx);
+    ++p->polls;
+    if (p->parked != nullptr && p->polls >= p->polls_before_wake) {
+        sched_task* t = p->parked;
+        p->parked = nullptr;
+        sched_resume(t);
+        return 1;
+    }
+    return 0;
+}
+
+void io_done(sched_worker*, sched_task*) noexcept {}
+
+void io_start(sched_worker*, sched_task* t) noexcept {
+    static_cast<Poll*>(t->arg)->parked = t;
+    sched_suspend(t, io_done, SCHED_SUSPEND_IO);
+}
+
+void check_current(sched_worker* w, sched_task* t) noexcept {
+    *static_cast<bool*>(t->arg) = sched_current_worker() == w && sched_current_task() == t;
+}
+
+int exits = 0;
+void count_exit(sched_worker*, sched_task*) noexcept { ++exits; }
+
+} // namespace
+
+TEST(SchedTest, YieldInterleavesReadyTasksInFifoOrder) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    Trace a{ "", 3, 'a' }, b{ "", 2, 'b' };
+    sched_task ta, tb;
+    sched_task_init(&ta, yield_step, &a);
+    sched_task_init(&tb, yield_step, &b);
+    sched_spawn(&w, &ta);
+    sched_spawn(&w, &tb);
+    sched_run(&w);
+    EXPECT_EQ(a.out, "aaa");
+    EXPECT_EQ(b.out, "bb");
+    EXPECT_EQ(ta.state, SCHED_TASK_DONE);
+    EXPECT_EQ(tb.state, SCHED_TASK_DONE);
+    EXPECT_EQ(w.switches, 5u);
+    EXPECT_EQ(w.yields, 3u);
+    EXPECT_EQ(w.live_tasks, 0);
+    EXPECT_NE(ta.id, tb.id);
+}
+
+TEST(SchedTest, SuspendedTasksResumeWhenWoken) {
+    sched_worker w;
+    sched_worker_init(&w, 1);
+    Shared s;
+    ut_dlink_init(&s.waiters);
+    Waiter w1, w2;
+    w1.shared = w2.shared = &s;
+    sched_task_init(&w1.task, waiter_start, nullptr);
+    sched_task_init(&w2.task, waiter_start, nullptr);
+    sched_task waker;
+    sched_task_init(&waker, waker_start, &s);
+    sched_spawn(&w, &w1.task);
+    sched_spawn(&w, &w2.task);
+    sched_spawn(&w, &waker);
+    sched_run(&w);
+    EXPECT_EQ(s.out, "wait;wait;wake;resumed;resumed;");
+    EXPECT_EQ(w.suspends[SCHED_SUSPEND_EVENT], 2u);
+    EXPECT_EQ(w.resumes, 2u);
+    EXPECT_EQ(w.suspended_tasks, 0);
+}
+
+TEST(SchedTest, RunReturnsWhenOnlyUnwakeableTasksAreLeft) {
+    sched_worker w;
+    sched_worker_init(&w, 2);
+    Shared s;
+    ut_dlink_init(&s.waiters);
+    Waiter w1;
+    w1.shared = &s;
+    sched_task_init(&w1.task, waiter_start, nullptr);
+    sched_spawn(&w, &w1.task);
+    sched_run(&w);
+    EXPECT_EQ(w1.task.state, SCHED_TASK_SUSPENDED);
+    EXPECT_EQ(w.live_tasks, 1);
+
+    // A task spawned later can still wake it
+    sched_task waker;
+    sched_task_init(&waker, waker_start, &s);
+    sched_spawn(&w, &waker);
+    sched_run(&w);
+    EXPECT_EQ(w1.task.state, SCHED_TASK_DONE);
+    EXPECT_EQ(s.out, "wait;wake;resumed;");
+}
+
+TEST(SchedTest, PollersResumeParkedTasks) {
+    sched_worker w;
+    sched_worker_init(&w, 3);
+    Poll p{ nullptr, 5, 0 };
+    sched_poller poller;
+    sched_poller_register(&w, &poller, poll_wake, &p);
+    sched_task t;
+    sched_task_init(&t, io_start, &p, count_exit);
+    exits = 0;
+    sched_spawn(&w, &t);
+    sched_run(&w);
+    EXPECT_EQ(t.state, SCHED_TASK_DONE);
+    EXPECT_EQ(exits, 1);
+    EXPECT_GE(p.polls, 5);
+    EXPECT_EQ(w.suspends[SCHED_SUSPEND_IO], 1u);
+    sched_poller_unregister(&poller);
+}
+
+TEST(SchedTest, CurrentWorkerAndTaskAreVisibleInsideSteps) {
+    sched_worker w;
+    sched_worker_init(&w, 4);
+    bool ok = false;
+    sched_task t;
+    sched_task_init(&t, check_current, &ok);
+    sched_spawn(&w, &t);
+    sched_run(&w);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(sched_current_worker(), nullptr);
+    EXPECT_EQ(sched_current_task(), nullptr);
+}
+
+TEST(SchedTest, TaskBoundariesAreEbrQuiescentPoints) {
+    ut_ebr_domain d;
+    ut_ebr_domain_init(&d, UT_EBR_MODE_EPOCH);
+    ut_ebr_participant p;
+    ASSERT_EQ(ut_ebr_participant_register(&d, &p, [](void*, void*) noexcept {}, nullptr), 0);
+    sched_worker w;
+    sched_worker_init(&w, 5, &p);
+
+    // Each step advances the epoch; the worker must re-announce it between steps
+    Trace tr{ "", 4, 'x' };
+    sched_task t;
+    sched_task_init(&t, [](sched_worker* wk, sched_task* tk) noexcept {
+        EXPECT_TRUE(ut_ebr_try_advance(wk->ebr->domain));
+        yield_step(wk, tk);
+    }, &tr);
+    sched_spawn(&w, &t);
+    sched_run(&w);
+    EXPECT_EQ(tr.out, "xxxx");
+    EXPECT_FALSE(ut_ebr_is_active(&p));
+    ut_ebr_participant_unregister(&p);
+}
+
+TEST(SchedTest, ResumeListSplicesWaitersInArrivalOrder) {
+    sched_worker w;
+    sched_worker_init(&w, 6);
+    Shared s;
+    ut_dlink_init(&s.waiters);
+    Waiter      waiters[4];
+    const char* tags = "abcd";
+    for (int i = 0; i < 4; ++i) {
+        waiters[i].shared = &s;
+        sched_task_init(&waiters[i].task, tagged_start, (void*)(tags + i));
+        sched_spawn(&w, &waiters[i].task);
+    }
+    sched_task waker;
+    sched_task_init(&waker, batch_waker_start, &s);
+    sched_spawn(&w, &waker);
+    sched_run(&w);
+    EXPECT_EQ(s.out, "wake;abcd");
+    EXPECT_TRUE(ut_dlink_is_detached(&s.waiters));
+    EXPECT_EQ(w.resumes, 4u);
+    EXPECT_EQ(w.remote_resumes, 0u);
+    EXPECT_EQ(w.suspended_tasks, 0);
+    EXPECT_EQ(w.live_tasks, 0);
+}
+
+TEST(SchedTest, ResumeListFillsTheRingBeforeTheOverflowList) {
+    sched_worker w;
+    sched_worker_init(&w, 8);
+    Landing l{};
+    ut_dlink_init(&l.shared.waiters);
+    constexpr ib_u32           N = SCHED_RUNQ_SIZE + 3;
+    std::vector<LandingWaiter> waiters(N);
+    for (ib_u32 i = 0; i < N; ++i) {
+        waiters[i].landing = &l;
+        waiters[i].index   = i;
+        sched_task_init(&waiters[i].task, landing_start, nullptr);
+        sched_spawn(&w, &waiters[i].task);
+    }
+    sched_task waker;
+    sched_task_init(&waker, landing_waker_start, &l);
+    sched_spawn(&w, &waker);
+    sched_run(&w);
+
+    // Only what the ring cannot hold is out of reach of thieves
+    EXPECT_EQ(l.in_ring, SCHED_RUNQ_SIZE);
+    EXPECT_EQ(l.overflow, 3u);
+    // The ring first, then the overflow list: arrival order either way
+    ASSERT_EQ(l.order.size(), (size_t)N);
+    for (ib_u32 i = 0; i < N; ++i) EXPECT_EQ(l.order[i], i);
+    EXPECT_EQ(w.resumes, (ib_u64)N);
+    EXPECT_EQ(w.suspended_tasks, 0);
+    EXPECT_EQ(w.live_tasks, 0);
+}
+
+TEST(SchedTest, ResumeListFromAnotherThreadPushesOneInboxChain) {
+    sched_worker w;
+    sched_worker_init(&w, 7);
+    Shared s;
+    ut_dlink_init(&s.waiters);
+    Waiter      waiters[3];
+    const char* tags = "xyz";
+    for (int i = 0; i < 3; ++i) {
+        waiters[i].shared = &s;
+        sched_task_init(&waiters[i].task, tagged_start, (void*)(tags + i));
+        sched_spawn(&w, &waiters[i].task);
+    }
+    sched_run(&w);
+    EXPECT_EQ(w.suspended_tasks, 3);
+
+    std::thread waker([&] { sched_resume_list(&s.waiters); });
+    waker.join();
+    sched_task* head = w.inbox.load();
+    ASSERT_NE(head, nullptr);
+    EXPECT_EQ(head, &waiters[2].task);   // LIFO inbox: the chain is pushed newest first
+    sched_run(&w);
+    EXPECT_EQ(s.out, "xyz");
+    EXPECT_EQ(w.remote_resumes, 3u);
+    EXPECT_EQ(w.suspended_tasks, 0);
+    EXPECT_EQ(w.live_tasks, 0);
+}
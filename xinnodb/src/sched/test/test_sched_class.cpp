@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "sched.hpp" // IWYU pragma: keep
+
+namespace {
+
+struct Scan {
+    sched_task   task;
+    int          next;
+    int          rows;
+    std::string* log;
+};
+
+void scan_step(sched_worker*, sched_task* t) noexcept {
+    Scan* s = (Scan*)t;
+    while (s->next < s->rows) {
+        ++s->next;
+        if (sched_checkpoint(t, scan_step)) return;
+    }
+    s->log->append("scan;");
+}
+
+void point_step(sched_worker*, sched_task* t) noexcept {
+    static_cast<std::string*>(t->arg)->append("point;");
+}
+
+void spin(int n) {
+    volatile int x = 0;
+    for (int i = 0; i < n; ++i) x = x + i;
+}
+
+struct Hog {
+    sched_task task;
+    int*       budget;  ///< Steps left for all hogs together
+    int        steps;
+};
+
+// Each step is charged a fixed cost far above the measured one, so OS preemptions of the test
+// process do not change the expected shares
+constexpr ib_u64 HOG_STEP_CYCLES = 1'000'000'000;
+
+void hog_step(sched_worker*, sched_task* t) noexcept {
+    Hog* h = (Hog*)t;
+    if (*h->budget <= 0) return;
+    --*h->budget;
+    ++h->steps;
+    sched_charge(t, HOG_STEP_CYCLES);
+    sched_yield(t, hog_step);
+}
+
+} // namespace
+
+TEST(SchedClassTest, CheckpointsPreemptLongSteps) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_class_configure(&w, SCHED_CLASS_OLTP, 16, 0, 100);
+    std::string log;
+    Scan scan{ {}, 0, 1000, &log };
+    sched_task_init(&scan.task, scan_step, nullptr);
+    sched_task point;
+    sched_task_init(&point, point_step, &log);
+    sched_spawn(&w, &scan.task);
+    sched_spawn(&w, &point);
+    sched_run(&w);
+    EXPECT_EQ(log, "point;scan;");
+    EXPECT_EQ(scan.next, 1000);
+    EXPECT_EQ(w.classes[SCHED_CLASS_OLTP].preemptions, 10u);
+    EXPECT_EQ(w.classes[SCHED_CLASS_OLTP].steps, 12u);
+}
+
+TEST(SchedClassTest, CycleBudgetPreemptsWithoutIterationLimit) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_class_configure(&w, SCHED_CLASS_BACKGROUND, 4, 50'000);
+    std::string log;
+    Scan scan{ {}, 0, 0, &log };
+    sched_task_init(&scan.task, [](sched_worker*, sched_task* t) noexcept {
+        // Stop at the first preemption point
+        while (!sched_budget_exceeded(t)) spin(100);
+        ((Scan*)t)->log->append("preempted;");
+    }, nullptr);
+    scan.task.cls = SCHED_CLASS_BACKGROUND;
+    sched_spawn(&w, &scan.task);
+    sched_run(&w);
+    EXPECT_EQ(log, "preempted;");
+    EXPECT_GE(w.classes[SCHED_CLASS_BACKGROUND].cycles, ut_clock_ns_to_tsc(50'000));
+}
+
+TEST(SchedClassTest, FairQueueingFollowsClassWeights) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    int  budget = 630;
+    Hog  hogs[SCHED_CLASS_COUNT];
+    for (ib_u32 c = 0; c < SCHED_CLASS_COUNT; ++c) {
+        hogs[c].budget = &budget;
+        hogs[c].steps  = 0;
+        sched_task_init(&hogs[c].task, hog_step, nullptr);
+        hogs[c].task.cls = (sched_class)c;
+    }
+    // Lowest class first: FIFO order alone would alternate evenly
+    for (int c = SCHED_CLASS_COUNT - 1; c >= 0; --c) sched_spawn(&w, &hogs[c].task);
+    sched_run(&w);
+    // Weights 16:4:1 over 630 steps
+    EXPECT_NEAR(hogs[SCHED_CLASS_OLTP].steps, 480, 5);
+    EXPECT_NEAR(hogs[SCHED_CLASS_BACKGROUND].steps, 120, 5);
+    EXPECT_NEAR(hogs[SCHED_CLASS_MAINTENANCE].steps, 30, 5);
+}
+
+TEST(SchedClassTest, IdleClassesDoNotBankTime) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    int budget = 100;
+    Hog bg{ {}, &budget, 0 };
+    sched_task_init(&bg.task, hog_step, nullptr);
+    bg.task.cls = SCHED_CLASS_BACKGROUND;
+    sched_spawn(&w, &bg.task);
+    sched_run(&w);
+    ASSERT_EQ(bg.steps, 100);
+
+    // A fresh OLTP hog must not run alone until it has caught up with 100 background steps
+    budget = 60;
+    bg.steps = 0;
+    sched_task_init(&bg.task, hog_step, nullptr);
+    bg.task.cls = SCHED_CLASS_BACKGROUND;
+    Hog oltp{ {}, &budget, 0 };
+    sched_task_init(&oltp.task, hog_step, nullptr);
+    sched_spawn(&w, &oltp.task);
+    sched_spawn(&w, &bg.task);
+    sched_run(&w);
+    EXPECT_NEAR(bg.steps, 12, 3);
+    EXPECT_NEAR(oltp.steps, 48, 3);
+}
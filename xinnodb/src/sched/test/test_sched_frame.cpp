@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include "sched.hpp" // IWYU pragma: keep
+
+#include <vector>
+
+namespace {
+
+struct key16 {
+    ib_u64 lo;
+    ib_u64 hi;
+};
+
+using chain_frame = co_frame<double, key16, int>;
+
+/// One CPS chain: every step unpacks the frame of the previous one and spills the next
+struct Chain {
+    co_arena           arena;
+    chain_frame*       frame;
+    double             base;
+    int                steps;
+    std::vector<int>   seen;
+    std::vector<void*> slots;
+    bool               own_arena;   ///< co_arena_current() was the task's arena in every step
+};
+
+void chain_step(sched_worker*, sched_task* t) noexcept {
+    Chain* c = static_cast<Chain*>(t->arg);
+    c->own_arena &= co_arena_current() == t->arena;
+    if (c->frame == nullptr) {
+        c->frame = co_frame_pack(c->base, key16{ 1, 2 }, 0);
+    } else {
+        chain_frame* f = c->frame;
+        c->seen.push_back(co_arg<2>(f));
+        EXPECT_EQ(co_arg<0>(f), c->base + co_arg<2>(f));
+        EXPECT_EQ(co_arg<1>(f).hi, co_arg<1>(f).lo + 1);
+        // Forwards fields of its own frame: they are copied before the other slot is written
+        c->frame = co_frame_pack(co_arg<0>(f) + 1, key16{ co_arg<1>(f).lo + 1, co_arg<1>(f).hi + 1 }, co_arg<2>(f) + 1);
+    }
+    c->slots.push_back(c->frame);
+    if (--c->steps > 0) sched_yield(t, chain_step);
+}
+
+void pack_outside(sched_worker*, sched_task* t) noexcept {
+    *static_cast<co_arena**>(t->arg) = co_arena_current();
+}
+
+} // namespace
+
+TEST(SchedFrame, LayoutFollowsDeclarationOrder) {
+    using layout = co_frame_layout<char, double, int, key16>;
+    EXPECT_EQ(layout::offsets[0], 0u);
+    EXPECT_EQ(layout::offsets[1], 8u);
+    EXPECT_EQ(layout::offsets[2], 16u);
+    EXPECT_EQ(layout::offsets[3], 24u);
+    EXPECT_EQ(layout::size, 40u);
+    EXPECT_EQ(layout::align, 8u);
+    EXPECT_EQ(co_frame_layout<>::size, 1u);
+}
+
+TEST(SchedFrame, InterleavedChainsKeepTheirFrames) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+
+    constexpr int kSteps = 8;
+    Chain         chains[2];
+    sched_task    tasks[2];
+    for (int i = 0; i < 2; ++i) {
+        Chain& c = chains[i];
+        co_arena_init(&c.arena);
+        c.frame     = nullptr;
+        c.base      = 100.0 * (i + 1);
+        c.steps     = kSteps;
+        c.own_arena = true;
+        sched_task_init(&tasks[i], chain_step, &c);
+        tasks[i].arena = &c.arena;
+        sched_spawn(&w, &tasks[i]);
+    }
+    sched_run(&w);
+
+    for (int i = 0; i < 2; ++i) {
+        const Chain& c = chains[i];
+        EXPECT_TRUE(c.own_arena);
+        ASSERT_EQ(c.seen.size(), (size_t)kSteps - 1);
+        for (int s = 0; s < kSteps - 1; ++s) EXPECT_EQ(c.seen[s], s);
+        // Frames never leave the task's own arena
+        for (void* slot : c.slots) {
+            EXPECT_TRUE(slot == c.arena.slots[0] || slot == c.arena.slots[1]);
+        }
+    }
+    EXPECT_EQ(co_arena_tls, nullptr);
+}
+
+TEST(SchedFrame, SlotsAlternate) {
+    co_arena arena;
+    co_arena_init(&arena);
+    co_arena_tls = &arena;
+
+    auto* a = co_frame_pack(1.5, 7);
+    auto* b = co_frame_pack(co_arg<0>(a) * 2, co_arg<1>(a) + 1);
+    EXPECT_NE((void*)a, (void*)b);
+    // The frame received by a step is still intact after it spilled once
+    EXPECT_EQ(co_arg<0>(a), 1.5);
+    EXPECT_EQ(co_arg<1>(a), 7);
+
+    // The third frame reuses the first slot; its values were read from the second
+    auto* c = co_frame_pack(co_arg<0>(b) + 1, co_arg<1>(b) + 1);
+    EXPECT_EQ((void*)c, (void*)a);
+    EXPECT_EQ(co_arg<0>(c), 4.0);
+    EXPECT_EQ(co_arg<1>(c), 9);
+
+    // The fourth overwrites the second with values read from it
+    auto* d = co_frame_pack(co_arg<0>(b) + 2, co_arg<1>(b) * 2);
+    EXPECT_EQ((void*)d, (void*)b);
+    EXPECT_EQ(co_arg<0>(d), 5.0);
+    EXPECT_EQ(co_arg<1>(d), 16);
+
+    co_arena_tls = nullptr;
+}
+
+TEST(SchedFrame, TaskWithoutArenaUsesTheThreadArena) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+
+    co_arena*  seen = nullptr;
+    sched_task t;
+    sched_task_init(&t, pack_outside, &seen);
+    EXPECT_EQ(t.arena, nullptr);
+    sched_spawn(&w, &t);
+    sched_run(&w);
+
+    EXPECT_EQ(seen, &co_arena_thread);
+    EXPECT_EQ(co_arena_current(), &co_arena_thread);
+}
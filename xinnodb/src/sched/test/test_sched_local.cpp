@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "sched.hpp" // IWYU pragma: keep
+
+namespace {
+
+struct Seen {
+    void* trx;
+    void* pca;
+    void* pwa;
+};
+
+void read_locals(sched_worker*, sched_task* t) noexcept {
+    Seen* seen = static_cast<Seen*>(t->arg);
+    seen->trx  = sched_local(SCHED_LOCAL_TRX);
+    seen->pca  = sched_local(SCHED_LOCAL_PCA);
+    seen->pwa  = sched_pwa();
+}
+
+void io_done(sched_worker*, sched_task*) noexcept {}
+
+void io_start(sched_worker*, sched_task* t) noexcept {
+    *static_cast<sched_task**>(t->arg) = t;
+    sched_suspend(t, io_done, SCHED_SUSPEND_IO);
+}
+
+ib_u64 poll_complete(sched_worker*, void* ctx) noexcept {
+    sched_task** parked = static_cast<sched_task**>(ctx);
+    if (*parked == nullptr) return 0;
+    sched_task* t = *parked;
+    *parked = nullptr;
+    sched_resume(t);
+    return 1;
+}
+
+void yield_three(sched_worker*, sched_task* t) noexcept {
+    int* left = static_cast<int*>(t->arg);
+    if (--*left > 0) sched_yield(t, yield_three);
+}
+
+void latch_granted(sched_worker*, sched_task* t) noexcept {
+    *static_cast<int*>(t->arg) += 10;
+}
+
+/// Waits for a latch that turns out to be free before the step returns
+void latch_wait_satisfied(sched_worker*, sched_task* t) noexcept {
+    sched_suspend(t, latch_granted, SCHED_SUSPEND_LATCH);
+    sched_resume(t);
+}
+
+} // namespace
+
+TEST(SchedLocal, SlotsAreReadFromTheRunningTask) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    int trx = 0, pca = 0, pwa = 0;
+    w.ext[SCHED_EXT_PWA] = &pwa;
+
+    Seen       seen{};
+    sched_task t;
+    sched_task_init(&t, read_locals, &seen);
+    sched_local_set(&t, SCHED_LOCAL_TRX, &trx);
+    sched_local_set(&t, SCHED_LOCAL_PCA, &pca);
+    sched_spawn(&w, &t);
+    sched_run(&w);
+
+    EXPECT_EQ(seen.trx, &trx);
+    EXPECT_EQ(seen.pca, &pca);
+    EXPECT_EQ(seen.pwa, &pwa);
+    EXPECT_EQ(sched_local(SCHED_LOCAL_TRX), nullptr);
+    EXPECT_EQ(sched_pwa(), nullptr);
+}
+
+TEST(SchedLocal, InheritCopiesSlotsAndClass) {
+    int        trx = 0;
+    sched_task parent, child;
+    sched_task_init(&parent, read_locals, nullptr);
+    sched_task_init(&child, read_locals, nullptr);
+    sched_local_set(&parent, SCHED_LOCAL_TRX, &trx);
+    parent.cls = SCHED_CLASS_BACKGROUND;
+    sched_task_inherit(&child, &parent);
+    EXPECT_EQ(child.locals[SCHED_LOCAL_TRX], &trx);
+    EXPECT_EQ(child.cls, SCHED_CLASS_BACKGROUND);
+}
+
+TEST(SchedAcct, StepsCyclesAndWaitsAreCharged) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_task*  parked = nullptr;
+    sched_poller poller;
+    sched_poller_register(&w, &poller, poll_complete, &parked);
+
+    int        left = 3;
+    sched_task a, b;
+    sched_task_init(&a, yield_three, &left);
+    sched_task_init(&b, io_start, &parked);
+    b.cls = SCHED_CLASS_BACKGROUND;
+    sched_spawn(&w, &a);
+    sched_spawn(&w, &b);
+    sched_run(&w);
+    sched_poller_unregister(&poller);
+
+    EXPECT_EQ(a.acct.steps, 3u);
+    EXPECT_GT(a.acct.cycles, 0u);
+    EXPECT_EQ(b.acct.steps, 2u);
+    EXPECT_EQ(b.acct.io_waits, 1u);
+    EXPECT_EQ(b.acct.latch_waits, 0u);
+
+    // Finished tasks are folded into the totals of their class
+    EXPECT_EQ(w.classes[SCHED_CLASS_OLTP].finished, 1u);
+    EXPECT_EQ(w.classes[SCHED_CLASS_OLTP].acct.steps, 3u);
+    EXPECT_EQ(w.classes[SCHED_CLASS_BACKGROUND].finished, 1u);
+    EXPECT_EQ(w.classes[SCHED_CLASS_BACKGROUND].acct.io_waits, 1u);
+    EXPECT_EQ(ut_acct_current(), nullptr);
+}
+
+TEST(SchedAcct, ResumeDuringTheOwnStepActsAsAYield) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    int        out = 0;
+    sched_task t;
+    sched_task_init(&t, latch_wait_satisfied, &out);
+    sched_spawn(&w, &t);
+    sched_run(&w);
+
+    EXPECT_EQ(out, 10);
+    EXPECT_EQ(t.state, SCHED_TASK_DONE);
+    EXPECT_EQ(t.acct.latch_waits, 1u);
+    EXPECT_EQ(w.suspended_tasks, 0);
+    EXPECT_EQ(w.live_tasks, 0);
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "sched_pool.hpp" // IWYU pragma: keep
+
+namespace {
+
+std::atomic<int> runs{ 0 };
+
+void count_step(sched_worker*, sched_task*) noexcept {
+    runs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void yield_twice_step(sched_worker*, sched_task* t) noexcept {
+    // arg counts the remaining yields
+    auto left = (std::uintptr_t)t->arg;
+    if (left > 0) {
+        t->arg = (void*)(left - 1);
+        sched_yield(t, yield_twice_step);
+        return;
+    }
+    runs.fetch_add(1, std::memory_order_relaxed);
+}
+
+struct Pool {
+    std::unique_ptr<sched_worker[]> workers;
+    std::unique_ptr<sched_pool>     pool;
+
+    explicit Pool(ib_u32 n) : workers(new sched_worker[n]), pool(new sched_pool) {
+        EXPECT_EQ(sched_pool_init(pool.get(), workers.get(), n), 0);
+    }
+
+    ib_u64 sum(ib_u64 sched_worker::*field) const {
+        ib_u64 total = 0;
+        for (ib_u32 i = 0; i < pool->count; ++i) total += workers[i].*field;
+        return total;
+    }
+};
+
+struct Parked {
+    sched_task                task;
+    std::atomic<sched_task*>* slot;
+    bool                      resumed;
+};
+
+void parked_done(sched_worker*, sched_task* t) noexcept {
+    ((Parked*)t)->resumed = true;
+}
+
+void parked_start(sched_worker*, sched_task* t) noexcept {
+    Parked* p = (Parked*)t;
+    sched_suspend(t, parked_done, SCHED_SUSPEND_EVENT);
+    p->slot->store(t, std::memory_order_release);
+}
+
+struct Fanout {
+    sched_task              task;
+    std::vector<sched_task> children;
+};
+
+void busy_step(sched_worker*, sched_task*) noexcept {
+    volatile ib_u64 x = 0;
+    for (int i = 0; i < 20000; ++i) x = x + i;
+    runs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void fanout_step(sched_worker* w, sched_task* t) noexcept {
+    Fanout* f = (Fanout*)t;
+    for (auto& c : f->children) sched_spawn(w, &c);
+}
+
+} // namespace
+
+TEST(SchedPoolTest, StealTakesHalfOfTheVictimRing) {
+    sched_worker victim, thief;
+    sched_worker_init(&victim, 0);
+    sched_worker_init(&thief, 1);
+    std::vector<sched_task> tasks(11);
+    runs = 0;
+    for (auto& t : tasks) {
+        sched_task_init(&t, count_step, nullptr);
+        sched_spawn(&victim, &t);
+    }
+    EXPECT_EQ(sched_runq_steal(&victim, &thief), 6u);
+    EXPECT_EQ(thief.steals, 1u);
+    EXPECT_EQ(thief.stolen_tasks, 6u);
+    // The oldest tasks move, in order
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(tasks[i].worker, &thief);
+    for (int i = 6; i < 11; ++i) EXPECT_EQ(tasks[i].worker, &victim);
+    EXPECT_EQ(sched_run_once(&thief), 6u);
+    EXPECT_EQ(sched_run_once(&victim), 5u);
+    EXPECT_EQ(runs.load(), 11);
+    EXPECT_EQ(sched_runq_steal(&victim, &thief), 0u);
+}
+
+TEST(SchedPoolTest, OverflowKeepsFifoOrderBeyondTheRing) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    std::vector<sched_task> tasks(SCHED_RUNQ_SIZE + 40);
+    std::vector<sched_task*> order;
+    for (auto& t : tasks) {
+        sched_task_init(&t, [](sched_worker*, sched_task* tk) noexcept {
+            static_cast<std::vector<sched_task*>*>(tk->arg)->push_back(tk);
+        }, &order);
+        sched_spawn(&w, &t);
+    }
+    EXPECT_EQ(w.ready_overflow, 40u);
+    sched_run(&w);
+    ASSERT_EQ(order.size(), tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) EXPECT_EQ(order[i], &tasks[i]);
+}
+
+TEST(SchedPoolTest, InjectedTasksRunAndWaitIdleReturns) {
+    Pool p(4);
+    ASSERT_EQ(sched_pool_start(p.pool.get()), 0);
+    std::vector<sched_task> tasks(2000);
+    runs = 0;
+    for (auto& t : tasks) {
+        sched_task_init(&t, yield_twice_step, (void*)2);
+        sched_pool_inject(p.pool.get(), &t);
+    }
+    sched_pool_wait_idle(p.pool.get());
+    sched_pool_stop(p.pool.get());
+    EXPECT_EQ(runs.load(), 2000);
+    EXPECT_EQ(p.sum(&sched_worker::injected_tasks), 2000u);
+    for (auto& t : tasks) EXPECT_EQ(t.state, SCHED_TASK_DONE);
+}
+
+TEST(SchedPoolTest, ClientThreadsResumeTasksThroughTheInbox) {
+    Pool p(2);
+    ASSERT_EQ(sched_pool_start(p.pool.get()), 0);
+    std::atomic<sched_task*> slot{ nullptr };
+    Parked parked{ {}, &slot, false };
+    sched_task_init(&parked.task, parked_start, nullptr);
+    sched_pool_inject(p.pool.get(), &parked.task);
+
+    std::thread client([&] {
+        sched_task* t;
+        while ((t = slot.load(std::memory_order_acquire)) == nullptr) std::this_thread::yield();
+        // Let the worker park before the resume arrives
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        sched_resume(t);
+    });
+    client.join();
+    sched_pool_wait_idle(p.pool.get());
+    sched_pool_stop(p.pool.get());
+    EXPECT_TRUE(parked.resumed);
+    EXPECT_EQ(p.sum(&sched_worker::remote_resumes), 1u);
+}
+
+TEST(SchedPoolTest, IdleWorkersStealSpawnedTasks) {
+    Pool p(4);
+    ASSERT_EQ(sched_pool_start(p.pool.get()), 0);
+    Fanout f;
+    f.children.resize(512);
+    for (auto& c : f.children) sched_task_init(&c, busy_step, nullptr);
+    sched_task_init(&f.task, fanout_step, nullptr);
+    runs = 0;
+    sched_pool_inject(p.pool.get(), &f.task);
+    sched_pool_wait_idle(p.pool.get());
+    sched_pool_stop(p.pool.get());
+    EXPECT_EQ(runs.load(), 512);
+    ib_u64 spawned = 0, finished = 0;
+    for (ib_u32 i = 0; i < 4; ++i) {
+        spawned  += p.workers[i].spawned_total.load();
+        finished += p.workers[i].finished_total.load();
+    }
+    EXPECT_EQ(spawned, 512u);
+    EXPECT_EQ(finished, 513u);
+    if (std::thread::hardware_concurrency() > 1) {
+        EXPECT_GT(p.sum(&sched_worker::steals), 0u);
+    }
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "sched_sim.hpp" // IWYU pragma: keep
+
+namespace {
+
+// Lost update: `reader` reads, yields, then writes back; `incrementer` yields twice before its
+// increment. FIFO order is safe, some random interleavings lose the increment.
+struct Race {
+    sched_task reader;
+    sched_task incrementer;
+    int        counter;
+    int        seen;
+    int        yields_left;
+};
+
+void reader_write(sched_worker*, sched_task* t) noexcept {
+    Race* r = (Race*)t->arg;
+    r->counter = r->seen + 1;
+}
+
+void reader_read(sched_worker*, sched_task* t) noexcept {
+    Race* r = (Race*)t->arg;
+    r->seen = r->counter;
+    sched_yield(t, reader_write);
+}
+
+void incrementer_step(sched_worker*, sched_task* t) noexcept {
+    Race* r = (Race*)t->arg;
+    if (r->yields_left-- > 0) {
+        sched_yield(t, incrementer_step);
+        return;
+    }
+    ++r->counter;
+}
+
+int race_body(sched_worker* w, void*) noexcept {
+    Race r{};
+    r.yields_left = 2;
+    sched_task_init(&r.reader, reader_read, &r);
+    sched_task_init(&r.incrementer, incrementer_step, &r);
+    sched_spawn(w, &r.reader);
+    sched_spawn(w, &r.incrementer);
+    sched_run(w);
+    return r.counter == 2 ? 0 : 1;
+}
+
+} // namespace
+
+TEST(SchedSimTest, FifoOrderHidesTheRace) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    EXPECT_EQ(race_body(&w, nullptr), 0);
+}
+
+TEST(SchedSimTest, ExploringSeedsFindsTheRace) {
+    sched_sim_failure failure{};
+    std::vector<sched_sim_event> log(64);
+    EXPECT_EQ(sched_sim_explore(1, 1000, race_body, nullptr, &failure, log.data(), log.size()), 1);
+    EXPECT_EQ(failure.rc, 1);
+    EXPECT_GT(failure.log_len, 0u);
+    const ib_u64 seed = failure.seed;
+
+    // The failing seed fails again
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_sim sim;
+    sched_sim_init(&sim, &w, seed);
+    EXPECT_EQ(race_body(&w, nullptr), 1);
+    sched_sim_detach(&sim);
+}
+
+TEST(SchedSimTest, SameSeedRecordsTheSameLog) {
+    for (ib_u64 seed : { 3u, 17u, 12345u }) {
+        std::vector<sched_sim_event> a(64), b(64);
+        sched_worker w1, w2;
+        sched_worker_init(&w1, 0);
+        sched_worker_init(&w2, 0);
+        sched_sim s1, s2;
+        sched_sim_init(&s1, &w1, seed, a.data(), a.size());
+        sched_sim_init(&s2, &w2, seed, b.data(), b.size());
+        int r1 = race_body(&w1, nullptr);
+        int r2 = race_body(&w2, nullptr);
+        EXPECT_EQ(r1, r2);
+        ASSERT_EQ(s1.log_len, s2.log_len);
+        ASSERT_GT(s1.log_len, 0u);
+        for (ib_u64 i = 0; i < s1.log_len; ++i) {
+            EXPECT_EQ(a[i].kind, b[i].kind);
+            EXPECT_EQ(a[i].choice, b[i].choice);
+            EXPECT_EQ(a[i].task_id, b[i].task_id);
+        }
+    }
+}
+
+TEST(SchedSimTest, ReplayRepeatsARecordedInterleaving) {
+    sched_sim_failure failure{};
+    std::vector<sched_sim_event> recorded(64);
+    ASSERT_EQ(sched_sim_explore(1, 1000, race_body, nullptr, &failure, recorded.data(), recorded.size()), 1);
+    const ib_u64 seed = failure.seed;
+    const ib_u64 n    = failure.log_len;
+
+    // Replay under another seed: only the log decides
+    std::vector<sched_sim_event> replayed(64);
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_sim sim;
+    sched_sim_init(&sim, &w, seed + 1000, replayed.data(), replayed.size());
+    sched_sim_replay(&sim, recorded.data(), n);
+    EXPECT_EQ(race_body(&w, nullptr), 1);
+    EXPECT_FALSE(sim.diverged);
+    EXPECT_EQ(sim.replay_pos, n);
+    ASSERT_EQ(sim.log_len, n);
+    for (ib_u64 i = 0; i < n; ++i) EXPECT_EQ(replayed[i].task_id, recorded[i].task_id);
+}
+
+TEST(SchedSimTest, ReplayFlagsDivergence) {
+    // A log that picks a task that does not exist
+    sched_sim_event bogus[] = { { SCHED_SIM_PICK, 0, 999 } };
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_sim sim;
+    sched_sim_init(&sim, &w, 7);
+    sched_sim_replay(&sim, bogus, 1);
+    race_body(&w, nullptr);
+    EXPECT_TRUE(sim.diverged);
+    EXPECT_EQ(sim.diverged_at, 0u);
+}
+
+TEST(SchedSimTest, CompletionsAndChoicesAreLogged) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    std::vector<sched_sim_event> log(16);
+    sched_sim sim;
+    sched_sim_init(&sim, &w, 11, log.data(), log.size());
+    sched_task t;
+    sched_task_init(&t, [](sched_worker*, sched_task* tk) noexcept {
+        sched_suspend(tk, [](sched_worker*, sched_task*) noexcept {}, SCHED_SUSPEND_IO);
+    }, nullptr);
+    sched_spawn(&w, &t);
+    sched_run(&w);
+    ASSERT_EQ(t.state, SCHED_TASK_SUSPENDED);
+    EXPECT_LT(sched_sim_choose(&sim, 4), 4u);
+    sched_sim_complete(&sim, &t);
+    sched_run(&w);
+    EXPECT_EQ(t.state, SCHED_TASK_DONE);
+    ASSERT_EQ(sim.log_len, 4u);
+    EXPECT_EQ(log[0].kind, SCHED_SIM_PICK);
+    EXPECT_EQ(log[1].kind, SCHED_SIM_CHOICE);
+    EXPECT_EQ(log[2].kind, SCHED_SIM_COMPLETE);
+    EXPECT_EQ(log[2].task_id, t.id);
+    EXPECT_EQ(log[3].kind, SCHED_SIM_PICK);
+    sched_sim_detach(&sim);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "sched_timer.hpp" // IWYU pragma: keep
+
+namespace {
+
+constexpr ib_u64 TICK = 1000;
+
+struct Fired {
+    sched_timer timer;
+    ib_u64      deadline;
+    ib_u64      fired_at;   ///< Wheel time when the callback ran
+    sched_timer_wheel* wheel;
+};
+
+void record_fire(sched_timer*, void* arg) noexcept {
+    Fired* f    = (Fired*)arg;
+    f->fired_at = sched_timer_now(f->wheel);
+}
+
+struct TimerFixture : ::testing::Test {
+    sched_worker      worker;
+    sched_timer_wheel wheel;
+
+    void SetUp() override {
+        sched_worker_init(&worker, 0);
+        sched_timer_wheel_init(&wheel, &worker, UT_CLOCK_MANUAL, TICK);
+    }
+
+    void TearDown() override { sched_timer_wheel_detach(&wheel); }
+
+    void arm(Fired* f, ib_u64 deadline) {
+        sched_timer_init(&f->timer, record_fire, f);
+        f->deadline = deadline;
+        f->fired_at = 0;
+        f->wheel    = &wheel;
+        sched_timer_arm(&wheel, &f->timer, deadline);
+    }
+};
+
+} // namespace
+
+TEST_F(TimerFixture, TimersFireAtTheirTickOnEveryLevel) {
+    const ib_u64 deadlines[] = { 1, 5 * TICK, 63 * TICK, 64 * TICK, 70 * TICK, 4100 * TICK, 300000 * TICK, 20000000 * TICK };
+    std::vector<Fired> timers(std::size(deadlines));
+    for (size_t i = 0; i < timers.size(); ++i) arm(&timers[i], deadlines[i]);
+    EXPECT_EQ(wheel.pending, timers.size());
+
+    // Walk time in uneven steps; each timer fires on the first advance that reaches its deadline
+    ib_u64 now = 0, step = 7 * TICK;
+    while (wheel.pending != 0) {
+        const ib_u64 before = now;
+        now += step;
+        step = step * 3 / 2;
+        sched_timer_advance(&wheel, now);
+        for (auto& f : timers) {
+            if (f.deadline > before && f.deadline <= now) {
+                EXPECT_EQ(f.fired_at, now) << f.deadline;
+            }
+            if (f.deadline > now) {
+                EXPECT_FALSE(f.timer.fired) << f.deadline;
+            }
+        }
+    }
+    for (auto& f : timers) EXPECT_TRUE(f.timer.fired);
+    EXPECT_EQ(wheel.fired_total, timers.size());
+    EXPECT_GT(wheel.cascaded_total, 0u);
+}
+
+TEST_F(TimerFixture, RandomTimersNeverFireEarlyOrLate) {
+    ut_rnd rnd;
+    ut_rnd_init(&rnd, 42);
+    std::vector<Fired> timers(5000);
+    for (auto& f : timers) arm(&f, ut_rnd_range(&rnd, 1, 5'000'000) * TICK / 10);
+    ib_u64 now = 0;
+    while (wheel.pending != 0) {
+        const ib_u64 before = now;
+        now += ut_rnd_range(&rnd, 1, 200) * TICK;
+        sched_timer_advance(&wheel, now);
+        for (auto& f : timers) {
+            const bool due = f.deadline <= (now / TICK) * TICK;
+            if (f.fired_at == now) {
+                EXPECT_GT(f.deadline, (before / TICK) * TICK);
+            }
+            EXPECT_EQ(f.timer.fired, due) << f.deadline << " at " << now;
+        }
+    }
+}
+
+TEST_F(TimerFixture, CancelAndRearmAreConstantTime) {
+    std::vector<Fired> timers(100000);
+    for (size_t i = 0; i < timers.size(); ++i) arm(&timers[i], (1 + i % 10000) * TICK);
+    for (size_t i = 0; i < timers.size(); i += 2) EXPECT_TRUE(sched_timer_cancel(&wheel, &timers[i].timer));
+    EXPECT_FALSE(sched_timer_cancel(&wheel, &timers[0].timer));
+    // Re-arm one cancelled and one pending timer further away
+    sched_timer_arm(&wheel, &timers[0].timer, 20000 * TICK);
+    sched_timer_arm(&wheel, &timers[1].timer, 20000 * TICK);
+    EXPECT_EQ(wheel.pending, timers.size() / 2 + 1);
+
+    EXPECT_EQ(sched_timer_advance(&wheel, 10000 * TICK), timers.size() / 2 - 1);
+    EXPECT_FALSE(timers[0].timer.fired);
+    EXPECT_FALSE(timers[2].timer.fired);
+    EXPECT_TRUE(timers[3].timer.fired);
+    EXPECT_EQ(sched_timer_advance(&wheel, 20000 * TICK), 2u);
+    EXPECT_EQ(wheel.pending, 0u);
+}
+
+TEST_F(TimerFixture, ExpiredTimersResumeSuspendedTasks) {
+    struct Sleeper {
+        sched_task  task;
+        sched_timer timer;
+        bool        woke;
+    } s{};
+    sched_task_init(&s.task, [](sched_worker* w, sched_task* t) noexcept {
+        Sleeper* sl = (Sleeper*)t;
+        sched_timer_init(&sl->timer, sched_timer_resume_task, t);
+        sched_suspend(t, [](sched_worker*, sched_task* t2) noexcept { ((Sleeper*)t2)->woke = true; }, SCHED_SUSPEND_TIMER);
+        sched_timer_arm_after(sched_timer_wheel_of(w), &sl->timer, 3 * TICK);
+    }, nullptr);
+    sched_spawn(&worker, &s.task);
+    sched_run_once(&worker);
+    EXPECT_EQ(s.task.state, SCHED_TASK_SUSPENDED);
+    sched_timer_advance(&wheel, 2 * TICK);
+    EXPECT_EQ(s.task.state, SCHED_TASK_SUSPENDED);
+    sched_timer_advance(&wheel, 3 * TICK);
+    sched_run(&worker);
+    EXPECT_TRUE(s.woke);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_TIMER], 1u);
+}
+
+TEST(SchedTimerClockTest, CoarseClockWheelFiresFromThePoller) {
+    sched_worker w;
+    sched_worker_init(&w, 0);
+    sched_timer_wheel wh;
+    sched_timer_wheel_init(&wh, &w, UT_CLOCK_COARSE);
+    bool fired = false;
+    sched_timer t;
+    sched_timer_init(&t, [](sched_timer*, void* arg) noexcept { *(bool*)arg = true; }, &fired);
+    sched_timer_arm(&wh, &t, ut_clock_ns(UT_CLOCK_COARSE) + 2 * SCHED_TIMER_TICK_NS);
+    const ib_u64 give_up = ut_clock_ns(UT_CLOCK_MONOTONIC) + 2'000'000'000ull;
+    while (!fired && ut_clock_ns(UT_CLOCK_MONOTONIC) < give_up) sched_poll(&w);
+    EXPECT_TRUE(fired);
+    sched_timer_wheel_detach(&wh);
+}
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "sched_trace.hpp" // IWYU pragma: keep
+
+namespace {
+
+void yield_twice(sched_worker*, sched_task* t) noexcept {
+    int* left = static_cast<int*>(t->arg);
+    if (--*left > 0) sched_yield(t, yield_twice);
+}
+
+void io_done(sched_worker*, sched_task*) noexcept {}
+
+void io_start(sched_worker*, sched_task* t) noexcept {
+    *static_cast<sched_task**>(t->arg) = t;
+    sched_suspend(t, io_done, SCHED_SUSPEND_IO);
+}
+
+ib_u64 poll_complete(sched_worker*, void* ctx) noexcept {
+    sched_task** parked = static_cast<sched_task**>(ctx);
+    if (*parked == nullptr) return 0;
+    sched_task* t = *parked;
+    *parked = nullptr;
+    sched_resume(t);
+    return 1;
+}
+
+struct TraceFixture : ::testing::Test {
+    sched_worker      worker;
+    sched_trace       trace;
+    sched_trace_event events[256];
+
+    void SetUp() override {
+        sched_worker_init(&worker, 3);
+        ASSERT_EQ(sched_trace_init(&trace, events, sizeof(events)), 0);
+        sched_trace_attach(&worker, &trace);
+    }
+
+    /// Kinds recorded for `task`, oldest first, with the argument after a colon when set
+    std::vector<std::string> kinds_of(const sched_task* task) const {
+        std::vector<std::string> out;
+        for (ib_u64 i = 0; i < sched_trace_size(&trace); ++i) {
+            const sched_trace_event* e = sched_trace_at(&trace, i);
+            if (e->task != task->id) continue;
+            std::string s = sched_trace_kind_name((sched_trace_kind)e->kind);
+            if (e->arg != 0) s += ":" + std::to_string(e->arg);
+            out.push_back(s);
+        }
+        return out;
+    }
+
+    std::string export_json() const {
+        char*       buf  = nullptr;
+        std::size_t size = 0;
+        std::FILE*  out  = open_memstream(&buf, &size);
+        const sched_trace* traces[] = { &trace };
+        EXPECT_EQ(sched_trace_export_chrome(out, traces, 1), 0);
+        std::fclose(out);
+        std::string json(buf, size);
+        std::free(buf);
+        return json;
+    }
+};
+
+} // namespace
+
+TEST(SchedTrace, InitRoundsDownToPowerOfTwo) {
+    sched_trace       trace;
+    sched_trace_event events[13];
+    ASSERT_EQ(sched_trace_init(&trace, events, sizeof(events)), 0);
+    EXPECT_EQ(trace.mask, 7u);
+    EXPECT_EQ(sched_trace_size(&trace), 0u);
+    EXPECT_EQ(sched_trace_init(&trace, events, sizeof(sched_trace_event)), -1);
+}
+
+TEST_F(TraceFixture, RecordsYieldLifecycle) {
+    int        left = 2;
+    sched_task t;
+    sched_task_init(&t, yield_twice, &left);
+    sched_spawn(&worker, &t);
+    sched_run(&worker);
+
+    const std::vector<std::string> expected = { "create", "run", "yield", "run", "complete" };
+    EXPECT_EQ(kinds_of(&t), expected);
+    for (ib_u64 i = 1; i < sched_trace_size(&trace); ++i) {
+        EXPECT_LE(sched_trace_at(&trace, i - 1)->tsc, sched_trace_at(&trace, i)->tsc);
+    }
+}
+
+TEST_F(TraceFixture, RecordsSuspendReasonAndResumes) {
+    sched_task*  parked = nullptr;
+    sched_poller poller;
+    sched_poller_register(&worker, &poller, poll_complete, &parked);
+    sched_task t;
+    sched_task_init(&t, io_start, &parked);
+    t.cls = SCHED_CLASS_BACKGROUND;
+    sched_spawn(&worker, &t);
+    sched_run(&worker);
+    sched_poller_unregister(&poller);
+
+    const std::vector<std::string> expected = {
+        "create", "run", "suspend:" + std::to_string(SCHED_SUSPEND_IO), "resume", "run", "complete"
+    };
+    EXPECT_EQ(kinds_of(&t), expected);
+    EXPECT_EQ(sched_trace_at(&trace, 0)->cls, SCHED_CLASS_BACKGROUND);
+}
+
+TEST_F(TraceFixture, RemoteResumeIsRecordedByTheOwner) {
+    sched_task* parked = nullptr;
+    sched_task  t;
+    sched_task_init(&t, io_start, &parked);
+    sched_spawn(&worker, &t);
+    sched_run_once(&worker);
+    ASSERT_EQ(parked, &t);
+
+    // Not on the worker thread: goes through the inbox
+    sched_resume(&t);
+    sched_run(&worker);
+
+    const std::vector<std::string> expected = {
+        "create", "run", "suspend:" + std::to_string(SCHED_SUSPEND_IO), "resume:1", "run", "complete"
+    };
+    EXPECT_EQ(kinds_of(&t), expected);
+}
+
+TEST_F(TraceFixture, RingKeepsTheMostRecentEvents) {
+    sched_trace_event small[8];
+    ASSERT_EQ(sched_trace_init(&trace, small, sizeof(small)), 0);
+    sched_trace_attach(&worker, &trace);
+
+    int        left = 10;
+    sched_task t;
+    sched_task_init(&t, yield_twice, &left);
+    sched_spawn(&worker, &t);
+    sched_run(&worker);
+
+    // create + 10 runs + 9 yields + complete
+    EXPECT_EQ(trace.head, 21u);
+    EXPECT_EQ(sched_trace_size(&trace), 8u);
+    EXPECT_EQ(sched_trace_at(&trace, 7)->kind, SCHED_TRACE_COMPLETE);
+    EXPECT_EQ(sched_trace_at(&trace, 6)->kind, SCHED_TRACE_RUN);
+}
+
+TEST_F(TraceFixture, DetachStopsRecording) {
+    sched_trace_detach(&worker);
+    int        left = 3;
+    sched_task t;
+    sched_task_init(&t, yield_twice, &left);
+    sched_spawn(&worker, &t);
+    sched_run(&worker);
+    EXPECT_EQ(trace.head, 0u);
+}
+
+TEST_F(TraceFixture, ExportsChromeTraceJson) {
+    sched_task*  parked = nullptr;
+    sched_poller poller;
+    sched_poller_register(&worker, &poller, poll_complete, &parked);
+    int        left = 2;
+    sched_task a, b;
+    sched_task_init(&a, yield_twice, &left);
+    sched_task_init(&b, io_start, &parked);
+    sched_spawn(&worker, &a);
+    sched_spawn(&worker, &b);
+    sched_run(&worker);
+    sched_poller_unregister(&poller);
+
+    const std::string json = export_json();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+    EXPECT_NE(json.find("\"name\":\"worker 3\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"X\",\"name\":\"oltp\",\"pid\":1,\"tid\":3"), std::string::npos);
+    EXPECT_NE(json.find("\"end\":\"suspend\",\"reason\":\"io\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"b\",\"cat\":\"task\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"io\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"runnable\""), std::string::npos);
+
+    // Two steps per task
+    std::size_t slices = 0;
+    for (std::size_t at = 0; (at = json.find("\"ph\":\"X\"", at)) != std::string::npos; ++at) ++slices;
+    EXPECT_EQ(slices, 4u);
+
+    int depth = 0;
+    for (char c : json) {
+        if (c == '{' || c == '[') ++depth;
+        if (c == '}' || c == ']') --depth;
+        EXPECT_GE(depth, 0);
+    }
+    EXPECT_EQ(depth, 0);
+}
+
+TEST(SchedTrace, ExportMergesTheRingsByTimestamp) {
+    sched_trace       a, b;
+    sched_trace_event ea[4], eb[4];
+    ASSERT_EQ(sched_trace_init(&a, ea, sizeof(ea)), 0);
+    ASSERT_EQ(sched_trace_init(&b, eb, sizeof(eb)), 0);
+    a.worker = 0;
+    b.worker = 1;
+    ea[0] = { 1000, 1, SCHED_TRACE_CREATE, SCHED_CLASS_OLTP, 0, 0 };
+    ea[1] = { 1100, 1, SCHED_TRACE_RUN, SCHED_CLASS_OLTP, 0, 0 };
+    ea[2] = { 1400, 1, SCHED_TRACE_COMPLETE, SCHED_CLASS_OLTP, 0, 0 };
+    eb[0] = { 1050, 2, SCHED_TRACE_CREATE, SCHED_CLASS_BACKGROUND, 0, 0 };
+    eb[1] = { 1200, 2, SCHED_TRACE_RUN, SCHED_CLASS_BACKGROUND, 0, 0 };
+    eb[2] = { 1300, 2, SCHED_TRACE_COMPLETE, SCHED_CLASS_BACKGROUND, 0, 0 };
+    a.head = 3;
+    b.head = 3;
+
+    char*              buf      = nullptr;
+    std::size_t        size     = 0;
+    std::FILE*         out      = open_memstream(&buf, &size);
+    const sched_trace* traces[] = { &a, &b };
+    ASSERT_EQ(sched_trace_export_chrome(out, traces, 2), 0);
+    std::fclose(out);
+    const std::string json(buf, size);
+    std::free(buf);
+
+    // The step of task 2 ends first, then both tasks' lives close in completion order
+    const std::size_t step2 = json.find("\"ph\":\"X\",\"name\":\"background\",\"pid\":1,\"tid\":1");
+    const std::size_t step1 = json.find("\"ph\":\"X\",\"name\":\"oltp\",\"pid\":1,\"tid\":0");
+    ASSERT_NE(step2, std::string::npos);
+    ASSERT_NE(step1, std::string::npos);
+    EXPECT_LT(step2, step1);
+    EXPECT_NE(json.find("\"id\":\"0x2\",\"name\":\"background\""), std::string::npos);
+    EXPECT_NE(json.find("\"id\":\"0x1\",\"name\":\"oltp\""), std::string::npos);
+}
+
+TEST_F(TraceFixture, ExportReportsAWriteError) {
+    int        left = 2;
+    sched_task t;
+    sched_task_init(&t, yield_twice, &left);
+    sched_spawn(&worker, &t);
+    sched_run(&worker);
+
+    const sched_trace* traces[] = { &trace };
+    for (const bool buffered : { true, false }) {
+        std::FILE* full = std::fopen("/dev/full", "w");
+        if (full == nullptr) GTEST_SKIP() << "no /dev/full";
+        if (!buffered) std::setvbuf(full, nullptr, _IONBF, 0);
+        EXPECT_EQ(sched_trace_export_chrome(full, traces, 1), -1);
+        std::fclose(full);
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "defs.hpp"
+#include "xinnodb.hpp"   // IWYU pragma: keep
+#include "ut_assert.hpp" // IWYU pragma: keep
+
+#include <atomic>
+#include <cerrno>
+
+
+/// \defgroup SGA sga
+/// \ingroup components
+/// \brief Shared Global Area
+/// \details The SGA is the memory shared by the client and the worker processes: buffer pool
+/// frames, per-worker buffers, client contexts, the log and debug buffers and the file table. It
+/// is one contiguous region whose layout is a pure function of the `ib_sga_state_desc`:
+/// sga_layout_compute() places a header page, then each area in the fixed order of `sga_area`,
+/// every one starting on an SGA_ALIGN (huge page, hence also cache line) boundary and rounded up
+/// to whole huge pages, so that no two areas share a page or a line and each can be backed by
+/// huge pages on its own. ib_get_sga_state_required_size() is the exact size of that layout.
+///
+/// Startup is one mapping and one header check. sga_open() either formats the header of a fresh
+/// region, or validates the header it finds and attaches: a process that restarts on a region
+/// that outlived it (a shared memory file, a caller-provided buffer) checks the magic, the format
+/// version, the checksum of the header and, when it passes a descriptor, that the SGA was
+/// formatted for the same one; nothing else is read or written. Formatting publishes the magic last, with a
+/// release store, after a CAS has claimed the header, so processes that start together agree on
+/// one formatter and the others wait for it. The claim carries the pid of the formatter, and
+/// `claimer` its identity (see `ut_proc`): if that process dies before it publishes the magic,
+/// the next sga_open() claims the header in turn and formats it again, even once the pid has
+/// been reused.
+///
+/// The areas themselves are not initialised, apart from the file table of a caller-provided
+/// buffer which is zeroed; pages of a mapping made by sga_open() are zero. Each area belongs to
+/// the module that uses it, which formats it on first use.
+/// @{
+
+inline static constexpr ib_u64 SGA_MAGIC            = 0x4147'5342'4E4E'4958; ///< "XINNBSGA"
+inline static constexpr ib_u64 SGA_MAGIC_FORMATTING = ~SGA_MAGIC << 32;      ///< Header claimed by the formatter whose pid is or-ed in
+inline static constexpr ib_u64 SGA_MAGIC_PID_MASK   = 0xffff'ffff;           ///< The pid bits of a claimed header
+inline static constexpr ib_u32 SGA_VERSION          = 1;                     ///< Bumped by any layout change
+inline static constexpr ib_u64 SGA_ALIGN            = 2 * 1024 * 1024;       ///< Area alignment: one huge page
+inline static constexpr ib_u64 SGA_CACHE_LINE       = 64;                    ///< Minimum alignment of a caller buffer
+inline static constexpr ib_u64 SGA_FRAME_SIZE       = 16 * 1024;             ///< Bytes per buffer pool frame
+inline static constexpr ib_u64 SGA_FILE_NAME_MAX    = 232;                   ///< Bytes of a file table name, NUL included
+inline static constexpr ib_u64 SGA_FORMAT_WAIT_NS   = 1'000'000'000;         ///< Wait for another formatter at most
+
+/// \brief The areas of the SGA, in layout order
+enum sga_area : ib_u32 {
+    SGA_AREA_FRAMES = 0,  ///< `frame_count` buffer pool frames of SGA_FRAME_SIZE
+    SGA_AREA_FILES,       ///< `file_table_capacity` `sga_file_entry`
+    SGA_AREA_WORKERS,     ///< `worker_buffer_size` bytes
+    SGA_AREA_CONTEXTS,    ///< `context_buffer_size` bytes
+    SGA_AREA_LOG,         ///< `log_buffer_size` bytes
+    SGA_AREA_DEBUG,       ///< `debug_buffer_size` bytes
+    SGA_AREA_COUNT
+};
+
+/// \brief Where an area lies, relative to the start of the SGA
+struct sga_area_desc {
+    ib_u64 offset;   ///< SGA_ALIGN multiple
+    ib_u64 size;     ///< SGA_ALIGN multiple; 0 for an empty area
+};
+
+/// \brief The layout of an SGA
+struct sga_layout {
+    sga_area_desc areas[SGA_AREA_COUNT];
+    ib_u64        total_size;
+};
+
+/// \brief A slot of the file table; all zero when free
+struct alignas(64) sga_file_entry {
+    std::atomic<ib_u32> state;                  ///< 0 when the slot is free
+    ib_u32              flags;
+    ib_u64              space_id;
+    ib_u64              size;                   ///< Bytes
+    char                name[SGA_FILE_NAME_MAX];
+};
+static_assert(sizeof(sga_file_entry) == 256, "file table entries are fixed size");
+
+/// \brief The header at offset 0 of an SGA
+/// \details Everything from `version` to `checksum` is written once by the formatter and covered
+/// by the checksum. `attached` is the only field that changes afterwards.
+struct alignas(64) sga_header {
+    std::atomic<ib_u64> magic;                  ///< SGA_MAGIC once formatted
+    ib_u32              version;                ///< SGA_VERSION of the formatter
+    ib_u32              header_size;            ///< sizeof(sga_header) of the formatter
+    ib_u64              total_size;
+    ib_u64              align;                  ///< SGA_ALIGN of the formatter
+    ib_u64              frame_size;             ///< SGA_FRAME_SIZE of the formatter
+    ib_u64              creator_pid;
+    ib_u64              flags;                  ///< SGA_FLAG_*
+    ib_sga_state_desc   desc;
+    sga_area_desc       areas[SGA_AREA_COUNT];
+    ib_u64              checksum;
+
+    alignas(64) std::atomic<ib_u64> attached;   ///< Open handles, over all processes
+    std::atomic<ib_u64>             claimer;    ///< Identity of the last process to try to claim the header
+};
+
+inline static constexpr ib_u64 SGA_FLAG_MAPPED     = 1;   ///< The region is a mapping made by sga_open()
+inline static constexpr ib_u64 SGA_FLAG_HUGE_PAGES = 2;   ///< ... backed by reserved huge pages (MAP_HUGETLB)
+
+int         sga_layout_compute(const ib_sga_state_desc* desc, sga_layout* out) noexcept;
+ib_u64      sga_required_size(const ib_sga_state_desc* desc) noexcept;
+int         sga_open(void* buffer, ib_u64 buffer_size, const ib_sga_state_desc* desc, sga_header** out, bool* attached) noexcept;
+void        sga_close(sga_header* h) noexcept;
+
+inline static char*           sga_area_base(const sga_header* h, sga_area area) noexcept;
+inline static ib_u64          sga_area_size(const sga_header* h, sga_area area) noexcept;
+inline static sga_file_entry* sga_file_table(const sga_header* h) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief The first byte of `area`; SGA_ALIGN aligned if the SGA itself is
+inline char* sga_area_base(const sga_header* h, sga_area area) noexcept {
+    IB_ASSERT(area < SGA_AREA_COUNT, "no such SGA area");
+    return (char*)h + h->areas[area].offset;
+}
+
+inline ib_u64 sga_area_size(const sga_header* h, sga_area area) noexcept {
+    IB_ASSERT(area < SGA_AREA_COUNT, "no such SGA area");
+    return h->areas[area].size;
+}
+
+/// \brief The `desc.file_table_capacity` entries of the file table
+inline sga_file_entry* sga_file_table(const sga_header* h) noexcept {
+    return (sga_file_entry*)sga_area_base(h, SGA_AREA_FILES);
+}
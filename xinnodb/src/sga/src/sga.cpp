@@ -0,0 +1,187 @@
+#include "sga.hpp"
+#include "ut_clock.hpp"
+#include "ut_proc.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstring>
+
+inline static constexpr ib_u64 sga_round_up(ib_u64 n, ib_u64 align) noexcept {
+    return (n + align - 1) / align * align;
+}
+
+/// \brief FNV-1a over the fields the formatter writes once, `version` to `checksum` excluded
+static ib_u64 sga_header_checksum(const sga_header* h) noexcept {
+    const unsigned char* p   = (const unsigned char*)h + offsetof(sga_header, version);
+    const unsigned char* end = (const unsigned char*)h + offsetof(sga_header, checksum);
+    ib_u64               sum = 0xcbf2'9ce4'8422'2325;
+    for (; p < end; ++p) sum = (sum ^ *p) * 0x0000'0100'0000'01b3;
+    return sum;
+}
+
+/// \brief Maps `size` bytes of zeroed memory that forked processes share, on huge pages if possible
+/// \details `size` is a multiple of SGA_ALIGN. Without reserved huge pages the mapping is made
+/// SGA_ALIGN larger, trimmed to an aligned range and offered to transparent huge pages.
+static char* sga_map(ib_u64 size, ib_u64* flags) noexcept {
+    void* m = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (m != MAP_FAILED) {
+        *flags |= SGA_FLAG_HUGE_PAGES;
+        return (char*)m;
+    }
+    m = mmap(nullptr, size + SGA_ALIGN, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) return nullptr;
+    char*        raw  = (char*)m;
+    char*        base = (char*)sga_round_up((ib_u64)(ib_uintptr)raw, SGA_ALIGN);
+    const ib_u64 head = (ib_u64)(base - raw);
+    if (head != 0) munmap(raw, head);
+    if (head != SGA_ALIGN) munmap(base + size, SGA_ALIGN - head);
+    madvise(base, size, MADV_HUGEPAGE);   // best effort: THP may be disabled
+    return base;
+}
+
+/// \brief False once the process that claimed a header with `magic` has exited without publishing it
+/// \details Claimers record their identity before the claim, so `claimer` names the formatter
+/// unless a later claimer overwrote it, which shows as another pid; then only the pid is checked.
+static bool sga_formatter_alive(const sga_header* h, ib_u64 magic) noexcept {
+    const ib_u32 pid = (ib_u32)(magic & SGA_MAGIC_PID_MASK);
+    const ib_u64 id  = h->claimer.load(std::memory_order_relaxed);
+    return ut_proc_pid(id) == pid ? ut_proc_alive(id) : ut_proc_pid_alive(pid);
+}
+
+/// \brief Writes the header of a region claimed by the caller and publishes the magic
+static void sga_format(sga_header* h, const ib_sga_state_desc* desc, const sga_layout* layout, ib_u64 flags) noexcept {
+    std::memset((char*)h + offsetof(sga_header, version), 0, sizeof(sga_header) - offsetof(sga_header, version));
+    h->version     = SGA_VERSION;
+    h->header_size = sizeof(sga_header);
+    h->total_size  = layout->total_size;
+    h->align       = SGA_ALIGN;
+    h->frame_size  = SGA_FRAME_SIZE;
+    h->creator_pid = (ib_u64)getpid();
+    h->flags       = flags;
+    h->desc        = *desc;
+    std::memcpy(h->areas, layout->areas, sizeof(h->areas));
+    h->checksum = sga_header_checksum(h);
+    h->attached.store(1, std::memory_order_relaxed);
+    h->magic.store(SGA_MAGIC, std::memory_order_release);
+}
+
+/// \brief Checks the header of a formatted region before attaching to it
+/// \param desc The descriptor the caller expects, or nullptr to take the SGA as it is
+static int sga_validate(const sga_header* h, ib_u64 buffer_size, const ib_sga_state_desc* desc) noexcept {
+    if (h->version != SGA_VERSION || h->header_size != sizeof(sga_header) || h->align != SGA_ALIGN
+        || h->frame_size != SGA_FRAME_SIZE) {
+        return -EPROTONOSUPPORT;
+    }
+    if (h->checksum != sga_header_checksum(h)) return -EBADMSG;
+    if (h->total_size > buffer_size) return -EINVAL;
+    if (desc != nullptr && std::memcmp(&h->desc, desc, sizeof(ib_sga_state_desc)) != 0) return -ESTALE;
+    return 0;
+}
+
+/// \brief Lays out an SGA for `desc`: the header page, then each area on its own huge pages
+/// \return 0, or -EINVAL if the sizes overflow
+int sga_layout_compute(const ib_sga_state_desc* desc, sga_layout* out) noexcept {
+    IB_ASSERT_NOT_NULL(desc);
+    IB_ASSERT_NOT_NULL(out);
+    ib_u64 bytes[SGA_AREA_COUNT];
+    if (__builtin_mul_overflow(desc->frame_count, SGA_FRAME_SIZE, &bytes[SGA_AREA_FRAMES])) return -EINVAL;
+    if (__builtin_mul_overflow((ib_u64)desc->file_table_capacity, (ib_u64)sizeof(sga_file_entry), &bytes[SGA_AREA_FILES])) {
+        return -EINVAL;
+    }
+    bytes[SGA_AREA_WORKERS]  = desc->worker_buffer_size;
+    bytes[SGA_AREA_CONTEXTS] = desc->context_buffer_size;
+    bytes[SGA_AREA_LOG]      = desc->log_buffer_size;
+    bytes[SGA_AREA_DEBUG]    = desc->debug_buffer_size;
+
+    ib_u64 offset = sga_round_up(sizeof(sga_header), SGA_ALIGN);
+    for (ib_u32 a = 0; a < SGA_AREA_COUNT; ++a) {
+        if (bytes[a] > ~(ib_u64)0 - SGA_ALIGN) return -EINVAL;
+        const ib_u64 size = sga_round_up(bytes[a], SGA_ALIGN);
+        out->areas[a]     = { offset, size };
+        if (__builtin_add_overflow(offset, size, &offset)) return -EINVAL;
+    }
+    out->total_size = offset;
+    return 0;
+}
+
+/// \brief The exact number of bytes of an SGA for `desc`, or 0 if it cannot be laid out
+ib_u64 sga_required_size(const ib_sga_state_desc* desc) noexcept {
+    sga_layout layout;
+    return sga_layout_compute(desc, &layout) == 0 ? layout.total_size : 0;
+}
+
+/// \brief Creates or attaches to an SGA
+/// \details With `buffer` == nullptr, maps a new shared region of the required size and formats
+/// it. Otherwise `buffer` (SGA_CACHE_LINE aligned; SGA_ALIGN aligned to keep the areas on huge
+/// page boundaries) is either attached to if it holds a valid SGA, or formatted if it does not:
+/// its header is written and its file table zeroed. `desc` may be nullptr only to attach.
+/// \param attached Out: true if an existing SGA was attached to, false if one was formatted
+/// \return 0; -EINVAL for a bad argument or a buffer too small; -ENOMEM if the mapping failed;
+/// -ENOENT if `desc` is nullptr and `buffer` holds no SGA; -EPROTONOSUPPORT if the SGA was
+/// formatted by an incompatible version; -EBADMSG if its header is corrupt; -ESTALE if it was
+/// formatted for another descriptor; -EBUSY if its formatter, still running, did not finish in
+/// SGA_FORMAT_WAIT_NS
+int sga_open(void* buffer, ib_u64 buffer_size, const ib_sga_state_desc* desc, sga_header** out, bool* attached) noexcept {
+    IB_ASSERT_NOT_NULL(out);
+    IB_ASSERT_NOT_NULL(attached);
+    *out      = nullptr;
+    *attached = false;
+    sga_layout layout;
+    if (desc != nullptr && sga_layout_compute(desc, &layout) != 0) return -EINVAL;
+
+    if (buffer == nullptr) {
+        if (desc == nullptr) return -EINVAL;
+        ib_u64 flags = SGA_FLAG_MAPPED;
+        char*  base  = sga_map(layout.total_size, &flags);
+        if (base == nullptr) return -ENOMEM;
+        // Fresh pages are zero: the file table is already empty
+        sga_format((sga_header*)base, desc, &layout, flags);
+        *out = (sga_header*)base;
+        return 0;
+    }
+
+    if ((ib_uintptr)buffer % SGA_CACHE_LINE != 0 || buffer_size < sizeof(sga_header)) return -EINVAL;
+    sga_header* h        = (sga_header*)buffer;
+    ib_u64      magic    = h->magic.load(std::memory_order_acquire);
+    ib_u64      deadline = 0;
+    for (;;) {
+        if (magic == SGA_MAGIC) {
+            const int rc = sga_validate(h, buffer_size, desc);
+            if (rc != 0) return rc;
+            h->attached.fetch_add(1, std::memory_order_relaxed);
+            *out      = h;
+            *attached = true;
+            return 0;
+        }
+        if ((magic & ~SGA_MAGIC_PID_MASK) == SGA_MAGIC_FORMATTING && sga_formatter_alive(h, magic)) {
+            // Another process claimed the header a moment ago
+            const ib_u64 now = ut_clock_ns(UT_CLOCK_MONOTONIC);
+            if (deadline == 0) deadline = now + SGA_FORMAT_WAIT_NS;
+            if (now > deadline) return -EBUSY;
+            __builtin_ia32_pause();
+            magic = h->magic.load(std::memory_order_acquire);
+            continue;
+        }
+        // Unformatted, or claimed by a formatter that died: claim it
+        if (desc == nullptr) return -ENOENT;
+        if (layout.total_size > buffer_size) return -EINVAL;
+        const ib_u64 claim = SGA_MAGIC_FORMATTING | (ib_u64)getpid();
+        h->claimer.store(ut_proc_self(), std::memory_order_relaxed);
+        if (h->magic.compare_exchange_strong(magic, claim, std::memory_order_acquire, std::memory_order_acquire)) {
+            std::memset((char*)h + layout.areas[SGA_AREA_FILES].offset, 0, desc->file_table_capacity * sizeof(sga_file_entry));
+            sga_format(h, desc, &layout, 0);
+            *out = h;
+            return 0;
+        }
+    }
+}
+
+/// \brief Drops the handle `h`; unmaps this process's view if the region was mapped by sga_open()
+/// \details The SGA itself stays valid for the other processes attached to it.
+void sga_close(sga_header* h) noexcept {
+    if (h == nullptr) return;
+    h->attached.fetch_sub(1, std::memory_order_relaxed);
+    if ((h->flags & SGA_FLAG_MAPPED) != 0) munmap(h, h->total_size);
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include "sga.hpp"     // IWYU pragma: keep
+#include "ut_proc.hpp" // IWYU pragma: keep
+
+namespace {
+
+ib_sga_state_desc small_desc() {
+    ib_sga_state_desc d{};
+    d.frame_count         = 64;                // 1 MiB of frames
+    d.worker_buffer_size  = 3 * 1024 * 1024;   // spans two huge pages
+    d.context_buffer_size = 0;                 // empty area
+    d.log_buffer_size     = 4096;
+    d.debug_buffer_size   = 1;
+    d.file_table_capacity = 100;
+    return d;
+}
+
+/// A caller buffer, huge page aligned, that outlives the handles opened on it
+struct Buffer {
+    ib_u64 size;
+    void*  mem;
+
+    explicit Buffer(ib_u64 n) : size(n), mem(std::aligned_alloc(SGA_ALIGN, n)) {
+        std::memset(mem, 0xa5, n);
+    }
+    ~Buffer() { std::free(mem); }
+};
+
+TEST(Sga, LayoutIsDeterministicAndHugePageAligned) {
+    const ib_sga_state_desc d = small_desc();
+    sga_layout              a;
+    sga_layout              b;
+    ASSERT_EQ(sga_layout_compute(&d, &a), 0);
+    ASSERT_EQ(sga_layout_compute(&d, &b), 0);
+    EXPECT_EQ(std::memcmp(&a, &b, sizeof(sga_layout)), 0);
+
+    EXPECT_GE(a.areas[0].offset, sizeof(sga_header));
+    ib_u64 end = a.areas[0].offset;
+    for (ib_u32 i = 0; i < SGA_AREA_COUNT; ++i) {
+        EXPECT_EQ(a.areas[i].offset % SGA_ALIGN, 0u);
+        EXPECT_EQ(a.areas[i].size % SGA_ALIGN, 0u);
+        EXPECT_EQ(a.areas[i].offset, end);   // in order, no overlap, no gap
+        end += a.areas[i].size;
+    }
+    EXPECT_EQ(a.total_size, end);
+
+    EXPECT_EQ(a.areas[SGA_AREA_FRAMES].size, SGA_ALIGN);
+    EXPECT_EQ(a.areas[SGA_AREA_FILES].size, SGA_ALIGN);
+    EXPECT_EQ(a.areas[SGA_AREA_WORKERS].size, 2 * SGA_ALIGN);
+    EXPECT_EQ(a.areas[SGA_AREA_CONTEXTS].size, 0u);
+    EXPECT_EQ(a.areas[SGA_AREA_LOG].size, SGA_ALIGN);
+    EXPECT_EQ(a.areas[SGA_AREA_DEBUG].size, SGA_ALIGN);
+    EXPECT_EQ(sga_required_size(&d), 7 * SGA_ALIGN);
+}
+
+TEST(Sga, OverflowingSizesCannotBeLaidOut) {
+    ib_sga_state_desc d = small_desc();
+    d.frame_count       = ~(ib_u64)0 / 1024;
+    EXPECT_EQ(sga_required_size(&d), 0u);
+    d                 = small_desc();
+    d.log_buffer_size = ~(ib_u64)0 - 1;
+    EXPECT_EQ(sga_required_size(&d), 0u);
+    d                    = small_desc();
+    d.worker_buffer_size = ~(ib_u64)0 / 2;
+    d.log_buffer_size    = ~(ib_u64)0 / 2;
+    EXPECT_EQ(sga_required_size(&d), 0u);
+}
+
+TEST(Sga, MappedSgaIsFormattedAndShared) {
+    const ib_sga_state_desc d = small_desc();
+    sga_header*             h = nullptr;
+    bool                    attached;
+    ASSERT_EQ(sga_open(nullptr, 0, &d, &h, &attached), 0);
+    ASSERT_NE(h, nullptr);
+    EXPECT_FALSE(attached);
+    EXPECT_EQ((ib_uintptr)h % SGA_ALIGN, 0u);
+    EXPECT_EQ(h->magic.load(), SGA_MAGIC);
+    EXPECT_EQ(h->total_size, sga_required_size(&d));
+    EXPECT_NE(h->flags & SGA_FLAG_MAPPED, 0u);
+    EXPECT_EQ(h->attached.load(), 1u);
+    EXPECT_EQ(sga_file_table(h)[d.file_table_capacity - 1].state.load(), 0u);
+
+    // Every non-empty area is writable end to end
+    for (ib_u32 a = 0; a < SGA_AREA_COUNT; ++a) {
+        const ib_u64 size = sga_area_size(h, (sga_area)a);
+        if (size == 0) continue;
+        char* base = sga_area_base(h, (sga_area)a);
+        EXPECT_EQ((ib_uintptr)base % SGA_ALIGN, 0u);
+        base[0]        = (char)a;
+        base[size - 1] = (char)a;
+    }
+
+    // A forked worker writes through the same pages
+    char*       log = sga_area_base(h, SGA_AREA_LOG);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        std::strcpy(log, "from the worker");
+        _exit(0);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_STREQ(log, "from the worker");
+    sga_close(h);
+}
+
+TEST(Sga, RestartAttachesToTheExistingSga) {
+    const ib_sga_state_desc d = small_desc();
+    Buffer                  buf(sga_required_size(&d));
+    sga_header*             h = nullptr;
+    bool                    attached;
+    ASSERT_EQ(sga_open(buf.mem, buf.size, &d, &h, &attached), 0);
+    EXPECT_FALSE(attached);
+    EXPECT_EQ(h->flags & SGA_FLAG_MAPPED, 0u);
+    EXPECT_EQ(sga_file_table(h)[0].state.load(), 0u);
+    EXPECT_EQ(sga_file_table(h)[d.file_table_capacity - 1].state.load(), 0u);
+    // The other areas are left as they were
+    EXPECT_EQ((unsigned char)sga_area_base(h, SGA_AREA_FRAMES)[0], 0xa5);
+    sga_file_table(h)[3].state.store(1);
+    std::strcpy(sga_file_table(h)[3].name, "ibdata1");
+    sga_close(h);
+
+    // Same descriptor, then none at all
+    sga_header* again = nullptr;
+    ASSERT_EQ(sga_open(buf.mem, buf.size, &d, &again, &attached), 0);
+    EXPECT_TRUE(attached);
+    EXPECT_EQ(again, h);
+    EXPECT_STREQ(sga_file_table(again)[3].name, "ibdata1");
+    sga_header* any = nullptr;
+    ASSERT_EQ(sga_open(buf.mem, buf.size, nullptr, &any, &attached), 0);
+    EXPECT_TRUE(attached);
+    EXPECT_EQ(again->attached.load(), 2u);
+    sga_close(any);
+    sga_close(again);
+    EXPECT_EQ(h->attached.load(), 0u);
+}
+
+TEST(Sga, AttachRejectsAnIncompatibleHeader) {
+    const ib_sga_state_desc d = small_desc();
+    Buffer                  buf(sga_required_size(&d));
+    sga_header*             h = nullptr;
+    bool                    attached;
+    ASSERT_EQ(sga_open(buf.mem, buf.size, &d, &h, &attached), 0);
+
+    sga_header*       other = nullptr;
+    ib_sga_state_desc more  = d;
+    more.frame_count += 1;
+    EXPECT_EQ(sga_open(buf.mem, buf.size, &more, &other, &attached), -ESTALE);
+    EXPECT_EQ(sga_open(buf.mem, buf.size - 1, &d, &other, &attached), -EINVAL);
+
+    h->desc.debug_buffer_size = 2;   // a stray write into the header
+    EXPECT_EQ(sga_open(buf.mem, buf.size, &d, &other, &attached), -EBADMSG);
+    h->desc.debug_buffer_size = d.debug_buffer_size;
+
+    h->version = SGA_VERSION + 1;
+    EXPECT_EQ(sga_open(buf.mem, buf.size, &d, &other, &attached), -EPROTONOSUPPORT);
+    h->version = SGA_VERSION;
+
+    ASSERT_EQ(sga_open(buf.mem, buf.size, &d, &other, &attached), 0);
+    EXPECT_TRUE(attached);
+    EXPECT_EQ(other, h);
+    sga_close(other);
+    sga_close(h);
+}
+
+TEST(Sga, CallerBufferIsChecked) {
+    const ib_sga_state_desc d = small_desc();
+    Buffer                  buf(sga_required_size(&d));
+    sga_header*             h = nullptr;
+    bool                    attached;
+    EXPECT_EQ(sga_open(buf.mem, buf.size - 1, &d, &h, &attached), -EINVAL);
+    EXPECT_EQ(sga_open((char*)buf.mem + 8, buf.size - 8, &d, &h, &attached), -EINVAL);
+    EXPECT_EQ(sga_open(buf.mem, buf.size, nullptr, &h, &attached), -ENOENT);
+    EXPECT_EQ(sga_open(nullptr, 0, nullptr, &h, &attached), -EINVAL);
+    EXPECT_EQ(h, nullptr);
+    // Nothing was formatted
+    EXPECT_NE(((sga_header*)buf.mem)->magic.load(), SGA_MAGIC);
+}
+
+TEST(Sga, HeaderClaimedByADeadFormatterIsFormattedAgain) {
+    const ib_sga_state_desc d = small_desc();
+    Buffer                  buf(sga_required_size(&d));
+    sga_header*             h = nullptr;
+    bool                    attached;
+
+    // A formatter that is still running keeps the header
+    sga_header* claimed = (sga_header*)buf.mem;
+    claimed->magic.store(SGA_MAGIC_FORMATTING | (ib_u64)getppid());
+    EXPECT_EQ(sga_open(buf.mem, buf.size, &d, &h, &attached), -EBUSY);
+    EXPECT_EQ(h, nullptr);
+
+    // One that died after its claim does not
+    const pid_t pid = fork();
+    if (pid == 0) _exit(0);
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    claimed->magic.store(SGA_MAGIC_FORMATTING | (ib_u64)pid);
+    EXPECT_EQ(sga_open(buf.mem, buf.size, nullptr, &h, &attached), -ENOENT);
+    ASSERT_EQ(sga_open(buf.mem, buf.size, &d, &h, &attached), 0);
+    EXPECT_FALSE(attached);
+    EXPECT_EQ(h->magic.load(), SGA_MAGIC);
+    EXPECT_EQ(h->creator_pid, (ib_u64)getpid());
+    EXPECT_EQ(sga_file_table(h)[0].state.load(), 0u);
+    sga_close(h);
+}
+
+TEST(Sga, HeaderClaimedUnderAReusedPidIsFormattedAgain) {
+    const ib_sga_state_desc d = small_desc();
+    Buffer                  buf(sga_required_size(&d));
+    sga_header*             h = nullptr;
+    bool                    attached;
+
+    // The pid of the claim is running, but it is not the process that claimed the header
+    const ib_u64 parent = ut_proc_identity((ib_u32)getppid());
+    ASSERT_NE(parent, 0u);
+    sga_header* claimed = (sga_header*)buf.mem;
+    claimed->claimer.store(parent ^ 1);
+    claimed->magic.store(SGA_MAGIC_FORMATTING | (ib_u64)getppid());
+    ASSERT_EQ(sga_open(buf.mem, buf.size, &d, &h, &attached), 0);
+    EXPECT_FALSE(attached);
+    EXPECT_EQ(h->magic.load(), SGA_MAGIC);
+    sga_close(h);
+}
+
+} // namespace
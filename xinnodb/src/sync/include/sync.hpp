@@ -0,0 +1,420 @@
+#pragma once
+
+#include "xinnodb.hpp"               // IWYU pragma: keep
+#include "ut_assert.hpp"             // IWYU pragma: keep
+#include "ut_dlink.hpp"              // IWYU pragma: keep
+#include "sched.hpp"                 // IWYU pragma: keep
+#include "task.hpp"                  // IWYU pragma: keep
+#include "ut_clock.hpp"              // IWYU pragma: keep
+#include "sync_profile.hpp"          // IWYU pragma: keep
+
+#include <atomic>
+#include <coroutine>
+#include <source_location>
+
+/// \defgroup sync sync
+/// \ingroup components
+/// \brief Latches that suspend tasks, not threads
+/// \details InnoDB's mutexes spin for a while, then block the thread on an OS event, and its
+/// rw-locks do the same around an atomic `lock_word`. Blocking a thread here would stall a worker
+/// and every task queued on it, so these latches park the waiting *task* instead:
+///
+/// 1. fast path: one atomic compare-and-swap on the latch word, uncontended;
+/// 2. a bounded spin (`sync_spin_rounds` configuration variable) re-trying the fast path, skipped
+///    when the holder runs on the same worker and so cannot make progress meanwhile;
+/// 3. the task links a waiter (living in its coroutine frame) into the latch's intrusive FIFO,
+///    parks with SCHED_SUSPEND_LATCH (charged to `ut_acct::latch_waits`) and the worker runs
+///    other tasks. The releaser hands the latch over to the waiters it wakes: a woken task owns
+///    the latch when it resumes and never re-competes for it.
+///
+/// Waiter queues are protected by a spin lock held for a few list operations only. Latches are
+/// not owned by a worker: a task may release a latch acquired on another worker (after being
+/// stolen) and waiters on any worker are woken through sched_resume(). Outside of tasks (plain
+/// threads, tests) the same calls spin with backoff on their waiter instead of parking.
+///
+/// `sync_mutex` is exclusive. `sync_rw_latch` has InnoDB's three modes:
+///
+/// | held \ wanted | S   | SX  | X   |
+/// |---------------|-----|-----|-----|
+/// | S             | yes | yes | no  |
+/// | SX            | yes | no  | no  |
+/// | X             | no  | no  | no  |
+///
+/// SX (shared-exclusive) is the latch a writer takes while it prepares a change that readers may
+/// still look at; the SX latch of a page or index is the SX mode of its `sync_rw_latch`. Once
+/// anyone waits, new requests queue behind the waiters instead of barging in, so writers do not
+/// starve. When the latch frees up, the wake policy decides who gets it:
+///
+/// - SYNC_WAKE_FIFO: the waiters at the head of the queue, as long as they are compatible with
+///   each other (a run of S and SX requests, or a single X);
+/// - SYNC_WAKE_BATCH_READERS: the head, plus every S waiter in the queue that is compatible,
+///   even behind an X waiter, so a burst of readers is admitted as one batch.
+///
+/// Latches are not recursive and a holder cannot upgrade its mode. Each latch may belong to a
+/// `sync_class` for the contention profiler, see sync_profile.hpp.
+///
+/// Events, semaphores, countdowns and barriers, for tasks that wait for each other rather than
+/// for a latch, are in sync_event.hpp.
+///
+/// sync_init() registers the configuration variables of the module and the default profiler
+/// class; latches work without it, but their settings cannot be changed until it has run.
+
+/// \addtogroup sync
+/// @{
+
+inline static constexpr ib_u32 SYNC_SPIN_ROUNDS_DEFAULT = 30;
+inline static constexpr ib_u32 SYNC_SPIN_PAUSES         = 8;    ///< `pause` instructions per spin round
+
+/// \brief Latch modes
+enum sync_mode : ib_u8 {
+    SYNC_S  = 0,
+    SYNC_SX = 1,
+    SYNC_X  = 2,
+};
+
+/// \brief Whom a released sync_rw_latch is handed to
+enum sync_wake_policy : ib_u8 {
+    SYNC_WAKE_FIFO          = 0,
+    SYNC_WAKE_BATCH_READERS = 1,
+};
+
+/// \brief A task (or thread) queued on a latch; lives in the awaiter
+struct sync_waiter {
+    ut_dlink          link;
+    task*             t;                ///< nullptr for a thread outside of tasks
+    std::atomic<bool> granted;          ///< Threads spin on it
+    sync_mode         mode;
+};
+
+/// \brief Exclusive latch
+struct sync_mutex {
+    std::atomic<ib_u32>        word;    ///< SYNC_LOCKED | SYNC_WAITERS
+    std::atomic<bool>          wait_lock;
+    std::atomic<sched_worker*> holder;  ///< Worker of the holder, a hint to skip spinning
+    ut_dlink                   waiters;
+    sync_class*                cls;     ///< Profiler class, nullptr for sync_class_default
+    std::atomic<std::source_location> holder_site;   ///< Sampled while the profiler is on
+};
+
+/// \brief Shared / shared-exclusive / exclusive latch
+struct sync_rw_latch {
+    std::atomic<ib_u32>        word;    ///< S holders in the low bits, SYNC_RW_SX, SYNC_RW_X, SYNC_WAITERS
+    std::atomic<bool>          wait_lock;
+    std::atomic<sched_worker*> holder;  ///< Worker of the X holder, a hint to skip spinning
+    sync_wake_policy           policy;
+    ut_dlink                   waiters;
+    sync_class*                cls;     ///< Profiler class, nullptr for sync_class_default
+    std::atomic<std::source_location> holder_site;   ///< Sampled while the profiler is on
+};
+
+/// \brief Awaitable returned by sync_mutex_lock()
+struct sync_mutex_awaiter {
+    sync_mutex*          m;
+    sync_waiter          w;
+    std::source_location site;
+    sync_profile_wait    prof;
+
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> h) noexcept;
+    void await_resume() noexcept;
+};
+
+/// \brief Awaitable returned by sync_rw_s_lock(), sync_rw_sx_lock() and sync_rw_x_lock()
+struct sync_rw_awaiter {
+    sync_rw_latch*       l;
+    sync_waiter          w;
+    std::source_location site;
+    sync_profile_wait    prof;
+
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> h) noexcept;
+    void await_resume() noexcept;
+};
+
+inline static constexpr ib_u32 SYNC_LOCKED  = 1u << 0;
+inline static constexpr ib_u32 SYNC_RW_SX   = 1u << 28;
+inline static constexpr ib_u32 SYNC_RW_X    = 1u << 29;
+inline static constexpr ib_u32 SYNC_WAITERS = 1u << 30;
+inline static constexpr ib_u32 SYNC_RW_READERS_MASK = SYNC_RW_SX - 1;
+
+int    sync_init() noexcept;
+ib_u32 sync_spin_rounds() noexcept;
+bool   sync_mutex_lock_wait(sync_mutex* m, sync_waiter* w) noexcept;
+void   sync_mutex_unlock_wake(sync_mutex* m) noexcept;
+bool   sync_rw_lock_wait(sync_rw_latch* l, sync_waiter* w) noexcept;
+void   sync_rw_unlock_wake(sync_rw_latch* l) noexcept;
+void   sync_waiter_block(sync_waiter* w) noexcept;
+void   sync_mutex_lock_blocking(sync_mutex* m, std::source_location site = std::source_location::current()) noexcept;
+void   sync_rw_lock_blocking(sync_rw_latch* l, sync_mode mode, std::source_location site = std::source_location::current()) noexcept;
+
+inline static sync_waiter*       sync_waiter_from_link(ut_dlink* link) noexcept;
+inline static bool               sync_rw_compatible(ib_u32 word, sync_mode mode) noexcept;
+inline static void               sync_wait_lock_acquire(std::atomic<bool>* lock) noexcept;
+inline static void               sync_wait_lock_release(std::atomic<bool>* lock) noexcept;
+inline static void               sync_profile_hold(sync_class* cls, std::atomic<std::source_location>* holder_site,
+                                                   std::source_location site, ib_u32 spins) noexcept;
+inline static void               sync_profile_wait_start(sync_profile_wait* prof, const std::atomic<std::source_location>* holder_site,
+                                                         ib_u32 spins) noexcept;
+inline static void               sync_profile_wait_end(sync_profile_wait* prof, sync_class* cls,
+                                                       std::atomic<std::source_location>* holder_site, std::source_location site) noexcept;
+
+inline static void               sync_mutex_init(sync_mutex* m, sync_class* cls = nullptr) noexcept;
+inline static bool               sync_mutex_try_lock(sync_mutex* m) noexcept;
+inline static sync_mutex_awaiter sync_mutex_lock(sync_mutex* m, std::source_location site = std::source_location::current()) noexcept;
+inline static void               sync_mutex_unlock(sync_mutex* m) noexcept;
+inline static bool               sync_mutex_is_locked(const sync_mutex* m) noexcept;
+
+inline static void            sync_rw_init(sync_rw_latch* l, sync_wake_policy policy = SYNC_WAKE_FIFO, sync_class* cls = nullptr) noexcept;
+inline static bool            sync_rw_try_lock(sync_rw_latch* l, sync_mode mode) noexcept;
+inline static sync_rw_awaiter sync_rw_s_lock(sync_rw_latch* l, std::source_location site = std::source_location::current()) noexcept;
+inline static sync_rw_awaiter sync_rw_sx_lock(sync_rw_latch* l, std::source_location site = std::source_location::current()) noexcept;
+inline static sync_rw_awaiter sync_rw_x_lock(sync_rw_latch* l, std::source_location site = std::source_location::current()) noexcept;
+inline static void            sync_rw_s_unlock(sync_rw_latch* l) noexcept;
+inline static void            sync_rw_sx_unlock(sync_rw_latch* l) noexcept;
+inline static void            sync_rw_x_unlock(sync_rw_latch* l) noexcept;
+inline static ib_u32          sync_rw_readers(const sync_rw_latch* l) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline sync_waiter* sync_waiter_from_link(ut_dlink* link) noexcept {
+    return (sync_waiter*)((char*)link - IB_OFFSET_OF(sync_waiter, link));
+}
+
+/// \brief True if `mode` can be granted next to the holders recorded in the latch word `word`
+/// \details The compatibility matrix above; shared with the cross-process latches of sync_shm.hpp.
+inline bool sync_rw_compatible(ib_u32 word, sync_mode mode) noexcept {
+    switch (mode) {
+    case SYNC_S:  return (word & SYNC_RW_X) == 0;
+    case SYNC_SX: return (word & (SYNC_RW_X | SYNC_RW_SX)) == 0;
+    default:      return (word & (SYNC_RW_X | SYNC_RW_SX | SYNC_RW_READERS_MASK)) == 0;
+    }
+}
+
+/// \brief Takes the spin lock of a waiter queue; it is held for a few list operations at most
+inline void sync_wait_lock_acquire(std::atomic<bool>* lock) noexcept {
+    while (lock->exchange(true, std::memory_order_acquire)) {
+        while (lock->load(std::memory_order_relaxed)) __builtin_ia32_pause();
+    }
+}
+
+inline void sync_wait_lock_release(std::atomic<bool>* lock) noexcept {
+    lock->store(false, std::memory_order_release);
+}
+
+/// \brief Records an acquisition that did not suspend, while the profiler is on
+inline void sync_profile_hold(sync_class* cls, std::atomic<std::source_location>* holder_site, std::source_location site,
+                              ib_u32 spins) noexcept {
+    if (!sync_profile_on()) return;
+    holder_site->store(site, std::memory_order_relaxed);
+    sync_profile_acquired(cls, spins);
+}
+
+/// \brief Starts timing a suspension, and samples the holder that causes it, while the profiler is on
+inline void sync_profile_wait_start(sync_profile_wait* prof, const std::atomic<std::source_location>* holder_site,
+                                    ib_u32 spins) noexcept {
+    if (!sync_profile_on()) return;
+    prof->start_ns = ut_clock_ns(UT_CLOCK_TSC);
+    prof->spins    = spins;
+    prof->holder   = holder_site->load(std::memory_order_relaxed);
+}
+
+/// \brief Records a granted suspension, if it was timed
+inline void sync_profile_wait_end(sync_profile_wait* prof, sync_class* cls, std::atomic<std::source_location>* holder_site,
+                                  std::source_location site) noexcept {
+    if (prof->start_ns == 0) return;
+    holder_site->store(site, std::memory_order_relaxed);
+    sync_profile_waited(cls, prof, ut_clock_ns(UT_CLOCK_TSC));
+}
+
+inline void sync_mutex_init(sync_mutex* m, sync_class* cls) noexcept {
+    m->word.store(0, std::memory_order_relaxed);
+    m->cls = cls;
+    m->holder_site.store(std::source_location{}, std::memory_order_relaxed);
+    m->wait_lock.store(false, std::memory_order_relaxed);
+    m->holder.store(nullptr, std::memory_order_relaxed);
+    ut_dlink_init(&m->waiters);
+}
+
+/// \brief Takes the mutex if it is free and nobody waits for it
+inline bool sync_mutex_try_lock(sync_mutex* m) noexcept {
+    ib_u32 expected = 0;
+    if (!m->word.compare_exchange_strong(expected, SYNC_LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) return false;
+    m->holder.store(sched_current_worker(), std::memory_order_relaxed);
+    return true;
+}
+
+/// \brief `co_await sync_mutex_lock(&m)` returns once the task holds `m`
+inline sync_mutex_awaiter sync_mutex_lock(sync_mutex* m, std::source_location site) noexcept {
+    return sync_mutex_awaiter{ m, {}, site, {} };
+}
+
+inline void sync_mutex_unlock(sync_mutex* m) noexcept {
+    ib_u32 expected = SYNC_LOCKED;
+    m->holder.store(nullptr, std::memory_order_relaxed);
+    if (m->word.compare_exchange_strong(expected, 0, std::memory_order_release, std::memory_order_relaxed)) return;
+    sync_mutex_unlock_wake(m);
+}
+
+inline bool sync_mutex_is_locked(const sync_mutex* m) noexcept {
+    return (m->word.load(std::memory_order_relaxed) & SYNC_LOCKED) != 0;
+}
+
+inline bool sync_mutex_awaiter::await_ready() noexcept {
+    if (sync_mutex_try_lock(m)) {
+        sync_profile_hold(m->cls, &m->holder_site, site, 0);
+        return true;
+    }
+    const sched_worker* self   = sched_current_worker();
+    const ib_u32        rounds = sync_spin_rounds();
+    ib_u32              r      = 0;
+    while (r < rounds) {
+        const sched_worker* h = m->holder.load(std::memory_order_relaxed);
+        if (self != nullptr && h == self) break;   // the holder waits for this worker to return to its loop
+        for (ib_u32 i = 0; i < SYNC_SPIN_PAUSES; ++i) __builtin_ia32_pause();
+        ++r;
+        if ((m->word.load(std::memory_order_relaxed) & (SYNC_LOCKED | SYNC_WAITERS)) == 0 && sync_mutex_try_lock(m)) {
+            sync_profile_hold(m->cls, &m->holder_site, site, r);
+            return true;
+        }
+    }
+    prof.spins = r;
+    return false;
+}
+
+inline bool sync_mutex_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    w.t    = task_current();
+    w.mode = SYNC_X;
+    if (w.t == nullptr) {
+        sync_mutex_lock_blocking(m, site);
+        return false;
+    }
+    sync_profile_wait_start(&prof, &m->holder_site, prof.spins);
+    // Parked before it is visible to a releaser, so that the releaser can resume it right away
+    task_park(w.t, h, SCHED_SUSPEND_LATCH);
+    if (sync_mutex_lock_wait(m, &w)) return true;
+    sched_resume(&w.t->sched);   // acquired after all: the step continues as a yield
+    return true;
+}
+
+inline void sync_mutex_awaiter::await_resume() noexcept {
+    sync_profile_wait_end(&prof, m->cls, &m->holder_site, site);
+}
+
+inline void sync_rw_init(sync_rw_latch* l, sync_wake_policy policy, sync_class* cls) noexcept {
+    l->word.store(0, std::memory_order_relaxed);
+    l->cls = cls;
+    l->holder_site.store(std::source_location{}, std::memory_order_relaxed);
+    l->wait_lock.store(false, std::memory_order_relaxed);
+    l->holder.store(nullptr, std::memory_order_relaxed);
+    l->policy = policy;
+    ut_dlink_init(&l->waiters);
+}
+
+/// \brief Takes `l` in `mode` if that is compatible with the holders and nobody waits
+inline bool sync_rw_try_lock(sync_rw_latch* l, sync_mode mode) noexcept {
+    ib_u32 w = l->word.load(std::memory_order_relaxed);
+    for (;;) {
+        ib_u32 next;
+        switch (mode) {
+        case SYNC_S:
+            if ((w & (SYNC_RW_X | SYNC_WAITERS)) != 0) return false;
+            next = w + 1;
+            break;
+        case SYNC_SX:
+            if ((w & (SYNC_RW_X | SYNC_RW_SX | SYNC_WAITERS)) != 0) return false;
+            next = w | SYNC_RW_SX;
+            break;
+        default:
+            if (w != 0) return false;
+            next = SYNC_RW_X;
+            break;
+        }
+        if (l->word.compare_exchange_weak(w, next, std::memory_order_acquire, std::memory_order_relaxed)) break;
+    }
+    if (mode == SYNC_X) l->holder.store(sched_current_worker(), std::memory_order_relaxed);
+    return true;
+}
+
+/// \brief `co_await sync_rw_s_lock(&l)` returns once the task shares `l`
+inline sync_rw_awaiter sync_rw_s_lock(sync_rw_latch* l, std::source_location site) noexcept {
+    return sync_rw_awaiter{ l, { {}, nullptr, {}, SYNC_S }, site, {} };
+}
+
+/// \brief `co_await sync_rw_sx_lock(&l)` returns once the task holds `l` in SX mode
+inline sync_rw_awaiter sync_rw_sx_lock(sync_rw_latch* l, std::source_location site) noexcept {
+    return sync_rw_awaiter{ l, { {}, nullptr, {}, SYNC_SX }, site, {} };
+}
+
+/// \brief `co_await sync_rw_x_lock(&l)` returns once the task holds `l` exclusively
+inline sync_rw_awaiter sync_rw_x_lock(sync_rw_latch* l, std::source_location site) noexcept {
+    return sync_rw_awaiter{ l, { {}, nullptr, {}, SYNC_X }, site, {} };
+}
+
+inline void sync_rw_s_unlock(sync_rw_latch* l) noexcept {
+    const ib_u32 prev = l->word.fetch_sub(1, std::memory_order_release);
+    IB_ASSERT((prev & SYNC_RW_READERS_MASK) != 0, "S latch not held");
+    if ((prev & SYNC_WAITERS) != 0) sync_rw_unlock_wake(l);
+}
+
+inline void sync_rw_sx_unlock(sync_rw_latch* l) noexcept {
+    const ib_u32 prev = l->word.fetch_and(~SYNC_RW_SX, std::memory_order_release);
+    IB_ASSERT((prev & SYNC_RW_SX) != 0, "SX latch not held");
+    if ((prev & SYNC_WAITERS) != 0) sync_rw_unlock_wake(l);
+}
+
+inline void sync_rw_x_unlock(sync_rw_latch* l) noexcept {
+    l->holder.store(nullptr, std::memory_order_relaxed);
+    const ib_u32 prev = l->word.fetch_and(~SYNC_RW_X, std::memory_order_release);
+    IB_ASSERT((prev & SYNC_RW_X) != 0, "X latch not held");
+    if ((prev & SYNC_WAITERS) != 0) sync_rw_unlock_wake(l);
+}
+
+/// \brief Tasks and threads holding `l` in S mode
+inline ib_u32 sync_rw_readers(const sync_rw_latch* l) noexcept {
+    return l->word.load(std::memory_order_relaxed) & SYNC_RW_READERS_MASK;
+}
+
+inline bool sync_rw_awaiter::await_ready() noexcept {
+    if (sync_rw_try_lock(l, w.mode)) {
+        sync_profile_hold(l->cls, &l->holder_site, site, 0);
+        return true;
+    }
+    const sched_worker* self   = sched_current_worker();
+    const ib_u32        rounds = sync_spin_rounds();
+    ib_u32              r      = 0;
+    while (r < rounds) {
+        const ib_u32 word = l->word.load(std::memory_order_relaxed);
+        if ((word & SYNC_WAITERS) != 0) break;   // queue behind them
+        if (self != nullptr && (word & SYNC_RW_X) != 0 && l->holder.load(std::memory_order_relaxed) == self) break;
+        for (ib_u32 i = 0; i < SYNC_SPIN_PAUSES; ++i) __builtin_ia32_pause();
+        ++r;
+        if (sync_rw_try_lock(l, w.mode)) {
+            sync_profile_hold(l->cls, &l->holder_site, site, r);
+            return true;
+        }
+    }
+    prof.spins = r;
+    return false;
+}
+
+inline bool sync_rw_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    w.t = task_current();
+    if (w.t == nullptr) {
+        sync_rw_lock_blocking(l, w.mode, site);
+        return false;
+    }
+    sync_profile_wait_start(&prof, &l->holder_site, prof.spins);
+    task_park(w.t, h, SCHED_SUSPEND_LATCH);
+    if (sync_rw_lock_wait(l, &w)) return true;
+    sched_resume(&w.t->sched);
+    return true;
+}
+
+inline void sync_rw_awaiter::await_resume() noexcept {
+    sync_profile_wait_end(&prof, l->cls, &l->holder_site, site);
+}
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "sync.hpp"
+
+#include <atomic>
+#include <coroutine>
+
+/// \defgroup sync_event Events, semaphores and barriers
+/// \ingroup sync
+/// \brief Coordination between tasks: wait for something to happen rather than for a latch
+/// \details InnoDB's `os_event` is a condition variable plus a flag that threads block on. Here
+/// the waiting is done by tasks, which park (SCHED_SUSPEND_EVENT) on the intrusive waiter queue
+/// of the object, as they do on latches; threads outside of tasks spin with backoff instead.
+///
+/// - `sync_event`: a flag. With SYNC_EVENT_MANUAL_RESET a set wakes every waiter and the event
+///   stays set until sync_event_reset(); with SYNC_EVENT_AUTO_RESET a set releases one waiter,
+///   or stays pending for the next one if nobody waits (a group commit leader waking the
+///   followers uses the former, a flusher signalling its coordinator the latter).
+/// - `sync_semaphore`: counting permits, e.g. the I/O slots of a flush batch. A release hands
+///   permits to the oldest waiters; a request that finds a permit free takes it even if others
+///   wait, so that the permits never idle.
+/// - `sync_countdown`: opens once counted down to zero and stays open, so that a coordinator
+///   waits for the N pieces of a parallel operation (std::latch; "latch" means something else
+///   in this code base).
+/// - `sync_barrier`: reusable rendezvous of a fixed number of parties; the last one to arrive
+///   completes the phase, does not suspend and is told so.
+///
+/// Waking many tasks is one operation for the scheduler: the waiters are taken off the queue
+/// in one splice and handed to sched_resume_list(). On the waking worker, the OLTP waiters fill
+/// the free slots of its stealable ring in one batch, published with a single store, and the
+/// rest is spliced onto its ready lists; the waiters of another worker are pushed onto its inbox
+/// as one chain. Waiters woken together run in the order they arrived.
+
+/// \addtogroup sync_event
+/// @{
+
+/// \brief Whether a set event stays set
+enum sync_event_mode : ib_u8 {
+    SYNC_EVENT_MANUAL_RESET = 0,
+    SYNC_EVENT_AUTO_RESET   = 1,
+};
+
+/// \brief Flag that tasks wait for
+struct sync_event {
+    std::atomic<bool> signaled;
+    std::atomic<bool> wait_lock;
+    sync_event_mode   mode;
+    ut_dlink          waiters;
+};
+
+/// \brief Counting semaphore
+struct sync_semaphore {
+    std::atomic<ib_u64> permits;
+    std::atomic<ib_u32> waiting;        ///< Queued waiters: releases take the queue lock only when non-zero
+    std::atomic<bool>   wait_lock;
+    ut_dlink            waiters;
+};
+
+/// \brief Single-use countdown
+struct sync_countdown {
+    std::atomic<ib_u64> count;
+    std::atomic<bool>   wait_lock;
+    ut_dlink            waiters;
+};
+
+/// \brief Reusable barrier
+struct sync_barrier {
+    std::atomic<bool> wait_lock;
+    ib_u64            parties;
+    ib_u64            arrived;          ///< In the current phase; protected by `wait_lock`
+    ib_u64            phase;            ///< Phases completed
+    ut_dlink          waiters;
+};
+
+/// \brief Awaitable returned by sync_event_wait()
+struct sync_event_awaiter {
+    sync_event* e;
+    sync_waiter w;
+
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> h) noexcept;
+    void await_resume() noexcept {}
+};
+
+/// \brief Awaitable returned by sync_semaphore_acquire()
+struct sync_semaphore_awaiter {
+    sync_semaphore* s;
+    sync_waiter     w;
+
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> h) noexcept;
+    void await_resume() noexcept {}
+};
+
+/// \brief Awaitable returned by sync_countdown_wait()
+struct sync_countdown_awaiter {
+    sync_countdown* c;
+    sync_waiter     w;
+
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> h) noexcept;
+    void await_resume() noexcept {}
+};
+
+/// \brief Awaitable returned by sync_barrier_arrive_and_wait(); yields true to the party that completed the phase
+struct sync_barrier_awaiter {
+    sync_barrier* b;
+    sync_waiter   w;
+    bool          last;
+
+    bool await_ready() noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) noexcept;
+    bool await_resume() noexcept { return last; }
+};
+
+void   sync_waiters_wake(ut_dlink* list) noexcept;
+
+void   sync_event_set(sync_event* e) noexcept;
+bool   sync_event_wait_queue(sync_event* e, sync_waiter* w) noexcept;
+void   sync_event_wait_blocking(sync_event* e) noexcept;
+bool   sync_semaphore_acquire_wait(sync_semaphore* s, sync_waiter* w) noexcept;
+void   sync_semaphore_release_wake(sync_semaphore* s) noexcept;
+void   sync_semaphore_acquire_blocking(sync_semaphore* s) noexcept;
+void   sync_countdown_open(sync_countdown* c) noexcept;
+bool   sync_countdown_wait_queue(sync_countdown* c, sync_waiter* w) noexcept;
+void   sync_countdown_wait_blocking(sync_countdown* c) noexcept;
+bool   sync_barrier_arrive(sync_barrier* b, sync_waiter* w, std::coroutine_handle<> h) noexcept;
+bool   sync_barrier_arrive_and_wait_blocking(sync_barrier* b) noexcept;
+
+inline static void                   sync_event_init(sync_event* e, sync_event_mode mode, bool signaled = false) noexcept;
+inline static void                   sync_event_reset(sync_event* e) noexcept;
+inline static bool                   sync_event_is_set(const sync_event* e) noexcept;
+inline static sync_event_awaiter     sync_event_wait(sync_event* e) noexcept;
+
+inline static void                   sync_semaphore_init(sync_semaphore* s, ib_u64 permits) noexcept;
+inline static bool                   sync_semaphore_try_acquire(sync_semaphore* s) noexcept;
+inline static sync_semaphore_awaiter sync_semaphore_acquire(sync_semaphore* s) noexcept;
+inline static void                   sync_semaphore_release(sync_semaphore* s, ib_u64 n = 1) noexcept;
+inline static ib_u64                 sync_semaphore_available(const sync_semaphore* s) noexcept;
+
+inline static void                   sync_countdown_init(sync_countdown* c, ib_u64 count) noexcept;
+inline static void                   sync_countdown_count_down(sync_countdown* c, ib_u64 n = 1) noexcept;
+inline static bool                   sync_countdown_try_wait(const sync_countdown* c) noexcept;
+inline static sync_countdown_awaiter sync_countdown_wait(sync_countdown* c) noexcept;
+
+inline static void                   sync_barrier_init(sync_barrier* b, ib_u64 parties) noexcept;
+inline static sync_barrier_awaiter   sync_barrier_arrive_and_wait(sync_barrier* b) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline void sync_event_init(sync_event* e, sync_event_mode mode, bool signaled) noexcept {
+    e->signaled.store(signaled, std::memory_order_relaxed);
+    e->wait_lock.store(false, std::memory_order_relaxed);
+    e->mode = mode;
+    ut_dlink_init(&e->waiters);
+}
+
+/// \brief Clears a manual-reset event; later waiters suspend until the next sync_event_set()
+inline void sync_event_reset(sync_event* e) noexcept {
+    e->signaled.store(false, std::memory_order_relaxed);
+}
+
+inline bool sync_event_is_set(const sync_event* e) noexcept {
+    return e->signaled.load(std::memory_order_acquire);
+}
+
+/// \brief `co_await sync_event_wait(&e)` returns once `e` is set (and, auto-reset, consumed the set)
+inline sync_event_awaiter sync_event_wait(sync_event* e) noexcept {
+    return sync_event_awaiter{ e, { {}, nullptr, { false }, SYNC_X } };
+}
+
+inline bool sync_event_awaiter::await_ready() noexcept {
+    if (e->mode == SYNC_EVENT_MANUAL_RESET) return e->signaled.load(std::memory_order_acquire);
+    bool expected = true;
+    return e->signaled.compare_exchange_strong(expected, false, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline bool sync_event_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    w.t = task_current();
+    if (w.t == nullptr) {
+        sync_event_wait_blocking(e);
+        return false;
+    }
+    task_park(w.t, h, SCHED_SUSPEND_EVENT);
+    if (sync_event_wait_queue(e, &w)) return true;
+    sched_resume(&w.t->sched);   // set meanwhile: the step continues as a yield
+    return true;
+}
+
+inline void sync_semaphore_init(sync_semaphore* s, ib_u64 permits) noexcept {
+    s->permits.store(permits, std::memory_order_relaxed);
+    s->waiting.store(0, std::memory_order_relaxed);
+    s->wait_lock.store(false, std::memory_order_relaxed);
+    ut_dlink_init(&s->waiters);
+}
+
+/// \brief Takes a permit if one is free
+inline bool sync_semaphore_try_acquire(sync_semaphore* s) noexcept {
+    // seq_cst: pairs with sync_semaphore_release(), see sync_semaphore_acquire_wait()
+    ib_u64 n = s->permits.load(std::memory_order_seq_cst);
+    while (n != 0) {
+        if (s->permits.compare_exchange_weak(n, n - 1, std::memory_order_seq_cst)) return true;
+    }
+    return false;
+}
+
+/// \brief `co_await sync_semaphore_acquire(&s)` returns once the task holds a permit
+inline sync_semaphore_awaiter sync_semaphore_acquire(sync_semaphore* s) noexcept {
+    return sync_semaphore_awaiter{ s, { {}, nullptr, { false }, SYNC_X } };
+}
+
+/// \brief Returns `n` permits; queued waiters are handed them oldest first
+inline void sync_semaphore_release(sync_semaphore* s, ib_u64 n) noexcept {
+    s->permits.fetch_add(n, std::memory_order_seq_cst);
+    if (s->waiting.load(std::memory_order_seq_cst) != 0) sync_semaphore_release_wake(s);
+}
+
+inline ib_u64 sync_semaphore_available(const sync_semaphore* s) noexcept {
+    return s->permits.load(std::memory_order_relaxed);
+}
+
+inline bool sync_semaphore_awaiter::await_ready() noexcept {
+    return sync_semaphore_try_acquire(s);
+}
+
+inline bool sync_semaphore_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    w.t = task_current();
+    if (w.t == nullptr) {
+        sync_semaphore_acquire_blocking(s);
+        return false;
+    }
+    task_park(w.t, h, SCHED_SUSPEND_EVENT);
+    if (sync_semaphore_acquire_wait(s, &w)) return true;
+    sched_resume(&w.t->sched);
+    return true;
+}
+
+inline void sync_countdown_init(sync_countdown* c, ib_u64 count) noexcept {
+    c->count.store(count, std::memory_order_relaxed);
+    c->wait_lock.store(false, std::memory_order_relaxed);
+    ut_dlink_init(&c->waiters);
+}
+
+/// \brief Counts `n` pieces of work done; the one that reaches zero wakes the waiters
+inline void sync_countdown_count_down(sync_countdown* c, ib_u64 n) noexcept {
+    const ib_u64 prev = c->count.fetch_sub(n, std::memory_order_acq_rel);
+    IB_ASSERT(prev >= n, "countdown counted below zero");
+    if (prev == n) sync_countdown_open(c);
+}
+
+/// \brief True once the count reached zero
+inline bool sync_countdown_try_wait(const sync_countdown* c) noexcept {
+    return c->count.load(std::memory_order_acquire) == 0;
+}
+
+/// \brief `co_await sync_countdown_wait(&c)` returns once `c` has been counted down to zero
+inline sync_countdown_awaiter sync_countdown_wait(sync_countdown* c) noexcept {
+    return sync_countdown_awaiter{ c, { {}, nullptr, { false }, SYNC_X } };
+}
+
+inline bool sync_countdown_awaiter::await_ready() noexcept {
+    return sync_countdown_try_wait(c);
+}
+
+inline bool sync_countdown_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    w.t = task_current();
+    if (w.t == nullptr) {
+        sync_countdown_wait_blocking(c);
+        return false;
+    }
+    task_park(w.t, h, SCHED_SUSPEND_EVENT);
+    if (sync_countdown_wait_queue(c, &w)) return true;
+    sched_resume(&w.t->sched);
+    return true;
+}
+
+inline void sync_barrier_init(sync_barrier* b, ib_u64 parties) noexcept {
+    IB_ASSERT(parties != 0, "a barrier needs parties");
+    b->wait_lock.store(false, std::memory_order_relaxed);
+    b->parties = parties;
+    b->arrived = 0;
+    b->phase   = 0;
+    ut_dlink_init(&b->waiters);
+}
+
+/// \brief `co_await sync_barrier_arrive_and_wait(&b)` returns once all parties arrived in this phase
+/// \return true for the party whose arrival completed the phase
+inline sync_barrier_awaiter sync_barrier_arrive_and_wait(sync_barrier* b) noexcept {
+    return sync_barrier_awaiter{ b, { {}, nullptr, { false }, SYNC_X }, false };
+}
+
+inline bool sync_barrier_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    w.t = task_current();
+    if (w.t == nullptr) {
+        last = sync_barrier_arrive_and_wait_blocking(b);
+        return false;
+    }
+    last = !sync_barrier_arrive(b, &w, h);
+    return !last;
+}
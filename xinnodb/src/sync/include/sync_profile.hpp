@@ -0,0 +1,105 @@
+#pragma once
+
+#include "xinnodb.hpp"               // IWYU pragma: keep
+#include "ut_dlink.hpp"              // IWYU pragma: keep
+
+#include <atomic>
+#include <cstdio>
+#include <source_location>
+
+/// \defgroup sync_profile Latch profiler
+/// \ingroup sync
+/// \brief Contention statistics per latch class, switched on at runtime
+/// \details InnoDB counts spin rounds, OS waits and exits in a handful of globals, which tell
+/// that latches are contended but not which ones. Here every latch may name a `sync_class`
+/// (the latches of all buffer pool pages, of one hash table, ...) and, while the `sync_profile`
+/// configuration variable is on, each acquisition through an awaiter or a blocking call charges
+/// its class:
+///
+/// - acquisitions, spin rounds and suspensions (parked tasks or sleeping threads);
+/// - the time from the suspension to the grant, total and maximum;
+/// - the call site of the holder the waiter found, from the `std::source_location` of the
+///   holder's lock call. The sites that made others wait the longest are kept per class
+///   (SYNC_PROFILE_SITES of them, by the space-saving heavy hitters algorithm).
+///
+/// Latches without a class count against `sync_class_default`. While the profiler is off the
+/// latches pay one relaxed load of a global flag per acquisition; while it is on, the counters
+/// are shared atomics, which is acceptable for a diagnostic mode. The holder site is sampled:
+/// it is set by the awaiters and the blocking calls, not by try-locks.
+///
+/// sync_profile_snapshot() and sync_profile_print() report the classes ranked by total wait,
+/// into rows provided by the caller (sync_profile_class_count() of them for a full report): the
+/// reports allocate nothing, and a failed write is returned rather than thrown.
+
+/// \addtogroup sync_profile
+/// @{
+
+inline static constexpr ib_u32 SYNC_PROFILE_SITES     = 8;
+inline static constexpr ib_u32 SYNC_PROFILE_PRINT_TOP = 3;    ///< Holder sites printed per class
+
+/// \brief Time latches of one class made others wait while held from one call site
+struct sync_site_stats {
+    std::source_location site;
+    ib_u64               waits;
+    ib_u64               wait_ns;
+};
+
+/// \brief Latches profiled together
+struct sync_class {
+    ut_dlink            link;
+    const char*         name;
+    std::atomic<ib_u64> acquisitions;
+    std::atomic<ib_u64> spins;
+    std::atomic<ib_u64> suspends;
+    std::atomic<ib_u64> wait_ns;
+    std::atomic<ib_u64> max_wait_ns;
+    std::atomic<bool>   sites_lock;
+    ib_u32              site_count;
+    sync_site_stats     sites[SYNC_PROFILE_SITES];   ///< Unordered
+};
+
+/// \brief Snapshot of a class, see sync_profile_snapshot()
+struct sync_profile_row {
+    const sync_class* cls;
+    ib_u64            acquisitions;
+    ib_u64            spins;
+    ib_u64            suspends;
+    ib_u64            wait_ns;
+    ib_u64            max_wait_ns;
+    ib_u32            site_count;
+    sync_site_stats   sites[SYNC_PROFILE_SITES];     ///< By wait time, longest first
+};
+
+/// \brief What an awaiter remembers about its wait while the profiler is on
+struct sync_profile_wait {
+    ib_u64               start_ns;     ///< 0 if the profiler was off when the wait started
+    ib_u32               spins;
+    std::source_location holder;
+};
+
+extern std::atomic<bool> sync_profile_enabled;
+extern sync_class        sync_class_default;
+
+int    sync_profile_register() noexcept;
+int    sync_class_register(sync_class* c, const char* name) noexcept;
+void   sync_class_unregister(sync_class* c) noexcept;
+void   sync_profile_enable(bool on) noexcept;
+void   sync_profile_reset() noexcept;
+void   sync_profile_acquired(sync_class* c, ib_u32 spins) noexcept;
+void   sync_profile_waited(sync_class* c, const sync_profile_wait* w, ib_u64 end_ns) noexcept;
+ib_u32 sync_profile_class_count() noexcept;
+ib_u32 sync_profile_snapshot(sync_profile_row* rows, ib_u32 max) noexcept;
+int    sync_profile_print(std::FILE* out, sync_profile_row* rows, ib_u32 max) noexcept;
+
+inline static bool sync_profile_on() noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline bool sync_profile_on() noexcept {
+    return sync_profile_enabled.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "sync.hpp"
+#include "ut_proc.hpp"
+
+#include <atomic>
+#include <coroutine>
+
+/// \defgroup sync_shm Cross-process latches
+/// \ingroup sync
+/// \brief Latches for structures in shared memory (the SGA), usable from every process
+/// \details The waiter queues of `sync_mutex` and `sync_rw_latch` link coroutine frames and
+/// tasks of one address space, so they cannot be shared. These latches keep all of their state
+/// in 32-bit words that mean the same thing in every process:
+///
+/// - a `sync_shm_mutex` word holds the pid of the owner process, plus SYNC_WAITERS;
+/// - a `sync_shm_rw_latch` word has the layout of `sync_rw_latch` (S holders, SYNC_RW_SX,
+///   SYNC_RW_X, SYNC_WAITERS); the SX and X holders are kept next to it.
+///
+/// Next to each pid the latch records the identity of the process (see `ut_proc`), so that a pid
+/// reused by a later process does not keep a dead owner alive.
+///
+/// Waiting follows the in-process latches: the fast path, then `sync_spin_rounds` retries.
+/// After that a thread sleeps on the word with `FUTEX_WAIT`, without `FUTEX_PRIVATE_FLAG`, so
+/// that the kernel keys the wait on the physical page and a release in another process wakes
+/// it. SYNC_WAITERS means "somebody may sleep on the futex": releases that see it clear it and
+/// call `FUTEX_WAKE`, and sleepers set it again if they lose the race. A task must not put its
+/// worker to sleep, so it parks instead, on the `sync_shm_worker` of its worker, whose poller
+/// retries the latches of its parked tasks. Polled tasks never set SYNC_WAITERS and cost
+/// releasers nothing, but then nothing tells the worker that a latch was released: the poller
+/// backs off exponentially between rounds that get no latch, from SYNC_SHM_RETRY_MIN_NS to
+/// SYNC_SHM_RETRY_MAX_NS, and the parked tasks do not count in `poll_pending`, so a pool worker
+/// that has nothing else to do parks with its timeout instead of spinning on a latch held for
+/// long.
+///
+/// Robust owners: a process may die while it holds a latch exclusively. Waiters sleep with a
+/// timeout of SYNC_SHM_PROBE_NS and, once it expires, check that the owner process still exists. If
+/// it does not, the waiter takes the latch over and its request completes with `owner_died`
+/// set (the return value of the awaiter and of the blocking calls): the structure the latch
+/// protects may be half-updated and the new owner has to repair or discard it. S holders are
+/// counted per process as well, in SYNC_SHM_READER_SLOTS slots of the latch: a waiter that finds
+/// the latch held in S mode probes the processes of the slots and drops the holds of the dead
+/// ones. Readers do not modify the structure, so that does not set `owner_died`. The holds of a
+/// process that finds every slot taken are only counted in the latch word and cannot be
+/// reclaimed; neither can a hold whose process died between updating the word and its slot. An
+/// owner that dies between taking the latch and recording its identity is checked by pid only,
+/// like every owner where `/proc` cannot be read: if its pid is reused before a waiter probes it,
+/// the latch stays held.
+///
+/// Unlike the in-process latches, waiters are not queued: they are not served in order, there
+/// is no wake policy and latecomers may barge in. All processes must share a pid namespace.
+/// @{
+
+inline static constexpr ib_u64 SYNC_SHM_PROBE_NS     = 10'000'000;   ///< Waits between owner liveness checks
+inline static constexpr ib_u64 SYNC_SHM_RETRY_MIN_NS = 2'000;        ///< First delay between poller retries
+inline static constexpr ib_u64 SYNC_SHM_RETRY_MAX_NS = 1'000'000;    ///< Longest delay between poller retries: a pool worker's park timeout
+inline static constexpr ib_u32 SYNC_SHM_PID_MASK     = SYNC_WAITERS - 1;
+inline static constexpr ib_u32 SYNC_SHM_WAKE_ALL     = 0x7fffffff;
+inline static constexpr ib_u32 SYNC_SHM_READER_SLOTS = 8;            ///< Processes whose S holds of a latch are tracked
+
+enum sync_shm_kind : ib_u8 {
+    SYNC_SHM_MUTEX = 0,
+    SYNC_SHM_RW    = 1,
+};
+
+/// \brief Exclusive latch in shared memory
+struct sync_shm_mutex {
+    std::atomic<ib_u32> word;           ///< Owner pid | SYNC_WAITERS; 0 when free
+    std::atomic<ib_u64> owner_id;       ///< Identity of the owner, 0 until it is recorded
+};
+
+/// \brief Shared / shared-exclusive / exclusive latch in shared memory
+struct sync_shm_rw_latch {
+    std::atomic<ib_u32> word;           ///< S holders, SYNC_RW_SX, SYNC_RW_X, SYNC_WAITERS
+    std::atomic<ib_u64> sx_owner;       ///< Identity of the SX holder, 0 if none
+    std::atomic<ib_u64> x_owner;        ///< Identity of the X holder, 0 if none
+    std::atomic<ib_u64> readers[SYNC_SHM_READER_SLOTS];      ///< Pid << 32 | S holds of that process; 0 if free
+    std::atomic<ib_u64> reader_ids[SYNC_SHM_READER_SLOTS];   ///< Identity of the process of each slot, 0 until recorded
+};
+
+/// \brief A task parked on a cross-process latch; lives in the awaiter
+struct sync_shm_waiter {
+    ut_dlink      link;
+    task*         t;
+    void*         latch;
+    ib_u64        probe_ns;             ///< Next owner liveness check
+    sync_shm_kind kind;
+    sync_mode     mode;
+    bool          owner_died;
+};
+
+/// \brief Per-worker list of tasks waiting for cross-process latches, and its poller
+struct sync_shm_worker {
+    sched_worker* sched;
+    sched_poller  poller;
+    ut_dlink      waiters;              ///< sync_shm_waiter, oldest last
+    ib_u64        retry_ns;             ///< Next round of retries
+    ib_u64        retry_delay_ns;       ///< Delay after a round that gets no latch, doubled each time
+    ib_u64        parked_total;
+    ib_u64        polls;                ///< Latch retries by the poller
+    ib_u64        recovered;            ///< Latches taken over from dead owners
+};
+
+/// \brief Awaitable returned by the sync_shm_*_lock() functions
+/// \details `co_await` yields true if the latch was taken over from a dead owner.
+struct sync_shm_awaiter {
+    sync_shm_waiter w;
+
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> h) noexcept;
+    bool await_resume() const noexcept { return w.owner_died; }
+};
+
+extern std::atomic<ib_u32> sync_shm_pid;
+
+ib_u32 sync_shm_self_init() noexcept;
+bool   sync_shm_owner_alive(ib_u32 pid, ib_u64 id) noexcept;
+void   sync_shm_wake(std::atomic<ib_u32>* word, ib_u32 count) noexcept;
+int    sync_shm_worker_init(sync_shm_worker* sw, sched_worker* w) noexcept;
+void   sync_shm_worker_detach(sync_shm_worker* sw) noexcept;
+bool   sync_shm_acquire(sync_shm_waiter* w, bool probe) noexcept;
+bool   sync_shm_mutex_lock_blocking(sync_shm_mutex* m) noexcept;
+bool   sync_shm_rw_lock_blocking(sync_shm_rw_latch* l, sync_mode mode) noexcept;
+
+inline static ib_u32 sync_shm_self() noexcept;
+
+inline static void             sync_shm_mutex_init(sync_shm_mutex* m) noexcept;
+inline static bool             sync_shm_mutex_try_lock(sync_shm_mutex* m) noexcept;
+inline static sync_shm_awaiter sync_shm_mutex_lock(sync_shm_mutex* m) noexcept;
+inline static void             sync_shm_mutex_unlock(sync_shm_mutex* m) noexcept;
+inline static ib_u32           sync_shm_mutex_owner(const sync_shm_mutex* m) noexcept;
+
+inline static void             sync_shm_rw_init(sync_shm_rw_latch* l) noexcept;
+inline static bool             sync_shm_rw_try_lock(sync_shm_rw_latch* l, sync_mode mode) noexcept;
+inline static sync_shm_awaiter sync_shm_rw_s_lock(sync_shm_rw_latch* l) noexcept;
+inline static sync_shm_awaiter sync_shm_rw_sx_lock(sync_shm_rw_latch* l) noexcept;
+inline static sync_shm_awaiter sync_shm_rw_x_lock(sync_shm_rw_latch* l) noexcept;
+inline static void             sync_shm_rw_s_unlock(sync_shm_rw_latch* l) noexcept;
+inline static void             sync_shm_rw_sx_unlock(sync_shm_rw_latch* l) noexcept;
+inline static void             sync_shm_rw_x_unlock(sync_shm_rw_latch* l) noexcept;
+inline static ib_u32           sync_shm_rw_readers(const sync_shm_rw_latch* l) noexcept;
+inline static void             sync_shm_rw_reader_add(sync_shm_rw_latch* l) noexcept;
+inline static void             sync_shm_rw_reader_remove(sync_shm_rw_latch* l) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Pid of this process, cached (and reset in children after fork())
+inline ib_u32 sync_shm_self() noexcept {
+    const ib_u32 pid = sync_shm_pid.load(std::memory_order_relaxed);
+    return pid != 0 ? pid : sync_shm_self_init();
+}
+
+inline void sync_shm_mutex_init(sync_shm_mutex* m) noexcept {
+    m->word.store(0, std::memory_order_relaxed);
+    m->owner_id.store(0, std::memory_order_relaxed);
+}
+
+inline bool sync_shm_mutex_try_lock(sync_shm_mutex* m) noexcept {
+    ib_u32 expected = 0;
+    if (!m->word.compare_exchange_strong(expected, sync_shm_self(), std::memory_order_acquire, std::memory_order_relaxed)) return false;
+    m->owner_id.store(ut_proc_self(), std::memory_order_relaxed);
+    return true;
+}
+
+/// \brief `co_await sync_shm_mutex_lock(&m)` returns once the task holds `m`
+inline sync_shm_awaiter sync_shm_mutex_lock(sync_shm_mutex* m) noexcept {
+    return sync_shm_awaiter{ { {}, nullptr, m, 0, SYNC_SHM_MUTEX, SYNC_X, false } };
+}
+
+inline void sync_shm_mutex_unlock(sync_shm_mutex* m) noexcept {
+    m->owner_id.store(0, std::memory_order_relaxed);
+    const ib_u32 prev = m->word.exchange(0, std::memory_order_release);
+    IB_ASSERT((prev & SYNC_SHM_PID_MASK) != 0, "shared mutex not held");
+    if ((prev & SYNC_WAITERS) != 0) sync_shm_wake(&m->word, 1);
+}
+
+/// \brief Pid of the process holding `m`, 0 if it is free
+inline ib_u32 sync_shm_mutex_owner(const sync_shm_mutex* m) noexcept {
+    return m->word.load(std::memory_order_relaxed) & SYNC_SHM_PID_MASK;
+}
+
+inline void sync_shm_rw_init(sync_shm_rw_latch* l) noexcept {
+    l->word.store(0, std::memory_order_relaxed);
+    l->sx_owner.store(0, std::memory_order_relaxed);
+    l->x_owner.store(0, std::memory_order_relaxed);
+    for (ib_u32 i = 0; i < SYNC_SHM_READER_SLOTS; ++i) {
+        l->readers[i].store(0, std::memory_order_relaxed);
+        l->reader_ids[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/// \brief Takes `l` in `mode` if that is compatible with the holders
+inline bool sync_shm_rw_try_lock(sync_shm_rw_latch* l, sync_mode mode) noexcept {
+    sync_shm_waiter w{ {}, nullptr, l, 0, SYNC_SHM_RW, mode, false };
+    return sync_shm_acquire(&w, false);
+}
+
+/// \brief `co_await sync_shm_rw_s_lock(&l)` returns once the task shares `l`
+inline sync_shm_awaiter sync_shm_rw_s_lock(sync_shm_rw_latch* l) noexcept {
+    return sync_shm_awaiter{ { {}, nullptr, l, 0, SYNC_SHM_RW, SYNC_S, false } };
+}
+
+/// \brief `co_await sync_shm_rw_sx_lock(&l)` returns once the task holds `l` in SX mode
+inline sync_shm_awaiter sync_shm_rw_sx_lock(sync_shm_rw_latch* l) noexcept {
+    return sync_shm_awaiter{ { {}, nullptr, l, 0, SYNC_SHM_RW, SYNC_SX, false } };
+}
+
+/// \brief `co_await sync_shm_rw_x_lock(&l)` returns once the task holds `l` exclusively
+inline sync_shm_awaiter sync_shm_rw_x_lock(sync_shm_rw_latch* l) noexcept {
+    return sync_shm_awaiter{ { {}, nullptr, l, 0, SYNC_SHM_RW, SYNC_X, false } };
+}
+
+inline void sync_shm_rw_s_unlock(sync_shm_rw_latch* l) noexcept {
+    sync_shm_rw_reader_remove(l);   // before the word, so that a slot never counts more than the word
+    const ib_u32 prev = l->word.fetch_sub(1, std::memory_order_release);
+    IB_ASSERT((prev & SYNC_RW_READERS_MASK) != 0, "shared S latch not held");
+    // Only the last reader can let a waiter in
+    if ((prev & SYNC_WAITERS) != 0 && (prev & SYNC_RW_READERS_MASK) == 1 &&
+        (l->word.fetch_and(~SYNC_WAITERS, std::memory_order_relaxed) & SYNC_WAITERS) != 0) {
+        sync_shm_wake(&l->word, SYNC_SHM_WAKE_ALL);
+    }
+}
+
+inline void sync_shm_rw_sx_unlock(sync_shm_rw_latch* l) noexcept {
+    l->sx_owner.store(0, std::memory_order_relaxed);
+    const ib_u32 prev = l->word.fetch_and(~(SYNC_RW_SX | SYNC_WAITERS), std::memory_order_release);
+    IB_ASSERT((prev & SYNC_RW_SX) != 0, "shared SX latch not held");
+    if ((prev & SYNC_WAITERS) != 0) sync_shm_wake(&l->word, SYNC_SHM_WAKE_ALL);
+}
+
+inline void sync_shm_rw_x_unlock(sync_shm_rw_latch* l) noexcept {
+    l->x_owner.store(0, std::memory_order_relaxed);
+    const ib_u32 prev = l->word.fetch_and(~(SYNC_RW_X | SYNC_WAITERS), std::memory_order_release);
+    IB_ASSERT((prev & SYNC_RW_X) != 0, "shared X latch not held");
+    if ((prev & SYNC_WAITERS) != 0) sync_shm_wake(&l->word, SYNC_SHM_WAKE_ALL);
+}
+
+/// \brief Tasks and threads holding `l` in S mode, in all processes
+inline ib_u32 sync_shm_rw_readers(const sync_shm_rw_latch* l) noexcept {
+    return l->word.load(std::memory_order_relaxed) & SYNC_RW_READERS_MASK;
+}
+
+/// \brief Counts an S hold of this process in a reader slot of `l`; the hold stays untracked if
+/// every slot belongs to another process
+/// \details The process that claims a free slot records its identity in `reader_ids` afterwards.
+inline void sync_shm_rw_reader_add(sync_shm_rw_latch* l) noexcept {
+    const ib_u64 self = (ib_u64)sync_shm_self() << 32;
+    for (ib_u32 i = 0; i < SYNC_SHM_READER_SLOTS; ++i) {
+        std::atomic<ib_u64>& slot = l->readers[i];
+        ib_u64               v    = slot.load(std::memory_order_relaxed);
+        while (v == 0 || (v >> 32 << 32) == self) {
+            if (slot.compare_exchange_weak(v, (v == 0 ? self : v) + 1, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                if (v == 0) l->reader_ids[i].store(ut_proc_self(), std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+}
+
+/// \brief Uncounts an S hold of this process; the slot is freed with its last hold
+/// \details The identity of a freed slot is cleared unless the next process to claim it has
+/// recorded its own already.
+inline void sync_shm_rw_reader_remove(sync_shm_rw_latch* l) noexcept {
+    const ib_u64 self = (ib_u64)sync_shm_self() << 32;
+    for (ib_u32 i = 0; i < SYNC_SHM_READER_SLOTS; ++i) {
+        std::atomic<ib_u64>& slot = l->readers[i];
+        ib_u64               v    = slot.load(std::memory_order_relaxed);
+        while ((v >> 32 << 32) == self) {
+            const ib_u64 next = (ib_u32)v == 1 ? 0 : v - 1;
+            if (slot.compare_exchange_weak(v, next, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                ib_u64 id = ut_proc_self();
+                if (next == 0) l->reader_ids[i].compare_exchange_strong(id, 0, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,179 @@
+#include "sync_event.hpp"
+
+// -----------------------------------------------------------------------------
+// Waiters
+// -----------------------------------------------------------------------------
+
+/// \brief Resumes the waiters on `list`, already taken off their queue, and leaves it empty
+/// \details Threads are released one by one; tasks go back to the scheduler as one batch, see
+/// sched_resume_list(). A waiter lives in its awaiter or on the stack of its thread: it is not
+/// touched once released.
+void sync_waiters_wake(ut_dlink* list) noexcept {
+    ut_dlink tasks;
+    ut_dlink_init(&tasks);
+    while (ut_dlink* link = ut_dlink_dequeue(list)) {
+        sync_waiter* w = sync_waiter_from_link(link);
+        if (w->t != nullptr) {
+            ut_dlink_enqueue(&tasks, &w->t->sched.link);
+        } else {
+            w->granted.store(true, std::memory_order_release);
+        }
+    }
+    sched_resume_list(&tasks);
+}
+
+// -----------------------------------------------------------------------------
+// Event
+// -----------------------------------------------------------------------------
+
+/// \brief Sets `e`: wakes every waiter (manual reset) or the oldest one (auto reset)
+/// \details An auto-reset event with nobody waiting stays set until a wait consumes it.
+void sync_event_set(sync_event* e) noexcept {
+    if (e->mode == SYNC_EVENT_MANUAL_RESET && e->signaled.load(std::memory_order_acquire)) return;
+    ut_dlink woken;
+    ut_dlink_init(&woken);
+    sync_wait_lock_acquire(&e->wait_lock);
+    if (e->mode == SYNC_EVENT_MANUAL_RESET) {
+        e->signaled.store(true, std::memory_order_release);
+        ut_dlink_splice(&woken, &e->waiters);
+    } else if (ut_dlink* link = ut_dlink_dequeue(&e->waiters)) {
+        ut_dlink_enqueue(&woken, link);
+    } else {
+        e->signaled.store(true, std::memory_order_release);
+    }
+    sync_wait_lock_release(&e->wait_lock);
+    sync_waiters_wake(&woken);
+}
+
+/// \brief Slow path of sync_event_wait(): queues `w` unless the event turns out to be set
+/// \details A task must be parked before the call: it may be resumed as soon as it is queued.
+/// \return true if `w` was queued, false if the event was set (and, auto reset, consumed)
+bool sync_event_wait_queue(sync_event* e, sync_waiter* w) noexcept {
+    sync_wait_lock_acquire(&e->wait_lock);
+    bool set;
+    if (e->mode == SYNC_EVENT_MANUAL_RESET) {
+        set = e->signaled.load(std::memory_order_acquire);
+    } else {
+        set = e->signaled.exchange(false, std::memory_order_acquire);
+    }
+    if (!set) ut_dlink_enqueue(&e->waiters, &w->link);
+    sync_wait_lock_release(&e->wait_lock);
+    return !set;
+}
+
+/// \brief Waits for `e` from a thread that does not run tasks, spinning on its own waiter
+void sync_event_wait_blocking(sync_event* e) noexcept {
+    sync_event_awaiter a = sync_event_wait(e);
+    if (a.await_ready()) return;
+    if (sync_event_wait_queue(e, &a.w)) sync_waiter_block(&a.w);
+}
+
+// -----------------------------------------------------------------------------
+// Semaphore
+// -----------------------------------------------------------------------------
+
+/// \brief Slow path of sync_semaphore_acquire(): queues `w` unless a permit turns up
+/// \details `waiting` is raised before the last try and a release adds its permits before it
+/// reads `waiting` (both sequentially consistent), so either the try sees the permit or the
+/// release sees the waiter and comes for the queue lock.
+/// \return true if `w` was queued, false if a permit was taken
+bool sync_semaphore_acquire_wait(sync_semaphore* s, sync_waiter* w) noexcept {
+    sync_wait_lock_acquire(&s->wait_lock);
+    s->waiting.fetch_add(1, std::memory_order_seq_cst);
+    if (sync_semaphore_try_acquire(s)) {
+        s->waiting.fetch_sub(1, std::memory_order_relaxed);
+        sync_wait_lock_release(&s->wait_lock);
+        return false;
+    }
+    ut_dlink_enqueue(&s->waiters, &w->link);
+    sync_wait_lock_release(&s->wait_lock);
+    return true;
+}
+
+/// \brief Slow path of sync_semaphore_release(): hands the free permits to the oldest waiters
+void sync_semaphore_release_wake(sync_semaphore* s) noexcept {
+    ut_dlink woken;
+    ut_dlink_init(&woken);
+    sync_wait_lock_acquire(&s->wait_lock);
+    while (!ut_dlink_is_detached(&s->waiters) && sync_semaphore_try_acquire(s)) {
+        ut_dlink_enqueue(&woken, ut_dlink_dequeue(&s->waiters));
+        s->waiting.fetch_sub(1, std::memory_order_relaxed);
+    }
+    sync_wait_lock_release(&s->wait_lock);
+    sync_waiters_wake(&woken);
+}
+
+/// \brief Takes a permit from a thread that does not run tasks, spinning on its own waiter
+void sync_semaphore_acquire_blocking(sync_semaphore* s) noexcept {
+    if (sync_semaphore_try_acquire(s)) return;
+    sync_waiter w{ {}, nullptr, { false }, SYNC_X };
+    if (sync_semaphore_acquire_wait(s, &w)) sync_waiter_block(&w);
+}
+
+// -----------------------------------------------------------------------------
+// Countdown
+// -----------------------------------------------------------------------------
+
+/// \brief Wakes everybody waiting for `c`, which reached zero
+void sync_countdown_open(sync_countdown* c) noexcept {
+    ut_dlink woken;
+    ut_dlink_init(&woken);
+    sync_wait_lock_acquire(&c->wait_lock);
+    ut_dlink_splice(&woken, &c->waiters);
+    sync_wait_lock_release(&c->wait_lock);
+    sync_waiters_wake(&woken);
+}
+
+/// \brief Slow path of sync_countdown_wait(): queues `w` unless the count reached zero
+/// \details The count is read with the queue locked, and the party that brings it to zero
+/// takes the lock afterwards, so a waiter is either queued before the wakeup or sees zero.
+/// \return true if `w` was queued
+bool sync_countdown_wait_queue(sync_countdown* c, sync_waiter* w) noexcept {
+    sync_wait_lock_acquire(&c->wait_lock);
+    const bool open = c->count.load(std::memory_order_acquire) == 0;
+    if (!open) ut_dlink_enqueue(&c->waiters, &w->link);
+    sync_wait_lock_release(&c->wait_lock);
+    return !open;
+}
+
+/// \brief Waits for `c` from a thread that does not run tasks, spinning on its own waiter
+void sync_countdown_wait_blocking(sync_countdown* c) noexcept {
+    if (sync_countdown_try_wait(c)) return;
+    sync_waiter w{ {}, nullptr, { false }, SYNC_X };
+    if (sync_countdown_wait_queue(c, &w)) sync_waiter_block(&w);
+}
+
+// -----------------------------------------------------------------------------
+// Barrier
+// -----------------------------------------------------------------------------
+
+/// \brief Counts the arrival of `w`; the last party of the phase wakes the others
+/// \details A task that is not the last is parked on `h` with the queue locked, so that the
+/// last party cannot resume it before it is suspended, and does not need to yield otherwise.
+/// \return true if `w` was queued, false if its arrival completed the phase
+bool sync_barrier_arrive(sync_barrier* b, sync_waiter* w, std::coroutine_handle<> h) noexcept {
+    sync_wait_lock_acquire(&b->wait_lock);
+    if (++b->arrived < b->parties) {
+        if (w->t != nullptr) task_park(w->t, h, SCHED_SUSPEND_EVENT);
+        ut_dlink_enqueue(&b->waiters, &w->link);
+        sync_wait_lock_release(&b->wait_lock);
+        return true;
+    }
+    ut_dlink woken;
+    ut_dlink_init(&woken);
+    ut_dlink_splice(&woken, &b->waiters);
+    b->arrived = 0;
+    ++b->phase;
+    sync_wait_lock_release(&b->wait_lock);
+    sync_waiters_wake(&woken);
+    return false;
+}
+
+/// \brief Arrives at `b` from a thread that does not run tasks and spins until the phase completes
+/// \return true if this arrival completed the phase
+bool sync_barrier_arrive_and_wait_blocking(sync_barrier* b) noexcept {
+    sync_waiter w{ {}, nullptr, { false }, SYNC_X };
+    if (!sync_barrier_arrive(b, &w, {})) return true;
+    sync_waiter_block(&w);
+    return false;
+}
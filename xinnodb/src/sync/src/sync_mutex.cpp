@@ -0,0 +1,115 @@
+#include "sync.hpp"
+#include "ut_cfg.hpp"
+#include "ut_rnd.hpp"
+
+// -----------------------------------------------------------------------------
+// Settings
+// -----------------------------------------------------------------------------
+
+static std::atomic<ib_u32> sync_cfg_spin_rounds_now{ SYNC_SPIN_ROUNDS_DEFAULT };
+static ib_ulint            sync_cfg_spin_rounds = SYNC_SPIN_ROUNDS_DEFAULT;
+static ut_cfg_var          sync_cfg_spin_rounds_var;
+
+static int sync_cfg_apply_spin_rounds(ut_cfg_var* var, const void* value) noexcept {
+    ut_cfg_store(var, value);
+    sync_cfg_spin_rounds_now.store((ib_u32)*(const ib_ulint*)value, std::memory_order_relaxed);
+    return 0;
+}
+
+/// \return 0, or -1 with nothing registered
+static int sync_register() noexcept {
+    if (ut_cfg_register(&sync_cfg_spin_rounds_var, "sync_spin_rounds", IB_CFG_ULINT, &sync_cfg_spin_rounds, sync_cfg_apply_spin_rounds, 0,
+                        100'000) != 0) {
+        return -1;
+    }
+    if (sync_profile_register() != 0) {
+        ut_cfg_unregister(&sync_cfg_spin_rounds_var);
+        return -1;
+    }
+    return 0;
+}
+
+/// \brief Registers the settings of the module and the default latch class; only the first call
+/// does, the others return its result
+/// \return 0 on success, -1 if one of the names was already taken (none of them is then registered)
+int sync_init() noexcept {
+    static const int rc = sync_register();
+    return rc;
+}
+
+/// \brief Fast-path retries of a latch request before it queues
+ib_u32 sync_spin_rounds() noexcept {
+    return sync_cfg_spin_rounds_now.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Waiters
+// -----------------------------------------------------------------------------
+
+/// \brief Spins, with backoff, until a thread waiter has been handed the latch
+void sync_waiter_block(sync_waiter* w) noexcept {
+    ut_rnd rnd;
+    ut_rnd_init(&rnd, ut_rnd_entropy());
+    ut_backoff backoff;
+    ut_backoff_init(&backoff, &rnd);
+    while (!w->granted.load(std::memory_order_acquire)) ut_backoff_pause(&backoff);
+}
+
+// -----------------------------------------------------------------------------
+// Mutex
+// -----------------------------------------------------------------------------
+
+/// \brief Slow path of sync_mutex_lock(): queues `w` unless the mutex turns out to be free
+/// \details With the queue locked, either the mutex is taken or SYNC_WAITERS is set with a
+/// compare-and-swap against the word just read, so a release racing with us either happens
+/// before (and we take the mutex) or sees the flag (and hands the mutex to the queue).
+/// A task must be parked before the call: it may be resumed as soon as it is queued.
+/// \return true if `w` was queued, false if the mutex was taken
+bool sync_mutex_lock_wait(sync_mutex* m, sync_waiter* w) noexcept {
+    sync_wait_lock_acquire(&m->wait_lock);
+    ib_u32 word = m->word.load(std::memory_order_relaxed);
+    for (;;) {
+        if ((word & SYNC_LOCKED) == 0) {
+            if (!m->word.compare_exchange_weak(word, word | SYNC_LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) continue;
+            sync_wait_lock_release(&m->wait_lock);
+            m->holder.store(sched_current_worker(), std::memory_order_relaxed);
+            return false;
+        }
+        if ((word & SYNC_WAITERS) != 0) break;
+        if (m->word.compare_exchange_weak(word, word | SYNC_WAITERS, std::memory_order_relaxed, std::memory_order_relaxed)) break;
+    }
+    ut_dlink_enqueue(&m->waiters, &w->link);
+    sync_wait_lock_release(&m->wait_lock);
+    return true;
+}
+
+/// \brief Slow path of sync_mutex_unlock(): hands the mutex to the oldest waiter
+/// \details The mutex stays locked throughout, so nobody can barge in between the release and
+/// the resumption of the new owner.
+void sync_mutex_unlock_wake(sync_mutex* m) noexcept {
+    sync_wait_lock_acquire(&m->wait_lock);
+    ut_dlink* link = ut_dlink_dequeue(&m->waiters);
+    IB_ASSERT_NOT_NULL(link, "mutex flagged with waiters has none");
+    sync_waiter* w = sync_waiter_from_link(link);
+    if (ut_dlink_is_detached(&m->waiters)) m->word.store(SYNC_LOCKED, std::memory_order_release);
+    m->holder.store(w->t != nullptr ? w->t->sched.worker : nullptr, std::memory_order_relaxed);
+    sync_wait_lock_release(&m->wait_lock);
+    if (w->t != nullptr) {
+        sched_resume(&w->t->sched);
+    } else {
+        w->granted.store(true, std::memory_order_release);
+    }
+}
+
+/// \brief Takes `m` from a thread that does not run tasks, spinning on its own waiter
+void sync_mutex_lock_blocking(sync_mutex* m, std::source_location site) noexcept {
+    if (sync_mutex_try_lock(m)) {
+        sync_profile_hold(m->cls, &m->holder_site, site, 0);
+        return;
+    }
+    sync_profile_wait prof{};
+    sync_profile_wait_start(&prof, &m->holder_site, 0);
+    sync_waiter w{ {}, nullptr, { false }, SYNC_X };
+    if (sync_mutex_lock_wait(m, &w)) sync_waiter_block(&w);
+    sync_profile_wait_end(&prof, m->cls, &m->holder_site, site);
+}
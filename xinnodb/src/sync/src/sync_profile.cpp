@@ -0,0 +1,239 @@
+#include "sync_profile.hpp"
+#include "ut.hpp"
+#include "ut_assert.hpp"
+#include "ut_cfg.hpp"
+#include "ut_print.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+std::atomic<bool> sync_profile_enabled{ false };
+sync_class        sync_class_default;
+
+static std::atomic<bool> sync_class_lock_word{ false };
+static ut_dlink          sync_classes = { &sync_classes, &sync_classes };
+
+static void sync_class_lock() noexcept {
+    while (sync_class_lock_word.exchange(true, std::memory_order_acquire)) {
+        while (sync_class_lock_word.load(std::memory_order_relaxed)) __builtin_ia32_pause();
+    }
+}
+
+static void sync_class_unlock() noexcept {
+    sync_class_lock_word.store(false, std::memory_order_release);
+}
+
+static sync_class* sync_class_of(ut_dlink* link) noexcept {
+    return (sync_class*)((char*)link - IB_OFFSET_OF(sync_class, link));
+}
+
+static void sync_class_clear(sync_class* c) noexcept {
+    c->acquisitions.store(0, std::memory_order_relaxed);
+    c->spins.store(0, std::memory_order_relaxed);
+    c->suspends.store(0, std::memory_order_relaxed);
+    c->wait_ns.store(0, std::memory_order_relaxed);
+    c->max_wait_ns.store(0, std::memory_order_relaxed);
+    c->site_count = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Settings
+// -----------------------------------------------------------------------------
+
+static ib_bool    sync_cfg_profile = false;
+static ut_cfg_var sync_cfg_profile_var;
+
+static int sync_cfg_apply_profile(ut_cfg_var* var, const void* value) noexcept {
+    ut_cfg_store(var, value);
+    sync_profile_enabled.store(*(const ib_bool*)value, std::memory_order_relaxed);
+    return 0;
+}
+
+/// \brief Registers the setting and the default class; called once, by sync_init()
+/// \return 0, or -1 with nothing registered
+int sync_profile_register() noexcept {
+    if (ut_cfg_register(&sync_cfg_profile_var, "sync_profile", IB_CFG_IBOOL, &sync_cfg_profile, sync_cfg_apply_profile) != 0) {
+        return -1;
+    }
+    if (sync_class_register(&sync_class_default, "default") != 0) {
+        ut_cfg_unregister(&sync_cfg_profile_var);
+        return -1;
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Classes
+// -----------------------------------------------------------------------------
+
+/// \brief Adds `c` to the classes reported by the profiler, with zeroed statistics
+/// \return 0 on success, -1 if a class with that name is already registered
+int sync_class_register(sync_class* c, const char* name) noexcept {
+    IB_ASSERT_NOT_NULL(c);
+    IB_ASSERT_NOT_NULL(name);
+    c->name = name;
+    c->sites_lock.store(false, std::memory_order_relaxed);
+    sync_class_clear(c);
+    sync_class_lock();
+    for (ut_dlink* it = sync_classes.next; it != &sync_classes; it = it->next) {
+        if (std::strcmp(sync_class_of(it)->name, name) == 0) {
+            sync_class_unlock();
+            ut_dlink_init(&c->link);
+            return -1;
+        }
+    }
+    ut_dlink_enqueue(&sync_classes, &c->link);
+    sync_class_unlock();
+    return 0;
+}
+
+/// \brief Withdraws `c`; its latches must not be used afterwards
+void sync_class_unregister(sync_class* c) noexcept {
+    sync_class_lock();
+    ut_dlink_detach(&c->link);
+    sync_class_unlock();
+}
+
+/// \brief Same as setting the `sync_profile` configuration variable
+void sync_profile_enable(bool on) noexcept {
+    const ib_bool value = on;
+    ut_cfg_set("sync_profile", &value);
+}
+
+/// \brief Zeroes the statistics of every class
+void sync_profile_reset() noexcept {
+    sync_class_lock();
+    for (ut_dlink* it = sync_classes.next; it != &sync_classes; it = it->next) {
+        sync_class* c = sync_class_of(it);
+        while (c->sites_lock.exchange(true, std::memory_order_acquire)) __builtin_ia32_pause();
+        sync_class_clear(c);
+        c->sites_lock.store(false, std::memory_order_release);
+    }
+    sync_class_unlock();
+}
+
+// -----------------------------------------------------------------------------
+// Recording
+// -----------------------------------------------------------------------------
+
+/// \brief Charges an acquisition that did not suspend
+void sync_profile_acquired(sync_class* c, ib_u32 spins) noexcept {
+    if (c == nullptr) c = &sync_class_default;
+    c->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (spins != 0) c->spins.fetch_add(spins, std::memory_order_relaxed);
+}
+
+/// \brief Charges an acquisition that suspended at `w->start_ns` and was granted at `end_ns`
+void sync_profile_waited(sync_class* c, const sync_profile_wait* w, ib_u64 end_ns) noexcept {
+    if (c == nullptr) c = &sync_class_default;
+    const ib_u64 ns = end_ns > w->start_ns ? end_ns - w->start_ns : 0;
+    c->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (w->spins != 0) c->spins.fetch_add(w->spins, std::memory_order_relaxed);
+    c->suspends.fetch_add(1, std::memory_order_relaxed);
+    c->wait_ns.fetch_add(ns, std::memory_order_relaxed);
+    ib_u64 max = c->max_wait_ns.load(std::memory_order_relaxed);
+    while (ns > max && !c->max_wait_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+
+    // Space-saving: a new site evicts the one with the least wait and inherits its count, so
+    // the heavy hitters are kept whatever the order in which the waits come
+    while (c->sites_lock.exchange(true, std::memory_order_acquire)) __builtin_ia32_pause();
+    sync_site_stats* slot = nullptr;
+    for (ib_u32 i = 0; i < c->site_count && slot == nullptr; ++i) {
+        const std::source_location& s = c->sites[i].site;
+        if (s.line() == w->holder.line() && std::strcmp(s.file_name(), w->holder.file_name()) == 0) slot = &c->sites[i];
+    }
+    if (slot == nullptr && c->site_count < SYNC_PROFILE_SITES) {
+        slot  = &c->sites[c->site_count++];
+        *slot = { w->holder, 0, 0 };
+    } else if (slot == nullptr) {
+        slot = &c->sites[0];
+        for (ib_u32 i = 1; i < SYNC_PROFILE_SITES; ++i) {
+            if (c->sites[i].wait_ns < slot->wait_ns) slot = &c->sites[i];
+        }
+        slot->site = w->holder;
+    }
+    ++slot->waits;
+    slot->wait_ns += ns;
+    c->sites_lock.store(false, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+// Reports
+// -----------------------------------------------------------------------------
+
+static void sync_profile_row_of(const sync_class* c, sync_profile_row* row) noexcept {
+    sync_class* mc = (sync_class*)c;
+    row->cls          = c;
+    row->acquisitions = c->acquisitions.load(std::memory_order_relaxed);
+    row->spins        = c->spins.load(std::memory_order_relaxed);
+    row->suspends     = c->suspends.load(std::memory_order_relaxed);
+    row->wait_ns      = c->wait_ns.load(std::memory_order_relaxed);
+    row->max_wait_ns  = c->max_wait_ns.load(std::memory_order_relaxed);
+    while (mc->sites_lock.exchange(true, std::memory_order_acquire)) __builtin_ia32_pause();
+    row->site_count = c->site_count;
+    std::memcpy(row->sites, c->sites, sizeof(row->sites));
+    mc->sites_lock.store(false, std::memory_order_release);
+    std::sort(row->sites, row->sites + row->site_count,
+              [](const sync_site_stats& a, const sync_site_stats& b) { return a.wait_ns > b.wait_ns; });
+}
+
+/// \brief Ranks `a` before `b`: longer total wait first, then more acquisitions
+static bool sync_profile_row_before(const sync_profile_row* a, const sync_profile_row* b) noexcept {
+    return a->wait_ns != b->wait_ns ? a->wait_ns > b->wait_ns : a->acquisitions > b->acquisitions;
+}
+
+/// \brief Number of registered classes, to size the rows of sync_profile_snapshot()
+ib_u32 sync_profile_class_count() noexcept {
+    ib_u32 count = 0;
+    sync_class_lock();
+    for (ut_dlink* it = sync_classes.next; it != &sync_classes; it = it->next) ++count;
+    sync_class_unlock();
+    return count;
+}
+
+/// \brief Copies the statistics of the `max` classes with the longest total wait to `rows`,
+/// longest first; classes that rank equal keep their registration order
+/// \return The number of rows filled in
+ib_u32 sync_profile_snapshot(sync_profile_row* rows, ib_u32 max) noexcept {
+    ib_u32 n = 0;
+    sync_class_lock();
+    for (ut_dlink* it = sync_classes.next; it != &sync_classes; it = it->next) {
+        sync_profile_row row;
+        sync_profile_row_of(sync_class_of(it), &row);
+        // Insertion into the ranked rows: there are tens of classes
+        ib_u32 at = n;
+        while (at > 0 && sync_profile_row_before(&row, &rows[at - 1])) --at;
+        if (at == max) continue;
+        if (n < max) ++n;
+        for (ib_u32 i = n - 1; i > at; --i) rows[i] = rows[i - 1];
+        rows[at] = row;
+    }
+    sync_class_unlock();
+    return n;
+}
+
+/// \brief Prints the classes that were used, by total wait time, with their worst holder sites
+/// \param rows Room for the snapshot of `max` classes, see sync_profile_class_count(); classes
+/// beyond the first `max` are left out
+/// \return 0 on success, -1 on a write error
+int sync_profile_print(std::FILE* out, sync_profile_row* rows, ib_u32 max) noexcept {
+    IB_ASSERT_NOT_NULL(out);
+    const ib_u32 n = sync_profile_snapshot(rows, max);
+    ut_print     p;
+    ut_print_init(&p, out);
+    ut_print_fmt(&p, "{:<24} {:>12} {:>12} {:>10} {:>14} {:>12}\n", "class", "acquisitions", "spins", "suspends", "wait_ns",
+                 "max_wait_ns");
+    for (ib_u32 c = 0; c < n; ++c) {
+        const sync_profile_row& r = rows[c];
+        if (r.acquisitions == 0) continue;
+        ut_print_fmt(&p, "{:<24} {:>12} {:>12} {:>10} {:>14} {:>12}\n", r.cls->name, r.acquisitions, r.spins, r.suspends, r.wait_ns,
+                     r.max_wait_ns);
+        for (ib_u32 i = 0; i < r.site_count && i < SYNC_PROFILE_PRINT_TOP; ++i) {
+            const sync_site_stats& s = r.sites[i];
+            ut_print_fmt(&p, "    held at {}:{} ({}) caused {} waits, {} ns\n", s.site.file_name(), s.site.line(), s.site.function_name(),
+                         s.waits, s.wait_ns);
+        }
+    }
+    return ut_print_finish(&p);
+}
@@ -0,0 +1,90 @@
+#include "sync.hpp"
+#include "sync_event.hpp"
+
+/// \brief What granting `mode` adds to the latch word
+static ib_u32 sync_rw_grant(sync_mode mode) noexcept {
+    switch (mode) {
+    case SYNC_S:  return 1;
+    case SYNC_SX: return SYNC_RW_SX;
+    default:      return SYNC_RW_X;
+    }
+}
+
+/// \brief Slow path of the sync_rw_*_lock() awaiters: queues `w` unless its mode can be granted
+/// \details Only an empty queue lets a request in, so latecomers do not overtake waiters.
+/// As for the mutex, SYNC_WAITERS is set with a compare-and-swap against the word just read.
+/// \return true if `w` was queued, false if the latch was taken
+bool sync_rw_lock_wait(sync_rw_latch* l, sync_waiter* w) noexcept {
+    sync_wait_lock_acquire(&l->wait_lock);
+    const bool queue_empty = ut_dlink_is_detached(&l->waiters);
+    ib_u32     word        = l->word.load(std::memory_order_relaxed);
+    for (;;) {
+        if (queue_empty && sync_rw_compatible(word, w->mode)) {
+            if (!l->word.compare_exchange_weak(word, word + sync_rw_grant(w->mode), std::memory_order_acquire, std::memory_order_relaxed)) {
+                continue;
+            }
+            sync_wait_lock_release(&l->wait_lock);
+            if (w->mode == SYNC_X) l->holder.store(sched_current_worker(), std::memory_order_relaxed);
+            return false;
+        }
+        if ((word & SYNC_WAITERS) != 0) break;
+        if (l->word.compare_exchange_weak(word, word | SYNC_WAITERS, std::memory_order_relaxed, std::memory_order_relaxed)) break;
+    }
+    ut_dlink_enqueue(&l->waiters, &w->link);
+    sync_wait_lock_release(&l->wait_lock);
+    return true;
+}
+
+/// \brief Called by a release that saw SYNC_WAITERS: grants the latch to the waiters the wake
+/// policy picks, then resumes them as one batch
+/// \details While SYNC_WAITERS is set, holders can only enter under the queue lock (new requests
+/// queue behind the waiters), but they may leave at any time. The word read here can therefore
+/// only show more holders than there are, so grants decided on it stay valid, at worst fewer
+/// than possible, and are applied with a single atomic add, which also clears SYNC_WAITERS when
+/// the queue runs empty. A waiter left behind by a stale read is not stranded: every later
+/// release sees SYNC_WAITERS and comes back for the lock.
+void sync_rw_unlock_wake(sync_rw_latch* l) noexcept {
+    ut_dlink granted;
+    ut_dlink_init(&granted);
+    sync_wait_lock_acquire(&l->wait_lock);
+    if (ut_dlink_is_detached(&l->waiters)) {
+        // Another release has granted everybody in the meantime
+        sync_wait_lock_release(&l->wait_lock);
+        return;
+    }
+    const ib_u32 word  = l->word.load(std::memory_order_relaxed);
+    ib_u32       delta = 0;
+    bool         head  = true;
+    for (ut_dlink* link = l->waiters.prev; link != &l->waiters;) {
+        ut_dlink*    prev = link->prev;
+        sync_waiter* w    = sync_waiter_from_link(link);
+        if (sync_rw_compatible(word + delta, w->mode) && (head || l->policy == SYNC_WAKE_FIFO || w->mode == SYNC_S)) {
+            delta += sync_rw_grant(w->mode);
+            if (w->mode == SYNC_X) l->holder.store(w->t != nullptr ? w->t->sched.worker : nullptr, std::memory_order_relaxed);
+            ut_dlink_detach(link);
+            ut_dlink_enqueue(&granted, link);
+        } else if (head || l->policy == SYNC_WAKE_FIFO) {
+            break;
+        }
+        head = false;
+        link = prev;
+    }
+    if (ut_dlink_is_detached(&l->waiters)) delta -= SYNC_WAITERS;
+    if (delta != 0) l->word.fetch_add(delta, std::memory_order_release);
+    sync_wait_lock_release(&l->wait_lock);
+
+    sync_waiters_wake(&granted);
+}
+
+/// \brief Takes `l` in `mode` from a thread that does not run tasks, spinning on its own waiter
+void sync_rw_lock_blocking(sync_rw_latch* l, sync_mode mode, std::source_location site) noexcept {
+    if (sync_rw_try_lock(l, mode)) {
+        sync_profile_hold(l->cls, &l->holder_site, site, 0);
+        return;
+    }
+    sync_profile_wait prof{};
+    sync_profile_wait_start(&prof, &l->holder_site, 0);
+    sync_waiter w{ {}, nullptr, { false }, mode };
+    if (sync_rw_lock_wait(l, &w)) sync_waiter_block(&w);
+    sync_profile_wait_end(&prof, l->cls, &l->holder_site, site);
+}
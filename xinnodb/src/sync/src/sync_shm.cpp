@@ -0,0 +1,273 @@
+#include "sync_shm.hpp"
+#include "ut_clock.hpp"
+
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+
+std::atomic<ib_u32> sync_shm_pid{ 0 };
+
+static void sync_shm_after_fork() noexcept {
+    sync_shm_pid.store((ib_u32)getpid(), std::memory_order_relaxed);
+}
+
+/// \brief Caches the pid of the process; children re-cache theirs right after fork()
+ib_u32 sync_shm_self_init() noexcept {
+    static const bool registered = pthread_atfork(nullptr, nullptr, sync_shm_after_fork) == 0;
+    (void)registered;
+    const ib_u32 pid = (ib_u32)getpid();
+    IB_ASSERT((pid & ~SYNC_SHM_PID_MASK) == 0, "pid does not fit in a shared latch word");
+    sync_shm_pid.store(pid, std::memory_order_relaxed);
+    return pid;
+}
+
+/// \brief False once the process that took a latch as `pid` has exited
+/// \param id The identity recorded next to `pid`; one that names another pid is left over from
+/// an earlier holder, and only `pid` is checked
+bool sync_shm_owner_alive(ib_u32 pid, ib_u64 id) noexcept {
+    if (pid == 0) return true;
+    if (ut_proc_pid(id) == pid) return ut_proc_alive(id);
+    return pid == sync_shm_self() || ut_proc_pid_alive(pid);
+}
+
+/// \brief Wakes up to `count` threads of any process sleeping on `word`
+void sync_shm_wake(std::atomic<ib_u32>* word, ib_u32 count) noexcept {
+    syscall(SYS_futex, (ib_u32*)word, FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+/// \brief Sleeps on `word` while it holds `expected`, for SYNC_SHM_PROBE_NS at most
+/// \return true if the wait timed out
+static bool sync_shm_sleep(std::atomic<ib_u32>* word, ib_u32 expected) noexcept {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(SYNC_SHM_PROBE_NS / 1'000'000'000);
+    ts.tv_nsec = (long)(SYNC_SHM_PROBE_NS % 1'000'000'000);
+    return syscall(SYS_futex, (ib_u32*)word, FUTEX_WAIT, expected, &ts, nullptr, 0) != 0 && errno == ETIMEDOUT;
+}
+
+// -----------------------------------------------------------------------------
+// Acquisition
+// -----------------------------------------------------------------------------
+
+/// \brief Takes `m` if it is free, or if `probe` and its owner process has died
+/// \param flags Bits to set along with the pid: SYNC_WAITERS after a futex wait, since other
+/// threads may still sleep and the next release has to wake one of them
+static bool sync_shm_mutex_acquire(sync_shm_mutex* m, ib_u32 flags, bool probe, bool* owner_died) noexcept {
+    const ib_u32 self = sync_shm_self();
+    ib_u32       word = m->word.load(std::memory_order_relaxed);
+    for (;;) {
+        const ib_u32 owner = word & SYNC_SHM_PID_MASK;
+        if (owner != 0 && (!probe || sync_shm_owner_alive(owner, m->owner_id.load(std::memory_order_relaxed)))) return false;
+        if (m->word.compare_exchange_weak(word, self | (word & SYNC_WAITERS) | flags, std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {
+            m->owner_id.store(ut_proc_self(), std::memory_order_relaxed);
+            *owner_died = owner != 0;
+            return true;
+        }
+    }
+}
+
+/// \brief Drops the S holds that the reader slots of `l` attribute to processes that have died
+/// \return The number of holds dropped
+static ib_u32 sync_shm_rw_reclaim_readers(sync_shm_rw_latch* l) noexcept {
+    ib_u32 dropped = 0;
+    for (ib_u32 i = 0; i < SYNC_SHM_READER_SLOTS; ++i) {
+        std::atomic<ib_u64>& slot = l->readers[i];
+        ib_u64               v    = slot.load(std::memory_order_relaxed);
+        const ib_u32         pid  = (ib_u32)(v >> 32);
+        ib_u64               id   = l->reader_ids[i].load(std::memory_order_relaxed);
+        if (pid == 0 || sync_shm_owner_alive(pid, id)) continue;
+        if (!slot.compare_exchange_strong(v, 0, std::memory_order_relaxed, std::memory_order_relaxed)) continue;
+        l->reader_ids[i].compare_exchange_strong(id, 0, std::memory_order_relaxed);
+        const ib_u32 holds = (ib_u32)v;
+        const ib_u32 prev  = l->word.fetch_sub(holds, std::memory_order_release);
+        IB_ASSERT((prev & SYNC_RW_READERS_MASK) >= holds, "reader slot counts more than the latch word");
+        // Like the last reader, let the sleepers in
+        if ((prev & SYNC_WAITERS) != 0 && (prev & SYNC_RW_READERS_MASK) == holds &&
+            (l->word.fetch_and(~SYNC_WAITERS, std::memory_order_relaxed) & SYNC_WAITERS) != 0) {
+            sync_shm_wake(&l->word, SYNC_SHM_WAKE_ALL);
+        }
+        dropped += holds;
+    }
+    return dropped;
+}
+
+/// \brief Takes `l` in `mode` if that is compatible with the holders, counting holders whose
+/// process has died as gone when `probe` is set
+static bool sync_shm_rw_acquire(sync_shm_rw_latch* l, sync_mode mode, bool probe, bool* owner_died) noexcept {
+    const ib_u32 grant = mode == SYNC_S ? 1 : mode == SYNC_SX ? SYNC_RW_SX : SYNC_RW_X;
+    ib_u32       word  = l->word.load(std::memory_order_relaxed);
+    for (;;) {
+        ib_u32 held    = word;
+        ib_u64 dead_sx = 0;
+        ib_u64 dead_x  = 0;
+        if (probe && !sync_rw_compatible(held, mode)) {
+            if ((held & SYNC_RW_READERS_MASK) != 0 && sync_shm_rw_reclaim_readers(l) != 0) {
+                word = l->word.load(std::memory_order_relaxed);
+                continue;
+            }
+            const ib_u64 sx = l->sx_owner.load(std::memory_order_relaxed);
+            const ib_u64 x  = l->x_owner.load(std::memory_order_relaxed);
+            if ((held & SYNC_RW_SX) != 0 && sx != 0 && !sync_shm_owner_alive(ut_proc_pid(sx), sx)) {
+                held &= ~SYNC_RW_SX;
+                dead_sx = sx;
+            }
+            if ((held & SYNC_RW_X) != 0 && x != 0 && !sync_shm_owner_alive(ut_proc_pid(x), x)) {
+                held &= ~SYNC_RW_X;
+                dead_x = x;
+            }
+        }
+        if (!sync_rw_compatible(held, mode)) return false;
+        if (!l->word.compare_exchange_weak(word, held + grant, std::memory_order_acquire, std::memory_order_relaxed)) continue;
+        if (mode == SYNC_S) sync_shm_rw_reader_add(l);
+        // A dead holder's identity is replaced by ours, or cleared if we do not take its mode
+        if (dead_sx != 0) l->sx_owner.compare_exchange_strong(dead_sx, 0, std::memory_order_relaxed);
+        if (dead_x != 0) l->x_owner.compare_exchange_strong(dead_x, 0, std::memory_order_relaxed);
+        if (mode == SYNC_SX) l->sx_owner.store(ut_proc_self(), std::memory_order_relaxed);
+        if (mode == SYNC_X) l->x_owner.store(ut_proc_self(), std::memory_order_relaxed);
+        *owner_died = dead_sx != 0 || dead_x != 0;
+        return true;
+    }
+}
+
+/// \brief One attempt at the latch of `w`, without waiting
+/// \param probe Check whether the exclusive holder is still alive, and take the latch over if not
+bool sync_shm_acquire(sync_shm_waiter* w, bool probe) noexcept {
+    if (w->kind == SYNC_SHM_MUTEX) return sync_shm_mutex_acquire((sync_shm_mutex*)w->latch, 0, probe, &w->owner_died);
+    return sync_shm_rw_acquire((sync_shm_rw_latch*)w->latch, w->mode, probe, &w->owner_died);
+}
+
+/// \brief Fast path and bounded spin shared by the awaiter and the blocking calls
+static bool sync_shm_spin(sync_shm_waiter* w) noexcept {
+    if (sync_shm_acquire(w, false)) return true;
+    const ib_u32 rounds = sync_spin_rounds();
+    for (ib_u32 r = 0; r < rounds; ++r) {
+        for (ib_u32 i = 0; i < SYNC_SPIN_PAUSES; ++i) __builtin_ia32_pause();
+        if (sync_shm_acquire(w, false)) return true;
+    }
+    return false;
+}
+
+/// \brief Takes `m` from a thread, sleeping on the futex while another process holds it
+/// \return true if `m` was taken over from a dead owner
+bool sync_shm_mutex_lock_blocking(sync_shm_mutex* m) noexcept {
+    sync_shm_waiter w{ {}, nullptr, m, 0, SYNC_SHM_MUTEX, SYNC_X, false };
+    if (sync_shm_spin(&w)) return w.owner_died;
+    bool slept = false;
+    bool probe = false;
+    for (;;) {
+        if (sync_shm_mutex_acquire(m, slept ? SYNC_WAITERS : 0, probe, &w.owner_died)) return w.owner_died;
+        ib_u32 word = m->word.load(std::memory_order_relaxed);
+        if ((word & SYNC_SHM_PID_MASK) == 0) continue;
+        if ((word & SYNC_WAITERS) == 0 &&
+            !m->word.compare_exchange_strong(word, word | SYNC_WAITERS, std::memory_order_relaxed, std::memory_order_relaxed)) {
+            continue;
+        }
+        probe = sync_shm_sleep(&m->word, word | SYNC_WAITERS);
+        slept = true;
+    }
+}
+
+/// \brief Takes `l` in `mode` from a thread, sleeping on the futex while the holders are
+/// incompatible
+/// \return true if `l` was taken over from a dead SX or X holder
+bool sync_shm_rw_lock_blocking(sync_shm_rw_latch* l, sync_mode mode) noexcept {
+    sync_shm_waiter w{ {}, nullptr, l, 0, SYNC_SHM_RW, mode, false };
+    if (sync_shm_spin(&w)) return w.owner_died;
+    bool probe = false;
+    for (;;) {
+        if (sync_shm_rw_acquire(l, mode, probe, &w.owner_died)) return w.owner_died;
+        ib_u32 word = l->word.load(std::memory_order_relaxed);
+        if (sync_rw_compatible(word, mode)) continue;
+        if ((word & SYNC_WAITERS) == 0 &&
+            !l->word.compare_exchange_strong(word, word | SYNC_WAITERS, std::memory_order_relaxed, std::memory_order_relaxed)) {
+            continue;
+        }
+        probe = sync_shm_sleep(&l->word, word | SYNC_WAITERS);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Tasks
+// -----------------------------------------------------------------------------
+
+/// \brief Retries the latches of the parked tasks, oldest first, and resumes those that got theirs
+/// \details Rounds that get no latch double the delay before the next one, up to
+/// SYNC_SHM_RETRY_MAX_NS; a round that gets one starts over from SYNC_SHM_RETRY_MIN_NS.
+static ib_u64 sync_shm_poll(sched_worker*, void* ctx) noexcept {
+    sync_shm_worker* sw = (sync_shm_worker*)ctx;
+    if (ut_dlink_is_detached(&sw->waiters)) return 0;
+    const ib_u64 now = ut_clock_ns(UT_CLOCK_MONOTONIC);
+    if (now < sw->retry_ns) return 0;
+    ib_u64 resumed = 0;
+    for (ut_dlink* link = sw->waiters.prev; link != &sw->waiters;) {
+        ut_dlink*        prev  = link->prev;
+        sync_shm_waiter* w     = (sync_shm_waiter*)((char*)link - IB_OFFSET_OF(sync_shm_waiter, link));
+        const bool       probe = now >= w->probe_ns;
+        if (probe) w->probe_ns = now + SYNC_SHM_PROBE_NS;
+        ++sw->polls;
+        if (sync_shm_acquire(w, probe)) {
+            if (w->owner_died) ++sw->recovered;
+            ut_dlink_detach(link);
+            sched_resume(&w->t->sched);
+            ++resumed;
+        }
+        link = prev;
+    }
+    sw->retry_delay_ns = resumed != 0 ? SYNC_SHM_RETRY_MIN_NS : std::min(sw->retry_delay_ns * 2, SYNC_SHM_RETRY_MAX_NS);
+    sw->retry_ns       = now + sw->retry_delay_ns;
+    return resumed;
+}
+
+/// \brief Lets the tasks of `w` wait for cross-process latches without blocking the worker;
+/// call on the thread that owns `w` before it runs tasks
+/// \details A worker without it blocks on the futex when one of its tasks has to wait.
+int sync_shm_worker_init(sync_shm_worker* sw, sched_worker* w) noexcept {
+    IB_ASSERT_NOT_NULL(sw);
+    IB_ASSERT_NOT_NULL(w);
+    sw->sched          = w;
+    sw->retry_ns       = 0;
+    sw->retry_delay_ns = SYNC_SHM_RETRY_MIN_NS;
+    sw->parked_total   = 0;
+    sw->polls          = 0;
+    sw->recovered      = 0;
+    ut_dlink_init(&sw->waiters);
+    sched_poller_register(w, &sw->poller, sync_shm_poll, sw);
+    w->ext[SCHED_EXT_SYNC] = sw;
+    return 0;
+}
+
+/// \brief Detaches `sw` from its worker; no task may still wait on it
+void sync_shm_worker_detach(sync_shm_worker* sw) noexcept {
+    IB_ASSERT(ut_dlink_is_detached(&sw->waiters), "tasks still wait for shared latches");
+    sched_poller_unregister(&sw->poller);
+    sw->sched->ext[SCHED_EXT_SYNC] = nullptr;
+}
+
+bool sync_shm_awaiter::await_ready() noexcept {
+    return sync_shm_spin(&w);
+}
+
+bool sync_shm_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    task*            t  = task_current();
+    sync_shm_worker* sw = t != nullptr ? (sync_shm_worker*)t->sched.worker->ext[SCHED_EXT_SYNC] : nullptr;
+    if (sw == nullptr) {
+        w.owner_died = w.kind == SYNC_SHM_MUTEX ? sync_shm_mutex_lock_blocking((sync_shm_mutex*)w.latch)
+                                                : sync_shm_rw_lock_blocking((sync_shm_rw_latch*)w.latch, w.mode);
+        return false;
+    }
+    const ib_u64 now = ut_clock_ns(UT_CLOCK_MONOTONIC);
+    w.t              = t;
+    w.probe_ns       = now + SYNC_SHM_PROBE_NS;
+    task_park(t, h, SCHED_SUSPEND_LATCH);
+    ut_dlink_enqueue(&sw->waiters, &w.link);
+    ++sw->parked_total;
+    // The newcomer has just spun: start the rounds over, after the shortest delay
+    sw->retry_delay_ns = SYNC_SHM_RETRY_MIN_NS;
+    sw->retry_ns       = now + SYNC_SHM_RETRY_MIN_NS;
+    return true;
+}
@@ -0,0 +1,275 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "sync_event.hpp" // IWYU pragma: keep
+#include "task.hpp"       // IWYU pragma: keep
+#include "task_test.hpp"  // IWYU pragma: keep
+
+namespace {
+
+struct SyncEventFixture : ::testing::Test, task_test_env {
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+    }
+
+    void TearDown() override {
+        task_test_env_destroy(this);
+    }
+};
+
+/// \brief Runs the worker until every task is done or suspended (its task_worker poller keeps sched_run() going)
+void settle(sched_worker* w) {
+    while (sched_run_once(w) != 0 || !sched_ready_empty(w) || w->inbox.load() != nullptr) {
+    }
+}
+
+ib_async<void> await_event(sync_event* e, std::vector<int>* order, int id) {
+    co_await sync_event_wait(e);
+    order->push_back(id);
+}
+
+ib_async<void> set_after(sync_event* e, std::vector<int>* order, int yields) {
+    for (int i = 0; i < yields; ++i) co_await task_yield();
+    order->push_back(-1);
+    sync_event_set(e);
+}
+
+ib_async<void> limited(sync_semaphore* s, int* inside, int* peak, int yields) {
+    co_await sync_semaphore_acquire(s);
+    *peak = std::max(*peak, ++*inside);
+    for (int i = 0; i < yields; ++i) co_await task_yield();
+    --*inside;
+    sync_semaphore_release(s);
+}
+
+ib_async<void> piece(sync_countdown* c, int* done, int yields) {
+    for (int i = 0; i < yields; ++i) co_await task_yield();
+    ++*done;
+    sync_countdown_count_down(c);
+}
+
+ib_async<void> coordinator(sync_countdown* c, const int* done, int* seen) {
+    co_await sync_countdown_wait(c);
+    *seen = *done;
+}
+
+ib_async<void> party(sync_barrier* b, int id, int phases, std::vector<int>* log, int* lasts) {
+    for (int p = 0; p < phases; ++p) {
+        for (int i = 0; i < id; ++i) co_await task_yield();
+        log->push_back(p);
+        if (co_await sync_barrier_arrive_and_wait(b)) ++*lasts;
+    }
+}
+
+} // namespace
+
+TEST_F(SyncEventFixture, ManualResetWakesEveryWaiterInArrivalOrder) {
+    sync_event       e;
+    std::vector<int> order;
+    sync_event_init(&e, SYNC_EVENT_MANUAL_RESET);
+    for (int id = 0; id < 4; ++id) ASSERT_EQ(task_spawn(&worker, await_event(&e, &order, id)), 0);
+    ASSERT_EQ(task_spawn(&worker, set_after(&e, &order, 2)), 0);
+    settle(&worker);
+
+    EXPECT_EQ(order, (std::vector<int>{ -1, 0, 1, 2, 3 }));
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_EVENT], 4u);
+    EXPECT_EQ(worker.suspended_tasks, 0);
+    EXPECT_TRUE(sync_event_is_set(&e));
+
+    // Stays set: later waiters go through; a reset makes them wait again
+    ASSERT_EQ(task_spawn(&worker, await_event(&e, &order, 4)), 0);
+    settle(&worker);
+    EXPECT_EQ(order.back(), 4);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_EVENT], 4u);
+    sync_event_reset(&e);
+    ASSERT_EQ(task_spawn(&worker, await_event(&e, &order, 5)), 0);
+    settle(&worker);
+    EXPECT_EQ(worker.suspended_tasks, 1);
+    sync_event_set(&e);
+    settle(&worker);
+    EXPECT_EQ(order.back(), 5);
+    EXPECT_EQ(worker.live_tasks, 0);
+}
+
+TEST_F(SyncEventFixture, AutoResetReleasesOneWaiterPerSet) {
+    sync_event       e;
+    std::vector<int> order;
+    sync_event_init(&e, SYNC_EVENT_AUTO_RESET);
+    for (int id = 0; id < 3; ++id) ASSERT_EQ(task_spawn(&worker, await_event(&e, &order, id)), 0);
+    settle(&worker);
+    EXPECT_EQ(worker.suspended_tasks, 3);
+
+    sync_event_set(&e);
+    settle(&worker);
+    EXPECT_EQ(order, (std::vector<int>{ 0 }));
+    EXPECT_FALSE(sync_event_is_set(&e));
+    sync_event_set(&e);
+    sync_event_set(&e);
+    settle(&worker);
+    EXPECT_EQ(order, (std::vector<int>{ 0, 1, 2 }));
+
+    // Nobody waits: the set is kept for the next waiter only
+    sync_event_set(&e);
+    EXPECT_TRUE(sync_event_is_set(&e));
+    ASSERT_EQ(task_spawn(&worker, await_event(&e, &order, 3)), 0);
+    ASSERT_EQ(task_spawn(&worker, await_event(&e, &order, 4)), 0);
+    settle(&worker);
+    EXPECT_EQ(order.back(), 3);
+    EXPECT_EQ(worker.suspended_tasks, 1);
+    sync_event_set(&e);
+    settle(&worker);
+    EXPECT_EQ(order.back(), 4);
+    EXPECT_EQ(worker.live_tasks, 0);
+}
+
+TEST_F(SyncEventFixture, SemaphoreBoundsConcurrency) {
+    sync_semaphore s;
+    int            inside = 0;
+    int            peak   = 0;
+    sync_semaphore_init(&s, 2);
+    for (int i = 0; i < 6; ++i) ASSERT_EQ(task_spawn(&worker, limited(&s, &inside, &peak, 3)), 0);
+    settle(&worker);
+
+    EXPECT_EQ(peak, 2);
+    EXPECT_EQ(inside, 0);
+    EXPECT_EQ(sync_semaphore_available(&s), 2u);
+    EXPECT_EQ(s.waiting.load(), 0u);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_EVENT], 4u);
+    EXPECT_EQ(worker.live_tasks, 0);
+}
+
+TEST_F(SyncEventFixture, SemaphoreReleaseOfManyPermitsWakesThatManyWaiters) {
+    sync_semaphore s;
+    int            inside = 0;
+    int            peak   = 0;
+    sync_semaphore_init(&s, 0);
+    for (int i = 0; i < 5; ++i) ASSERT_EQ(task_spawn(&worker, limited(&s, &inside, &peak, 1)), 0);
+    settle(&worker);
+    EXPECT_EQ(s.waiting.load(), 5u);
+
+    sync_semaphore_release(&s, 3);
+    EXPECT_EQ(s.waiting.load(), 2u);
+    EXPECT_EQ(sync_semaphore_available(&s), 0u);
+    settle(&worker);
+    EXPECT_EQ(peak, 3);
+    EXPECT_EQ(worker.live_tasks, 0);
+    EXPECT_EQ(sync_semaphore_available(&s), 3u);
+}
+
+TEST_F(SyncEventFixture, CountdownOpensWhenAllPiecesAreDone) {
+    sync_countdown c;
+    int            done = 0;
+    int            seen = -1;
+    sync_countdown_init(&c, 4);
+    ASSERT_EQ(task_spawn(&worker, coordinator(&c, &done, &seen)), 0);
+    for (int i = 0; i < 4; ++i) ASSERT_EQ(task_spawn(&worker, piece(&c, &done, i + 1)), 0);
+    settle(&worker);
+
+    EXPECT_EQ(seen, 4);
+    EXPECT_TRUE(sync_countdown_try_wait(&c));
+    int late = -1;
+    ASSERT_EQ(task_spawn(&worker, coordinator(&c, &done, &late)), 0);
+    settle(&worker);
+    EXPECT_EQ(late, 4);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_EVENT], 1u);
+}
+
+TEST_F(SyncEventFixture, BarrierPhasesDoNotOverlap) {
+    constexpr int    PARTIES = 3;
+    constexpr int    PHASES  = 4;
+    sync_barrier     b;
+    std::vector<int> log;
+    int              lasts = 0;
+    sync_barrier_init(&b, PARTIES);
+    for (int id = 0; id < PARTIES; ++id) ASSERT_EQ(task_spawn(&worker, party(&b, id, PHASES, &log, &lasts)), 0);
+    settle(&worker);
+
+    ASSERT_EQ(log.size(), (ib_size)PARTIES * PHASES);
+    for (ib_size i = 0; i < log.size(); ++i) EXPECT_EQ(log[i], (int)(i / PARTIES));
+    EXPECT_EQ(lasts, PHASES);
+    EXPECT_EQ(b.phase, (ib_u64)PHASES);
+    EXPECT_EQ(b.arrived, 0u);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_EVENT], (ib_u64)(PARTIES - 1) * PHASES);
+    EXPECT_EQ(worker.live_tasks, 0);
+}
+
+TEST_F(SyncEventFixture, ThreadsAndTasksCoordinate) {
+    sync_countdown c;
+    sync_barrier   b;
+    sync_event     e;
+    int            done  = 0;
+    int            seen  = -1;
+    int            lasts = 0;
+    sync_countdown_init(&c, 2);
+    sync_barrier_init(&b, 2);
+    sync_event_init(&e, SYNC_EVENT_MANUAL_RESET);
+    std::vector<int> log;
+    std::vector<int> order;
+    ASSERT_EQ(task_spawn(&worker, coordinator(&c, &done, &seen)), 0);
+    ASSERT_EQ(task_spawn(&worker, party(&b, 0, 1, &log, &lasts)), 0);
+    ASSERT_EQ(task_spawn(&worker, await_event(&e, &order, 0)), 0);
+    settle(&worker);
+    EXPECT_EQ(worker.suspended_tasks, 3);
+
+    bool thread_last = false;
+    std::thread thread([&] {
+        done = 2;
+        sync_countdown_count_down(&c, 2);
+        thread_last = sync_barrier_arrive_and_wait_blocking(&b);
+        sync_event_set(&e);
+        sync_event_wait_blocking(&e);
+        sync_countdown_wait_blocking(&c);
+    });
+    while (worker.live_tasks != 0) sched_run_once(&worker);
+    thread.join();
+
+    EXPECT_EQ(seen, 2);
+    EXPECT_TRUE(thread_last);
+    EXPECT_EQ(lasts, 0);
+    EXPECT_EQ(order, (std::vector<int>{ 0 }));
+    EXPECT_EQ(worker.remote_resumes, 3u);
+    EXPECT_EQ(worker.suspended_tasks, 0);
+}
+
+TEST_F(SyncEventFixture, SemaphoreSharedByTasksAndAThread) {
+    constexpr int  TASKS = 4;
+    constexpr int  ITERS = 200;
+    sync_semaphore s;
+    int            inside = 0;
+    int            peak   = 0;
+    sync_semaphore_init(&s, 1);
+    std::atomic<int> thread_inside{ 0 };
+    for (int i = 0; i < TASKS; ++i) {
+        ASSERT_EQ(task_spawn(&worker, [](sync_semaphore* s, int* inside, int* peak, std::atomic<int>* other) -> ib_async<void> {
+                      for (int n = 0; n < ITERS; ++n) {
+                          co_await sync_semaphore_acquire(s);
+                          if (other->load() != 0) ++*peak;
+                          ++*inside;
+                          if (n % 8 == 0) co_await task_yield();
+                          --*inside;
+                          sync_semaphore_release(s);
+                      }
+                  }(&s, &inside, &peak, &thread_inside)),
+                  0);
+    }
+    int thread_overlaps = 0;
+    std::thread thread([&] {
+        for (int n = 0; n < ITERS; ++n) {
+            sync_semaphore_acquire_blocking(&s);
+            thread_inside.store(1);
+            if (inside != 0) ++thread_overlaps;
+            thread_inside.store(0);
+            sync_semaphore_release(&s);
+        }
+    });
+    while (worker.live_tasks != 0) sched_run_once(&worker);
+    thread.join();
+
+    EXPECT_EQ(peak, 0);
+    EXPECT_EQ(thread_overlaps, 0);
+    EXPECT_EQ(sync_semaphore_available(&s), 1u);
+    EXPECT_EQ(s.waiting.load(), 0u);
+}
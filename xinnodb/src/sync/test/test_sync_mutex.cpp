@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "sync.hpp"      // IWYU pragma: keep
+#include "task.hpp"      // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+#include "ut_cfg.hpp"    // IWYU pragma: keep
+
+namespace {
+
+struct SyncMutexFixture : ::testing::Test, task_test_env {
+    sync_mutex m;
+
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+        sync_mutex_init(&m);
+    }
+
+    void TearDown() override {
+        task_test_env_destroy(this);
+    }
+};
+
+ib_async<void> hold(sync_mutex* m, std::vector<int>* order, int id, int yields) {
+    co_await sync_mutex_lock(m);
+    order->push_back(id);
+    for (int i = 0; i < yields; ++i) co_await task_yield();
+    sync_mutex_unlock(m);
+}
+
+ib_async<void> bystander(int* steps, int n) {
+    for (int i = 0; i < n; ++i) {
+        ++*steps;
+        co_await task_yield();
+    }
+}
+
+ib_async<void> add(sync_mutex* m, ib_u64* counter, int n) {
+    for (int i = 0; i < n; ++i) {
+        co_await sync_mutex_lock(m);
+        const ib_u64 seen = *counter;
+        if (i % 4 == 0) co_await task_yield();
+        *counter = seen + 1;
+        sync_mutex_unlock(m);
+    }
+}
+
+} // namespace
+
+TEST(SyncMutex, SpinRoundsAreSetThroughTheConfiguration) {
+    ASSERT_EQ(sync_init(), 0);
+    EXPECT_EQ(sync_init(), 0);
+    EXPECT_EQ(sync_spin_rounds(), SYNC_SPIN_ROUNDS_DEFAULT);
+
+    const ib_ulint rounds = 5, too_many = 1'000'000;
+    ASSERT_EQ(ut_cfg_set("sync_spin_rounds", &rounds), 0);
+    EXPECT_EQ(sync_spin_rounds(), 5u);
+    EXPECT_EQ(ut_cfg_set("sync_spin_rounds", &too_many), -2);
+    const ib_ulint restore = SYNC_SPIN_ROUNDS_DEFAULT;
+    ASSERT_EQ(ut_cfg_set("sync_spin_rounds", &restore), 0);
+}
+
+TEST_F(SyncMutexFixture, TryLockIsExclusive) {
+    ASSERT_TRUE(sync_mutex_try_lock(&m));
+    EXPECT_TRUE(sync_mutex_is_locked(&m));
+    EXPECT_FALSE(sync_mutex_try_lock(&m));
+    sync_mutex_unlock(&m);
+    EXPECT_FALSE(sync_mutex_is_locked(&m));
+    sync_mutex_lock_blocking(&m);
+    EXPECT_TRUE(sync_mutex_is_locked(&m));
+    sync_mutex_unlock(&m);
+    EXPECT_EQ(m.word.load(), 0u);
+}
+
+TEST_F(SyncMutexFixture, WaitersAreGrantedInArrivalOrderWithoutBlockingTheWorker) {
+    std::vector<int> order;
+    int              steps = 0;
+    ASSERT_EQ(task_spawn(&worker, hold(&m, &order, 0, 8)), 0);
+    for (int id = 1; id <= 3; ++id) ASSERT_EQ(task_spawn(&worker, hold(&m, &order, id, 1)), 0);
+    ASSERT_EQ(task_spawn(&worker, bystander(&steps, 8)), 0);
+    sched_run(&worker);
+
+    EXPECT_EQ(order, (std::vector<int>{ 0, 1, 2, 3 }));
+    EXPECT_EQ(steps, 8);   // ran while the mutex was held
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_LATCH], 3u);
+    EXPECT_EQ(worker.suspended_tasks, 0u);
+    EXPECT_FALSE(sync_mutex_is_locked(&m));
+    EXPECT_TRUE(ut_dlink_is_detached(&m.waiters));
+}
+
+TEST_F(SyncMutexFixture, TasksAndAThreadShareTheMutex) {
+    constexpr int TASKS = 4;
+    constexpr int ITERS = 2000;
+    ib_u64        counter = 0;
+    for (int i = 0; i < TASKS; ++i) ASSERT_EQ(task_spawn(&worker, add(&m, &counter, ITERS)), 0);
+    std::thread thread([&] {
+        for (int i = 0; i < ITERS; ++i) {
+            sync_mutex_lock_blocking(&m);
+            ++counter;
+            sync_mutex_unlock(&m);
+        }
+    });
+    while (worker.live_tasks != 0) sched_run_once(&worker);
+    thread.join();
+
+    EXPECT_EQ(counter, (ib_u64)(TASKS + 1) * ITERS);
+    EXPECT_FALSE(sync_mutex_is_locked(&m));
+    EXPECT_EQ(worker.suspended_tasks, 0u);
+}
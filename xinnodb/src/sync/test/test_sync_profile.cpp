@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "sync.hpp"      // IWYU pragma: keep
+#include "task.hpp"      // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+#include "ut_cfg.hpp"    // IWYU pragma: keep
+
+namespace {
+
+struct SyncProfileFixture : ::testing::Test, task_test_env {
+    sync_class    hot;
+    sync_class    cold;
+    sync_mutex    hot_mutex;
+    sync_rw_latch cold_latch;
+
+    void SetUp() override {
+        ASSERT_EQ(sync_init(), 0);
+        ASSERT_EQ(task_test_env_init(this), 0);
+        ASSERT_EQ(sync_class_register(&hot, "test.sync.hot"), 0);
+        ASSERT_EQ(sync_class_register(&cold, "test.sync.cold"), 0);
+        sync_mutex_init(&hot_mutex, &hot);
+        sync_rw_init(&cold_latch, SYNC_WAKE_FIFO, &cold);
+    }
+
+    void TearDown() override {
+        sync_profile_enable(false);
+        sync_class_unregister(&cold);
+        sync_class_unregister(&hot);
+        task_test_env_destroy(this);
+    }
+
+    const sync_profile_row* find(const sync_profile_row* rows, ib_u32 n, const sync_class* c) {
+        for (ib_u32 i = 0; i < n; ++i) {
+            if (rows[i].cls == c) return &rows[i];
+        }
+        return nullptr;
+    }
+};
+
+ib_async<void> hold(sync_mutex* m, int yields) {
+    co_await sync_mutex_lock(m);
+    for (int i = 0; i < yields; ++i) co_await task_yield();
+    sync_mutex_unlock(m);
+}
+
+ib_async<void> read(sync_rw_latch* l, int n) {
+    for (int i = 0; i < n; ++i) {
+        co_await sync_rw_s_lock(l);
+        sync_rw_s_unlock(l);
+    }
+}
+
+void run_workload(sched_worker* w, sync_mutex* m, sync_rw_latch* l) {
+    for (int i = 0; i < 4; ++i) ASSERT_EQ(task_spawn(w, hold(m, 3)), 0);
+    ASSERT_EQ(task_spawn(w, read(l, 10)), 0);
+    sched_run(w);
+}
+
+} // namespace
+
+TEST_F(SyncProfileFixture, NothingIsRecordedWhileOff) {
+    run_workload(&worker, &hot_mutex, &cold_latch);
+    EXPECT_EQ(hot.acquisitions.load(), 0u);
+    EXPECT_EQ(cold.acquisitions.load(), 0u);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_LATCH], 3u);
+}
+
+TEST_F(SyncProfileFixture, ClassesAreRankedByWaitWithTheHolderSite) {
+    const ib_bool on = true;
+    ASSERT_EQ(ut_cfg_set("sync_profile", &on), 0);
+    ASSERT_TRUE(sync_profile_on());
+    run_workload(&worker, &hot_mutex, &cold_latch);
+
+    EXPECT_EQ(hot.acquisitions.load(), 4u);
+    EXPECT_EQ(hot.suspends.load(), 3u);
+    EXPECT_GT(hot.wait_ns.load(), 0u);
+    EXPECT_GE(hot.wait_ns.load(), hot.max_wait_ns.load());
+    EXPECT_EQ(cold.acquisitions.load(), 10u);
+    EXPECT_EQ(cold.suspends.load(), 0u);
+
+    sync_profile_row rows[16];
+    const ib_u32     n  = sync_profile_snapshot(rows, 16);
+    const auto*      rh = find(rows, n, &hot);
+    const auto*      rc = find(rows, n, &cold);
+    ASSERT_NE(rh, nullptr);
+    ASSERT_NE(rc, nullptr);
+    EXPECT_LT(rh, rc);
+    for (ib_u32 i = 1; i < n; ++i) EXPECT_GE(rows[i - 1].wait_ns, rows[i].wait_ns);
+    ASSERT_EQ(rh->site_count, 1u);   // every waiter found a holder locked in hold()
+    EXPECT_EQ(rh->sites[0].waits, 3u);
+    EXPECT_NE(std::strstr(rh->sites[0].site.file_name(), "test_sync_profile.cpp"), nullptr);
+    EXPECT_NE(std::strstr(rh->sites[0].site.function_name(), "hold"), nullptr);
+
+    EXPECT_EQ(n, sync_profile_class_count());
+    std::FILE* out = std::tmpfile();
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(sync_profile_print(out, rows, 16), 0);
+    std::rewind(out);
+    std::string text(4096, '\0');
+    text.resize(std::fread(text.data(), 1, text.size(), out));
+    std::fclose(out);
+    EXPECT_NE(text.find("test.sync.hot"), std::string::npos);
+    EXPECT_NE(text.find("held at"), std::string::npos);
+    EXPECT_LT(text.find("test.sync.hot"), text.find("test.sync.cold"));
+
+    sync_profile_reset();
+    EXPECT_EQ(hot.acquisitions.load(), 0u);
+    EXPECT_EQ(hot.site_count, 0u);
+}
+
+TEST_F(SyncProfileFixture, SnapshotKeepsTheLongestWaits) {
+    hot.wait_ns.store(300);
+    cold.wait_ns.store(200);
+    sync_profile_row rows[1];
+    ASSERT_EQ(sync_profile_snapshot(rows, 1), 1u);
+    EXPECT_EQ(rows[0].cls, &hot);
+    ASSERT_EQ(sync_profile_snapshot(rows, 0), 0u);
+}
+
+TEST_F(SyncProfileFixture, PrintReturnsAWriteError) {
+    hot.acquisitions.store(1);
+    std::FILE* full = std::fopen("/dev/full", "w");
+    if (full == nullptr) GTEST_SKIP() << "no /dev/full";
+    std::setvbuf(full, nullptr, _IONBF, 0);
+    sync_profile_row rows[16];
+    EXPECT_EQ(sync_profile_print(full, rows, 16), -1);
+    std::fclose(full);
+}
+
+TEST_F(SyncProfileFixture, ClassNamesAreUnique) {
+    sync_class dup;
+    EXPECT_EQ(sync_class_register(&dup, "test.sync.hot"), -1);
+    sync_class_unregister(&dup);
+}
+
+TEST_F(SyncProfileFixture, InitRegistersTheSettingAndTheDefaultClass) {
+    EXPECT_EQ(sync_init(), 0);
+    ib_cfg_type type;
+    ASSERT_EQ(ut_cfg_type_of("sync_profile", &type), 0);
+    EXPECT_EQ(type, IB_CFG_IBOOL);
+
+    sync_class dup;
+    EXPECT_EQ(sync_class_register(&dup, "default"), -1);
+    sync_class_unregister(&dup);
+}
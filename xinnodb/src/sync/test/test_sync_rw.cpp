@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "sync.hpp"      // IWYU pragma: keep
+#include "task.hpp"      // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+
+namespace {
+
+struct SyncRwFixture : ::testing::Test, task_test_env {
+    sync_rw_latch l;
+
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+    }
+
+    void TearDown() override {
+        task_test_env_destroy(this);
+    }
+};
+
+struct Log {
+    std::vector<int> order;
+    int              max_readers = 0;
+};
+
+ib_async<void> hold(sync_rw_latch* l, sync_mode mode, Log* log, int id, int yields) {
+    switch (mode) {
+    case SYNC_S:  co_await sync_rw_s_lock(l); break;
+    case SYNC_SX: co_await sync_rw_sx_lock(l); break;
+    default:      co_await sync_rw_x_lock(l); break;
+    }
+    log->order.push_back(id);
+    if ((int)sync_rw_readers(l) > log->max_readers) log->max_readers = (int)sync_rw_readers(l);
+    for (int i = 0; i < yields; ++i) co_await task_yield();
+    switch (mode) {
+    case SYNC_S:  sync_rw_s_unlock(l); break;
+    case SYNC_SX: sync_rw_sx_unlock(l); break;
+    default:      sync_rw_x_unlock(l); break;
+    }
+}
+
+/// X holder, then S, S, X, S queued behind it
+void queue_behind_writer(sched_worker* w, sync_rw_latch* l, Log* log) {
+    ASSERT_EQ(task_spawn(w, hold(l, SYNC_X, log, 0, 6)), 0);
+    ASSERT_EQ(task_spawn(w, hold(l, SYNC_S, log, 1, 2)), 0);
+    ASSERT_EQ(task_spawn(w, hold(l, SYNC_S, log, 2, 2)), 0);
+    ASSERT_EQ(task_spawn(w, hold(l, SYNC_X, log, 3, 2)), 0);
+    ASSERT_EQ(task_spawn(w, hold(l, SYNC_S, log, 4, 2)), 0);
+    sched_run(w);
+}
+
+struct Pair {
+    ib_u64 a = 0;
+    ib_u64 b = 0;
+    bool   torn = false;
+};
+
+ib_async<void> writer(sync_rw_latch* l, Pair* p, int n) {
+    for (int i = 0; i < n; ++i) {
+        co_await sync_rw_x_lock(l);
+        ++p->a;
+        co_await task_yield();
+        ++p->b;
+        sync_rw_x_unlock(l);
+    }
+}
+
+ib_async<void> reader(sync_rw_latch* l, Pair* p, sync_mode mode, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (mode == SYNC_S) {
+            co_await sync_rw_s_lock(l);
+        } else {
+            co_await sync_rw_sx_lock(l);
+        }
+        const ib_u64 a = p->a;
+        co_await task_yield();
+        if (p->a != a || p->b != a) p->torn = true;
+        if (mode == SYNC_S) {
+            sync_rw_s_unlock(l);
+        } else {
+            sync_rw_sx_unlock(l);
+        }
+    }
+}
+
+} // namespace
+
+TEST_F(SyncRwFixture, ModesFollowTheCompatibilityMatrix) {
+    sync_rw_init(&l);
+    ASSERT_TRUE(sync_rw_try_lock(&l, SYNC_S));
+    EXPECT_TRUE(sync_rw_try_lock(&l, SYNC_S));
+    EXPECT_TRUE(sync_rw_try_lock(&l, SYNC_SX));
+    EXPECT_FALSE(sync_rw_try_lock(&l, SYNC_SX));
+    EXPECT_FALSE(sync_rw_try_lock(&l, SYNC_X));
+    EXPECT_EQ(sync_rw_readers(&l), 2u);
+    sync_rw_s_unlock(&l);
+    sync_rw_s_unlock(&l);
+    EXPECT_FALSE(sync_rw_try_lock(&l, SYNC_X));
+    EXPECT_TRUE(sync_rw_try_lock(&l, SYNC_S));
+    sync_rw_s_unlock(&l);
+    sync_rw_sx_unlock(&l);
+    ASSERT_TRUE(sync_rw_try_lock(&l, SYNC_X));
+    EXPECT_FALSE(sync_rw_try_lock(&l, SYNC_S));
+    EXPECT_FALSE(sync_rw_try_lock(&l, SYNC_SX));
+    sync_rw_x_unlock(&l);
+    EXPECT_EQ(l.word.load(), 0u);
+}
+
+TEST_F(SyncRwFixture, FifoPolicyStopsAtTheFirstIncompatibleWaiter) {
+    sync_rw_init(&l, SYNC_WAKE_FIFO);
+    Log log;
+    queue_behind_writer(&worker, &l, &log);
+    EXPECT_EQ(log.order, (std::vector<int>{ 0, 1, 2, 3, 4 }));
+    EXPECT_EQ(log.max_readers, 2);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_LATCH], 4u);
+    EXPECT_EQ(l.word.load(), 0u);
+}
+
+TEST_F(SyncRwFixture, BatchPolicyAdmitsQueuedReadersTogether) {
+    sync_rw_init(&l, SYNC_WAKE_BATCH_READERS);
+    Log log;
+    queue_behind_writer(&worker, &l, &log);
+    EXPECT_EQ(log.order, (std::vector<int>{ 0, 1, 2, 4, 3 }));
+    EXPECT_EQ(log.max_readers, 3);
+    EXPECT_EQ(l.word.load(), 0u);
+}
+
+TEST_F(SyncRwFixture, SxLatchAdmitsReadersButNotWriters) {
+    sync_rw_init(&l);
+    Log log;
+    ASSERT_EQ(task_spawn(&worker, hold(&l, SYNC_SX, &log, 0, 4)), 0);
+    ASSERT_EQ(task_spawn(&worker, hold(&l, SYNC_X, &log, 1, 1)), 0);
+    ASSERT_EQ(task_spawn(&worker, hold(&l, SYNC_SX, &log, 2, 1)), 0);
+    sched_run(&worker);
+    EXPECT_EQ(log.order, (std::vector<int>{ 0, 1, 2 }));
+
+    // A reader gets in next to the SX holder without queueing
+    log = {};
+    ASSERT_TRUE(sync_rw_try_lock(&l, SYNC_SX));
+    ASSERT_EQ(task_spawn(&worker, hold(&l, SYNC_S, &log, 0, 0)), 0);
+    sched_run(&worker);
+    EXPECT_EQ(log.order, (std::vector<int>{ 0 }));
+    sync_rw_sx_unlock(&l);
+    EXPECT_EQ(l.word.load(), 0u);
+}
+
+TEST_F(SyncRwFixture, WritersNeverOverlapReadersAcrossThreads) {
+    for (sync_wake_policy policy : { SYNC_WAKE_FIFO, SYNC_WAKE_BATCH_READERS }) {
+        sync_rw_init(&l, policy);
+        constexpr int ITERS = 500;
+        Pair          p;
+        ASSERT_EQ(task_spawn(&worker, writer(&l, &p, ITERS)), 0);
+        ASSERT_EQ(task_spawn(&worker, reader(&l, &p, SYNC_S, ITERS)), 0);
+        ASSERT_EQ(task_spawn(&worker, reader(&l, &p, SYNC_S, ITERS)), 0);
+        ASSERT_EQ(task_spawn(&worker, reader(&l, &p, SYNC_SX, ITERS)), 0);
+        std::thread thread([&] {
+            for (int i = 0; i < ITERS; ++i) {
+                sync_rw_lock_blocking(&l, SYNC_X);
+                ++p.a;
+                ++p.b;
+                sync_rw_x_unlock(&l);
+                sync_rw_lock_blocking(&l, SYNC_S);
+                if (p.a != p.b) p.torn = true;
+                sync_rw_s_unlock(&l);
+            }
+        });
+        while (worker.live_tasks != 0) sched_run_once(&worker);
+        thread.join();
+
+        EXPECT_FALSE(p.torn);
+        EXPECT_EQ(p.a, 2u * ITERS);
+        EXPECT_EQ(l.word.load(), 0u);
+        EXPECT_EQ(worker.suspended_tasks, 0u);
+    }
+}
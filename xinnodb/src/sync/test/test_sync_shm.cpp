@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ctime>
+
+#include "sync_shm.hpp"  // IWYU pragma: keep
+#include "task.hpp"      // IWYU pragma: keep
+#include "task_test.hpp" // IWYU pragma: keep
+
+namespace {
+
+/// What the processes of a test share
+struct Shared {
+    sync_shm_mutex      m;
+    sync_shm_rw_latch   l;
+    std::atomic<ib_u32> held;
+    std::atomic<ib_u32> release;
+    ib_u64              counter;
+};
+
+struct SyncShmFixture : ::testing::Test, task_test_env {
+    sync_shm_worker sw;
+    Shared*         sh = nullptr;
+
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+        ASSERT_EQ(sync_shm_worker_init(&sw, &worker), 0);
+        void* mem = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        ASSERT_NE(mem, MAP_FAILED);
+        sh = (Shared*)mem;
+        sync_shm_mutex_init(&sh->m);
+        sync_shm_rw_init(&sh->l);
+        (void)sync_shm_self();
+    }
+
+    void TearDown() override {
+        munmap(sh, sizeof(Shared));
+        sync_shm_worker_detach(&sw);
+        task_test_env_destroy(this);
+    }
+
+    /// Runs `fn` in a child process, returns its pid
+    template <typename Fn>
+    pid_t spawn(Fn fn) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            fn();
+            _exit(0);
+        }
+        return pid;
+    }
+
+    static void wait_for(std::atomic<ib_u32>* flag) {
+        while (flag->load(std::memory_order_acquire) == 0) {
+            struct timespec ts{ 0, 100'000 };
+            nanosleep(&ts, nullptr);
+        }
+    }
+
+    static void reap(pid_t pid) {
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+    }
+};
+
+ib_async<void> x_lock_then_flag(sync_shm_rw_latch* l, bool* died, bool* acquired) {
+    *died     = co_await sync_shm_rw_x_lock(l);
+    *acquired = true;
+    sync_shm_rw_x_unlock(l);
+}
+
+ib_async<void> s_lock(sync_shm_rw_latch* l, bool* died, ib_u32* readers) {
+    *died    = co_await sync_shm_rw_s_lock(l);
+    *readers = sync_shm_rw_readers(l);
+    sync_shm_rw_s_unlock(l);
+}
+
+ib_async<void> until(const bool* done, int* steps) {
+    while (!*done) {
+        ++*steps;
+        co_await task_yield();
+    }
+}
+
+} // namespace
+
+TEST_F(SyncShmFixture, MutexExcludesAcrossProcesses) {
+    constexpr int ITERS = 20000;
+    auto          add   = [this] {
+        for (int i = 0; i < ITERS; ++i) {
+            EXPECT_FALSE(sync_shm_mutex_lock_blocking(&sh->m));
+            ++sh->counter;
+            sync_shm_mutex_unlock(&sh->m);
+        }
+    };
+    const pid_t child = spawn(add);
+    add();
+    reap(child);
+    EXPECT_EQ(sh->counter, 2u * ITERS);
+    EXPECT_EQ(sh->m.word.load(), 0u);
+}
+
+TEST_F(SyncShmFixture, MutexOfADeadProcessIsTakenOver) {
+    const pid_t child = spawn([this] { ASSERT_TRUE(sync_shm_mutex_try_lock(&sh->m)); });
+    reap(child);
+    EXPECT_EQ(sync_shm_mutex_owner(&sh->m), (ib_u32)child);
+    EXPECT_FALSE(sync_shm_mutex_try_lock(&sh->m));
+
+    EXPECT_TRUE(sync_shm_mutex_lock_blocking(&sh->m));
+    EXPECT_EQ(sync_shm_mutex_owner(&sh->m), sync_shm_self());
+    sync_shm_mutex_unlock(&sh->m);
+    EXPECT_FALSE(sync_shm_mutex_lock_blocking(&sh->m));
+    sync_shm_mutex_unlock(&sh->m);
+}
+
+TEST_F(SyncShmFixture, MutexOfAReusedPidIsTakenOver) {
+    // The owner recorded our pid, but it was another process that started at another time
+    const ib_u64 self = ut_proc_self();
+    sh->m.word.store(ut_proc_pid(self), std::memory_order_relaxed);
+    sh->m.owner_id.store(self ^ 1, std::memory_order_relaxed);
+    EXPECT_TRUE(ut_proc_pid_alive(ut_proc_pid(self)));
+    EXPECT_FALSE(ut_proc_alive(self ^ 1));
+
+    EXPECT_TRUE(sync_shm_mutex_lock_blocking(&sh->m));
+    EXPECT_EQ(sh->m.owner_id.load(), self);
+    sync_shm_mutex_unlock(&sh->m);
+    EXPECT_EQ(sh->m.owner_id.load(), 0u);
+}
+
+TEST_F(SyncShmFixture, TaskWaitsForAnotherProcessWithoutBlockingTheWorker) {
+    const pid_t child = spawn([this] {
+        ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_X));
+        sh->held.store(1, std::memory_order_release);
+        wait_for(&sh->release);
+        sync_shm_rw_x_unlock(&sh->l);
+    });
+    wait_for(&sh->held);
+    EXPECT_FALSE(sync_shm_rw_try_lock(&sh->l, SYNC_S));
+
+    bool died     = true;
+    bool acquired = false;
+    int  steps    = 0;
+    ASSERT_EQ(task_spawn(&worker, x_lock_then_flag(&sh->l, &died, &acquired)), 0);
+    ASSERT_EQ(task_spawn(&worker, until(&acquired, &steps)), 0);
+    while (steps < 100) sched_run_once(&worker);
+    EXPECT_FALSE(acquired);
+    sh->release.store(1, std::memory_order_release);
+    sched_run(&worker);
+    reap(child);
+
+    EXPECT_TRUE(acquired);
+    EXPECT_FALSE(died);
+    EXPECT_EQ(sw.parked_total, 1u);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_LATCH], 1u);
+    EXPECT_EQ(worker.poll_pending, 0u);
+    EXPECT_EQ(sh->l.word.load(), 0u);
+}
+
+TEST_F(SyncShmFixture, PollerBacksOffWhileTheLatchStaysHeld) {
+    ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_X));
+    bool died     = true;
+    bool acquired = false;
+    int  steps    = 0;
+    ASSERT_EQ(task_spawn(&worker, x_lock_then_flag(&sh->l, &died, &acquired)), 0);
+    ASSERT_EQ(task_spawn(&worker, until(&acquired, &steps)), 0);
+    while (steps < 2000) sched_run_once(&worker);
+    // A pool worker would park: the waiter is not a pending completion
+    EXPECT_EQ(worker.poll_pending, 0u);
+    EXPECT_LT(sw.polls, 200u);
+    EXPECT_GT(sw.retry_delay_ns, SYNC_SHM_RETRY_MIN_NS);
+    EXPECT_LE(sw.retry_delay_ns, SYNC_SHM_RETRY_MAX_NS);
+    EXPECT_FALSE(acquired);
+
+    sync_shm_rw_x_unlock(&sh->l);
+    sched_run(&worker);
+    EXPECT_TRUE(acquired);
+    EXPECT_FALSE(died);
+    EXPECT_EQ(sw.retry_delay_ns, SYNC_SHM_RETRY_MIN_NS);
+}
+
+TEST_F(SyncShmFixture, WriterOfADeadProcessIsTakenOverByATask) {
+    const pid_t child = spawn([this] { ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_X)); });
+    reap(child);
+    EXPECT_EQ(ut_proc_pid(sh->l.x_owner.load()), (ib_u32)child);
+
+    bool   died    = false;
+    ib_u32 readers = 0;
+    ASSERT_EQ(task_spawn(&worker, s_lock(&sh->l, &died, &readers)), 0);
+    sched_run(&worker);
+    EXPECT_TRUE(died);
+    EXPECT_EQ(readers, 1u);
+    EXPECT_EQ(sw.recovered, 1u);
+    EXPECT_EQ(sh->l.x_owner.load(), 0u);
+    EXPECT_EQ(sh->l.word.load(), 0u);
+}
+
+TEST_F(SyncShmFixture, ReadersOfADeadProcessAreReclaimed) {
+    ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_S));
+    const pid_t child = spawn([this] {
+        ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_S));
+        ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_S));
+    });
+    reap(child);
+    EXPECT_EQ(sync_shm_rw_readers(&sh->l), 3u);
+
+    // The probe drops the two holds of the child; ours still keeps the writer out
+    sync_shm_waiter w{ {}, nullptr, &sh->l, 0, SYNC_SHM_RW, SYNC_X, false };
+    EXPECT_FALSE(sync_shm_acquire(&w, false));
+    EXPECT_EQ(sync_shm_rw_readers(&sh->l), 3u);
+    EXPECT_FALSE(sync_shm_acquire(&w, true));
+    EXPECT_EQ(sync_shm_rw_readers(&sh->l), 1u);
+
+    sync_shm_rw_s_unlock(&sh->l);
+    for (const std::atomic<ib_u64>& slot : sh->l.readers) EXPECT_EQ(slot.load(), 0u);
+    for (const std::atomic<ib_u64>& id : sh->l.reader_ids) EXPECT_EQ(id.load(), 0u);
+    EXPECT_FALSE(sync_shm_rw_lock_blocking(&sh->l, SYNC_X));
+    sync_shm_rw_x_unlock(&sh->l);
+    EXPECT_EQ(sh->l.word.load(), 0u);
+}
+
+TEST_F(SyncShmFixture, RwModesFollowTheCompatibilityMatrixAcrossProcesses) {
+    ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_SX));
+    const pid_t child = spawn([this] {
+        ASSERT_TRUE(sync_shm_rw_try_lock(&sh->l, SYNC_S));
+        ASSERT_FALSE(sync_shm_rw_try_lock(&sh->l, SYNC_SX));
+        ASSERT_FALSE(sync_shm_rw_try_lock(&sh->l, SYNC_X));
+        sync_shm_rw_s_unlock(&sh->l);
+        // Sleeps on the futex until the parent releases SX
+        ASSERT_FALSE(sync_shm_rw_lock_blocking(&sh->l, SYNC_X));
+        sh->counter = 1;
+        sync_shm_rw_x_unlock(&sh->l);
+    });
+    while (sync_shm_rw_readers(&sh->l) == 0 && (sh->l.word.load() & SYNC_WAITERS) == 0) {
+        struct timespec ts{ 0, 100'000 };
+        nanosleep(&ts, nullptr);
+    }
+    EXPECT_EQ(sh->l.sx_owner.load(), ut_proc_self());
+    sync_shm_rw_sx_unlock(&sh->l);
+    reap(child);
+    EXPECT_EQ(sh->counter, 1u);
+    EXPECT_EQ(sh->l.word.load(), 0u);
+}
@@ -1,13 +1,19 @@
 #include <fmt/format.h>
-#include <random>
 #include <cstdlib>
 #include "tail_call.hpp"
+#include "ut_rnd.hpp"
+
+static ut_rnd example_rnd;
+
+struct key16 {
+    unsigned long long hi, lo;
+};
+
+using scan_frame = co_frame<double, key16, int>;
+using wide_frame = co_frame<int, int, int, int, int, int, int, int, int, int, int, int, int, int, double>;
 
 IB_ASYNC do_print4(int x, int y, int z) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> int_dist(0, 99);
-    if (int_dist(gen) > 50) {
+    if (ut_rnd_bounded(&example_rnd, 100) > 50) {
         fmt::print("4 >\n");
         fmt::print("end\n");
         std::exit(0);
@@ -18,10 +24,7 @@ IB_ASYNC do_print4(int x, int y, int z) {
 }
 
 IB_ASYNC do_print3(void* ptr = nullptr) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> int_dist(0, 99);
-    int val = int_dist(gen);
+    int val = (int)ut_rnd_bounded(&example_rnd, 100);
     if (val > 50) {
         fmt::print("3 >\n");
         co_do(do_print4, 1, 2, 3);
@@ -32,10 +35,7 @@ IB_ASYNC do_print3(void* ptr = nullptr) {
 }
 
 IB_ASYNC do_print2(void* ptr = nullptr) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> int_dist(0, 99);
-    int val = int_dist(gen);
+    int val = (int)ut_rnd_bounded(&example_rnd, 100);
     if (val > 50) {
         fmt::print("2 >\n");
         co_do(do_print3, ptr);
@@ -46,10 +46,7 @@ IB_ASYNC do_print2(void* ptr = nullptr) {
 }
 
 IB_ASYNC do_print1(void* ptr = nullptr) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> int_dist(0, 99);
-    int val = int_dist(gen);
+    int val = (int)ut_rnd_bounded(&example_rnd, 100);
     if (val > 50) {
         fmt::print("1 >\n");
         co_do(do_print2, ptr);
@@ -59,12 +56,31 @@ IB_ASYNC do_print1(void* ptr = nullptr) {
     }
 }
 
+// 14 integers and a double: more than co_do can pass in registers
+IB_ASYNC do_wide(wide_frame* f) {
+    int sum = co_arg<0>(f) + co_arg<1>(f) + co_arg<2>(f) + co_arg<3>(f) + co_arg<4>(f) + co_arg<5>(f) + co_arg<6>(f) +
+              co_arg<7>(f) + co_arg<8>(f) + co_arg<9>(f) + co_arg<10>(f) + co_arg<11>(f) + co_arg<12>(f) + co_arg<13>(f);
+    fmt::print("wide sum={} scale={}\n", sum, co_arg<14>(f));
+    co_do(do_print1, nullptr);
+}
+
+// A scan step carrying a selectivity estimate and a 16-byte key
+IB_ASYNC do_scan(scan_frame* f) {
+    const double sel  = co_arg<0>(f);
+    const key16  key  = co_arg<1>(f);
+    const int    left = co_arg<2>(f);
+    fmt::print("scan key={:x}:{:x} sel={:.3f}\n", key.hi, key.lo, sel);
+    if (left > 0) co_spill(do_scan, sel * 0.5, key16{ key.hi, key.lo + 1 }, left - 1);
+    co_spill(do_wide, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, sel);
+}
+
 IB_ASYNC async_main(int argc, char** argv) {
     fmt::print("begin\n");
-    co_do(do_print1, nullptr);
+    co_spill(do_scan, 1.0, key16{ 0xabc, 0 }, 3);
 }
 
 int main(int argc, char** argv) {
+    ut_rnd_init(&example_rnd, ut_rnd_entropy());
     co_do(async_main, argc, argv);
     __builtin_unreachable();
 }
@@ -2,6 +2,8 @@
 
 #include <type_traits>
 
+#include "sched_frame.hpp"
+
 // OPTION 1: With [[preserve_none]] - Maximum performance for CPS
 #define IB_ASYNC [[noreturn]] __attribute__((preserve_none)) void
 
@@ -129,6 +131,14 @@ constexpr bool check_tail_call() {
 #define TAIL_CALL_DISPATCH_IMPL(n, ...) TAIL_CALL_DISPATCH_IMPL2(n, __VA_ARGS__)
 #define TAIL_CALL_DISPATCH_IMPL2(n, ...) TAIL_CALL_##n(__VA_ARGS__)
 
+// Tail call with the arguments spilled to a continuation frame: any count, FP and wide types.
+// The callee takes a single co_frame<Args...>* whose Args are the (decayed) argument types.
+#define co_spill(fn, ...) do { \
+    auto* __frame = co_frame_pack(__VA_ARGS__); \
+    static_assert(std::is_invocable_v<decltype(fn), decltype(__frame)>, "co_spill: callee frame type doesn't match arguments"); \
+    TAIL_CALL_1(fn, __frame); \
+} while(0)
+
 #define co_if(cond, if_true, if_false, ...) \
    if (cond) { \
       co_do(if_true __VA_OPT__(,) __VA_ARGS__); \
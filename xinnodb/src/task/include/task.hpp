@@ -0,0 +1,169 @@
+#pragma once
+
+#include "xinnodb.hpp"               // IWYU pragma: keep
+#include "ut_assert.hpp"             // IWYU pragma: keep
+#include "ut_dlink.hpp"              // IWYU pragma: keep
+#include "alloc.hpp"                 // IWYU pragma: keep
+#include "sched.hpp"                 // IWYU pragma: keep
+#include "sched_timer.hpp"           // IWYU pragma: keep
+
+#include <atomic>
+#include <coroutine>
+
+/// \defgroup task task
+/// \ingroup components
+/// \brief Coroutine tasks on top of the scheduler
+/// \details A `task` is a `sched_task` whose step resumes a C++20 coroutine (`ib_async`). The
+/// coroutine chain runs until it completes or an awaitable parks the task (task_park(), or a
+/// co_await task_yield()); control then returns to the worker loop. Awaiting another ib_async is a
+/// symmetric transfer inside the same step and costs no scheduler round trip.
+///
+/// Every coroutine frame and task context is carved from the worker's `alloc_table`. A small
+/// reserve table absorbs frames allocated while the main table is exhausted; a task that awaits
+/// such a frame is parked on `frame_waiters` and restarted when a frame is freed, so memory
+/// pressure turns into back-pressure instead of an exception.
+///
+/// A frame freed on another worker (the task was stolen, or finished elsewhere) is pushed onto the
+/// owner's lock-free `remote_frees` stack and returned to its table by the owner's poller.
+
+/// \addtogroup task
+/// @{
+
+/// \brief Per-worker coroutine frame allocator
+struct task_worker {
+    sched_worker* sched;
+    alloc_table*  alloc;                ///< Main allocator (frames are tagged alloc_kind::PROMISE)
+    alloc_table   reserve;              ///< Emergency frames used while `alloc` is exhausted
+    ut_dlink      frame_waiters;        ///< Tasks parked until frame memory is freed
+    ib_u64        frames_allocated;
+    ib_u64        frames_freed;
+    ib_u64        frames_from_reserve;
+    ib_u64        frame_failures;       ///< Allocation failed in both tables
+    ib_u64        frame_waits;
+    ib_u64        remote_frees_total;   ///< Frames returned by other workers
+    std::atomic<void*> remote_frees;    ///< Frames freed by other threads, linked through their body
+    sched_poller  poller;               ///< Drains `remote_frees`
+};
+
+/// \brief A coroutine task
+struct task {
+    sched_task              sched;
+    std::coroutine_handle<> root;           ///< Outermost coroutine, destroyed on exit
+    std::coroutine_handle<> resume_point;   ///< Coroutine to resume on the next step
+};
+
+/// \brief Awaitable returned by task_yield()
+struct task_yield_awaiter {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) const noexcept;
+    void await_resume() const noexcept {}
+};
+
+/// \brief Awaitable returned by task_checkpoint()
+struct task_checkpoint_awaiter {
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> h) const noexcept;
+    void await_resume() const noexcept {}
+};
+
+/// \brief Awaitable returned by task_sleep_for() and task_deadline()
+/// \details The timer lives in the awaiting coroutine frame: sleeping costs no allocation.
+struct task_sleep_awaiter {
+    ib_u64      ns;
+    bool        relative;
+    sched_timer timer;
+
+    bool await_ready() const noexcept { return relative && ns == 0; }
+    void await_suspend(std::coroutine_handle<> h) noexcept;
+    void await_resume() const noexcept {}
+};
+
+int  task_worker_init(task_worker* tw, sched_worker* w, alloc_table* at, void* reserve_mem, ib_size reserve_size) noexcept;
+void task_worker_detach(task_worker* tw) noexcept;
+int  task_spawn_handle(sched_worker* w, std::coroutine_handle<> root, sched_class cls = SCHED_CLASS_OLTP) noexcept;
+void task_step(sched_worker* w, sched_task* t) noexcept;
+void task_park(task* t, std::coroutine_handle<> h, sched_suspend_reason reason) noexcept;
+
+template <typename T>
+inline static int                     task_spawn(sched_worker* w, ib_async<T>&& a, sched_class cls = SCHED_CLASS_OLTP) noexcept;
+inline static task*                   task_current() noexcept;
+inline static task_yield_awaiter      task_yield() noexcept;
+inline static task_checkpoint_awaiter task_checkpoint() noexcept;
+inline static task_sleep_awaiter      task_sleep_for(ib_u64 ns) noexcept;
+inline static task_sleep_awaiter      task_deadline(ib_u64 deadline_ns) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Spawns `a` as a root task of priority class `cls` on `w`
+/// \return 0 on success, -1 if `a` is invalid or the task context could not be allocated
+template <typename T>
+inline int task_spawn(sched_worker* w, ib_async<T>&& a, sched_class cls) noexcept {
+    if (!a.valid()) return -1;
+    auto h = a.release();
+    if (task_spawn_handle(w, h, cls) != 0) {
+        h.destroy();
+        return -1;
+    }
+    return 0;
+}
+
+/// \brief The task running on the current worker, or nullptr outside of tasks
+inline task* task_current() noexcept {
+    sched_task* st = sched_current_task();
+    if (st == nullptr || st->fn != task_step) return nullptr;
+    return (task*)st;
+}
+
+/// \brief `co_await task_yield()` requeues the task behind the other ready tasks
+inline task_yield_awaiter task_yield() noexcept {
+    return {};
+}
+
+inline void task_yield_awaiter::await_suspend(std::coroutine_handle<> h) const noexcept {
+    task* t = task_current();
+    IB_ASSERT_NOT_NULL(t, "task_yield awaited outside of a task");
+    t->resume_point = h;
+    sched_yield(&t->sched, task_step);
+}
+
+/// \brief `co_await task_checkpoint()` in long loops yields once the step budget of the task is used up
+inline task_checkpoint_awaiter task_checkpoint() noexcept {
+    return {};
+}
+
+inline bool task_checkpoint_awaiter::await_ready() const noexcept {
+    task* t = task_current();
+    return t == nullptr || !sched_budget_exceeded(&t->sched);
+}
+
+inline void task_checkpoint_awaiter::await_suspend(std::coroutine_handle<> h) const noexcept {
+    task* t = task_current();
+    ++t->sched.worker->classes[t->sched.cls].preemptions;
+    t->resume_point = h;
+    sched_yield(&t->sched, task_step);
+}
+
+/// \brief `co_await task_sleep_for(ns)` parks the task on the worker timer wheel for `ns` nanoseconds
+inline task_sleep_awaiter task_sleep_for(ib_u64 ns) noexcept {
+    return { ns, true, {} };
+}
+
+/// \brief `co_await task_deadline(t)` parks the task until the wheel clock reaches `t`
+inline task_sleep_awaiter task_deadline(ib_u64 deadline_ns) noexcept {
+    return { deadline_ns, false, {} };
+}
+
+inline void task_sleep_awaiter::await_suspend(std::coroutine_handle<> h) noexcept {
+    task* t = task_current();
+    IB_ASSERT_NOT_NULL(t, "task sleep awaited outside of a task");
+    sched_timer_wheel* wh = sched_timer_wheel_of(t->sched.worker);
+    IB_ASSERT_NOT_NULL(wh, "worker has no timer wheel");
+    sched_timer_init(&timer, sched_timer_resume_task, &t->sched);
+    task_park(t, h, SCHED_SUSPEND_TIMER);
+    sched_timer_arm(wh, &timer, relative ? sched_timer_now(wh) + ns : ns);
+}
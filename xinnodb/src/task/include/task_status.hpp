@@ -0,0 +1,40 @@
+#pragma once
+
+#include "task.hpp"                  // IWYU pragma: keep
+#include "ut_status.hpp"             // IWYU pragma: keep
+
+/// \defgroup task_status Task status variables
+/// \ingroup task
+/// \brief Per-class task costs published as status variables
+/// \details Registers, for each priority class `<class>` (`oltp`, `background`, `maintenance`),
+/// counters summed over a set of workers:
+///
+/// - `task.<class>.cycles`, `.steps`, `.preemptions`: every step run so far;
+/// - `task.<class>.finished`: tasks finished;
+/// - `task.<class>.allocs.<kind>`, `.alloc_bytes`, `.io_read_bytes`, `.io_write_bytes`,
+///   `.io_waits`, `.latch_waits`: accounts of the finished tasks.
+///
+/// The cost of a single query is the `ut_acct` of its tasks (`sched_task::acct`).
+
+/// \addtogroup task_status
+/// @{
+
+/// \brief Counters published per class
+constexpr ib_u32 TASK_STATUS_FIELDS = 9 + UT_ACCT_ALLOC_KINDS;
+
+/// \brief Longest variable name, terminator included
+constexpr ib_u32 TASK_STATUS_NAME_MAX = 48;
+
+/// \brief Registered variables of a set of workers
+struct task_status {
+    const sched_worker* workers;
+    ib_u32              count;
+    ib_u32              registered;
+    ut_status_var       vars[SCHED_CLASS_COUNT * TASK_STATUS_FIELDS];
+    char                names[SCHED_CLASS_COUNT * TASK_STATUS_FIELDS][TASK_STATUS_NAME_MAX];
+};
+
+int  task_status_register(task_status* st, const sched_worker* workers, ib_u32 count) noexcept;
+void task_status_unregister(task_status* st) noexcept;
+
+/// @}
@@ -0,0 +1,57 @@
+#include "task.hpp"
+
+#include <new>
+
+/// \brief Frees the task context once its root coroutine has completed
+static void task_on_exit(sched_worker*, sched_task* st) noexcept {
+    task* t = (task*)st;
+    IB_ASSERT(t->root.done(), "task step returned without suspending, yielding or completing");
+    t->root.destroy();
+    t->~task();
+    ib_async_frame_free(t, sizeof(task));
+}
+
+/// \brief Scheduler step of every coroutine task: resumes the coroutine chain where it stopped
+/// \details Returns when the chain completes (the task is done) or when an awaitable parked or
+/// requeued the task through task_park() / task_yield().
+void task_step(sched_worker*, sched_task* st) noexcept {
+    task* t = (task*)st;
+    std::coroutine_handle<> h = t->resume_point;
+    t->resume_point = nullptr;
+    h.resume();
+}
+
+/// \brief Wraps `root` (an initially suspended coroutine) into a task and makes it ready on `w`
+/// \details Called from a running task, the new task inherits its task-local slots.
+/// \return 0 on success, -1 if the task context could not be allocated
+int task_spawn_handle(sched_worker* w, std::coroutine_handle<> root, sched_class cls) noexcept {
+    IB_ASSERT_NOT_NULL(w);
+    void* mem = ib_async_frame_alloc(sizeof(task));
+    if (mem == nullptr) return -1;
+    (void)ib_async_frame_take_pressure();
+    task* t = ::new (mem) task{};
+    t->root         = root;
+    t->resume_point = root;
+    sched_task_init(&t->sched, task_step, nullptr, task_on_exit);
+    // Work spawned by a task runs for the same transaction and session
+    if (sched_task* parent = sched_current_task()) sched_task_inherit(&t->sched, parent);
+    t->sched.cls = cls;
+    sched_spawn(w, &t->sched);
+    return 0;
+}
+
+/// \brief Suspends `t` from an awaiter; `h` is resumed after sched_resume(&t->sched)
+/// \details Called from `await_suspend`. The awaiter links `t->sched.link` into its waiter queue.
+void task_park(task* t, std::coroutine_handle<> h, sched_suspend_reason reason) noexcept {
+    t->resume_point = h;
+    sched_suspend(&t->sched, task_step, reason);
+}
+
+bool ib_async_preempt(std::coroutine_handle<> callee) noexcept {
+    task* t = task_current();
+    if (t == nullptr || !sched_budget_exceeded(&t->sched)) return false;
+    ++t->sched.worker->classes[t->sched.cls].preemptions;
+    t->resume_point = callee;
+    sched_yield(&t->sched, task_step);
+    return true;
+}
@@ -0,0 +1,147 @@
+#include "task.hpp"
+#include "sched_pool.hpp"
+
+#include <cstdlib>
+
+/// \brief Prefix of every coroutine frame: where it must be returned
+struct task_frame_header {
+    alloc_table* owner;     ///< nullptr for frames allocated outside of a worker (std::malloc)
+    task_worker* tw;
+};
+static_assert(sizeof(task_frame_header) == 16, "frames must stay 16-byte aligned");
+
+static thread_local task_worker* task_tls_worker    = nullptr;
+static thread_local bool         task_frame_pressure = false;
+
+static task_worker* task_worker_current() noexcept {
+    sched_worker* w = sched_current_worker();
+    if (w != nullptr && w->ext[SCHED_EXT_TASK] != nullptr) return (task_worker*)w->ext[SCHED_EXT_TASK];
+    return task_tls_worker;
+}
+
+static void task_frame_release(task_worker* tw, task_frame_header* hdr) noexcept {
+    alloc_table_free(hdr->owner, hdr, 0);
+    ++tw->frames_freed;
+    if (ut_dlink* link = ut_dlink_dequeue(&tw->frame_waiters)) {
+        sched_resume(sched_task_from_link(link));
+    }
+}
+
+static ib_u64 task_remote_frees_drain(task_worker* tw) noexcept {
+    void*  frame = tw->remote_frees.exchange(nullptr, std::memory_order_acquire);
+    ib_u64 n     = 0;
+    while (frame != nullptr) {
+        void* next = *(void**)frame;
+        task_frame_release(tw, (task_frame_header*)frame - 1);
+        frame = next;
+        ++n;
+    }
+    tw->remote_frees_total += n;
+    return n;
+}
+
+static ib_u64 task_remote_frees_poll(sched_worker*, void* ctx) noexcept {
+    task_remote_frees_drain((task_worker*)ctx);
+    return 0;
+}
+
+/// \brief Attaches a frame allocator to `w` and binds it to the calling thread
+/// \param at Worker allocator; frames and task contexts are allocated from it
+/// \param reserve_mem Memory for the emergency frame reserve (at least 4 KiB)
+/// \return 0 on success, non-zero if the reserve could not be initialized
+int task_worker_init(task_worker* tw, sched_worker* w, alloc_table* at, void* reserve_mem, ib_size reserve_size) noexcept {
+    IB_ASSERT_NOT_NULL(tw);
+    IB_ASSERT_NOT_NULL(w);
+    IB_ASSERT_NOT_NULL(at);
+    int rc = alloc_table_init(&tw->reserve, reserve_mem, reserve_size);
+    if (rc != 0) return rc;
+    tw->sched               = w;
+    tw->alloc               = at;
+    tw->frames_allocated    = 0;
+    tw->frames_freed        = 0;
+    tw->frames_from_reserve = 0;
+    tw->frame_failures      = 0;
+    tw->frame_waits         = 0;
+    tw->remote_frees_total  = 0;
+    tw->remote_frees.store(nullptr, std::memory_order_relaxed);
+    ut_dlink_init(&tw->frame_waiters);
+    sched_poller_register(w, &tw->poller, task_remote_frees_poll, tw);
+    w->ext[SCHED_EXT_TASK] = tw;
+    task_tls_worker        = tw;
+    return 0;
+}
+
+void task_worker_detach(task_worker* tw) noexcept {
+    IB_ASSERT(ut_dlink_is_detached(&tw->frame_waiters), "tasks still waiting for frame memory");
+    task_remote_frees_drain(tw);
+    sched_poller_unregister(&tw->poller);
+    tw->sched->ext[SCHED_EXT_TASK] = nullptr;
+    if (task_tls_worker == tw) task_tls_worker = nullptr;
+}
+
+void* ib_async_frame_alloc(std::size_t size) noexcept {
+    task_worker*       tw = task_worker_current();
+    task_frame_header* hdr;
+    if (tw == nullptr) [[unlikely]] {
+        // Client threads that are not attached to a worker: cold path only
+        hdr = (task_frame_header*)std::malloc(sizeof(task_frame_header) + size);
+        if (hdr == nullptr) return nullptr;
+        hdr->owner = nullptr;
+        hdr->tw    = nullptr;
+        return hdr + 1;
+    }
+    alloc_table* owner = tw->alloc;
+    hdr = (task_frame_header*)alloc_table_try_malloc(owner, sizeof(task_frame_header) + size, alloc_kind::PROMISE);
+    if (hdr == nullptr) [[unlikely]] {
+        owner = &tw->reserve;
+        hdr   = (task_frame_header*)alloc_table_try_malloc(owner, sizeof(task_frame_header) + size, alloc_kind::PROMISE);
+        if (hdr == nullptr) {
+            ++tw->frame_failures;
+            return nullptr;
+        }
+        ++tw->frames_from_reserve;
+        task_frame_pressure = true;
+    }
+    ++tw->frames_allocated;
+    hdr->owner = owner;
+    hdr->tw    = tw;
+    return hdr + 1;
+}
+
+/// \details Every free may make room for a parked task: the oldest frame waiter is resumed.
+/// Frames of another worker go to its `remote_frees` stack; the frame body holds the link.
+void ib_async_frame_free(void* frame, std::size_t) noexcept {
+    task_frame_header* hdr = (task_frame_header*)frame - 1;
+    if (hdr->owner == nullptr) [[unlikely]] {
+        std::free(hdr);
+        return;
+    }
+    task_worker* tw = hdr->tw;
+    if (tw != task_worker_current()) [[unlikely]] {
+        void* head = tw->remote_frees.load(std::memory_order_relaxed);
+        do {
+            *(void**)frame = head;
+        } while (!tw->remote_frees.compare_exchange_weak(head, frame, std::memory_order_release,
+                                                         std::memory_order_relaxed));
+        if (tw->sched->pool != nullptr) sched_pool_wake(tw->sched);
+        return;
+    }
+    task_frame_release(tw, hdr);
+}
+
+bool ib_async_frame_take_pressure() noexcept {
+    const bool pressured = task_frame_pressure;
+    task_frame_pressure = false;
+    return pressured;
+}
+
+bool ib_async_frame_wait(std::coroutine_handle<> callee) noexcept {
+    task* t = task_current();
+    if (t == nullptr) return false;
+    task_worker* tw = (task_worker*)t->sched.worker->ext[SCHED_EXT_TASK];
+    if (tw == nullptr) return false;
+    ++tw->frame_waits;
+    task_park(t, callee, SCHED_SUSPEND_ALLOC);
+    ut_dlink_enqueue(&tw->frame_waiters, &t->sched.link);
+    return true;
+}
@@ -0,0 +1,96 @@
+#include "task_status.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr const char* TASK_STATUS_CLASS_NAME[SCHED_CLASS_COUNT] = { "oltp", "background", "maintenance" };
+
+enum task_status_field : ib_u32 {
+    TASK_STATUS_CYCLES         = 0,
+    TASK_STATUS_STEPS          = 1,
+    TASK_STATUS_PREEMPTIONS    = 2,
+    TASK_STATUS_FINISHED       = 3,
+    TASK_STATUS_ALLOC_BYTES    = 4,
+    TASK_STATUS_IO_READ_BYTES  = 5,
+    TASK_STATUS_IO_WRITE_BYTES = 6,
+    TASK_STATUS_IO_WAITS       = 7,
+    TASK_STATUS_LATCH_WAITS    = 8,
+    TASK_STATUS_ALLOCS         = 16,    ///< + alloc_kind
+};
+
+constexpr const char* TASK_STATUS_FIELD_NAME[] = {
+    "cycles", "steps", "preemptions", "finished", "alloc_bytes",
+    "io_read_bytes", "io_write_bytes", "io_waits", "latch_waits",
+};
+
+ib_u64 task_status_field_of(const sched_class_state* c, ib_u32 field) noexcept {
+    switch (field) {
+    case TASK_STATUS_CYCLES:         return c->cycles;
+    case TASK_STATUS_STEPS:          return c->steps;
+    case TASK_STATUS_PREEMPTIONS:    return c->preemptions;
+    case TASK_STATUS_FINISHED:       return c->finished;
+    case TASK_STATUS_ALLOC_BYTES:    return c->acct.alloc_bytes;
+    case TASK_STATUS_IO_READ_BYTES:  return c->acct.io_read_bytes;
+    case TASK_STATUS_IO_WRITE_BYTES: return c->acct.io_write_bytes;
+    case TASK_STATUS_IO_WAITS:       return c->acct.io_waits;
+    case TASK_STATUS_LATCH_WAITS:    return c->acct.latch_waits;
+    default:                         return c->acct.allocs[field - TASK_STATUS_ALLOCS];
+    }
+}
+
+/// \brief `arg` holds the class in its high bits and the field in its low byte
+ib_i64 task_status_read(const ut_status_var* var) noexcept {
+    const task_status* st    = (const task_status*)var->ctx;
+    const ib_u32       cls   = (ib_u32)(var->arg >> 8);
+    const ib_u32       field = (ib_u32)(var->arg & 0xff);
+    ib_u64 sum = 0;
+    for (ib_u32 i = 0; i < st->count; ++i) sum += task_status_field_of(&st->workers[i].classes[cls], field);
+    return (ib_i64)sum;
+}
+
+int task_status_add(task_status* st, ib_u32 cls, ib_u32 field, const char* name) noexcept {
+    char* buf = st->names[st->registered];
+    std::snprintf(buf, TASK_STATUS_NAME_MAX, "task.%s.%s", TASK_STATUS_CLASS_NAME[cls], name);
+    if (ut_status_register(&st->vars[st->registered], buf, task_status_read, st, ((ib_u64)cls << 8) | field) != 0) return -1;
+    ++st->registered;
+    return 0;
+}
+
+int task_status_add_class(task_status* st, ib_u32 cls) noexcept {
+    for (ib_u32 f = 0; f < sizeof(TASK_STATUS_FIELD_NAME) / sizeof(TASK_STATUS_FIELD_NAME[0]); ++f) {
+        if (task_status_add(st, cls, f, TASK_STATUS_FIELD_NAME[f]) != 0) return -1;
+    }
+    for (ib_u32 k = 1; k < UT_ACCT_ALLOC_KINDS; ++k) {
+        const char* kind = to_string((alloc_kind)k);
+        if (std::strcmp(kind, "invalid") == 0) continue;
+        char name[TASK_STATUS_NAME_MAX];
+        std::snprintf(name, sizeof(name), "allocs.%s", kind);
+        if (task_status_add(st, cls, TASK_STATUS_ALLOCS + k, name) != 0) return -1;
+    }
+    return 0;
+}
+
+} // namespace
+
+/// \brief Publishes the per-class counters of `count` workers
+/// \return 0 on success, -1 if the names are already registered (nothing is registered then)
+int task_status_register(task_status* st, const sched_worker* workers, ib_u32 count) noexcept {
+    IB_ASSERT_NOT_NULL(st);
+    st->workers    = workers;
+    st->count      = count;
+    st->registered = 0;
+    for (ib_u32 cls = 0; cls < SCHED_CLASS_COUNT; ++cls) {
+        if (task_status_add_class(st, cls) != 0) {
+            task_status_unregister(st);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void task_status_unregister(task_status* st) noexcept {
+    for (ib_u32 i = 0; i < st->registered; ++i) ut_status_unregister(&st->vars[i]);
+    st->registered = 0;
+}
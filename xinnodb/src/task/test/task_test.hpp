@@ -0,0 +1,51 @@
+#pragma once
+
+#include "task.hpp" // IWYU pragma: keep
+
+#include <cerrno>
+#include <cstdlib>
+
+/// \brief A scheduler worker with a task worker and the allocator behind it, for tests and benchmarks
+/// \details Fixtures derive from it (`struct F : ::testing::Test, task_test_env`) and call
+/// task_test_env_init() from SetUp() and task_test_env_destroy() from TearDown().
+struct task_test_env {
+    void*        table_mem   = nullptr;
+    void*        reserve_mem = nullptr;
+    alloc_table  table{};
+    sched_worker worker;
+    task_worker  tw;
+    bool         tw_attached = false;
+};
+
+inline static constexpr ib_size TASK_TEST_TABLE_SIZE   = 64 * 1024;
+inline static constexpr ib_size TASK_TEST_RESERVE_SIZE = 16 * 1024;
+
+inline static int  task_test_env_init(task_test_env* env, ib_u32 worker_id = 0, ib_size table_size = TASK_TEST_TABLE_SIZE) noexcept;
+inline static void task_test_env_destroy(task_test_env* env) noexcept;
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Allocates the memory of `env` and attaches its task worker
+/// \return 0, -ENOMEM, or the error of alloc_table_init() or task_worker_init(); destroy `env` either way
+inline int task_test_env_init(task_test_env* env, ib_u32 worker_id, ib_size table_size) noexcept {
+    env->table_mem   = std::aligned_alloc(64, table_size);
+    env->reserve_mem = std::aligned_alloc(64, TASK_TEST_RESERVE_SIZE);
+    if (env->table_mem == nullptr || env->reserve_mem == nullptr) return -ENOMEM;
+    if (int rc = alloc_table_init(&env->table, env->table_mem, table_size); rc != 0) return rc;
+    sched_worker_init(&env->worker, worker_id);
+    if (int rc = task_worker_init(&env->tw, &env->worker, &env->table, env->reserve_mem, TASK_TEST_RESERVE_SIZE); rc != 0) return rc;
+    env->tw_attached = true;
+    return 0;
+}
+
+inline void task_test_env_destroy(task_test_env* env) noexcept {
+    if (env->tw_attached) task_worker_detach(&env->tw);
+    env->tw_attached = false;
+    std::free(env->reserve_mem);
+    std::free(env->table_mem);
+    env->reserve_mem = nullptr;
+    env->table_mem   = nullptr;
+}
@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "task.hpp"        // IWYU pragma: keep
+#include "task_status.hpp" // IWYU pragma: keep
+#include "task_test.hpp"   // IWYU pragma: keep
+
+namespace {
+
+struct TaskFixture : ::testing::Test, task_test_env {
+
+    void SetUp() override {
+        ASSERT_EQ(task_test_env_init(this), 0);
+    }
+
+    void TearDown() override {
+        task_test_env_destroy(this);
+    }
+
+    std::vector<void*> drain(alloc_table* at) {
+        std::vector<void*> blocks;
+        while (void* p = alloc_table_try_malloc(at, 32)) blocks.push_back(p);
+        return blocks;
+    }
+};
+
+ib_async<int> leaf(int x) {
+    co_return x * 2;
+}
+
+ib_async<int> middle(int x) {
+    int a = co_await leaf(x);
+    int b = co_await leaf(x + 1);
+    co_return a + b;
+}
+
+ib_async<void> root(int x, int* out) {
+    *out = co_await middle(x);
+}
+
+ib_async<int> recurse(int depth) {
+    if (depth == 0) co_return 0;
+    co_return 1 + co_await recurse(depth - 1);
+}
+
+ib_async<void> recurse_root(int depth, int* out) {
+    *out = co_await recurse(depth);
+}
+
+ib_async<void> yielder(std::string* log, char tag, int n) {
+    for (int i = 0; i < n; ++i) {
+        log->push_back(tag);
+        co_await task_yield();
+    }
+}
+
+ib_async<void> parked_root(int* out, std::string* log) {
+    log->append("await;");
+    *out = co_await leaf(21);
+    log->append("done;");
+}
+
+ib_async<void> releaser(alloc_table* at, std::vector<void*>* blocks, std::string* log) {
+    co_await task_yield();
+    log->append("release;");
+    for (void* p : *blocks) alloc_table_free(at, p, 0);
+    blocks->clear();
+}
+
+ib_async<ib_err> failing_leaf() {
+    co_return DB_SUCCESS;
+}
+
+ib_async<void> oom_root(ib_err* out) {
+    *out = co_await failing_leaf();
+}
+
+ib_async<void> sleeper(std::string* log, ib_u64 ns, char tag) {
+    log->push_back(tag);
+    co_await task_sleep_for(ns);
+    log->push_back(tag);
+}
+
+ib_async<void> deadline_sleeper(std::string* log, ib_u64 deadline) {
+    co_await task_deadline(deadline);
+    log->push_back('d');
+}
+
+ib_async<void> awaiting_loop(std::string* log, int n) {
+    int sum = 0;
+    for (int i = 0; i < n; ++i) sum += co_await leaf(i);
+    log->append(sum == n * (n - 1) ? "loop;" : "bad;");
+}
+
+ib_async<void> marker(std::string* log) {
+    log->append("marker;");
+    co_return;
+}
+
+ib_async<void> read_trx(void** out) {
+    *out = sched_local(SCHED_LOCAL_TRX);
+    co_return;
+}
+
+ib_async<void> spawning_parent(void* trx, void** child_saw) {
+    sched_local_set(sched_current_task(), SCHED_LOCAL_TRX, trx);
+    task_spawn(sched_current_worker(), read_trx(child_saw));
+    co_return;
+}
+
+} // namespace
+
+TEST_F(TaskFixture, AwaitChainsReturnValuesAndFreeFrames) {
+    const ib_size free_before = table.free_mem_size;
+    int out = 0;
+    ASSERT_EQ(task_spawn(&worker, root(5, &out)), 0);
+    EXPECT_LT(table.free_mem_size, free_before);
+    sched_run(&worker);
+    EXPECT_EQ(out, 5 * 2 + 6 * 2);
+    EXPECT_EQ(table.free_mem_size, free_before);
+    EXPECT_EQ(tw.frames_allocated, tw.frames_freed);
+    EXPECT_EQ(tw.frames_from_reserve, 0u);
+    EXPECT_EQ(worker.live_tasks, 0u);
+}
+
+TEST_F(TaskFixture, FramesAreTaggedAsPromises) {
+    ib_async<int> a = leaf(1);
+    ASSERT_TRUE(a.valid());
+    EXPECT_EQ(alloc_table_kind_of((char*)a.handle.address() - 16), alloc_kind::PROMISE);
+}
+
+TEST_F(TaskFixture, DeepAwaitChainsUseSymmetricTransfer) {
+    int out = 0;
+    ASSERT_EQ(task_spawn(&worker, recurse_root(200, &out)), 0);
+    sched_run(&worker);
+    EXPECT_EQ(out, 200);
+}
+
+TEST_F(TaskFixture, YieldInterleavesTasks) {
+    std::string log;
+    ASSERT_EQ(task_spawn(&worker, yielder(&log, 'a', 3)), 0);
+    ASSERT_EQ(task_spawn(&worker, yielder(&log, 'b', 3)), 0);
+    sched_run(&worker);
+    EXPECT_EQ(log, "ababab");
+    EXPECT_EQ(tw.frames_allocated, tw.frames_freed);
+}
+
+TEST_F(TaskFixture, FrameExhaustionParksTheAwaitingTask) {
+    int out = 0;
+    std::string log;
+    std::vector<void*> blocks;
+    ASSERT_EQ(task_spawn(&worker, parked_root(&out, &log)), 0);
+    ASSERT_EQ(task_spawn(&worker, releaser(&table, &blocks, &log)), 0);
+    blocks = drain(&table);
+    ASSERT_FALSE(blocks.empty());
+
+    sched_run(&worker);
+    EXPECT_EQ(out, 42);
+    EXPECT_EQ(log, "await;release;done;");
+    EXPECT_EQ(tw.frames_from_reserve, 1u);
+    EXPECT_EQ(tw.frame_waits, 1u);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_ALLOC], 1u);
+    EXPECT_EQ(tw.frames_allocated, tw.frames_freed);
+}
+
+TEST_F(TaskFixture, ExhaustedReserveYieldsOutOfMemory) {
+    ib_err out = DB_SUCCESS;
+    ASSERT_EQ(task_spawn(&worker, oom_root(&out)), 0);
+    std::vector<void*> blocks = drain(&table);
+    std::vector<void*> reserve_blocks = drain(&tw.reserve);
+    sched_run(&worker);
+    EXPECT_EQ(out, DB_OUT_OF_MEMORY);
+    EXPECT_EQ(tw.frame_failures, 1u);
+    for (void* p : blocks) alloc_table_free(&table, p, 0);
+    for (void* p : reserve_blocks) alloc_table_free(&tw.reserve, p, 0);
+}
+
+TEST_F(TaskFixture, SleepsAndDeadlinesWakeInTimeOrder) {
+    sched_timer_wheel wheel;
+    sched_timer_wheel_init(&wheel, &worker, UT_CLOCK_MANUAL, 1000);
+    std::string log;
+    ASSERT_EQ(task_spawn(&worker, sleeper(&log, 5000, 'a')), 0);
+    ASSERT_EQ(task_spawn(&worker, sleeper(&log, 2000, 'b')), 0);
+    ASSERT_EQ(task_spawn(&worker, deadline_sleeper(&log, 3000)), 0);
+    sched_run_once(&worker);
+    EXPECT_EQ(log, "ab");
+    EXPECT_EQ(wheel.pending, 3u);
+    for (ib_u64 now = 1000; now <= 5000; now += 1000) {
+        sched_timer_advance(&wheel, now);
+        sched_run_once(&worker);
+    }
+    EXPECT_EQ(log, "abbda");
+    EXPECT_EQ(worker.live_tasks, 0);
+    EXPECT_EQ(worker.suspends[SCHED_SUSPEND_TIMER], 3u);
+    sched_timer_wheel_detach(&wheel);
+}
+
+TEST_F(TaskFixture, AwaitsArePreemptionPoints) {
+    sched_class_configure(&worker, SCHED_CLASS_BACKGROUND, 4, 0, 50);
+    std::string log;
+    ASSERT_EQ(task_spawn(&worker, awaiting_loop(&log, 500), SCHED_CLASS_BACKGROUND), 0);
+    ASSERT_EQ(task_spawn(&worker, marker(&log)), 0);
+    sched_run(&worker);
+    EXPECT_EQ(log, "marker;loop;");
+    EXPECT_GE(worker.classes[SCHED_CLASS_BACKGROUND].preemptions, 9u);
+    EXPECT_EQ(worker.live_tasks, 0);
+}
+
+TEST_F(TaskFixture, SpawnedTasksInheritTaskLocals) {
+    int   trx       = 0;
+    void* child_saw = nullptr;
+    ASSERT_EQ(task_spawn(&worker, spawning_parent(&trx, &child_saw)), 0);
+    sched_run(&worker);
+    EXPECT_EQ(child_saw, &trx);
+}
+
+TEST_F(TaskFixture, FramesAreChargedToTheAwaitingTask) {
+    int out = 0;
+    ASSERT_EQ(task_spawn(&worker, root(5, &out)), 0);
+    sched_run(&worker);
+    // The root frame is allocated by the spawning thread; the frames it awaits by the task
+    const ut_acct* acct = &worker.classes[SCHED_CLASS_OLTP].acct;
+    EXPECT_EQ(acct->allocs[(ib_u32)alloc_kind::PROMISE], 3u);
+    EXPECT_GT(acct->alloc_bytes, 0u);
+    EXPECT_EQ(acct->allocs[(ib_u32)alloc_kind::GENERIC_MALLOC], 0u);
+}
+
+TEST_F(TaskFixture, StatusVariablesSumTheWorkers) {
+    task_status st;
+    ASSERT_EQ(task_status_register(&st, &worker, 1), 0);
+    task_status dup;
+    EXPECT_EQ(task_status_register(&dup, &worker, 1), -1);
+
+    std::string log;
+    ASSERT_EQ(task_spawn(&worker, yielder(&log, 'a', 3)), 0);
+    ASSERT_EQ(task_spawn(&worker, yielder(&log, 'b', 3), SCHED_CLASS_MAINTENANCE), 0);
+    sched_run(&worker);
+
+    ib_i64 v = 0;
+    ASSERT_EQ(ut_status_get_i64("task.oltp.finished", &v), 0);
+    EXPECT_EQ(v, 1);
+    // Three yields, then the step that completes
+    ASSERT_EQ(ut_status_get_i64("task.maintenance.steps", &v), 0);
+    EXPECT_EQ(v, 4);
+    ASSERT_EQ(ut_status_get_i64("task.background.allocs.promise", &v), 0);
+    EXPECT_EQ(v, 0);
+    ASSERT_EQ(ut_status_get_i64("task.oltp.cycles", &v), 0);
+    EXPECT_GT(v, 0);
+
+    task_status_unregister(&st);
+    EXPECT_EQ(ut_status_get_i64("task.oltp.finished", &v), -1);
+}
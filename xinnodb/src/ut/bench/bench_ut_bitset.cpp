@@ -0,0 +1,64 @@
+// Bitmap scan benchmark: find-first-set, clear-run search, popcount and bulk fill over 4K, 64K and
+// 1M bit maps for every instruction set supported by the CPU.
+
+#include <fmt/format.h>
+#include <chrono>
+#include <cstdlib>
+
+#include "ut_bitset.hpp"
+
+static volatile ib_u64 bench_sink;
+
+template <typename Fn>
+static double bench_ns_per_op(int iterations, Fn&& fn) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) bench_sink = bench_sink + fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / iterations;
+}
+
+static void bench_map(ib_u64 nbits, const char* isa_name) {
+    ib_u64* words = (ib_u64*)std::aligned_alloc(64, ut_bitset_word_count(nbits) * sizeof(ib_u64));
+    ut_bitset bs;
+    ut_bitset_init(&bs, words, nbits);
+
+    // Mostly full map with a few holes: the shape of a busy buffer-pool free map
+    ut_bitset_set_range(&bs, 0, nbits);
+    ib_u64 seed = 0x9E3779B97F4A7C15ull;
+    for (ib_u64 i = 0; i < nbits / 4096 + 1; ++i) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        const ib_u64 b = (seed >> 11) % nbits;
+        ut_bitset_clear_range(&bs, b, b + 1 < nbits ? b + 1 : nbits);
+    }
+    ut_bitset_clear_range(&bs, nbits - 64, nbits);
+
+    const int iters = nbits >= (1ull << 20) ? 2000 : 20000;
+    const double clear_run = bench_ns_per_op(iters, [&](int) { return ut_bitset_find_clear_run(&bs, 64, 0); });
+    const double popcount  = bench_ns_per_op(iters, [&](int) { return ut_bitset_popcount_range(&bs, 0, nbits); });
+
+    // Sparse map: a single set bit at the end
+    ut_bitset_clear_range(&bs, 0, nbits);
+    ut_bitset_set(&bs, nbits - 1);
+    const double ffs       = bench_ns_per_op(iters, [&](int) { return ut_bitset_find_first_set(&bs, 0); });
+    const double fill      = bench_ns_per_op(iters, [&](int i) { ut_bitset_set_range(&bs, 3, nbits - 3); ut_bitset_clear_range(&bs, 3, nbits - 3); return (ib_u64)i; });
+
+    fmt::print("{:>8} {:>9} {:>14.1f} {:>14.1f} {:>14.1f} {:>14.1f}\n", isa_name, nbits, ffs, clear_run, popcount, fill);
+    std::free(words);
+}
+
+int main() {
+    fmt::print("{:>8} {:>9} {:>14} {:>14} {:>14} {:>14}\n", "isa", "bits", "ffs ns", "run64 ns", "popcnt ns", "set+clr ns");
+    const struct { ut_bitset_isa isa; const char* name; } isas[] = {
+        { UT_BITSET_ISA_SCALAR, "scalar" },
+        { UT_BITSET_ISA_AVX2,   "avx2"   },
+        { UT_BITSET_ISA_AVX512, "avx512" },
+    };
+    for (const auto& isa : isas) {
+        if (!ut_bitset_set_isa(isa.isa)) {
+            fmt::print("{:>8} unsupported\n", isa.name);
+            continue;
+        }
+        for (ib_u64 nbits : { 4096ull, 65536ull, 1048576ull }) bench_map(nbits, isa.name);
+    }
+    return 0;
+}
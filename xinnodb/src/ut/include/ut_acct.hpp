@@ -0,0 +1,68 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+/// \defgroup acct Resource accounting
+/// \brief Per-task resource counters
+/// \details Every scheduler task carries a `ut_acct`. While one of its steps runs, the scheduler
+/// publishes the account in a thread-local pointer, and the lower layers charge it directly:
+/// the allocator per block kind, the I/O layer per byte transferred, the scheduler itself for
+/// cycles, steps and waits. Nothing is charged outside of a task (the pointer is nullptr), and
+/// charging costs one thread-local load and a branch.
+///
+/// An account is written by the thread running its task only. Summing the accounts of the tasks
+/// of a query gives its cost; the scheduler folds the accounts of finished tasks into per-class
+/// totals of their worker.
+/// \ingroup ut
+
+/// \addtogroup acct
+/// @{
+
+/// \brief Allocation counters per account, indexed by `alloc_kind`
+constexpr ib_u32 UT_ACCT_ALLOC_KINDS = 8;
+
+/// \brief Resources consumed by a task
+struct ut_acct {
+    ib_u64 cycles;                          ///< TSC cycles of the steps run
+    ib_u64 steps;
+    ib_u64 allocs[UT_ACCT_ALLOC_KINDS];     ///< Blocks allocated, by `alloc_kind`
+    ib_u64 alloc_bytes;
+    ib_u64 io_read_bytes;
+    ib_u64 io_write_bytes;
+    ib_u64 io_waits;                        ///< Suspensions waiting for I/O
+    ib_u64 latch_waits;                     ///< Suspensions waiting for a latch
+};
+
+extern thread_local ut_acct* ut_acct_tls;
+
+void ut_acct_add(ut_acct* dst, const ut_acct* src) noexcept;
+
+inline static ut_acct* ut_acct_current() noexcept;
+inline static void     ut_acct_charge_alloc(ib_u32 kind, ib_size size) noexcept;
+inline static void     ut_acct_charge_io(ib_u64 read_bytes, ib_u64 write_bytes) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Account of the task running on this thread, nullptr outside of a task
+inline ut_acct* ut_acct_current() noexcept {
+    return ut_acct_tls;
+}
+
+inline void ut_acct_charge_alloc(ib_u32 kind, ib_size size) noexcept {
+    ut_acct* a = ut_acct_tls;
+    if (a == nullptr) return;
+    ++a->allocs[kind < UT_ACCT_ALLOC_KINDS ? kind : 0];
+    a->alloc_bytes += size;
+}
+
+inline void ut_acct_charge_io(ib_u64 read_bytes, ib_u64 write_bytes) noexcept {
+    ut_acct* a = ut_acct_tls;
+    if (a == nullptr) return;
+    a->io_read_bytes  += read_bytes;
+    a->io_write_bytes += write_bytes;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+/// \defgroup bitset Bitset
+/// \brief Bitsets and bitmap scans for allocator masks, page and lock bitmaps
+/// \details A bitset is a view over 64-byte aligned words owned by the caller (region memory, SGA,
+/// or a ut_bitset_fixed). Bits past `nbits` in the last word are always zero.
+///
+/// The word-range kernels (skip empty/full words, popcount, bulk fill) have scalar, AVX2 and
+/// AVX-512 variants selected once at runtime from the CPU features; the bit-level edges are
+/// handled by the scalar front end in this header and `ut_bitset.cpp`.
+/// \ingroup ut
+
+/// \addtogroup bitset
+/// @{
+
+/// \brief Returned by the find functions when no bit/run matches
+constexpr ib_u64 UT_BITSET_NPOS = ~0ull;
+
+/// \brief Instruction set used by the word-range kernels
+enum ut_bitset_isa {
+    UT_BITSET_ISA_SCALAR = 0,
+    UT_BITSET_ISA_AVX2   = 1,
+    UT_BITSET_ISA_AVX512 = 2,
+};
+
+/// \brief Runtime-sized bitset view
+struct ut_bitset {
+    ib_u64* words;
+    ib_u64  nbits;
+};
+
+/// \brief Number of 64-bit words needed for `nbits` bits, rounded up to a cache line
+inline static constexpr ib_u64 ut_bitset_word_count(ib_u64 nbits) noexcept {
+    return ((nbits + 511ull) / 512ull) * 8ull;
+}
+
+/// \brief Fixed-size bitset with inline storage, all bits clear
+template <ib_u64 N>
+struct ut_bitset_fixed {
+    alignas(64) ib_u64 words[ut_bitset_word_count(N)] = {};
+
+    ut_bitset view() noexcept { return ut_bitset{ words, N }; }
+};
+
+void          ut_bitset_init(ut_bitset* bs, ib_u64* words, ib_u64 nbits) noexcept;
+ib_u64        ut_bitset_find_first_set(const ut_bitset* bs, ib_u64 from) noexcept;
+ib_u64        ut_bitset_find_first_clear(const ut_bitset* bs, ib_u64 from) noexcept;
+ib_u64        ut_bitset_find_clear_run(const ut_bitset* bs, ib_u64 run_length, ib_u64 from) noexcept;
+ib_u64        ut_bitset_popcount_range(const ut_bitset* bs, ib_u64 begin, ib_u64 end) noexcept;
+void          ut_bitset_set_range(ut_bitset* bs, ib_u64 begin, ib_u64 end) noexcept;
+void          ut_bitset_clear_range(ut_bitset* bs, ib_u64 begin, ib_u64 end) noexcept;
+ut_bitset_isa ut_bitset_get_isa() noexcept;
+bool          ut_bitset_set_isa(ut_bitset_isa isa) noexcept;
+
+inline static void ut_bitset_set(ut_bitset* bs, ib_u64 bit) noexcept;
+inline static void ut_bitset_clear(ut_bitset* bs, ib_u64 bit) noexcept;
+inline static bool ut_bitset_test(const ut_bitset* bs, ib_u64 bit) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline void ut_bitset_set(ut_bitset* bs, ib_u64 bit) noexcept {
+    bs->words[bit >> 6] |= (1ull << (bit & 63ull));
+}
+
+inline void ut_bitset_clear(ut_bitset* bs, ib_u64 bit) noexcept {
+    bs->words[bit >> 6] &= ~(1ull << (bit & 63ull));
+}
+
+inline bool ut_bitset_test(const ut_bitset* bs, ib_u64 bit) noexcept {
+    return ((bs->words[bit >> 6] >> (bit & 63ull)) & 1ull) != 0ull;
+}
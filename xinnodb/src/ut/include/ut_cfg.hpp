@@ -0,0 +1,56 @@
+#pragma once
+
+#include "xinnodb.hpp"     // IWYU pragma: keep
+#include "ut_registry.hpp" // IWYU pragma: keep
+#include "ut_seqlock.hpp"  // IWYU pragma: keep
+
+/// \defgroup cfg Configuration variables
+/// \brief Process-wide registry of named settings
+/// \details The counterpart of the status registry for settings: modules register the variables
+/// they read and the API layer (ib_cfg_set(), ib_cfg_get(), ib_cfg_get_all(),
+/// ib_cfg_var_get_type()) reads and writes them by name.
+///
+/// A variable points at the storage its module reads: an `ib_bool` (IB_CFG_IBOOL), an `ib_ulint`
+/// (IB_CFG_ULINT, IB_CFG_ULONG), a `const char*` (IB_CFG_TEXT) or a function pointer (IB_CFG_CB).
+/// Numbers are checked against [min, max]. A variable with an `apply` callback validates and stores
+/// new values itself, through ut_cfg_store(); text variables need one, since the registry does not
+/// copy strings.
+///
+/// Registration, lookups by name and writes take the spin lock of the `ut_registry` holding the
+/// variables. Each variable also has a seqlock that ut_cfg_set() holds while the value is stored
+/// (by the registry or the apply callback), so ut_cfg_read() copies a consistent value from a hot
+/// path with relaxed atomic loads only: no shared line is written and readers do not contend with each other. Modules that keep their own copy (an
+/// atomic updated by the apply callback, or a `ut_seq` record for settings read together) read
+/// that instead; a setting changed while workers run takes effect whenever they next look at it.
+/// \ingroup ut
+
+/// \addtogroup cfg
+/// @{
+
+struct ut_cfg_var;
+
+/// \brief Validates and stores a new value; returns 0, or -1 to reject it
+using ut_cfg_apply_fn = int(ut_cfg_var* var, const void* value) noexcept;
+
+/// \brief A registered configuration variable
+struct ut_cfg_var {
+    ut_registry_entry entry;
+    ib_cfg_type       type;
+    void*             value;     ///< Storage of the type given by `type`
+    ut_cfg_apply_fn*  apply;     ///< nullptr: the registry stores accepted values in `value`
+    ib_ulint          min;       ///< Bounds of numeric values
+    ib_ulint          max;
+    ut_seqlock        seq;       ///< Odd while a new value is being stored
+};
+
+int    ut_cfg_register(ut_cfg_var* var, const char* name, ib_cfg_type type, void* value, ut_cfg_apply_fn* apply = nullptr,
+                       ib_ulint min = 0, ib_ulint max = ~(ib_ulint)0) noexcept;
+void   ut_cfg_unregister(ut_cfg_var* var) noexcept;
+int    ut_cfg_set(const char* name, const void* value) noexcept;
+int    ut_cfg_get(const char* name, void* out) noexcept;
+void   ut_cfg_read(const ut_cfg_var* var, void* out) noexcept;
+void   ut_cfg_store(ut_cfg_var* var, const void* value) noexcept;
+int    ut_cfg_type_of(const char* name, ib_cfg_type* type) noexcept;
+ib_u32 ut_cfg_names(const char** names, ib_u32 max) noexcept;
+
+/// @}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+#include <time.h>
+#include <x86intrin.h>
+
+/// \defgroup clock Clock
+/// \brief Cheap monotonic time sources
+/// \details Timeouts and budgets do not need nanosecond accuracy, but they are read on every
+/// scheduler pass. Two cheap sources are offered next to `CLOCK_MONOTONIC`:
+///
+/// - `UT_CLOCK_COARSE`: `CLOCK_MONOTONIC_COARSE`, a vDSO read of the last kernel tick (1-4 ms
+///   resolution, no `rdtsc`, no syscall);
+/// - `UT_CLOCK_TSC`: `rdtsc` scaled to nanoseconds with a factor calibrated once against
+///   `CLOCK_MONOTONIC`. Only used on CPUs with an invariant TSC; falls back to `CLOCK_MONOTONIC`.
+///
+/// `UT_CLOCK_MANUAL` never reads a clock: the owner of the consumer moves time explicitly (tests,
+/// deterministic simulation). Readings of different sources are not comparable.
+/// \ingroup ut
+
+/// \addtogroup clock
+/// @{
+
+/// \brief Time source
+enum ut_clock_source : ib_u32 {
+    UT_CLOCK_MANUAL    = 0,
+    UT_CLOCK_COARSE    = 1,
+    UT_CLOCK_MONOTONIC = 2,
+    UT_CLOCK_TSC       = 3,
+};
+
+/// \brief TSC to nanoseconds conversion: ns = (tsc * mult) >> shift
+struct ut_clock_tsc_scale {
+    ib_u64 mult;
+    ib_u32 shift;
+    bool   invariant;   ///< False when the TSC cannot be used as a clock
+};
+
+/// \brief Cycles per nanosecond assumed when the TSC is not usable as a clock
+constexpr ib_u64 UT_CLOCK_TSC_FALLBACK_GHZ = 3;
+
+const ut_clock_tsc_scale* ut_clock_tsc() noexcept;
+
+inline static ib_u64 ut_clock_ns(ut_clock_source source) noexcept;
+inline static ib_u64 ut_clock_posix_ns(clockid_t id) noexcept;
+inline static ib_u64 ut_clock_ns_to_tsc(ib_u64 ns) noexcept;
+inline static ib_u64 ut_clock_tsc_to_ns(ib_u64 cycles) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline ib_u64 ut_clock_posix_ns(clockid_t id) noexcept {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (ib_u64)ts.tv_sec * 1'000'000'000ull + (ib_u64)ts.tv_nsec;
+}
+
+/// \brief Current time of `source` in nanoseconds (0 for UT_CLOCK_MANUAL)
+inline ib_u64 ut_clock_ns(ut_clock_source source) noexcept {
+    switch (source) {
+    case UT_CLOCK_COARSE:
+        return ut_clock_posix_ns(CLOCK_MONOTONIC_COARSE);
+    case UT_CLOCK_MONOTONIC:
+        return ut_clock_posix_ns(CLOCK_MONOTONIC);
+    case UT_CLOCK_TSC: {
+        const ut_clock_tsc_scale* s = ut_clock_tsc();
+        if (!s->invariant) [[unlikely]] return ut_clock_posix_ns(CLOCK_MONOTONIC);
+        return (ib_u64)(((unsigned __int128)__rdtsc() * s->mult) >> s->shift);
+    }
+    case UT_CLOCK_MANUAL:
+        break;
+    }
+    return 0;
+}
+
+/// \brief Converts a duration to TSC cycles (for budgets compared against `rdtsc` deltas)
+inline ib_u64 ut_clock_ns_to_tsc(ib_u64 ns) noexcept {
+    const ut_clock_tsc_scale* s = ut_clock_tsc();
+    if (!s->invariant) return ns * UT_CLOCK_TSC_FALLBACK_GHZ;
+    return (ib_u64)(((unsigned __int128)ns << s->shift) / s->mult);
+}
+
+/// \brief Converts TSC cycles to nanoseconds (for `rdtsc` deltas and timestamps)
+inline ib_u64 ut_clock_tsc_to_ns(ib_u64 cycles) noexcept {
+    const ut_clock_tsc_scale* s = ut_clock_tsc();
+    if (!s->invariant) return cycles / UT_CLOCK_TSC_FALLBACK_GHZ;
+    return (ib_u64)(((unsigned __int128)cycles * s->mult) >> s->shift);
+}
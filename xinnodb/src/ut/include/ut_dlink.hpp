@@ -23,6 +23,7 @@ inline static void      ut_dlink_insert_prev(ut_dlink* list, ut_dlink* link) noe
 inline static void      ut_dlink_insert_next(ut_dlink* list, ut_dlink* link) noexcept;
 inline static void      ut_dlink_push(ut_dlink* stack, ut_dlink* link) noexcept;
 inline static ut_dlink* ut_dlink_pop(ut_dlink* stack) noexcept;
+inline static void      ut_dlink_splice(ut_dlink* queue, ut_dlink* list) noexcept;
 /// @}
 
 
@@ -119,3 +120,17 @@ inline ut_dlink* ut_dlink_pop(ut_dlink* stack) noexcept {
     return target;
 }
 
+/// \brief Moves every link of `list` to `queue`, behind the links already queued, in their order
+/// \details Constant time whatever the length of `list`, which is left empty.
+inline void ut_dlink_splice(ut_dlink* queue, ut_dlink* list) noexcept {
+    IB_AD(queue != nullptr);
+    IB_AD(list != nullptr);
+    if (ut_dlink_is_detached(list)) return;
+    ut_dlink* newest = list->next;
+    ut_dlink* oldest = list->prev;
+    oldest->next      = queue->next;
+    queue->next->prev = oldest;
+    newest->prev      = queue;
+    queue->next       = newest;
+    ut_dlink_init(list);
+}
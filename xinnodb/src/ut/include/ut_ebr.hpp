@@ -0,0 +1,169 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+#include <atomic>
+
+/// \defgroup ebr EBR
+/// \brief Epoch-based memory reclamation
+/// \details Safe memory reclamation for structures that are read without latches (dictionary caches,
+/// page hash, lockless `ut` lists). A writer unlinks a node and retires it; the node is handed back
+/// to its owner (normally the worker `alloc_table`) only after every participant has gone through a
+/// grace period.
+///
+/// Two reader protocols share the same participant registry and retire lists:
+///
+/// - `UT_EBR_MODE_EPOCH`: readers bracket their accesses with ut_ebr_enter() / ut_ebr_leave(), or a
+///   worker stays online and calls ut_ebr_quiescent() between tasks (QSBR). A task boundary is a
+///   grace-period checkpoint, so readers inside tasks need no per-access bookkeeping at all.
+/// - `UT_EBR_MODE_HAZARD`: readers publish the pointer they dereference with ut_ebr_protect().
+///   This is the fallback for structures whose readers may stay suspended for a long time and would
+///   otherwise hold back the epoch of the whole domain.
+///
+/// Each participant writes only to its own cache line on the read path. Reclamation is performed by
+/// the participant that retired the node, so the reclaim callback runs on the owning worker.
+/// \ingroup ut
+
+/// \addtogroup ebr
+/// @{
+
+/// \brief Maximum number of participants (workers, client threads) in a domain
+constexpr ib_u32 UT_EBR_MAX_PARTICIPANTS = 256;
+
+/// \brief Number of hazard pointer slots per participant
+constexpr ib_u32 UT_EBR_HAZARD_SLOTS = 4;
+
+/// \brief Default number of retired nodes that triggers a collection
+constexpr ib_u32 UT_EBR_COLLECT_THRESHOLD = 64;
+
+/// \brief Reader protocol used by a domain
+enum ut_ebr_mode {
+    UT_EBR_MODE_EPOCH  = 0,
+    UT_EBR_MODE_HAZARD = 1,
+};
+
+/// \brief Callback returning a retired pointer to its owner
+/// \param ctx The context registered with the participant (e.g. an `alloc_table`)
+/// \param ptr The retired pointer
+using ut_ebr_reclaim_fn = void(void* ctx, void* ptr) noexcept;
+
+/// \brief Intrusive retire list node, embedded in the retired object
+struct ut_ebr_node {
+    struct ut_ebr_node* next;
+    void*               ptr;
+    ib_u64              epoch;
+};
+
+struct ut_ebr_domain;
+
+/// \brief Per worker/thread reclamation state
+/// \details The announced epoch and the hazard slots are the only shared fields; they live in the
+/// participant's own cache line and are written only by the owner.
+struct alignas(64) ut_ebr_participant {
+    std::atomic<ib_u64>   local_epoch;                  ///< (epoch << 1) | active bit
+    std::atomic<void*>    hazard[UT_EBR_HAZARD_SLOTS];  ///< Published hazard pointers
+    alignas(64) ut_ebr_domain* domain;
+    ut_ebr_reclaim_fn*    reclaim;
+    void*                 reclaim_ctx;
+    ut_ebr_node*          limbo_head;                   ///< Oldest retired node
+    ut_ebr_node*          limbo_tail;                   ///< Newest retired node
+    ib_u64                limbo_count;
+    ib_u64                retired_total;
+    ib_u64                reclaimed_total;
+    ib_u32                index;
+    ib_u32                nesting;
+};
+
+/// \brief Reclamation domain shared by all participants
+struct ut_ebr_domain {
+    alignas(64) std::atomic<ib_u64>              global_epoch;
+    alignas(64) std::atomic<ut_ebr_participant*> participants[UT_EBR_MAX_PARTICIPANTS];
+    std::atomic<ib_u32>                          participant_hwm;
+    ut_ebr_mode                                  mode;
+    ib_u32                                       collect_threshold;
+};
+
+void   ut_ebr_domain_init(ut_ebr_domain* d, ut_ebr_mode mode, ib_u32 collect_threshold = UT_EBR_COLLECT_THRESHOLD) noexcept;
+int    ut_ebr_participant_register(ut_ebr_domain* d, ut_ebr_participant* p, ut_ebr_reclaim_fn* reclaim, void* reclaim_ctx) noexcept;
+void   ut_ebr_participant_unregister(ut_ebr_participant* p) noexcept;
+void   ut_ebr_retire(ut_ebr_participant* p, ut_ebr_node* node, void* ptr) noexcept;
+bool   ut_ebr_try_advance(ut_ebr_domain* d) noexcept;
+ib_u64 ut_ebr_collect(ut_ebr_participant* p) noexcept;
+void   ut_ebr_synchronize(ut_ebr_participant* p) noexcept;
+
+inline static void  ut_ebr_enter(ut_ebr_participant* p) noexcept;
+inline static void  ut_ebr_leave(ut_ebr_participant* p) noexcept;
+inline static void  ut_ebr_online(ut_ebr_participant* p) noexcept;
+inline static void  ut_ebr_offline(ut_ebr_participant* p) noexcept;
+inline static void  ut_ebr_quiescent(ut_ebr_participant* p) noexcept;
+inline static bool  ut_ebr_is_active(const ut_ebr_participant* p) noexcept;
+inline static void* ut_ebr_protect(ut_ebr_participant* p, ib_u32 slot, const std::atomic<void*>* src) noexcept;
+inline static void  ut_ebr_clear(ut_ebr_participant* p, ib_u32 slot) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+constexpr ib_u64 UT_EBR_ACTIVE = 1ull;
+
+/// \brief Enters a read-side critical section (nestable)
+/// \details Announces the current global epoch; the seq_cst fence orders the announcement before
+/// any load of a shared pointer in the critical section.
+inline void ut_ebr_enter(ut_ebr_participant* p) noexcept {
+    if (p->nesting++ != 0) return;
+    const ib_u64 e = p->domain->global_epoch.load(std::memory_order_relaxed);
+    p->local_epoch.store((e << 1) | UT_EBR_ACTIVE, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+/// \brief Leaves a read-side critical section
+inline void ut_ebr_leave(ut_ebr_participant* p) noexcept {
+    if (--p->nesting != 0) return;
+    const ib_u64 l = p->local_epoch.load(std::memory_order_relaxed);
+    p->local_epoch.store(l & ~UT_EBR_ACTIVE, std::memory_order_release);
+}
+
+/// \brief Marks the participant online for quiescent-state based use (worker run loops)
+inline void ut_ebr_online(ut_ebr_participant* p) noexcept { ut_ebr_enter(p); }
+
+/// \brief Marks the participant offline (idle or blocked worker); it no longer holds back epochs
+inline void ut_ebr_offline(ut_ebr_participant* p) noexcept { ut_ebr_leave(p); }
+
+/// \brief Declares a quiescent point: the participant holds no reference obtained before this call
+/// \details Called by the scheduler when a task completes or yields. Only stores when the global
+/// epoch moved, so the common case is a read of a mostly read-only cache line.
+inline void ut_ebr_quiescent(ut_ebr_participant* p) noexcept {
+    if (p->nesting == 0) return;
+    const ib_u64 e = p->domain->global_epoch.load(std::memory_order_acquire);
+    const ib_u64 announced = (e << 1) | UT_EBR_ACTIVE;
+    if (p->local_epoch.load(std::memory_order_relaxed) != announced) {
+        p->local_epoch.store(announced, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    if (p->limbo_count != 0 && p->limbo_count >= p->domain->collect_threshold) {
+        ut_ebr_collect(p);
+    }
+}
+
+inline bool ut_ebr_is_active(const ut_ebr_participant* p) noexcept {
+    return (p->local_epoch.load(std::memory_order_relaxed) & UT_EBR_ACTIVE) != 0;
+}
+
+/// \brief Loads `*src` and publishes it in hazard slot `slot`
+/// \return The protected pointer; it stays valid until ut_ebr_clear() or the slot is reused
+inline void* ut_ebr_protect(ut_ebr_participant* p, ib_u32 slot, const std::atomic<void*>* src) noexcept {
+    void* v = src->load(std::memory_order_acquire);
+    for (;;) {
+        p->hazard[slot].store(v, std::memory_order_seq_cst);
+        void* again = src->load(std::memory_order_seq_cst);
+        if (again == v) return v;
+        v = again;
+    }
+}
+
+inline void ut_ebr_clear(ut_ebr_participant* p, ib_u32 slot) noexcept {
+    p->hazard[slot].store(nullptr, std::memory_order_release);
+}
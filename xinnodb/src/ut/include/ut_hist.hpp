@@ -0,0 +1,78 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+#include <atomic>
+
+/// \defgroup hist Latency histograms
+/// \brief Fixed-size log-linear histograms
+/// \details HDR-style: values below 2^UT_HIST_SUB_BITS get a bucket each, above that every power
+/// of two is split into 2^UT_HIST_SUB_BITS linear sub-buckets, so any recorded value is known to
+/// within 1 / 2^UT_HIST_SUB_BITS (3%) whatever its magnitude, from nanoseconds to a minute.
+/// Recording is an index computation and a few relaxed loads and stores: no allocation, no lock. A
+/// histogram is written by one thread while any thread may merge it into a private one; a merge
+/// that races with a recording may see its bucket without its count, or the reverse.
+/// \ingroup ut
+
+/// \addtogroup hist
+/// @{
+
+inline static constexpr ib_u32 UT_HIST_SUB_BITS = 5;
+inline static constexpr ib_u32 UT_HIST_MAX_BITS = 36;   ///< Values from 2^36 (68 s in ns) share the last bucket
+inline static constexpr ib_u32 UT_HIST_BUCKETS  = (UT_HIST_MAX_BITS - UT_HIST_SUB_BITS + 1) << UT_HIST_SUB_BITS;
+
+struct ut_hist {
+    ib_u64 count;
+    ib_u64 sum;
+    ib_u64 min;                         ///< ~0 while empty
+    ib_u64 max;
+    ib_u64 buckets[UT_HIST_BUCKETS];
+};
+
+void   ut_hist_init(ut_hist* h) noexcept;
+void   ut_hist_merge(ut_hist* dst, const ut_hist* src) noexcept;
+ib_u64 ut_hist_percentile(const ut_hist* h, double percentile) noexcept;
+
+inline static ib_u32 ut_hist_bucket(ib_u64 value) noexcept;
+inline static ib_u64 ut_hist_bucket_high(ib_u32 bucket) noexcept;
+inline static void   ut_hist_record(ut_hist* h, ib_u64 value) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Bucket of `value`
+inline ib_u32 ut_hist_bucket(ib_u64 value) noexcept {
+    constexpr ib_u64 sub = 1ull << UT_HIST_SUB_BITS;
+    if (value < sub) return (ib_u32)value;
+    if (value >> UT_HIST_MAX_BITS != 0) return UT_HIST_BUCKETS - 1;
+    const ib_u32 msb   = 63 - (ib_u32)__builtin_clzll(value);
+    const ib_u32 shift = msb - UT_HIST_SUB_BITS;
+    return ((shift + 1) << UT_HIST_SUB_BITS) + (ib_u32)((value >> shift) - sub);
+}
+
+/// \brief Highest value that falls into `bucket`
+inline ib_u64 ut_hist_bucket_high(ib_u32 bucket) noexcept {
+    constexpr ib_u64 sub   = 1ull << UT_HIST_SUB_BITS;
+    const ib_u32     group = bucket >> UT_HIST_SUB_BITS;
+    if (group == 0) return bucket;
+    const ib_u32 shift = group - 1;
+    return ((sub + (bucket & (sub - 1)) + 1) << shift) - 1;
+}
+
+/// \brief Records `value`; only the thread that owns `h` calls this
+/// \details A single writer: a relaxed load and a store cannot lose an update, and unlike a
+/// locked read-modify-write they cost no more than plain accesses. The atomic references only
+/// keep the concurrent merges free of torn reads.
+inline void ut_hist_record(ut_hist* h, ib_u64 value) noexcept {
+    std::atomic_ref<ib_u64> bucket(h->buckets[ut_hist_bucket(value)]), count(h->count), sum(h->sum);
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    std::atomic_ref<ib_u64> min(h->min), max(h->max);
+    if (value < min.load(std::memory_order_relaxed)) min.store(value, std::memory_order_relaxed);
+    if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+#include <fmt/format.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <utility>
+
+/// \defgroup print Report output
+/// \brief Formatted output to a stream from noexcept code
+/// \details `fmt::print()` to a `FILE*` throws `std::system_error` when a write fails, which a
+/// noexcept report function turns into `std::terminate`. A `ut_print` formats into a buffer of its
+/// own, hands full buffers to `std::fwrite()` and remembers a failed write instead; reports
+/// format everything, then check ut_print_finish() once. Nothing is allocated: the buffer lives
+/// in the `ut_print`, normally on the stack of the report function.
+/// \ingroup ut
+
+/// \addtogroup print
+/// @{
+
+inline static constexpr ib_u32 UT_PRINT_BUF_SIZE = 4096;
+
+/// \brief A stream being written by a report
+struct ut_print {
+    std::FILE* out;
+    ib_u32     used;                    ///< Bytes of `buf` not written yet
+    bool       failed;                  ///< A write failed; later output is dropped
+    char       buf[UT_PRINT_BUF_SIZE];
+};
+
+/// \brief Output iterator of `fmt::format_to()` into a `ut_print`
+struct ut_print_iterator {
+    using iterator_category = std::output_iterator_tag;
+    using value_type        = void;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = void;
+
+    ut_print* p;
+
+    ut_print_iterator& operator*() noexcept { return *this; }
+    ut_print_iterator& operator++() noexcept { return *this; }
+    ut_print_iterator  operator++(int) noexcept { return *this; }
+    inline ut_print_iterator& operator=(char c) noexcept;
+};
+
+void ut_print_init(ut_print* p, std::FILE* out) noexcept;
+void ut_print_flush(ut_print* p) noexcept;
+int  ut_print_finish(ut_print* p) noexcept;
+
+template <typename... Args>
+inline static void ut_print_fmt(ut_print* p, fmt::format_string<Args...> format, Args&&... args) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline ut_print_iterator& ut_print_iterator::operator=(char c) noexcept {
+    if (p->used == UT_PRINT_BUF_SIZE) ut_print_flush(p);
+    p->buf[p->used++] = c;
+    return *this;
+}
+
+/// \brief Appends formatted output; the format string is checked at compile time
+template <typename... Args>
+inline void ut_print_fmt(ut_print* p, fmt::format_string<Args...> format, Args&&... args) noexcept {
+    if (p->failed) return;
+    fmt::format_to(ut_print_iterator{ p }, format, std::forward<Args>(args)...);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+#include <atomic>
+
+/// \defgroup proc Process identity
+/// \brief Names a process in shared memory in a way that outlives the reuse of its pid
+/// \details The kernel hands the pid of an exited process to the next one once the pid space
+/// wraps, so a pid recorded in shared memory can name a process that never touched it, and
+/// `kill(pid, 0)` then reports a dead owner as alive. An identity adds the start time of the
+/// process (field 22 of `/proc/<pid>/stat`, clock ticks since boot) to the pid:
+/// `pid << 32 | start`, the start truncated to 32 bits. A process whose identity does not match
+/// the one recorded is a different one. Without `/proc`, only the pid is checked.
+///
+/// All processes must share a pid namespace and a `/proc` mounted for it.
+/// \ingroup ut
+
+/// \addtogroup proc
+/// @{
+
+extern std::atomic<ib_u64> ut_proc_self_id;
+
+ib_u64 ut_proc_identity(ib_u32 pid) noexcept;
+ib_u64 ut_proc_self_init() noexcept;
+bool   ut_proc_pid_alive(ib_u32 pid) noexcept;
+bool   ut_proc_alive(ib_u64 id) noexcept;
+
+inline static ib_u64 ut_proc_self() noexcept;
+inline static ib_u32 ut_proc_pid(ib_u64 id) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+/// \brief Identity of this process, cached (and reset in children after fork())
+inline ib_u64 ut_proc_self() noexcept {
+    const ib_u64 id = ut_proc_self_id.load(std::memory_order_relaxed);
+    return id != 0 ? id : ut_proc_self_init();
+}
+
+/// \brief Pid part of an identity
+inline ib_u32 ut_proc_pid(ib_u64 id) noexcept {
+    return (ib_u32)(id >> 32);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+#include "ut_ebr.hpp"  // IWYU pragma: keep
+
+#include <atomic>
+
+/// \defgroup rcu RCU
+/// \brief Read-copy-update publication of read-mostly objects
+/// \details Dictionary metadata and configuration records are read by every operation and
+/// replaced rarely. A `ut_rcu_ptr<T>` points at the current immutable version: readers load the
+/// pointer and use the object without any write to shared memory; a writer builds a new version,
+/// publishes it with one atomic exchange and retires the old one to an EBR participant, which
+/// hands it to its reclaim callback after a grace period.
+///
+/// Grace periods come from the EBR domain the workers are registered with: a worker created
+/// with an EBR participant stays online and reports a quiescent point after every task step
+/// (QSBR), so a reader inside a task needs no bookkeeping at all. The rule is that of kernel
+/// RCU: a pointer obtained with ut_rcu_read() must not be used after the next suspension point
+/// (a `co_await` that parks or yields), where the step ends. Threads that are not workers
+/// bracket their reads with ut_ebr_enter() / ut_ebr_leave() on their own participant.
+///
+/// `T` embeds a `ut_ebr_node rcu_node` member for the retire list. Writers may race: each one
+/// retires the version its own exchange replaced. Read-modify-write updates (derive the new
+/// version from the current one) must be serialised by the writers, or use
+/// ut_rcu_compare_publish().
+/// \ingroup ut
+
+/// \addtogroup rcu
+/// @{
+
+/// \brief Pointer to the current version of an RCU-published object
+template <typename T>
+struct ut_rcu_ptr {
+    std::atomic<T*> ptr;
+};
+
+template <typename T>
+inline static void ut_rcu_init(ut_rcu_ptr<T>* r, T* first) noexcept;
+template <typename T>
+inline static const T* ut_rcu_read(const ut_rcu_ptr<T>* r) noexcept;
+template <typename T>
+inline static void ut_rcu_publish(ut_rcu_ptr<T>* r, T* next, ut_ebr_participant* p) noexcept;
+template <typename T>
+inline static bool ut_rcu_compare_publish(ut_rcu_ptr<T>* r, const T* expected, T* next, ut_ebr_participant* p) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+template <typename T>
+inline void ut_rcu_init(ut_rcu_ptr<T>* r, T* first) noexcept {
+    r->ptr.store(first, std::memory_order_relaxed);
+}
+
+/// \brief The current version; valid until the reader's next quiescent point
+template <typename T>
+inline const T* ut_rcu_read(const ut_rcu_ptr<T>* r) noexcept {
+    return r->ptr.load(std::memory_order_acquire);
+}
+
+/// \brief Makes `next` (fully initialised) the current version and retires the previous one to `p`
+template <typename T>
+inline void ut_rcu_publish(ut_rcu_ptr<T>* r, T* next, ut_ebr_participant* p) noexcept {
+    T* prev = r->ptr.exchange(next, std::memory_order_acq_rel);
+    if (prev != nullptr) ut_ebr_retire(p, &prev->rcu_node, prev);
+}
+
+/// \brief Publishes `next` only if `expected` is still the current version, retiring it then
+/// \return false if another writer published first; `next` is left to the caller
+template <typename T>
+inline bool ut_rcu_compare_publish(ut_rcu_ptr<T>* r, const T* expected, T* next, ut_ebr_participant* p) noexcept {
+    T* prev = (T*)expected;
+    if (!r->ptr.compare_exchange_strong(prev, next, std::memory_order_acq_rel, std::memory_order_relaxed)) return false;
+    if (prev != nullptr) ut_ebr_retire(p, &prev->rcu_node, prev);
+    return true;
+}
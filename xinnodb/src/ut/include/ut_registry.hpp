@@ -0,0 +1,42 @@
+#pragma once
+
+#include "xinnodb.hpp"  // IWYU pragma: keep
+#include "ut_dlink.hpp" // IWYU pragma: keep
+
+#include <atomic>
+
+/// \defgroup registry Named registries
+/// \brief Process-wide lists of uniquely named entries
+/// \details The storage shared by the status and the configuration registries: an intrusive list
+/// of entries embedded in the variables of each registry, kept in registration order and guarded by
+/// a spin lock. Registries are static objects initialised with UT_REGISTRY_INIT, so they are usable
+/// before any constructor runs. Lookups walk the list: registries hold tens of entries and are
+/// consulted by name only from administrative paths.
+/// \ingroup ut
+
+/// \addtogroup registry
+/// @{
+
+/// \brief The part of a registered variable that its registry owns; the first member of the variable
+struct ut_registry_entry {
+    ut_dlink    link;
+    const char* name;
+};
+
+/// \brief A list of uniquely named entries
+struct ut_registry {
+    std::atomic<bool> lock_word;
+    ut_dlink          entries;
+};
+
+/// \brief Constant initializer of the static registry `r`
+#define UT_REGISTRY_INIT(r) { { false }, { &(r).entries, &(r).entries } }
+
+void               ut_registry_lock(ut_registry* r) noexcept;
+void               ut_registry_unlock(ut_registry* r) noexcept;
+ut_registry_entry* ut_registry_find(ut_registry* r, const char* name) noexcept;
+int                ut_registry_add(ut_registry* r, ut_registry_entry* e, const char* name) noexcept;
+void               ut_registry_remove(ut_registry* r, ut_registry_entry* e) noexcept;
+ib_u32             ut_registry_names(ut_registry* r, const char** names, ib_u32 max) noexcept;
+
+/// @}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+#include <immintrin.h>
+#include <x86intrin.h>
+
+/// \defgroup rnd Random
+/// \brief Fast non-cryptographic PRNG and randomized backoff
+/// \details `ut_rnd` is a wyrand generator: one 64-bit word of state, one add and one 128-bit
+/// multiply per draw. State is never shared: each worker owns one, each task gets its own stream
+/// forked from its worker with ut_rnd_fork(), and plain threads use ut_rnd_thread(). This replaces
+/// the shared `ut_rnd_ulint_counter` of InnoDB and the `std::mt19937` statics of the examples, so
+/// sampling decisions cost a few cycles and never bounce a cache line between cores.
+///
+/// `ut_backoff` builds on it: a randomized exponential pause for spin loops and CAS retries.
+/// Randomizing the wait breaks the lock-step retries of threads that failed on the same word.
+/// \ingroup ut
+
+/// \addtogroup rnd
+/// @{
+
+/// \brief wyrand generator state
+struct ut_rnd {
+    ib_u64 state;
+};
+
+/// \brief Randomized exponential backoff state
+struct ut_backoff {
+    ut_rnd* rnd;
+    ib_u32  limit;      ///< Current upper bound of the pause count
+    ib_u32  min_limit;
+    ib_u32  max_limit;
+};
+
+/// \brief Default initial pause bound of a backoff
+constexpr ib_u32 UT_BACKOFF_MIN = 4;
+
+/// \brief Default maximum pause bound of a backoff (about 10us of `pause` on recent cores)
+constexpr ib_u32 UT_BACKOFF_MAX = 1024;
+
+ut_rnd* ut_rnd_thread() noexcept;
+
+inline static void   ut_rnd_init(ut_rnd* r, ib_u64 seed) noexcept;
+inline static ib_u64 ut_rnd_entropy() noexcept;
+inline static ib_u64 ut_rnd_next(ut_rnd* r) noexcept;
+inline static ib_u64 ut_rnd_bounded(ut_rnd* r, ib_u64 n) noexcept;
+inline static ib_u64 ut_rnd_range(ut_rnd* r, ib_u64 lo, ib_u64 hi) noexcept;
+inline static double ut_rnd_unit(ut_rnd* r) noexcept;
+inline static bool   ut_rnd_one_in(ut_rnd* r, ib_u64 n) noexcept;
+inline static void   ut_rnd_fork(ut_rnd* parent, ut_rnd* child) noexcept;
+
+inline static void ut_backoff_init(ut_backoff* b, ut_rnd* rnd, ib_u32 min_limit = UT_BACKOFF_MIN, ib_u32 max_limit = UT_BACKOFF_MAX) noexcept;
+inline static void ut_backoff_pause(ut_backoff* b) noexcept;
+inline static void ut_backoff_reset(ut_backoff* b) noexcept;
+inline static bool ut_backoff_saturated(const ut_backoff* b) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+constexpr ib_u64 UT_RND_WY0 = 0xa0761d6478bd642full;
+constexpr ib_u64 UT_RND_WY1 = 0xe7037ed1a0b428dbull;
+
+/// \brief splitmix64 finalizer, used to turn weak seeds into well-spread states
+inline static ib_u64 ut_rnd_mix(ib_u64 x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+inline void ut_rnd_init(ut_rnd* r, ib_u64 seed) noexcept {
+    r->state = ut_rnd_mix(seed + UT_RND_WY0);
+}
+
+/// \brief Cheap seed material: TSC mixed with a stack address (differs per thread and per run)
+inline ib_u64 ut_rnd_entropy() noexcept {
+    int    probe;
+    ib_u64 addr = (ib_u64)&probe;
+    return ut_rnd_mix(__rdtsc() ^ (addr << 16) ^ addr);
+}
+
+inline ib_u64 ut_rnd_next(ut_rnd* r) noexcept {
+    r->state += UT_RND_WY0;
+    const unsigned __int128 m = (unsigned __int128)r->state * (r->state ^ UT_RND_WY1);
+    return (ib_u64)(m >> 64) ^ (ib_u64)m;
+}
+
+/// \brief Uniform draw in [0, n) (multiply-shift; bias below 2^-32 for n < 2^32)
+inline ib_u64 ut_rnd_bounded(ut_rnd* r, ib_u64 n) noexcept {
+    return (ib_u64)(((unsigned __int128)ut_rnd_next(r) * n) >> 64);
+}
+
+/// \brief Uniform draw in [lo, hi]
+inline ib_u64 ut_rnd_range(ut_rnd* r, ib_u64 lo, ib_u64 hi) noexcept {
+    return lo + ut_rnd_bounded(r, hi - lo + 1);
+}
+
+/// \brief Uniform draw in [0, 1)
+inline double ut_rnd_unit(ut_rnd* r) noexcept {
+    return (double)(ut_rnd_next(r) >> 11) * 0x1.0p-53;
+}
+
+/// \brief True with probability 1/n (sampling decisions)
+inline bool ut_rnd_one_in(ut_rnd* r, ib_u64 n) noexcept {
+    return ut_rnd_bounded(r, n) == 0;
+}
+
+/// \brief Seeds `child` with an independent stream derived from `parent` (worker -> task)
+inline void ut_rnd_fork(ut_rnd* parent, ut_rnd* child) noexcept {
+    child->state = ut_rnd_mix(ut_rnd_next(parent));
+}
+
+inline void ut_backoff_init(ut_backoff* b, ut_rnd* rnd, ib_u32 min_limit, ib_u32 max_limit) noexcept {
+    b->rnd       = rnd;
+    b->min_limit = min_limit == 0 ? 1 : min_limit;
+    b->max_limit = max_limit < b->min_limit ? b->min_limit : max_limit;
+    b->limit     = b->min_limit;
+}
+
+/// \brief Spins for a random number of `pause` in [1, limit], then doubles the limit
+inline void ut_backoff_pause(ut_backoff* b) noexcept {
+    ib_u32 spins = (ib_u32)ut_rnd_bounded(b->rnd, b->limit) + 1;
+    while (spins-- != 0) _mm_pause();
+    if (b->limit < b->max_limit) {
+        b->limit = b->limit * 2 > b->max_limit ? b->max_limit : b->limit * 2;
+    }
+}
+
+inline void ut_backoff_reset(ut_backoff* b) noexcept {
+    b->limit = b->min_limit;
+}
+
+/// \brief True once the backoff reached its maximum: callers should stop spinning and park
+inline bool ut_backoff_saturated(const ut_backoff* b) noexcept {
+    return b->limit >= b->max_limit;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "xinnodb.hpp" // IWYU pragma: keep
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/// \defgroup seqlock Seqlock
+/// \brief Snapshots of small read-mostly values that readers take without writing anything
+/// \details A reader-writer latch around a value read on every operation costs every reader an
+/// atomic write to the latch word, and that cache line then bounces between all the cores that
+/// read. With a sequence lock readers only load: they read the sequence, copy the value, and
+/// read the sequence again, retrying if a writer was active (odd sequence) or came in between.
+/// Writers make the sequence odd, update the value and make it even again; they exclude each
+/// other on the same word. Readers never wait for each other and never invalidate the line.
+///
+/// `ut_seq<T>` holds a trivially copyable `T` (a configuration record, dictionary statistics,
+/// ...) stored as relaxed atomic words, so the racy copy of a reader is well defined; the
+/// whole object starts on its own cache line. For values with pointers to memory that can be
+/// freed, publish the pointer with ut_rcu instead. Keep `T` small: readers copy all of it and
+/// retry while it is being written.
+/// \ingroup ut
+
+/// \addtogroup seqlock
+/// @{
+
+/// \brief A sequence number: odd while a writer updates the data it protects
+struct ut_seqlock {
+    std::atomic<ib_u64> seq;
+};
+
+/// \brief A value of type `T` behind a seqlock
+template <typename T>
+struct alignas(64) ut_seq {
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock values are copied bytewise");
+    static constexpr ib_size WORDS = (sizeof(T) + sizeof(ib_u64) - 1) / sizeof(ib_u64);
+
+    ut_seqlock          lock;
+    std::atomic<ib_u64> words[WORDS];
+};
+
+inline static void   ut_seqlock_init(ut_seqlock* s) noexcept;
+inline static ib_u64 ut_seqlock_read_begin(const ut_seqlock* s) noexcept;
+inline static bool   ut_seqlock_read_retry(const ut_seqlock* s, ib_u64 begin) noexcept;
+inline static void   ut_seqlock_write_begin(ut_seqlock* s) noexcept;
+inline static void   ut_seqlock_write_end(ut_seqlock* s) noexcept;
+
+template <typename T>
+inline static void ut_seq_init(ut_seq<T>* s, const T& value) noexcept;
+template <typename T>
+inline static T ut_seq_read(const ut_seq<T>* s) noexcept;
+template <typename T>
+inline static void ut_seq_write(ut_seq<T>* s, const T& value) noexcept;
+
+/// @}
+
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+inline void ut_seqlock_init(ut_seqlock* s) noexcept {
+    s->seq.store(0, std::memory_order_relaxed);
+}
+
+/// \brief Starts a read: waits out an active writer and returns the sequence to validate against
+inline ib_u64 ut_seqlock_read_begin(const ut_seqlock* s) noexcept {
+    for (;;) {
+        const ib_u64 seq = s->seq.load(std::memory_order_acquire);
+        if ((seq & 1) == 0) return seq;
+        __builtin_ia32_pause();
+    }
+}
+
+/// \brief Ends a read; true if a writer came in since `begin` and the copy must be taken again
+inline bool ut_seqlock_read_retry(const ut_seqlock* s, ib_u64 begin) noexcept {
+    // Orders the loads of the data before the second load of the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s->seq.load(std::memory_order_relaxed) != begin;
+}
+
+/// \brief Excludes other writers and tells readers an update is in progress
+inline void ut_seqlock_write_begin(ut_seqlock* s) noexcept {
+    ib_u64 seq = s->seq.load(std::memory_order_relaxed);
+    for (;;) {
+        if ((seq & 1) != 0) {
+            __builtin_ia32_pause();
+            seq = s->seq.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (s->seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) break;
+    }
+    // Orders the odd sequence before the stores to the data
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void ut_seqlock_write_end(ut_seqlock* s) noexcept {
+    s->seq.fetch_add(1, std::memory_order_release);
+}
+
+template <typename T>
+inline void ut_seq_init(ut_seq<T>* s, const T& value) noexcept {
+    ut_seqlock_init(&s->lock);
+    ib_u64 words[ut_seq<T>::WORDS] = {};
+    std::memcpy(words, &value, sizeof(T));
+    for (ib_size i = 0; i < ut_seq<T>::WORDS; ++i) s->words[i].store(words[i], std::memory_order_relaxed);
+}
+
+/// \brief A consistent copy of the value; loads only
+template <typename T>
+inline T ut_seq_read(const ut_seq<T>* s) noexcept {
+    ib_u64 words[ut_seq<T>::WORDS];
+    ib_u64 begin;
+    do {
+        begin = ut_seqlock_read_begin(&s->lock);
+        for (ib_size i = 0; i < ut_seq<T>::WORDS; ++i) words[i] = s->words[i].load(std::memory_order_relaxed);
+    } while (ut_seqlock_read_retry(&s->lock, begin));
+    T value;
+    std::memcpy(&value, words, sizeof(T));
+    return value;
+}
+
+template <typename T>
+inline void ut_seq_write(ut_seq<T>* s, const T& value) noexcept {
+    ib_u64 words[ut_seq<T>::WORDS] = {};
+    std::memcpy(words, &value, sizeof(T));
+    ut_seqlock_write_begin(&s->lock);
+    for (ib_size i = 0; i < ut_seq<T>::WORDS; ++i) s->words[i].store(words[i], std::memory_order_relaxed);
+    ut_seqlock_write_end(&s->lock);
+}
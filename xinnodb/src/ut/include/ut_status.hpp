@@ -0,0 +1,39 @@
+#pragma once
+
+#include "xinnodb.hpp"     // IWYU pragma: keep
+#include "ut_registry.hpp" // IWYU pragma: keep
+
+/// \defgroup status Status variables
+/// \brief Process-wide registry of named counters
+/// \details Modules publish their counters as named variables that are read on demand through a
+/// callback, so the hot paths keep updating plain per-worker fields and pay nothing for the
+/// registry. The API layer (ib_status_get_all(), ib_status_get_i64()) is a thin wrapper over it.
+///
+/// Variables are embedded in the state of the module that registers them; the names must stay
+/// valid until the variable is unregistered. Registration and lookups take the spin lock of the
+/// `ut_registry` that holds them: they are rare compared to the updates of the counters behind
+/// them. Counters of running workers are read without synchronization and are approximate.
+/// \ingroup ut
+
+/// \addtogroup status
+/// @{
+
+struct ut_status_var;
+
+/// \brief Reads the current value of a variable
+using ut_status_fn = ib_i64(const ut_status_var* var) noexcept;
+
+/// \brief A registered status variable
+struct ut_status_var {
+    ut_registry_entry entry;
+    ut_status_fn*     read;
+    const void*       ctx;      ///< Owner state, for `read`
+    ib_u64            arg;      ///< Selector within `ctx`, for `read`
+};
+
+int    ut_status_register(ut_status_var* var, const char* name, ut_status_fn* read, const void* ctx, ib_u64 arg = 0) noexcept;
+void   ut_status_unregister(ut_status_var* var) noexcept;
+int    ut_status_get_i64(const char* name, ib_i64* out) noexcept;
+ib_u32 ut_status_names(const char** names, ib_u32 max) noexcept;
+
+/// @}
@@ -0,0 +1,10 @@
+#include "ut_acct.hpp"
+
+thread_local ut_acct* ut_acct_tls = nullptr;
+
+/// \brief Adds every counter of `src` to `dst`
+void ut_acct_add(ut_acct* dst, const ut_acct* src) noexcept {
+    const ib_u64* s = (const ib_u64*)src;
+    ib_u64*       d = (ib_u64*)dst;
+    for (ib_size i = 0; i < sizeof(ut_acct) / sizeof(ib_u64); ++i) d[i] += s[i];
+}
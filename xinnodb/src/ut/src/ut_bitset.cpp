@@ -0,0 +1,331 @@
+#include "ut_bitset.hpp"
+#include "ut_assert.hpp"
+
+#include <atomic>
+#include <immintrin.h>
+
+// Word-range kernels
+// ----------------------------------------------------------------------------------------------------------------
+// All kernels work on the word range [b, e) of a 64-byte aligned array.
+
+struct ut_bitset_kernels {
+    ut_bitset_isa isa;
+    ib_u64 (*skip_zero)(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept;  // first non-zero word
+    ib_u64 (*skip_ones)(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept;  // first word with a clear bit
+    ib_u64 (*popcount)(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept;
+    void   (*fill)(ib_u64* w, ib_u64 b, ib_u64 e, ib_u64 value) noexcept;
+};
+
+static ib_u64 ut_bitset_skip_zero_scalar(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    for (; b < e; ++b) {
+        if (w[b] != 0ull) return b;
+    }
+    return e;
+}
+
+static ib_u64 ut_bitset_skip_ones_scalar(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    for (; b < e; ++b) {
+        if (w[b] != ~0ull) return b;
+    }
+    return e;
+}
+
+static ib_u64 ut_bitset_popcount_scalar(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    ib_u64 n = 0;
+    for (; b < e; ++b) n += (ib_u64)__builtin_popcountll(w[b]);
+    return n;
+}
+
+static void ut_bitset_fill_scalar(ib_u64* w, ib_u64 b, ib_u64 e, ib_u64 value) noexcept {
+    for (; b < e; ++b) w[b] = value;
+}
+
+// AVX2: 4 words per vector, two vectors per iteration
+
+__attribute__((target("avx2")))
+static ib_u64 ut_bitset_skip_zero_avx2(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    for (; b < e && (b & 3ull) != 0; ++b) {
+        if (w[b] != 0ull) return b;
+    }
+    for (; b + 8 <= e; b += 8) {
+        const __m256i v0 = _mm256_load_si256((const __m256i*)(w + b));
+        const __m256i v1 = _mm256_load_si256((const __m256i*)(w + b + 4));
+        const __m256i v  = _mm256_or_si256(v0, v1);
+        if (!_mm256_testz_si256(v, v)) break;
+    }
+    return ut_bitset_skip_zero_scalar(w, b, e);
+}
+
+__attribute__((target("avx2")))
+static ib_u64 ut_bitset_skip_ones_avx2(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    for (; b < e && (b & 3ull) != 0; ++b) {
+        if (w[b] != ~0ull) return b;
+    }
+    for (; b + 8 <= e; b += 8) {
+        const __m256i v0 = _mm256_load_si256((const __m256i*)(w + b));
+        const __m256i v1 = _mm256_load_si256((const __m256i*)(w + b + 4));
+        const __m256i v  = _mm256_and_si256(v0, v1);
+        if (!_mm256_testc_si256(v, ones)) break;
+    }
+    return ut_bitset_skip_ones_scalar(w, b, e);
+}
+
+// Nibble lookup popcount (Mula et al.), accumulated per 64-bit lane with SAD
+__attribute__((target("avx2")))
+static ib_u64 ut_bitset_popcount_avx2(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    ib_u64 n = 0;
+    for (; b < e && (b & 3ull) != 0; ++b) n += (ib_u64)__builtin_popcountll(w[b]);
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    for (; b + 4 <= e; b += 4) {
+        const __m256i v  = _mm256_load_si256((const __m256i*)(w + b));
+        const __m256i lo = _mm256_and_si256(v, low_mask);
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        const __m256i c  = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+    }
+    alignas(32) ib_u64 lanes[4];
+    _mm256_store_si256((__m256i*)lanes, acc);
+    n += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return n + ut_bitset_popcount_scalar(w, b, e);
+}
+
+__attribute__((target("avx2")))
+static void ut_bitset_fill_avx2(ib_u64* w, ib_u64 b, ib_u64 e, ib_u64 value) noexcept {
+    for (; b < e && (b & 3ull) != 0; ++b) w[b] = value;
+    const __m256i v = _mm256_set1_epi64x((long long)value);
+    for (; b + 4 <= e; b += 4) _mm256_store_si256((__m256i*)(w + b), v);
+    ut_bitset_fill_scalar(w, b, e, value);
+}
+
+// AVX-512: 8 words (one cache line) per vector
+
+__attribute__((target("avx512f,avx512bw")))
+static ib_u64 ut_bitset_skip_zero_avx512(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    for (; b < e && (b & 7ull) != 0; ++b) {
+        if (w[b] != 0ull) return b;
+    }
+    for (; b + 8 <= e; b += 8) {
+        const __m512i  v = _mm512_load_si512((const void*)(w + b));
+        const __mmask8 m = _mm512_test_epi64_mask(v, v);
+        if (m != 0) return b + (ib_u64)__builtin_ctz((unsigned)m);
+    }
+    return ut_bitset_skip_zero_scalar(w, b, e);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static ib_u64 ut_bitset_skip_ones_avx512(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    for (; b < e && (b & 7ull) != 0; ++b) {
+        if (w[b] != ~0ull) return b;
+    }
+    for (; b + 8 <= e; b += 8) {
+        const __m512i  v = _mm512_load_si512((const void*)(w + b));
+        const __mmask8 m = _mm512_cmpneq_epi64_mask(v, ones);
+        if (m != 0) return b + (ib_u64)__builtin_ctz((unsigned)m);
+    }
+    return ut_bitset_skip_ones_scalar(w, b, e);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static ib_u64 ut_bitset_popcount_avx512(const ib_u64* w, ib_u64 b, ib_u64 e) noexcept {
+    ib_u64 n = 0;
+    for (; b < e && (b & 7ull) != 0; ++b) n += (ib_u64)__builtin_popcountll(w[b]);
+    const __m512i lut = _mm512_set_epi8(4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0,
+                                        4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0,
+                                        4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0,
+                                        4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0);
+    const __m512i low_mask = _mm512_set1_epi8(0x0f);
+    __m512i acc = _mm512_setzero_si512();
+    for (; b + 8 <= e; b += 8) {
+        const __m512i v  = _mm512_load_si512((const void*)(w + b));
+        const __m512i lo = _mm512_and_si512(v, low_mask);
+        const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask);
+        const __m512i c  = _mm512_add_epi8(_mm512_shuffle_epi8(lut, lo), _mm512_shuffle_epi8(lut, hi));
+        acc = _mm512_add_epi64(acc, _mm512_sad_epu8(c, _mm512_setzero_si512()));
+    }
+    n += (ib_u64)_mm512_reduce_add_epi64(acc);
+    return n + ut_bitset_popcount_scalar(w, b, e);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void ut_bitset_fill_avx512(ib_u64* w, ib_u64 b, ib_u64 e, ib_u64 value) noexcept {
+    for (; b < e && (b & 7ull) != 0; ++b) w[b] = value;
+    const __m512i v = _mm512_set1_epi64((long long)value);
+    for (; b + 8 <= e; b += 8) _mm512_store_si512((void*)(w + b), v);
+    ut_bitset_fill_scalar(w, b, e, value);
+}
+
+static constexpr ut_bitset_kernels UT_BITSET_KERNELS_SCALAR = {
+    UT_BITSET_ISA_SCALAR, ut_bitset_skip_zero_scalar, ut_bitset_skip_ones_scalar, ut_bitset_popcount_scalar, ut_bitset_fill_scalar
+};
+static constexpr ut_bitset_kernels UT_BITSET_KERNELS_AVX2 = {
+    UT_BITSET_ISA_AVX2, ut_bitset_skip_zero_avx2, ut_bitset_skip_ones_avx2, ut_bitset_popcount_avx2, ut_bitset_fill_avx2
+};
+static constexpr ut_bitset_kernels UT_BITSET_KERNELS_AVX512 = {
+    UT_BITSET_ISA_AVX512, ut_bitset_skip_zero_avx512, ut_bitset_skip_ones_avx512, ut_bitset_popcount_avx512, ut_bitset_fill_avx512
+};
+
+static bool ut_bitset_isa_supported(ut_bitset_isa isa) noexcept {
+    __builtin_cpu_init();
+    switch (isa) {
+        case UT_BITSET_ISA_SCALAR: return true;
+        case UT_BITSET_ISA_AVX2:   return __builtin_cpu_supports("avx2");
+        case UT_BITSET_ISA_AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        default:                   return false;
+    }
+}
+
+static const ut_bitset_kernels* ut_bitset_detect_kernels() noexcept {
+    if (ut_bitset_isa_supported(UT_BITSET_ISA_AVX512)) return &UT_BITSET_KERNELS_AVX512;
+    if (ut_bitset_isa_supported(UT_BITSET_ISA_AVX2))   return &UT_BITSET_KERNELS_AVX2;
+    return &UT_BITSET_KERNELS_SCALAR;
+}
+
+static std::atomic<const ut_bitset_kernels*> ut_bitset_kernels_current{nullptr};
+
+static inline const ut_bitset_kernels* ut_bitset_kernels_get() noexcept {
+    const ut_bitset_kernels* k = ut_bitset_kernels_current.load(std::memory_order_relaxed);
+    if (__builtin_expect(k != nullptr, 1)) return k;
+    k = ut_bitset_detect_kernels();
+    ut_bitset_kernels_current.store(k, std::memory_order_relaxed);
+    return k;
+}
+
+// Public API
+// ----------------------------------------------------------------------------------------------------------------
+
+static inline ib_u64 ut_bitset_used_words(const ut_bitset* bs) noexcept {
+    return (bs->nbits + 63ull) >> 6;
+}
+
+/// \brief Binds a bitset to caller storage and clears it
+/// \param words 64-byte aligned storage of at least ut_bitset_word_count(nbits) words
+void ut_bitset_init(ut_bitset* bs, ib_u64* words, ib_u64 nbits) noexcept {
+    IB_ASSERT_NOT_NULL(words);
+    IB_ASSERT_EQ(((ib_u64)words & 63ull), 0ull, "bitset storage must be 64B aligned; words={}", (void*)words);
+    bs->words = words;
+    bs->nbits = nbits;
+    ut_bitset_kernels_get()->fill(words, 0, ut_bitset_word_count(nbits), 0ull);
+}
+
+/// \brief Finds the first set bit at or after `from`
+/// \return The bit index or UT_BITSET_NPOS
+ib_u64 ut_bitset_find_first_set(const ut_bitset* bs, ib_u64 from) noexcept {
+    if (from >= bs->nbits) return UT_BITSET_NPOS;
+    ib_u64 wi = from >> 6;
+    ib_u64 w  = bs->words[wi] & (~0ull << (from & 63ull));
+    if (w == 0ull) {
+        wi = ut_bitset_kernels_get()->skip_zero(bs->words, wi + 1, ut_bitset_used_words(bs));
+        if (wi == ut_bitset_used_words(bs)) return UT_BITSET_NPOS;
+        w = bs->words[wi];
+    }
+    return (wi << 6) + (ib_u64)__builtin_ctzll(w);
+}
+
+/// \brief Finds the first clear bit at or after `from`
+/// \return The bit index or UT_BITSET_NPOS
+ib_u64 ut_bitset_find_first_clear(const ut_bitset* bs, ib_u64 from) noexcept {
+    if (from >= bs->nbits) return UT_BITSET_NPOS;
+    ib_u64 wi = from >> 6;
+    ib_u64 w  = ~bs->words[wi] & (~0ull << (from & 63ull));
+    if (w == 0ull) {
+        wi = ut_bitset_kernels_get()->skip_ones(bs->words, wi + 1, ut_bitset_used_words(bs));
+        if (wi == ut_bitset_used_words(bs)) return UT_BITSET_NPOS;
+        w = ~bs->words[wi];
+    }
+    const ib_u64 bit = (wi << 6) + (ib_u64)__builtin_ctzll(w);
+    return bit < bs->nbits ? bit : UT_BITSET_NPOS;
+}
+
+// First set bit in [from, limit), or limit
+static ib_u64 ut_bitset_find_set_bounded(const ut_bitset* bs, ib_u64 from, ib_u64 limit) noexcept {
+    const ib_u64 wi = from >> 6;
+    const ib_u64 w  = bs->words[wi] & (~0ull << (from & 63ull));
+    ib_u64 bit;
+    if (w != 0ull) {
+        bit = (wi << 6) + (ib_u64)__builtin_ctzll(w);
+    } else {
+        const ib_u64 we = (limit + 63ull) >> 6;
+        const ib_u64 wj = ut_bitset_kernels_get()->skip_zero(bs->words, wi + 1, we);
+        if (wj == we) return limit;
+        bit = (wj << 6) + (ib_u64)__builtin_ctzll(bs->words[wj]);
+    }
+    return bit < limit ? bit : limit;
+}
+
+/// \brief Finds the first run of `run_length` consecutive clear bits starting at or after `from`
+/// \return The index of the first bit of the run or UT_BITSET_NPOS
+ib_u64 ut_bitset_find_clear_run(const ut_bitset* bs, ib_u64 run_length, ib_u64 from) noexcept {
+    if (run_length == 0) return from < bs->nbits ? from : UT_BITSET_NPOS;
+    ib_u64 pos = from;
+    for (;;) {
+        const ib_u64 start = ut_bitset_find_first_clear(bs, pos);
+        if (start == UT_BITSET_NPOS || bs->nbits - start < run_length) return UT_BITSET_NPOS;
+        const ib_u64 limit = start + run_length;
+        const ib_u64 set   = ut_bitset_find_set_bounded(bs, start, limit);
+        if (set == limit) return start;
+        pos = set + 1;
+    }
+}
+
+/// \brief Counts the set bits in [begin, end)
+ib_u64 ut_bitset_popcount_range(const ut_bitset* bs, ib_u64 begin, ib_u64 end) noexcept {
+    IB_ASSERT_NGT(end, bs->nbits);
+    if (begin >= end) return 0;
+    const ib_u64 wb = begin >> 6;
+    const ib_u64 we = (end - 1) >> 6;
+    const ib_u64 head_mask = ~0ull << (begin & 63ull);
+    const ib_u64 tail_mask = ~0ull >> (63ull - ((end - 1) & 63ull));
+    if (wb == we) return (ib_u64)__builtin_popcountll(bs->words[wb] & head_mask & tail_mask);
+    ib_u64 n = (ib_u64)__builtin_popcountll(bs->words[wb] & head_mask)
+             + (ib_u64)__builtin_popcountll(bs->words[we] & tail_mask);
+    return n + ut_bitset_kernels_get()->popcount(bs->words, wb + 1, we);
+}
+
+static void ut_bitset_fill_range(ut_bitset* bs, ib_u64 begin, ib_u64 end, bool value) noexcept {
+    IB_ASSERT_NGT(end, bs->nbits);
+    if (begin >= end) return;
+    const ib_u64 wb = begin >> 6;
+    const ib_u64 we = (end - 1) >> 6;
+    const ib_u64 head_mask = ~0ull << (begin & 63ull);
+    const ib_u64 tail_mask = ~0ull >> (63ull - ((end - 1) & 63ull));
+    if (wb == we) {
+        const ib_u64 m = head_mask & tail_mask;
+        bs->words[wb] = value ? (bs->words[wb] | m) : (bs->words[wb] & ~m);
+        return;
+    }
+    bs->words[wb] = value ? (bs->words[wb] | head_mask) : (bs->words[wb] & ~head_mask);
+    bs->words[we] = value ? (bs->words[we] | tail_mask) : (bs->words[we] & ~tail_mask);
+    ut_bitset_kernels_get()->fill(bs->words, wb + 1, we, value ? ~0ull : 0ull);
+}
+
+/// \brief Sets the bits in [begin, end)
+void ut_bitset_set_range(ut_bitset* bs, ib_u64 begin, ib_u64 end) noexcept {
+    ut_bitset_fill_range(bs, begin, end, true);
+}
+
+/// \brief Clears the bits in [begin, end)
+void ut_bitset_clear_range(ut_bitset* bs, ib_u64 begin, ib_u64 end) noexcept {
+    ut_bitset_fill_range(bs, begin, end, false);
+}
+
+/// \brief Returns the instruction set selected for the word-range kernels
+ut_bitset_isa ut_bitset_get_isa() noexcept {
+    return ut_bitset_kernels_get()->isa;
+}
+
+/// \brief Forces the kernels of `isa` (tests and benchmarks)
+/// \return false if the CPU does not support `isa`; the selection is left unchanged
+bool ut_bitset_set_isa(ut_bitset_isa isa) noexcept {
+    if (!ut_bitset_isa_supported(isa)) return false;
+    switch (isa) {
+        case UT_BITSET_ISA_AVX512: ut_bitset_kernels_current.store(&UT_BITSET_KERNELS_AVX512, std::memory_order_relaxed); break;
+        case UT_BITSET_ISA_AVX2:   ut_bitset_kernels_current.store(&UT_BITSET_KERNELS_AVX2,   std::memory_order_relaxed); break;
+        default:                   ut_bitset_kernels_current.store(&UT_BITSET_KERNELS_SCALAR, std::memory_order_relaxed); break;
+    }
+    return true;
+}
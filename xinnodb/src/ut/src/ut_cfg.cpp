@@ -0,0 +1,134 @@
+#include "ut_cfg.hpp"
+#include "ut_assert.hpp"
+
+#include <atomic>
+#include <cstring>
+
+static ut_registry ut_cfg_vars = UT_REGISTRY_INIT(ut_cfg_vars);
+
+static ut_cfg_var* ut_cfg_find(const char* name) noexcept {
+    return (ut_cfg_var*)ut_registry_find(&ut_cfg_vars, name);
+}
+
+static ib_size ut_cfg_value_size(ib_cfg_type type) noexcept {
+    switch (type) {
+    case IB_CFG_IBOOL: return sizeof(ib_bool);
+    case IB_CFG_ULINT:
+    case IB_CFG_ULONG: return sizeof(ib_ulint);
+    case IB_CFG_TEXT:  return sizeof(const char*);
+    case IB_CFG_CB:    return sizeof(void*);
+    }
+    return 0;
+}
+
+static_assert(sizeof(ib_bool) == sizeof(ib_u8) && sizeof(ib_ulint) == sizeof(ib_u64) && sizeof(void*) == sizeof(ib_u64),
+              "configuration values are a byte or a word");
+
+/// \brief Copies the value of `var` to `out` with one relaxed atomic load
+static void ut_cfg_load(const ut_cfg_var* var, void* out) noexcept {
+    if (ut_cfg_value_size(var->type) == sizeof(ib_u64)) {
+        const ib_u64 word = std::atomic_ref<ib_u64>(*(ib_u64*)var->value).load(std::memory_order_relaxed);
+        std::memcpy(out, &word, sizeof(word));
+    } else {
+        *(ib_u8*)out = std::atomic_ref<ib_u8>(*(ib_u8*)var->value).load(std::memory_order_relaxed);
+    }
+}
+
+/// \brief Stores `*value` in `var` with one relaxed atomic store; for ut_cfg_set() and the apply
+/// callbacks, which store while ut_cfg_read() may copy the value concurrently
+void ut_cfg_store(ut_cfg_var* var, const void* value) noexcept {
+    if (ut_cfg_value_size(var->type) == sizeof(ib_u64)) {
+        ib_u64 word;
+        std::memcpy(&word, value, sizeof(word));
+        std::atomic_ref<ib_u64>(*(ib_u64*)var->value).store(word, std::memory_order_relaxed);
+    } else {
+        std::atomic_ref<ib_u8>(*(ib_u8*)var->value).store(*(const ib_u8*)value, std::memory_order_relaxed);
+    }
+}
+
+/// \brief Publishes the variable stored at `value` under `name`
+/// \return 0 on success, -1 if a variable with that name is already registered
+int ut_cfg_register(ut_cfg_var* var, const char* name, ib_cfg_type type, void* value, ut_cfg_apply_fn* apply,
+                    ib_ulint min, ib_ulint max) noexcept {
+    IB_ASSERT_NOT_NULL(var);
+    IB_ASSERT_NOT_NULL(value);
+    IB_ASSERT(type != IB_CFG_TEXT || apply != nullptr, "text variables must store their own values");
+    var->type  = type;
+    var->value = value;
+    var->apply = apply;
+    var->min   = min;
+    var->max   = max;
+    ut_seqlock_init(&var->seq);
+    return ut_registry_add(&ut_cfg_vars, &var->entry, name);
+}
+
+/// \brief Withdraws a variable; a no-op for one that failed to register
+void ut_cfg_unregister(ut_cfg_var* var) noexcept {
+    ut_registry_remove(&ut_cfg_vars, &var->entry);
+}
+
+/// \brief Sets the variable called `name` from `*value`, which has the type of the variable
+/// \return 0 on success, -1 if no such variable is registered, -2 if the value was rejected
+int ut_cfg_set(const char* name, const void* value) noexcept {
+    IB_ASSERT_NOT_NULL(value);
+    int rc = 0;
+    ut_registry_lock(&ut_cfg_vars);
+    ut_cfg_var* v = ut_cfg_find(name);
+    if (v == nullptr) {
+        rc = -1;
+    } else if ((v->type == IB_CFG_ULINT || v->type == IB_CFG_ULONG) &&
+               (*(const ib_ulint*)value < v->min || *(const ib_ulint*)value > v->max)) {
+        rc = -2;
+    } else {
+        ut_seqlock_write_begin(&v->seq);
+        if (v->apply != nullptr) {
+            rc = v->apply(v, value) == 0 ? 0 : -2;
+        } else {
+            ut_cfg_store(v, value);
+        }
+        ut_seqlock_write_end(&v->seq);
+    }
+    ut_registry_unlock(&ut_cfg_vars);
+    return rc;
+}
+
+/// \brief Copies the value of the variable called `name` to `out`, which has the type of the variable
+/// \return 0 on success, -1 if no such variable is registered
+int ut_cfg_get(const char* name, void* out) noexcept {
+    IB_ASSERT_NOT_NULL(out);
+    ut_registry_lock(&ut_cfg_vars);
+    const ut_cfg_var* v = ut_cfg_find(name);
+    if (v != nullptr) ut_cfg_read(v, out);
+    ut_registry_unlock(&ut_cfg_vars);
+    return v != nullptr ? 0 : -1;
+}
+
+/// \brief Copies the value of a registered variable to `out` without taking the registry lock
+/// \details Retries while ut_cfg_set() is storing a new value, so the copy is never torn. The
+/// value is loaded atomically, so the copy taken while a writer stores is well defined, even if
+/// it is then discarded. The caller keeps `var` registered for the duration.
+void ut_cfg_read(const ut_cfg_var* var, void* out) noexcept {
+    IB_ASSERT_NOT_NULL(var);
+    IB_ASSERT_NOT_NULL(out);
+    ib_u64 begin;
+    do {
+        begin = ut_seqlock_read_begin(&var->seq);
+        ut_cfg_load(var, out);
+    } while (ut_seqlock_read_retry(&var->seq, begin));
+}
+
+/// \return 0 on success, -1 if no such variable is registered
+int ut_cfg_type_of(const char* name, ib_cfg_type* type) noexcept {
+    IB_ASSERT_NOT_NULL(type);
+    ut_registry_lock(&ut_cfg_vars);
+    const ut_cfg_var* v = ut_cfg_find(name);
+    if (v != nullptr) *type = v->type;
+    ut_registry_unlock(&ut_cfg_vars);
+    return v != nullptr ? 0 : -1;
+}
+
+/// \brief Copies up to `max` variable names, in registration order
+/// \return The number of registered variables (may exceed `max`)
+ib_u32 ut_cfg_names(const char** names, ib_u32 max) noexcept {
+    return ut_registry_names(&ut_cfg_vars, names, max);
+}
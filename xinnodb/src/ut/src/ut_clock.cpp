@@ -0,0 +1,48 @@
+#include "ut_clock.hpp"
+
+#include <cpuid.h>
+
+static bool ut_clock_tsc_invariant() noexcept {
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) return false;
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+/// \brief Reads CLOCK_MONOTONIC and the TSC at (nearly) the same instant
+/// \details The clock read is bracketed by two TSC reads; the tightest of a few tries wins, so a
+/// preemption between the two reads does not skew the calibration.
+static void ut_clock_tsc_sample(ib_u64* ns, ib_u64* tsc) noexcept {
+    ib_u64 best_gap = ~0ull;
+    for (int i = 0; i < 16; ++i) {
+        const ib_u64 before = __rdtsc();
+        const ib_u64 now    = ut_clock_posix_ns(CLOCK_MONOTONIC);
+        const ib_u64 after  = __rdtsc();
+        if (after - before < best_gap) {
+            best_gap = after - before;
+            *ns      = now;
+            *tsc     = before + (after - before) / 2;
+        }
+    }
+}
+
+/// \brief Measures the TSC frequency against CLOCK_MONOTONIC over about 20 ms
+static ut_clock_tsc_scale ut_clock_tsc_calibrate() noexcept {
+    ut_clock_tsc_scale s{ 0, 32, false };
+    if (!ut_clock_tsc_invariant()) return s;
+    ib_u64 ns0, tsc0, ns1, tsc1;
+    ut_clock_tsc_sample(&ns0, &tsc0);
+    do {
+        ut_clock_tsc_sample(&ns1, &tsc1);
+    } while (ns1 - ns0 < 20'000'000);
+    if (tsc1 <= tsc0) return s;
+    s.mult      = (ib_u64)(((unsigned __int128)(ns1 - ns0) << s.shift) / (tsc1 - tsc0));
+    s.invariant = s.mult != 0;
+    return s;
+}
+
+/// \brief TSC scale of this machine, calibrated on first use
+const ut_clock_tsc_scale* ut_clock_tsc() noexcept {
+    static const ut_clock_tsc_scale scale = ut_clock_tsc_calibrate();
+    return &scale;
+}
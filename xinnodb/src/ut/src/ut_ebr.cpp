@@ -0,0 +1,188 @@
+#include "ut_ebr.hpp"
+#include "ut_assert.hpp"
+#include "ut_rnd.hpp"
+
+#include <algorithm>
+
+void ut_ebr_domain_init(ut_ebr_domain* d, ut_ebr_mode mode, ib_u32 collect_threshold) noexcept {
+    IB_ASSERT_NOT_NULL(d);
+    d->global_epoch.store(1, std::memory_order_relaxed);
+    for (ib_u32 i = 0; i < UT_EBR_MAX_PARTICIPANTS; ++i) {
+        d->participants[i].store(nullptr, std::memory_order_relaxed);
+    }
+    d->participant_hwm.store(0, std::memory_order_relaxed);
+    d->mode = mode;
+    d->collect_threshold = collect_threshold == 0 ? 1 : collect_threshold;
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+/// \brief Registers a participant in the domain
+/// \param reclaim Called with `reclaim_ctx` for every pointer retired by this participant once it is safe
+/// \return 0 on success, -1 when the domain is full
+int ut_ebr_participant_register(ut_ebr_domain* d, ut_ebr_participant* p, ut_ebr_reclaim_fn* reclaim, void* reclaim_ctx) noexcept {
+    IB_ASSERT_NOT_NULL(d);
+    IB_ASSERT_NOT_NULL(p);
+    IB_ASSERT_NOT_NULL(reclaim);
+
+    p->local_epoch.store(0, std::memory_order_relaxed);
+    for (ib_u32 i = 0; i < UT_EBR_HAZARD_SLOTS; ++i) {
+        p->hazard[i].store(nullptr, std::memory_order_relaxed);
+    }
+    p->domain          = d;
+    p->reclaim         = reclaim;
+    p->reclaim_ctx     = reclaim_ctx;
+    p->limbo_head      = nullptr;
+    p->limbo_tail      = nullptr;
+    p->limbo_count     = 0;
+    p->retired_total   = 0;
+    p->reclaimed_total = 0;
+    p->nesting         = 0;
+
+    for (ib_u32 i = 0; i < UT_EBR_MAX_PARTICIPANTS; ++i) {
+        ut_ebr_participant* expected = nullptr;
+        if (d->participants[i].compare_exchange_strong(expected, p, std::memory_order_acq_rel)) {
+            p->index = i;
+            ib_u32 hwm = d->participant_hwm.load(std::memory_order_relaxed);
+            while (hwm < i + 1 && !d->participant_hwm.compare_exchange_weak(hwm, i + 1, std::memory_order_acq_rel)) {
+            }
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/// \brief Drains the participant's retire list and removes it from the domain
+/// \details Waits for grace periods until every node retired by `p` has been reclaimed, so the
+/// other participants must keep passing quiescent points while this runs.
+void ut_ebr_participant_unregister(ut_ebr_participant* p) noexcept {
+    IB_ASSERT_NOT_NULL(p);
+    IB_ASSERT_EQ(p->nesting, 0u, "participant unregistered inside a critical section");
+    while (p->limbo_count != 0) {
+        ut_ebr_synchronize(p);
+        ut_ebr_collect(p);
+    }
+    p->domain->participants[p->index].store(nullptr, std::memory_order_release);
+    p->domain = nullptr;
+}
+
+/// \brief Retires `ptr`; it is handed to the participant's reclaim callback after a grace period
+/// \param node Intrusive node, usually embedded in the object pointed by `ptr`
+void ut_ebr_retire(ut_ebr_participant* p, ut_ebr_node* node, void* ptr) noexcept {
+    IB_ASSERT_NOT_NULL(node);
+    node->next  = nullptr;
+    node->ptr   = ptr;
+    node->epoch = p->domain->global_epoch.load(std::memory_order_acquire);
+    if (p->limbo_tail != nullptr) {
+        p->limbo_tail->next = node;
+    } else {
+        p->limbo_head = node;
+    }
+    p->limbo_tail = node;
+    ++p->limbo_count;
+    ++p->retired_total;
+    if (p->limbo_count >= p->domain->collect_threshold) {
+        ut_ebr_collect(p);
+    }
+}
+
+/// \brief Advances the global epoch when every active participant has observed it
+/// \return true if the epoch was advanced by this call or concurrently
+bool ut_ebr_try_advance(ut_ebr_domain* d) noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const ib_u64 e   = d->global_epoch.load(std::memory_order_acquire);
+    const ib_u32 hwm = d->participant_hwm.load(std::memory_order_acquire);
+    for (ib_u32 i = 0; i < hwm; ++i) {
+        ut_ebr_participant* p = d->participants[i].load(std::memory_order_acquire);
+        if (p == nullptr) continue;
+        const ib_u64 l = p->local_epoch.load(std::memory_order_acquire);
+        if ((l & UT_EBR_ACTIVE) != 0 && (l >> 1) != e) return false;
+    }
+    ib_u64 expected = e;
+    d->global_epoch.compare_exchange_strong(expected, e + 1, std::memory_order_acq_rel);
+    return true;
+}
+
+static ib_u32 ut_ebr_collect_hazards(ut_ebr_domain* d, void** out, ib_u32 capacity) noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ib_u32 n = 0;
+    const ib_u32 hwm = d->participant_hwm.load(std::memory_order_acquire);
+    for (ib_u32 i = 0; i < hwm; ++i) {
+        ut_ebr_participant* p = d->participants[i].load(std::memory_order_acquire);
+        if (p == nullptr) continue;
+        for (ib_u32 s = 0; s < UT_EBR_HAZARD_SLOTS; ++s) {
+            void* h = p->hazard[s].load(std::memory_order_acquire);
+            if (h != nullptr && n < capacity) out[n++] = h;
+        }
+    }
+    std::sort(out, out + n);
+    return n;
+}
+
+/// \brief Reclaims the retired nodes of `p` that are no longer reachable by any reader
+/// \return The number of reclaimed nodes
+ib_u64 ut_ebr_collect(ut_ebr_participant* p) noexcept {
+    ut_ebr_domain* d = p->domain;
+    if (p->limbo_head == nullptr) return 0;
+
+    ib_u64 reclaimed = 0;
+    if (d->mode == UT_EBR_MODE_EPOCH) {
+        // Two advances complete a grace period for the oldest node when no reader lags behind
+        for (int i = 0; i < 2; ++i) {
+            if (p->limbo_head->epoch + 2 <= d->global_epoch.load(std::memory_order_acquire)) break;
+            if (!ut_ebr_try_advance(d)) break;
+        }
+        const ib_u64 e = d->global_epoch.load(std::memory_order_acquire);
+        // Retire lists are ordered by epoch: stop at the first node still in its grace period
+        while (p->limbo_head != nullptr && p->limbo_head->epoch + 2 <= e) {
+            ut_ebr_node* node = p->limbo_head;
+            p->limbo_head = node->next;
+            p->reclaim(p->reclaim_ctx, node->ptr);
+            ++reclaimed;
+        }
+        if (p->limbo_head == nullptr) p->limbo_tail = nullptr;
+    } else {
+        void* hazards[UT_EBR_MAX_PARTICIPANTS * UT_EBR_HAZARD_SLOTS];
+        const ib_u32 n = ut_ebr_collect_hazards(d, hazards, UT_EBR_MAX_PARTICIPANTS * UT_EBR_HAZARD_SLOTS);
+        ut_ebr_node*  kept_head = nullptr;
+        ut_ebr_node** kept_link = &kept_head;
+        ut_ebr_node*  kept_tail = nullptr;
+        for (ut_ebr_node* node = p->limbo_head; node != nullptr;) {
+            ut_ebr_node* next = node->next;
+            if (std::binary_search(hazards, hazards + n, node->ptr)) {
+                *kept_link = node;
+                kept_link  = &node->next;
+                kept_tail  = node;
+            } else {
+                p->reclaim(p->reclaim_ctx, node->ptr);
+                ++reclaimed;
+            }
+            node = next;
+        }
+        *kept_link = nullptr;
+        p->limbo_head = kept_head;
+        p->limbo_tail = kept_tail;
+    }
+    p->limbo_count     -= reclaimed;
+    p->reclaimed_total += reclaimed;
+    return reclaimed;
+}
+
+/// \brief Waits for a full grace period (two epoch advances)
+/// \details Announces a quiescent state for `p` first. Spins while another participant is still
+/// inside a critical section of an older epoch.
+void ut_ebr_synchronize(ut_ebr_participant* p) noexcept {
+    ut_ebr_domain* d = p->domain;
+    if (d->mode == UT_EBR_MODE_HAZARD) return;
+    ut_ebr_quiescent(p);
+    const ib_u64 target = d->global_epoch.load(std::memory_order_acquire) + 2;
+    ut_backoff   backoff;
+    ut_backoff_init(&backoff, ut_rnd_thread());
+    while (d->global_epoch.load(std::memory_order_acquire) < target) {
+        ut_ebr_quiescent(p);
+        if (ut_ebr_try_advance(d)) {
+            ut_backoff_reset(&backoff);
+        } else {
+            ut_backoff_pause(&backoff);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#include "ut_hist.hpp"
+
+#include <cstring>
+
+void ut_hist_init(ut_hist* h) noexcept {
+    std::memset((void*)h, 0, sizeof(*h));
+    h->min = ~0ull;
+}
+
+/// \brief A word of a histogram that its owner may be recording into
+static ib_u64 ut_hist_load(const ib_u64* word) noexcept {
+    return std::atomic_ref<ib_u64>(*const_cast<ib_u64*>(word)).load(std::memory_order_relaxed);
+}
+
+/// \brief Adds the values of `src`, possibly being recorded into by its owner, to the private `dst`
+void ut_hist_merge(ut_hist* dst, const ut_hist* src) noexcept {
+    const ib_u64 min = ut_hist_load(&src->min);
+    const ib_u64 max = ut_hist_load(&src->max);
+    dst->count += ut_hist_load(&src->count);
+    dst->sum   += ut_hist_load(&src->sum);
+    if (min < dst->min) dst->min = min;
+    if (max > dst->max) dst->max = max;
+    for (ib_u32 i = 0; i < UT_HIST_BUCKETS; ++i) dst->buckets[i] += ut_hist_load(&src->buckets[i]);
+}
+
+/// \brief Value below or at which `percentile` percent of the recorded values lie
+/// \details Reported as the highest value of the bucket, capped by the largest value recorded,
+/// so p100 is the exact maximum. 0 for an empty histogram.
+ib_u64 ut_hist_percentile(const ut_hist* h, double percentile) noexcept {
+    if (h->count == 0) return 0;
+    if (percentile > 100.0) percentile = 100.0;
+    ib_u64 rank = (ib_u64)(percentile / 100.0 * (double)h->count + 0.5);
+    if (rank == 0) rank = 1;
+    ib_u64 seen = 0;
+    for (ib_u32 i = 0; i < UT_HIST_BUCKETS; ++i) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            const ib_u64 high = ut_hist_bucket_high(i);
+            return high < h->max ? high : h->max;
+        }
+    }
+    return h->max;
+}
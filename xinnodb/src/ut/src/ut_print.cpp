@@ -0,0 +1,23 @@
+#include "ut_print.hpp"
+#include "ut_assert.hpp"
+
+void ut_print_init(ut_print* p, std::FILE* out) noexcept {
+    IB_ASSERT_NOT_NULL(out);
+    p->out    = out;
+    p->used   = 0;
+    p->failed = false;
+}
+
+/// \brief Writes the buffered bytes; after a failed write they are dropped
+void ut_print_flush(ut_print* p) noexcept {
+    if (!p->failed && p->used != 0 && std::fwrite(p->buf, 1, p->used, p->out) != p->used) p->failed = true;
+    p->used = 0;
+}
+
+/// \brief Writes what is left and flushes the stream
+/// \return 0 if everything was written, -1 if a write failed
+int ut_print_finish(ut_print* p) noexcept {
+    ut_print_flush(p);
+    if (!p->failed && std::fflush(p->out) != 0) p->failed = true;
+    return p->failed ? -1 : 0;
+}
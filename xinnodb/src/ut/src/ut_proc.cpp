@@ -0,0 +1,66 @@
+#include "ut_proc.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+std::atomic<ib_u64> ut_proc_self_id{ 0 };
+
+static void ut_proc_after_fork() noexcept {
+    ut_proc_self_id.store(0, std::memory_order_relaxed);
+}
+
+/// \brief Identity of the process that has `pid` now
+/// \return 0 if the process does not exist or `/proc` cannot be read
+ib_u64 ut_proc_identity(ib_u32 pid) noexcept {
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    char          buf[512];
+    const ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+    // The command name may hold spaces and parentheses: count fields from the last ')', which is
+    // followed by field 3, the state; stop on the space before field 22
+    const char* p = std::strrchr(buf, ')');
+    if (p == nullptr) return 0;
+    for (int field = 3; field <= 22; ++field) {
+        p = std::strchr(p + 1, ' ');
+        if (p == nullptr) return 0;
+    }
+    ib_u64 start = 0;
+    for (++p; *p >= '0' && *p <= '9'; ++p) start = start * 10 + (ib_u64)(*p - '0');
+    return (ib_u64)pid << 32 | (ib_u32)start;
+}
+
+/// \brief Caches the identity of the process; children reset theirs right after fork()
+ib_u64 ut_proc_self_init() noexcept {
+    static const bool registered = pthread_atfork(nullptr, nullptr, ut_proc_after_fork) == 0;
+    (void)registered;
+    const ib_u32 pid = (ib_u32)getpid();
+    ib_u64       id  = ut_proc_identity(pid);
+    if (id == 0) id = (ib_u64)pid << 32;
+    ut_proc_self_id.store(id, std::memory_order_relaxed);
+    return id;
+}
+
+/// \brief False once no process has `pid`; a process that cannot be signalled still exists
+/// \details Cannot tell the process that had `pid` from a later one, see ut_proc_alive().
+bool ut_proc_pid_alive(ib_u32 pid) noexcept {
+    return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+}
+
+/// \brief False once the process named by `id` has exited, even if its pid was reused since
+bool ut_proc_alive(ib_u64 id) noexcept {
+    if (id == ut_proc_self()) return true;
+    const ib_u64 now = ut_proc_identity(ut_proc_pid(id));
+    if (now != 0) return now == id;
+    return ut_proc_pid_alive(ut_proc_pid(id));
+}
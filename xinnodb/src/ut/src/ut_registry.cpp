@@ -0,0 +1,64 @@
+#include "ut_registry.hpp"
+#include "ut.hpp"
+#include "ut_assert.hpp"
+
+#include <cstring>
+
+static ut_registry_entry* ut_registry_entry_of(ut_dlink* link) noexcept {
+    return (ut_registry_entry*)((char*)link - IB_OFFSET_OF(ut_registry_entry, link));
+}
+
+void ut_registry_lock(ut_registry* r) noexcept {
+    while (r->lock_word.exchange(true, std::memory_order_acquire)) {
+        while (r->lock_word.load(std::memory_order_relaxed)) __builtin_ia32_pause();
+    }
+}
+
+void ut_registry_unlock(ut_registry* r) noexcept {
+    r->lock_word.store(false, std::memory_order_release);
+}
+
+/// \brief The entry called `name`, or nullptr; the caller holds the lock
+ut_registry_entry* ut_registry_find(ut_registry* r, const char* name) noexcept {
+    for (ut_dlink* it = r->entries.next; it != &r->entries; it = it->next) {
+        ut_registry_entry* e = ut_registry_entry_of(it);
+        if (std::strcmp(e->name, name) == 0) return e;
+    }
+    return nullptr;
+}
+
+/// \brief Appends `e` under `name`; the caller has filled the rest of the variable beforehand
+/// \return 0 on success, -1 if an entry with that name is already registered (`e` is left detached)
+int ut_registry_add(ut_registry* r, ut_registry_entry* e, const char* name) noexcept {
+    IB_ASSERT_NOT_NULL(e);
+    IB_ASSERT_NOT_NULL(name);
+    e->name = name;
+    ut_registry_lock(r);
+    if (ut_registry_find(r, name) != nullptr) {
+        ut_registry_unlock(r);
+        ut_dlink_init(&e->link);
+        return -1;
+    }
+    ut_dlink_insert_prev(&r->entries, &e->link);
+    ut_registry_unlock(r);
+    return 0;
+}
+
+/// \brief Withdraws `e`; a no-op for an entry that failed to register
+void ut_registry_remove(ut_registry* r, ut_registry_entry* e) noexcept {
+    ut_registry_lock(r);
+    ut_dlink_detach(&e->link);
+    ut_registry_unlock(r);
+}
+
+/// \brief Copies up to `max` entry names, in registration order
+/// \return The number of registered entries (may exceed `max`)
+ib_u32 ut_registry_names(ut_registry* r, const char** names, ib_u32 max) noexcept {
+    ib_u32 n = 0;
+    ut_registry_lock(r);
+    for (ut_dlink* it = r->entries.next; it != &r->entries; it = it->next, ++n) {
+        if (n < max) names[n] = ut_registry_entry_of(it)->name;
+    }
+    ut_registry_unlock(r);
+    return n;
+}
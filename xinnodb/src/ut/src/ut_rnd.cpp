@@ -0,0 +1,15 @@
+#include "ut_rnd.hpp"
+
+static thread_local ut_rnd ut_rnd_tls_state;
+static thread_local bool   ut_rnd_tls_seeded = false;
+
+/// \brief Generator of the calling thread, seeded on first use
+/// \details For threads that are not scheduler workers (client threads, tests). Workers and tasks
+/// carry their own `ut_rnd` and should use that instead.
+ut_rnd* ut_rnd_thread() noexcept {
+    if (!ut_rnd_tls_seeded) [[unlikely]] {
+        ut_rnd_init(&ut_rnd_tls_state, ut_rnd_entropy());
+        ut_rnd_tls_seeded = true;
+    }
+    return &ut_rnd_tls_state;
+}
@@ -0,0 +1,41 @@
+#include "ut_status.hpp"
+#include "ut_assert.hpp"
+
+static ut_registry ut_status_vars = UT_REGISTRY_INIT(ut_status_vars);
+
+static ut_status_var* ut_status_find(const char* name) noexcept {
+    return (ut_status_var*)ut_registry_find(&ut_status_vars, name);
+}
+
+/// \brief Publishes a variable under `name`
+/// \return 0 on success, -1 if a variable with that name is already registered
+int ut_status_register(ut_status_var* var, const char* name, ut_status_fn* read, const void* ctx, ib_u64 arg) noexcept {
+    IB_ASSERT_NOT_NULL(var);
+    IB_ASSERT_NOT_NULL(read);
+    var->read = read;
+    var->ctx  = ctx;
+    var->arg  = arg;
+    return ut_registry_add(&ut_status_vars, &var->entry, name);
+}
+
+/// \brief Withdraws a variable; a no-op for one that failed to register
+void ut_status_unregister(ut_status_var* var) noexcept {
+    ut_registry_remove(&ut_status_vars, &var->entry);
+}
+
+/// \brief Reads the variable called `name`
+/// \return 0 on success, -1 if no such variable is registered
+int ut_status_get_i64(const char* name, ib_i64* out) noexcept {
+    IB_ASSERT_NOT_NULL(out);
+    ut_registry_lock(&ut_status_vars);
+    const ut_status_var* v = ut_status_find(name);
+    if (v != nullptr) *out = v->read(v);
+    ut_registry_unlock(&ut_status_vars);
+    return v != nullptr ? 0 : -1;
+}
+
+/// \brief Copies up to `max` variable names, in registration order
+/// \return The number of registered variables (may exceed `max`)
+ib_u32 ut_status_names(const char** names, ib_u32 max) noexcept {
+    return ut_registry_names(&ut_status_vars, names, max);
+}
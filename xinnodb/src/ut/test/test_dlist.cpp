@@ -33,4 +33,31 @@ TEST(DLinkTest, BasicOperations) {
     EXPECT_EQ(d3.node.next, &d1.node);
     EXPECT_EQ(d2.node.next, &d3.node);
     EXPECT_EQ(d1.node.prev, &d3.node);
-}
\ No newline at end of file
+}
+
+TEST(DLinkTest, SpliceKeepsFifoOrder) {
+    Data d[5];
+    ut_dlink queue, list;
+    ut_dlink_init(&queue);
+    ut_dlink_init(&list);
+    for (int i = 0; i < 5; ++i) d[i].value = i;
+    ut_dlink_enqueue(&queue, &d[0].node);
+    ut_dlink_enqueue(&queue, &d[1].node);
+    for (int i = 2; i < 5; ++i) ut_dlink_enqueue(&list, &d[i].node);
+
+    ut_dlink_splice(&queue, &list);
+    EXPECT_TRUE(ut_dlink_is_detached(&list));
+    for (int i = 0; i < 5; ++i) {
+        ut_dlink* link = ut_dlink_dequeue(&queue);
+        ASSERT_NE(link, nullptr);
+        EXPECT_EQ(((Data*)link)->value, i);
+    }
+    EXPECT_TRUE(ut_dlink_is_detached(&queue));
+
+    // Into an empty queue, and from an empty list
+    ut_dlink_enqueue(&list, &d[0].node);
+    ut_dlink_splice(&queue, &list);
+    ut_dlink_splice(&queue, &list);
+    EXPECT_EQ(ut_dlink_dequeue(&queue), &d[0].node);
+    EXPECT_TRUE(ut_dlink_is_detached(&queue));
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ut_bitset.hpp" // IWYU pragma: keep
+
+namespace {
+
+// Bit-by-bit reference model
+struct RefBits {
+    std::vector<bool> bits;
+
+    ib_u64 first_set(ib_u64 from) const {
+        for (ib_u64 i = from; i < bits.size(); ++i) if (bits[i]) return i;
+        return UT_BITSET_NPOS;
+    }
+    ib_u64 clear_run(ib_u64 k, ib_u64 from) const {
+        ib_u64 run = 0;
+        for (ib_u64 i = from; i < bits.size(); ++i) {
+            run = bits[i] ? 0 : run + 1;
+            if (run == k) return i + 1 - k;
+        }
+        return UT_BITSET_NPOS;
+    }
+    ib_u64 popcount(ib_u64 b, ib_u64 e) const {
+        ib_u64 n = 0;
+        for (ib_u64 i = b; i < e; ++i) n += bits[i] ? 1 : 0;
+        return n;
+    }
+};
+
+class UtBitsetIsaTest : public ::testing::TestWithParam<ut_bitset_isa> {
+protected:
+    ut_bitset_isa saved = UT_BITSET_ISA_SCALAR;
+    void SetUp() override {
+        saved = ut_bitset_get_isa();
+        if (!ut_bitset_set_isa(GetParam())) GTEST_SKIP() << "ISA not supported on this CPU";
+    }
+    void TearDown() override { ut_bitset_set_isa(saved); }
+};
+
+} // namespace
+
+TEST(UtBitset, FixedViewStartsClear) {
+    ut_bitset_fixed<1000> storage;
+    ut_bitset             bs = storage.view();
+    EXPECT_EQ(bs.nbits, 1000u);
+    EXPECT_EQ(ut_bitset_find_first_set(&bs, 0), UT_BITSET_NPOS);
+    EXPECT_EQ(ut_bitset_popcount_range(&bs, 0, 1000), 0u);
+    ut_bitset_set(&bs, 999);
+    EXPECT_EQ(ut_bitset_find_first_set(&bs, 0), 999u);
+}
+
+TEST(UtBitset, FixedSetTestClear) {
+    ut_bitset_fixed<4096> storage;
+    ut_bitset bs;
+    ut_bitset_init(&bs, storage.words, 4096);
+    EXPECT_EQ(ut_bitset_find_first_set(&bs, 0), UT_BITSET_NPOS);
+    EXPECT_EQ(ut_bitset_find_first_clear(&bs, 0), 0u);
+
+    ut_bitset_set(&bs, 4095);
+    EXPECT_TRUE(ut_bitset_test(&bs, 4095));
+    EXPECT_EQ(ut_bitset_find_first_set(&bs, 0), 4095u);
+    ut_bitset_clear(&bs, 4095);
+    EXPECT_FALSE(ut_bitset_test(&bs, 4095));
+
+    ut_bitset_set_range(&bs, 0, 4096);
+    EXPECT_EQ(ut_bitset_popcount_range(&bs, 0, 4096), 4096u);
+    EXPECT_EQ(ut_bitset_find_first_clear(&bs, 0), UT_BITSET_NPOS);
+    EXPECT_EQ(ut_bitset_find_clear_run(&bs, 1, 0), UT_BITSET_NPOS);
+}
+
+TEST(UtBitset, RuntimeSizedTailBits) {
+    const ib_u64 nbits = 1000; // not a multiple of 64
+    ib_u64* words = (ib_u64*)std::aligned_alloc(64, ut_bitset_word_count(nbits) * sizeof(ib_u64));
+    ut_bitset bs;
+    ut_bitset_init(&bs, words, nbits);
+    ut_bitset_set_range(&bs, 0, nbits);
+    EXPECT_EQ(ut_bitset_find_first_clear(&bs, 0), UT_BITSET_NPOS);
+    ut_bitset_clear_range(&bs, 990, 1000);
+    EXPECT_EQ(ut_bitset_find_clear_run(&bs, 10, 0), 990u);
+    EXPECT_EQ(ut_bitset_find_clear_run(&bs, 11, 0), UT_BITSET_NPOS);
+    std::free(words);
+}
+
+TEST_P(UtBitsetIsaTest, MatchesReferenceOnRandomMaps) {
+    std::mt19937_64 gen(42);
+    for (ib_u64 nbits : {64ull, 4096ull, 65536ull + 37ull}) {
+        ib_u64* words = (ib_u64*)std::aligned_alloc(64, ut_bitset_word_count(nbits) * sizeof(ib_u64));
+        ut_bitset bs;
+        ut_bitset_init(&bs, words, nbits);
+        RefBits ref;
+        ref.bits.assign(nbits, false);
+
+        // Sparse random bits plus some dense ranges to exercise both skip kernels
+        for (int i = 0; i < 64; ++i) {
+            ib_u64 b = gen() % nbits;
+            ut_bitset_set(&bs, b);
+            ref.bits[b] = true;
+        }
+        ib_u64 rb = gen() % nbits, re = rb + (gen() % (nbits - rb + 1));
+        ut_bitset_set_range(&bs, rb, re);
+        for (ib_u64 i = rb; i < re; ++i) ref.bits[i] = true;
+        ib_u64 cb = gen() % nbits, ce = cb + (gen() % (nbits - cb + 1));
+        ut_bitset_clear_range(&bs, cb, ce);
+        for (ib_u64 i = cb; i < ce; ++i) ref.bits[i] = false;
+
+        for (int q = 0; q < 200; ++q) {
+            ib_u64 from = gen() % nbits;
+            ASSERT_EQ(ut_bitset_find_first_set(&bs, from), ref.first_set(from));
+            ib_u64 k = 1 + gen() % 700;
+            ASSERT_EQ(ut_bitset_find_clear_run(&bs, k, from), ref.clear_run(k, from)) << "k=" << k << " from=" << from;
+            ib_u64 b = gen() % nbits, e = b + (gen() % (nbits - b + 1));
+            ASSERT_EQ(ut_bitset_popcount_range(&bs, b, e), ref.popcount(b, e));
+        }
+        std::free(words);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllIsas, UtBitsetIsaTest,
+    ::testing::Values(UT_BITSET_ISA_SCALAR, UT_BITSET_ISA_AVX2, UT_BITSET_ISA_AVX512));
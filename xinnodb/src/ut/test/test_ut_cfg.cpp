@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "ut_cfg.hpp" // IWYU pragma: keep
+
+namespace {
+
+const char* canonical_mode(const char* s) noexcept {
+    if (std::strcmp(s, "fast") == 0) return "fast";
+    if (std::strcmp(s, "safe") == 0) return "safe";
+    return nullptr;
+}
+
+int apply_mode(ut_cfg_var* var, const void* value) noexcept {
+    const char* mode = canonical_mode(*(const char* const*)value);
+    if (mode == nullptr) return -1;
+    ut_cfg_store(var, &mode);
+    return 0;
+}
+
+} // namespace
+
+TEST(UtCfg, SetsNumbersWithinBounds) {
+    ib_ulint   size = 16;
+    ut_cfg_var var;
+    ASSERT_EQ(ut_cfg_register(&var, "test.cfg.size", IB_CFG_ULINT, &size, nullptr, 1, 64), 0);
+
+    ib_ulint v = 32;
+    EXPECT_EQ(ut_cfg_set("test.cfg.size", &v), 0);
+    EXPECT_EQ(size, 32u);
+    v = 65;
+    EXPECT_EQ(ut_cfg_set("test.cfg.size", &v), -2);
+    v = 0;
+    EXPECT_EQ(ut_cfg_set("test.cfg.size", &v), -2);
+    EXPECT_EQ(size, 32u);
+
+    ib_ulint    out  = 0;
+    ib_cfg_type type = IB_CFG_CB;
+    EXPECT_EQ(ut_cfg_get("test.cfg.size", &out), 0);
+    EXPECT_EQ(out, 32u);
+    EXPECT_EQ(ut_cfg_type_of("test.cfg.size", &type), 0);
+    EXPECT_EQ(type, IB_CFG_ULINT);
+
+    ut_cfg_unregister(&var);
+    EXPECT_EQ(ut_cfg_set("test.cfg.size", &v), -1);
+    EXPECT_EQ(ut_cfg_get("test.cfg.size", &out), -1);
+}
+
+TEST(UtCfg, TextGoesThroughTheApplyCallback) {
+    const char* mode = "safe";
+    ut_cfg_var  var;
+    ASSERT_EQ(ut_cfg_register(&var, "test.cfg.mode", IB_CFG_TEXT, &mode, apply_mode), 0);
+
+    char        buf[] = "fast";
+    const char* in    = buf;
+    EXPECT_EQ(ut_cfg_set("test.cfg.mode", &in), 0);
+    EXPECT_STREQ(mode, "fast");
+    EXPECT_NE(mode, buf);   // the canonical literal, not the caller's buffer
+    in = "bogus";
+    EXPECT_EQ(ut_cfg_set("test.cfg.mode", &in), -2);
+    EXPECT_STREQ(mode, "fast");
+    ut_cfg_unregister(&var);
+}
+
+TEST(UtCfg, RejectsDuplicateNamesAndListsTheRest) {
+    ib_bool    a = true, b = false;
+    ut_cfg_var va, vb;
+    ASSERT_EQ(ut_cfg_register(&va, "test.cfg.flag", IB_CFG_IBOOL, &a), 0);
+    EXPECT_EQ(ut_cfg_register(&vb, "test.cfg.flag", IB_CFG_IBOOL, &b), -1);
+    ut_cfg_unregister(&vb);
+
+    const char* names[64];
+    const ib_u32 n = ut_cfg_names(names, 64);
+    bool found = false;
+    for (ib_u32 i = 0; i < n && i < 64; ++i) found |= std::strcmp(names[i], "test.cfg.flag") == 0;
+    EXPECT_TRUE(found);
+    ut_cfg_unregister(&va);
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "ut_clock.hpp" // IWYU pragma: keep
+
+TEST(UtClockTest, SourcesAreMonotonic) {
+    for (ut_clock_source s : { UT_CLOCK_COARSE, UT_CLOCK_MONOTONIC, UT_CLOCK_TSC }) {
+        ib_u64 prev = ut_clock_ns(s);
+        for (int i = 0; i < 1000; ++i) {
+            ib_u64 now = ut_clock_ns(s);
+            EXPECT_GE(now, prev);
+            prev = now;
+        }
+    }
+    EXPECT_EQ(ut_clock_ns(UT_CLOCK_MANUAL), 0u);
+}
+
+TEST(UtClockTest, TscTracksTheMonotonicClock) {
+    if (!ut_clock_tsc()->invariant) GTEST_SKIP() << "no invariant TSC";
+    const ib_u64 mono0 = ut_clock_ns(UT_CLOCK_MONOTONIC);
+    const ib_u64 tsc0  = ut_clock_ns(UT_CLOCK_TSC);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const ib_u64 mono = ut_clock_ns(UT_CLOCK_MONOTONIC) - mono0;
+    const ib_u64 tsc  = ut_clock_ns(UT_CLOCK_TSC) - tsc0;
+    EXPECT_NEAR((double)tsc, (double)mono, mono * 0.1);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ut_ebr.hpp" // IWYU pragma: keep
+
+namespace {
+
+struct Node {
+    ut_ebr_node        ebr;
+    std::atomic<int>   canary;
+};
+
+struct Reclaimed {
+    std::atomic<ib_u64> count{0};
+};
+
+void count_reclaim(void* ctx, void* ptr) noexcept {
+    static_cast<Reclaimed*>(ctx)->count.fetch_add(1, std::memory_order_relaxed);
+    static_cast<Node*>(ptr)->canary.store(0xDEAD, std::memory_order_relaxed);
+}
+
+void delete_reclaim(void* ctx, void* ptr) noexcept {
+    static_cast<Reclaimed*>(ctx)->count.fetch_add(1, std::memory_order_relaxed);
+    Node* n = static_cast<Node*>(ptr);
+    n->canary.store(0xDEAD, std::memory_order_relaxed);
+    delete n;
+}
+
+} // namespace
+
+TEST(UtEbr, RetireReclaimsAfterGracePeriod) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 1000);
+    ut_ebr_participant p;
+    Reclaimed r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &p, &count_reclaim, &r), 0);
+
+    Node n{};
+    ut_ebr_retire(&p, &n.ebr, &n);
+    EXPECT_EQ(p.limbo_count, 1u);
+    EXPECT_EQ(ut_ebr_collect(&p), 1u); // advances twice: no active reader
+    EXPECT_EQ(r.count.load(), 1u);
+    EXPECT_EQ(p.limbo_count, 0u);
+
+    ut_ebr_participant_unregister(&p);
+    delete d;
+}
+
+TEST(UtEbr, ActiveReaderHoldsBackReclamation) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 1000);
+    ut_ebr_participant writer, reader;
+    Reclaimed r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &count_reclaim, &r), 0);
+    ASSERT_EQ(ut_ebr_participant_register(d, &reader, &count_reclaim, &r), 0);
+
+    ut_ebr_enter(&reader);
+    Node n{};
+    ut_ebr_retire(&writer, &n.ebr, &n);
+    for (int i = 0; i < 8; ++i) ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 0u);
+
+    ut_ebr_leave(&reader);
+    ut_ebr_collect(&writer);
+    ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 1u);
+
+    ut_ebr_participant_unregister(&reader);
+    ut_ebr_participant_unregister(&writer);
+    delete d;
+}
+
+TEST(UtEbr, QuiescentPointIsCheckpoint) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 1000);
+    ut_ebr_participant writer, worker;
+    Reclaimed r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &count_reclaim, &r), 0);
+    ASSERT_EQ(ut_ebr_participant_register(d, &worker, &count_reclaim, &r), 0);
+
+    ut_ebr_online(&worker);
+    Node n{};
+    ut_ebr_retire(&writer, &n.ebr, &n);
+    ut_ebr_collect(&writer);
+    ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 0u);
+
+    // Worker finishes tasks: each completion is a quiescent point
+    ut_ebr_quiescent(&worker);
+    ut_ebr_collect(&writer);
+    ut_ebr_quiescent(&worker);
+    ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 1u);
+
+    ut_ebr_offline(&worker);
+    ut_ebr_participant_unregister(&worker);
+    ut_ebr_participant_unregister(&writer);
+    delete d;
+}
+
+TEST(UtEbr, HazardPointerProtectsNode) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_HAZARD, 1000);
+    ut_ebr_participant writer, reader;
+    Reclaimed r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &count_reclaim, &r), 0);
+    ASSERT_EQ(ut_ebr_participant_register(d, &reader, &count_reclaim, &r), 0);
+
+    Node a{}, b{};
+    std::atomic<void*> head{&a};
+    void* seen = ut_ebr_protect(&reader, 0, &head);
+    EXPECT_EQ(seen, &a);
+
+    head.store(&b);
+    ut_ebr_retire(&writer, &a.ebr, &a);
+    EXPECT_EQ(ut_ebr_collect(&writer), 0u);
+
+    ut_ebr_clear(&reader, 0);
+    EXPECT_EQ(ut_ebr_collect(&writer), 1u);
+
+    ut_ebr_participant_unregister(&reader);
+    ut_ebr_participant_unregister(&writer);
+    delete d;
+}
+
+TEST(UtEbr, ConcurrentReadersNeverSeeReclaimedNode) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 16);
+    Reclaimed r;
+
+    std::atomic<Node*> shared{new Node{{}, 1}};
+    std::atomic<bool>  stop{false};
+    std::atomic<int>   failures{0};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            ut_ebr_participant p;
+            Reclaimed unused;
+            ASSERT_EQ(ut_ebr_participant_register(d, &p, &count_reclaim, &unused), 0);
+            ut_ebr_online(&p);
+            while (!stop.load(std::memory_order_relaxed)) {
+                Node* n = shared.load(std::memory_order_acquire);
+                if (n->canary.load(std::memory_order_relaxed) != 1) failures.fetch_add(1);
+                ut_ebr_quiescent(&p);
+            }
+            ut_ebr_offline(&p);
+            ut_ebr_participant_unregister(&p);
+        });
+    }
+
+    ut_ebr_participant writer;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &delete_reclaim, &r), 0);
+    for (int i = 0; i < 20000; ++i) {
+        Node* old = shared.exchange(new Node{{}, 1}, std::memory_order_acq_rel);
+        ut_ebr_retire(&writer, &old->ebr, old);
+    }
+    stop.store(true);
+    for (auto& t : readers) t.join();
+    ut_ebr_participant_unregister(&writer);
+
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(r.count.load(), 20000u);
+    delete shared.load();
+    delete d;
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "ut_hist.hpp" // IWYU pragma: keep
+#include "ut_rnd.hpp"  // IWYU pragma: keep
+
+TEST(UtHist, BucketsAreContiguousAndWithinRelativeError) {
+    EXPECT_EQ(ut_hist_bucket(0), 0u);
+    EXPECT_EQ(ut_hist_bucket(31), 31u);
+    EXPECT_EQ(ut_hist_bucket(32), 32u);
+    EXPECT_EQ(ut_hist_bucket(~0ull), UT_HIST_BUCKETS - 1);
+    for (ib_u32 b = 0; b + 1 < UT_HIST_BUCKETS; ++b) {
+        const ib_u64 high = ut_hist_bucket_high(b);
+        ASSERT_EQ(ut_hist_bucket(high), b);
+        ASSERT_EQ(ut_hist_bucket(high + 1), b + 1);
+    }
+    for (ib_u64 v : { 100ull, 12'345ull, 1'000'000ull, 987'654'321ull }) {
+        const ib_u64 high = ut_hist_bucket_high(ut_hist_bucket(v));
+        EXPECT_GE(high, v);
+        EXPECT_LE((double)(high - v), (double)v / 32.0) << v;
+    }
+}
+
+TEST(UtHist, PercentilesOfMergedHistograms) {
+    ut_hist a, b, all;
+    ut_hist_init(&a);
+    ut_hist_init(&b);
+    ut_hist_init(&all);
+    EXPECT_EQ(ut_hist_percentile(&all, 99.0), 0u);
+
+    // 999 fast values on one shard, a single slow one on the other
+    for (ib_u64 i = 1; i <= 999; ++i) ut_hist_record(&a, 1000 + i);
+    ut_hist_record(&b, 50'000'000);
+    ut_hist_merge(&all, &a);
+    ut_hist_merge(&all, &b);
+
+    EXPECT_EQ(all.count, 1000u);
+    EXPECT_EQ(all.min, 1001u);
+    EXPECT_EQ(all.max, 50'000'000u);
+    const ib_u64 p50 = ut_hist_percentile(&all, 50.0);
+    EXPECT_GE(p50, 1500u);
+    EXPECT_LE(p50, 1500u + 1500u / 32);
+    EXPECT_LE(ut_hist_percentile(&all, 99.9), 2048u);
+    EXPECT_EQ(ut_hist_percentile(&all, 100.0), 50'000'000u);
+}
+
+TEST(UtHist, MergesWhileTheOwnerRecords) {
+    constexpr ib_u64  N = 200'000;
+    ut_hist           h;
+    std::atomic<bool> done{ false };
+    ut_hist_init(&h);
+    std::thread owner([&] {
+        for (ib_u64 i = 1; i <= N; ++i) ut_hist_record(&h, i);
+        done.store(true, std::memory_order_release);
+    });
+    ib_u64 last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+        ut_hist snap;
+        ut_hist_init(&snap);
+        ut_hist_merge(&snap, &h);
+        EXPECT_GE(snap.count, last);   // counts only grow
+        EXPECT_LE(snap.count, N);
+        last = snap.count;
+    }
+    owner.join();
+
+    ut_hist all;
+    ut_hist_init(&all);
+    ut_hist_merge(&all, &h);
+    EXPECT_EQ(all.count, N);
+    EXPECT_EQ(all.sum, N * (N + 1) / 2);
+    EXPECT_EQ(all.min, 1u);
+    EXPECT_EQ(all.max, N);
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "ut_print.hpp" // IWYU pragma: keep
+
+TEST(UtPrint, OutputLongerThanTheBufferIsWrittenWhole) {
+    char*       buf  = nullptr;
+    std::size_t size = 0;
+    std::FILE*  out  = open_memstream(&buf, &size);
+    ut_print    p;
+    ut_print_init(&p, out);
+    std::string expected;
+    for (ib_u32 i = 0; i < UT_PRINT_BUF_SIZE; ++i) {
+        ut_print_fmt(&p, "{},", i);
+        expected += std::to_string(i) + ",";
+    }
+    EXPECT_EQ(ut_print_finish(&p), 0);
+    std::fclose(out);
+    EXPECT_EQ(std::string(buf, size), expected);
+    std::free(buf);
+}
+
+TEST(UtPrint, WriteErrorsAreReturnedNotThrown) {
+    std::FILE* full = std::fopen("/dev/full", "w");
+    if (full == nullptr) GTEST_SKIP() << "no /dev/full";
+    std::setvbuf(full, nullptr, _IONBF, 0);
+    ut_print p;
+    ut_print_init(&p, full);
+    for (ib_u32 i = 0; i < UT_PRINT_BUF_SIZE; ++i) ut_print_fmt(&p, "{:>8}", i);
+    EXPECT_TRUE(p.failed);
+    EXPECT_EQ(ut_print_finish(&p), -1);
+    std::fclose(full);
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ut_proc.hpp" // IWYU pragma: keep
+
+TEST(UtProcTest, SelfIsCachedAndAlive) {
+    const ib_u64 self = ut_proc_self();
+    EXPECT_EQ(ut_proc_pid(self), (ib_u32)getpid());
+    EXPECT_EQ(ut_proc_identity((ib_u32)getpid()), self);
+    EXPECT_TRUE(ut_proc_alive(self));
+}
+
+TEST(UtProcTest, ChildHasItsOwnIdentity) {
+    const ib_u64 parent = ut_proc_self();
+    int          fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    const pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        const ib_u64 id = ut_proc_self();
+        _exit(write(fds[1], &id, sizeof(id)) == sizeof(id) ? 0 : 1);
+    }
+    ib_u64 id = 0;
+    ASSERT_EQ(read(fds[0], &id, sizeof(id)), (ssize_t)sizeof(id));
+    close(fds[0]);
+    close(fds[1]);
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_EQ(ut_proc_pid(id), (ib_u32)child);
+    EXPECT_NE(id, parent);
+    EXPECT_FALSE(ut_proc_alive(id));
+    EXPECT_FALSE(ut_proc_pid_alive((ib_u32)child));
+}
+
+TEST(UtProcTest, AnotherStartTimeIsAnotherProcess) {
+    const ib_u64 self = ut_proc_self();
+    EXPECT_FALSE(ut_proc_alive(self ^ 1));
+    EXPECT_TRUE(ut_proc_pid_alive(ut_proc_pid(self ^ 1)));
+}
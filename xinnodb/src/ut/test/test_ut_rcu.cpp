@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ut_rcu.hpp" // IWYU pragma: keep
+
+namespace {
+
+/// An immutable version of some metadata
+struct Version {
+    ut_ebr_node      rcu_node;
+    ib_u64           id;
+    std::atomic<int> canary;
+};
+
+struct Reclaimed {
+    std::atomic<ib_u64> count{ 0 };
+};
+
+void delete_version(void* ctx, void* ptr) noexcept {
+    static_cast<Reclaimed*>(ctx)->count.fetch_add(1, std::memory_order_relaxed);
+    Version* v = static_cast<Version*>(ptr);
+    v->canary.store(0xDEAD, std::memory_order_relaxed);
+    delete v;
+}
+
+Version* make_version(ib_u64 id) {
+    Version* v = new Version{};
+    v->id      = id;
+    v->canary.store(0x600D, std::memory_order_relaxed);
+    return v;
+}
+
+} // namespace
+
+TEST(UtRcu, PublishRetiresThePreviousVersion) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 1000);
+    ut_ebr_participant writer;
+    Reclaimed          r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &delete_version, &r), 0);
+
+    ut_rcu_ptr<Version> ptr;
+    ut_rcu_init(&ptr, make_version(1));
+    EXPECT_EQ(ut_rcu_read(&ptr)->id, 1u);
+
+    ut_rcu_publish(&ptr, make_version(2), &writer);
+    EXPECT_EQ(ut_rcu_read(&ptr)->id, 2u);
+    EXPECT_EQ(writer.limbo_count, 1u);
+    ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 1u);
+
+    ut_ebr_participant_unregister(&writer);
+    delete ut_rcu_read(&ptr);
+    delete d;
+}
+
+TEST(UtRcu, ComparePublishFailsAgainstAStaleVersion) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 1000);
+    ut_ebr_participant writer;
+    Reclaimed          r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &delete_version, &r), 0);
+
+    ut_rcu_ptr<Version> ptr;
+    ut_rcu_init(&ptr, make_version(1));
+    const Version* seen = ut_rcu_read(&ptr);
+    ASSERT_TRUE(ut_rcu_compare_publish(&ptr, seen, make_version(2), &writer));
+
+    Version* lost = make_version(3);
+    EXPECT_FALSE(ut_rcu_compare_publish(&ptr, seen, lost, &writer));
+    EXPECT_EQ(ut_rcu_read(&ptr)->id, 2u);
+    delete lost;
+
+    ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 1u);
+    ut_ebr_participant_unregister(&writer);
+    delete ut_rcu_read(&ptr);
+    delete d;
+}
+
+TEST(UtRcu, QuiescentReaderHoldsBackReclamationUntilItsNextCheckpoint) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 1000);
+    ut_ebr_participant writer, worker;
+    Reclaimed          r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &delete_version, &r), 0);
+    ASSERT_EQ(ut_ebr_participant_register(d, &worker, &delete_version, &r), 0);
+
+    ut_rcu_ptr<Version> ptr;
+    ut_rcu_init(&ptr, make_version(1));
+
+    // A worker is online between its quiescent points, like a scheduler worker running a step
+    ut_ebr_online(&worker);
+    const Version* held = ut_rcu_read(&ptr);
+    ut_rcu_publish(&ptr, make_version(2), &writer);
+    for (int i = 0; i < 8; ++i) ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 0u);
+    EXPECT_EQ(held->canary.load(), 0x600D);
+    EXPECT_EQ(held->id, 1u);
+
+    ut_ebr_quiescent(&worker);   // the step ends: `held` is dead
+    ut_ebr_collect(&writer);
+    ut_ebr_quiescent(&worker);
+    ut_ebr_collect(&writer);
+    EXPECT_EQ(r.count.load(), 1u);
+
+    ut_ebr_offline(&worker);
+    ut_ebr_participant_unregister(&worker);
+    ut_ebr_participant_unregister(&writer);
+    delete ut_rcu_read(&ptr);
+    delete d;
+}
+
+TEST(UtRcu, ReadersSeeOnlyLiveVersions) {
+    auto* d = new ut_ebr_domain;
+    ut_ebr_domain_init(d, UT_EBR_MODE_EPOCH, 64);
+    ut_ebr_participant writer;
+    Reclaimed          r;
+    ASSERT_EQ(ut_ebr_participant_register(d, &writer, &delete_version, &r), 0);
+
+    ut_rcu_ptr<Version> ptr;
+    ut_rcu_init(&ptr, make_version(0));
+    std::atomic<bool>   stop{ false };
+    std::atomic<ib_u64> dead{ 0 };
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            ut_ebr_participant p;
+            ut_ebr_participant_register(d, &p, &delete_version, &r);
+            ut_ebr_online(&p);
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 16; ++i) {
+                    if (ut_rcu_read(&ptr)->canary.load(std::memory_order_relaxed) != 0x600D) dead.fetch_add(1);
+                }
+                ut_ebr_quiescent(&p);
+            }
+            ut_ebr_offline(&p);
+            ut_ebr_participant_unregister(&p);
+        });
+    }
+    for (ib_u64 i = 1; i <= 5'000; ++i) {
+        ut_rcu_publish(&ptr, make_version(i), &writer);
+        if (i % 64 == 0) ut_ebr_collect(&writer);
+    }
+    stop.store(true);
+    for (std::thread& t : readers) t.join();
+    ut_ebr_synchronize(&writer);
+    ut_ebr_collect(&writer);
+
+    EXPECT_EQ(dead.load(), 0u);
+    EXPECT_EQ(r.count.load(), 5'000u);
+    EXPECT_EQ(ut_rcu_read(&ptr)->id, 5'000u);
+    ut_ebr_participant_unregister(&writer);
+    delete ut_rcu_read(&ptr);
+    delete d;
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include "ut_registry.hpp" // IWYU pragma: keep
+
+namespace {
+
+ut_registry registry = UT_REGISTRY_INIT(registry);
+
+} // namespace
+
+TEST(UtRegistry, NamesAreUniqueAndKeptInRegistrationOrder) {
+    ut_registry_entry a, b, dup;
+    ASSERT_EQ(ut_registry_add(&registry, &a, "test.registry.a"), 0);
+    ASSERT_EQ(ut_registry_add(&registry, &b, "test.registry.b"), 0);
+    EXPECT_EQ(ut_registry_add(&registry, &dup, "test.registry.a"), -1);
+    ut_registry_remove(&registry, &dup);   // a no-op: it was never linked
+
+    const char* names[4];
+    ASSERT_EQ(ut_registry_names(&registry, names, 4), 2u);
+    EXPECT_STREQ(names[0], "test.registry.a");
+    EXPECT_STREQ(names[1], "test.registry.b");
+    EXPECT_EQ(ut_registry_names(&registry, names, 1), 2u);
+
+    ut_registry_lock(&registry);
+    EXPECT_EQ(ut_registry_find(&registry, "test.registry.b"), &b);
+    EXPECT_EQ(ut_registry_find(&registry, "test.registry.c"), nullptr);
+    ut_registry_unlock(&registry);
+
+    ut_registry_remove(&registry, &a);
+    ASSERT_EQ(ut_registry_names(&registry, names, 4), 1u);
+    EXPECT_STREQ(names[0], "test.registry.b");
+    ASSERT_EQ(ut_registry_add(&registry, &a, "test.registry.a"), 0);
+    ut_registry_remove(&registry, &a);
+    ut_registry_remove(&registry, &b);
+    EXPECT_EQ(ut_registry_names(&registry, names, 4), 0u);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+
+#include "ut_rnd.hpp" // IWYU pragma: keep
+
+TEST(UtRndTest, SameSeedSameStream) {
+    ut_rnd a, b;
+    ut_rnd_init(&a, 42);
+    ut_rnd_init(&b, 42);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(ut_rnd_next(&a), ut_rnd_next(&b));
+    }
+}
+
+TEST(UtRndTest, BoundedDrawsStayInRangeAndCoverIt) {
+    ut_rnd r;
+    ut_rnd_init(&r, 7);
+    ib_u64 hist[10] = {};
+    for (int i = 0; i < 100000; ++i) {
+        const ib_u64 v = ut_rnd_bounded(&r, 10);
+        ASSERT_LT(v, 10u);
+        ++hist[v];
+    }
+    for (ib_u64 h : hist) {
+        EXPECT_GT(h, 9000u);
+        EXPECT_LT(h, 11000u);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        const ib_u64 v = ut_rnd_range(&r, 5, 8);
+        ASSERT_GE(v, 5u);
+        ASSERT_LE(v, 8u);
+        const double u = ut_rnd_unit(&r);
+        ASSERT_GE(u, 0.0);
+        ASSERT_LT(u, 1.0);
+    }
+}
+
+TEST(UtRndTest, ForkedStreamsDiverge) {
+    ut_rnd worker, task_a, task_b;
+    ut_rnd_init(&worker, 1);
+    ut_rnd_fork(&worker, &task_a);
+    ut_rnd_fork(&worker, &task_b);
+    std::set<ib_u64> seen;
+    for (int i = 0; i < 64; ++i) {
+        seen.insert(ut_rnd_next(&task_a));
+        seen.insert(ut_rnd_next(&task_b));
+    }
+    EXPECT_EQ(seen.size(), 128u);
+}
+
+TEST(UtRndTest, ThreadGeneratorsAreDistinct) {
+    ut_rnd* main_rnd = ut_rnd_thread();
+    EXPECT_EQ(main_rnd, ut_rnd_thread());
+    ut_rnd* other = nullptr;
+    ib_u64  other_first = 0;
+    std::thread t([&] { other = ut_rnd_thread(); other_first = ut_rnd_next(other); });
+    t.join();
+    EXPECT_NE(main_rnd, other);
+    EXPECT_NE(ut_rnd_next(main_rnd), other_first);
+}
+
+TEST(UtBackoffTest, LimitDoublesUpToMaxAndResets) {
+    ut_rnd r;
+    ut_rnd_init(&r, 3);
+    ut_backoff b;
+    ut_backoff_init(&b, &r, 2, 16);
+    EXPECT_FALSE(ut_backoff_saturated(&b));
+    ut_backoff_pause(&b);
+    EXPECT_EQ(b.limit, 4u);
+    ut_backoff_pause(&b);
+    ut_backoff_pause(&b);
+    EXPECT_EQ(b.limit, 16u);
+    ut_backoff_pause(&b);
+    EXPECT_EQ(b.limit, 16u);
+    EXPECT_TRUE(ut_backoff_saturated(&b));
+    ut_backoff_reset(&b);
+    EXPECT_EQ(b.limit, 2u);
+}
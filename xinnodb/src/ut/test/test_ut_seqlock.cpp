@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ut_cfg.hpp"     // IWYU pragma: keep
+#include "ut_seqlock.hpp" // IWYU pragma: keep
+
+namespace {
+
+/// Every field equal to `gen`: a torn copy mixes generations
+struct Snapshot {
+    ib_u64 gen;
+    ib_u64 a;
+    ib_u32 b;
+    ib_u32 c;
+    ib_u64 d;
+};
+
+Snapshot make_snapshot(ib_u64 gen) noexcept {
+    return { gen, gen, (ib_u32)gen, (ib_u32)gen, gen };
+}
+
+bool consistent(const Snapshot& s) noexcept {
+    return s.a == s.gen && s.b == (ib_u32)s.gen && s.c == (ib_u32)s.gen && s.d == s.gen;
+}
+
+} // namespace
+
+TEST(UtSeqlock, ReadsWhatWasWritten) {
+    ut_seq<Snapshot> s;
+    ut_seq_init(&s, make_snapshot(7));
+    EXPECT_EQ(ut_seq_read(&s).gen, 7u);
+    EXPECT_EQ(s.lock.seq.load(), 0u);
+
+    ut_seq_write(&s, make_snapshot(8));
+    const Snapshot got = ut_seq_read(&s);
+    EXPECT_EQ(got.gen, 8u);
+    EXPECT_TRUE(consistent(got));
+    EXPECT_EQ(s.lock.seq.load(), 2u);
+    EXPECT_EQ(alignof(ut_seq<Snapshot>), 64u);
+}
+
+TEST(UtSeqlock, ReadersDoNotWrite) {
+    ut_seq<Snapshot> s;
+    ut_seq_init(&s, make_snapshot(1));
+    for (int i = 0; i < 1000; ++i) ut_seq_read(&s);
+    EXPECT_EQ(s.lock.seq.load(), 0u);
+}
+
+TEST(UtSeqlock, ConcurrentReadersNeverSeeTornSnapshots) {
+    ut_seq<Snapshot> s;
+    ut_seq_init(&s, make_snapshot(0));
+    std::atomic<bool>   stop{ false };
+    std::atomic<ib_u64> torn{ 0 };
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (!consistent(ut_seq_read(&s))) torn.fetch_add(1);
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&, w] {
+            for (ib_u64 i = 1; i <= 20'000; ++i) ut_seq_write(&s, make_snapshot(i * 2 + w));
+        });
+    }
+    for (std::thread& t : writers) t.join();
+    stop.store(true);
+    for (std::thread& t : readers) t.join();
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_TRUE(consistent(ut_seq_read(&s)));
+    EXPECT_EQ(s.lock.seq.load(), 2u * 40'000u);
+}
+
+TEST(UtSeqlock, CfgReadTakesNoLock) {
+    ib_ulint   size = 16;
+    ut_cfg_var var;
+    ASSERT_EQ(ut_cfg_register(&var, "test.seqlock.size", IB_CFG_ULINT, &size), 0);
+
+    ib_ulint out = 0;
+    ut_cfg_read(&var, &out);
+    EXPECT_EQ(out, 16u);
+    const ib_u64 seq = var.seq.seq.load();
+
+    const ib_ulint v = 48;
+    ASSERT_EQ(ut_cfg_set("test.seqlock.size", &v), 0);
+    EXPECT_EQ(var.seq.seq.load(), seq + 2);
+    ut_cfg_read(&var, &out);
+    EXPECT_EQ(out, 48u);
+    ASSERT_EQ(ut_cfg_get("test.seqlock.size", &out), 0);
+    EXPECT_EQ(out, 48u);
+    EXPECT_EQ(var.seq.seq.load(), seq + 2);
+
+    ut_cfg_unregister(&var);
+}
+
+TEST(UtSeqlock, CfgReadRacesWithSet) {
+    ib_ulint   size = 1;
+    ut_cfg_var var;
+    ASSERT_EQ(ut_cfg_register(&var, "test.seqlock.race", IB_CFG_ULINT, &size), 0);
+
+    std::atomic<bool> stop{ false };
+    std::atomic<int>  bad{ 0 };
+    std::thread       reader([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            ib_ulint out = 0;
+            ut_cfg_read(&var, &out);
+            if (out != 1 && out != ~(ib_ulint)0 - 1) bad.fetch_add(1);
+        }
+    });
+    for (int i = 0; i < 20'000; ++i) {
+        const ib_ulint v = i % 2 == 0 ? ~(ib_ulint)0 - 1 : 1;
+        ASSERT_EQ(ut_cfg_set("test.seqlock.race", &v), 0);
+    }
+    stop.store(true);
+    reader.join();
+    EXPECT_EQ(bad.load(), 0);
+
+    ut_cfg_unregister(&var);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "ut_status.hpp" // IWYU pragma: keep
+
+namespace {
+
+ib_i64 read_counter(const ut_status_var* var) noexcept {
+    return *(const ib_i64*)var->ctx + (ib_i64)var->arg;
+}
+
+bool listed(const char* name) {
+    std::vector<const char*> names(ut_status_names(nullptr, 0));
+    ut_status_names(names.data(), (ib_u32)names.size());
+    for (const char* n : names) {
+        if (std::strcmp(n, name) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(UtStatus, ReadsThroughTheCallback) {
+    ib_i64        counter = 41;
+    ut_status_var var;
+    ASSERT_EQ(ut_status_register(&var, "test.status.counter", read_counter, &counter, 1), 0);
+
+    ib_i64 value = 0;
+    ASSERT_EQ(ut_status_get_i64("test.status.counter", &value), 0);
+    EXPECT_EQ(value, 42);
+    counter = 99;
+    ASSERT_EQ(ut_status_get_i64("test.status.counter", &value), 0);
+    EXPECT_EQ(value, 100);
+    EXPECT_TRUE(listed("test.status.counter"));
+
+    ut_status_unregister(&var);
+    EXPECT_EQ(ut_status_get_i64("test.status.counter", &value), -1);
+    EXPECT_FALSE(listed("test.status.counter"));
+}
+
+TEST(UtStatus, RejectsDuplicateNames) {
+    ib_i64        a = 1, b = 2;
+    ut_status_var va, vb;
+    ASSERT_EQ(ut_status_register(&va, "test.status.dup", read_counter, &a), 0);
+    EXPECT_EQ(ut_status_register(&vb, "test.status.dup", read_counter, &b), -1);
+    ut_status_unregister(&vb);  // harmless on a rejected variable
+
+    ib_i64 value = 0;
+    ASSERT_EQ(ut_status_get_i64("test.status.dup", &value), 0);
+    EXPECT_EQ(value, 1);
+    ut_status_unregister(&va);
+}
+
+TEST(UtStatus, NamesReportsTheTotalWhenTruncated) {
+    ib_i64        c = 0;
+    ut_status_var v1, v2;
+    ASSERT_EQ(ut_status_register(&v1, "test.status.n1", read_counter, &c), 0);
+    ASSERT_EQ(ut_status_register(&v2, "test.status.n2", read_counter, &c), 0);
+    const char* one[1] = { nullptr };
+    EXPECT_GE(ut_status_names(one, 1), 2u);
+    EXPECT_NE(one[0], nullptr);
+    ut_status_unregister(&v2);
+    ut_status_unregister(&v1);
+}